@@ -0,0 +1,30 @@
+// adc_lut.h
+// ADC 查表：启动时把 esp_adc_cal 的 raw→mV 转换展开成 4096 项表，
+// 并为每个踏板生成融合了校准范围与死区映射的 raw→0..255 表（校准范围变化时重建）
+#pragma once
+#include <stdint.h>
+#include "pedal_filter.h"
+
+#define ADC_LUT_SIZE 4096 // 12 位 ADC
+
+extern uint16_t adcRawToMv[ADC_LUT_SIZE];
+
+// 用 halRawToMillivolts 生成 raw→mV 表（halAdcBegin 之后调用一次）
+void AdcLutBegin();
+
+static inline int AdcLutMillivolts(int raw)
+{
+  return adcRawToMv[raw & (ADC_LUT_SIZE - 1)];
+}
+
+// 每个踏板的 raw→0..255 映射表（EMA 之前的 valueRaw）
+struct PedalMapLut
+{
+  uint8_t value[ADC_LUT_SIZE];
+};
+
+// 按滤波器当前的校准范围与死区重建映射表
+void PedalMapLutBuild(PedalMapLut &lut, const PedalFilter &f);
+
+// 对比逐次调用 halRawToMillivolts 与查表的开销（单位 halCycleCount），iterations 次转换的总和
+void AdcLutBenchmark(int iterations, uint32_t &directCycles, uint32_t &lutCycles);
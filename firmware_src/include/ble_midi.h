@@ -0,0 +1,13 @@
+// ble_midi.h
+// BLE-MIDI GATT 服务（蓝牙模式为 MIDI 时代替蓝牙键盘）：DAW / 平板上的音乐软件可直接识别为 MIDI 输入
+// 数据包由 midi_codec.h 组装，这里只负责广播、连接与通知
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+void BleMidiBegin(const char *name);
+bool BleMidiConnected();
+// 当前连接可用的单个通知负载长度（MTU - 3）
+size_t BleMidiPayloadMax();
+// 发送一个 BLE-MIDI 数据包（notify，不等待确认）
+void BleMidiSend(const uint8_t *buf, size_t len);
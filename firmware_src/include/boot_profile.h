@@ -0,0 +1,40 @@
+// boot_profile.h
+// 启动阶段计时：setup() 各阶段到达时刻（us，自芯片启动起）
+// 记录放在 RTC 慢速内存（RTC_NOINIT），软件复位/看门狗复位后仍可读到上一次启动的记录；上电时校验失败则丢弃
+// 当前与上一次启动的记录通过网页门户 /boot 查看
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+enum BootPhase
+{
+  BOOT_SETUP,     // 进入 setup()
+  BOOT_PM,        // 电源管理与看门狗配置完成
+  BOOT_NVS,       // 读取配置完成
+  BOOT_ADC,       // ADC 与 raw→mV 查表就绪
+  BOOT_SENSE,     // 采样任务启动
+  BOOT_FIRST_DAC, // 第一次 DAC 输出
+  BOOT_RADIO,     // WiFi 关闭 / OTA 门户启动完成
+  BOOT_BLE,       // 蓝牙启动 / 关闭完成
+  BOOT_TONES,     // 开机提示音已放入队列（非阻塞，播放在后台进行）
+  BOOT_READY,     // setup() 结束
+  BOOT_PHASE_COUNT,
+};
+
+struct BootProfile
+{
+  uint32_t magic;
+  uint32_t bootCount;   // 自上电以来的启动次数
+  uint32_t resetReason; // esp_reset_reason()
+  uint32_t us[BOOT_PHASE_COUNT]; // 0 表示本次启动未经过该阶段
+};
+
+// setup() 最开始调用：保存上一次启动的记录并开始新的记录
+void BootProfileBegin(uint32_t resetReason);
+// 记录阶段到达时刻（每次启动只记录第一次，可在任意任务中调用）
+void BootMark(BootPhase phase);
+const BootProfile &BootProfileCurrent();
+// 上一次启动的记录；上电后的第一次启动没有记录，返回 false
+bool BootProfilePrevious(BootProfile &out);
+// 文本报告：每行 "boot_<阶段> 到达时刻us 距上一阶段us"，之后是上一次启动的 "prev_boot_..." 行
+size_t BootProfileFormat(char *buf, size_t len);
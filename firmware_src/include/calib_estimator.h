@@ -0,0 +1,56 @@
+// calib_estimator.h
+// 校准用的流式稳健估计（每个踏板 O(1) 内存，可在主机上编译运行）：
+//   P² 分位数估计（Jain & Chlamtac 1985）：0.5% / 99.5% 分位数作为松开/踩到底端点，单个 ADC 尖峰不会拉宽范围
+//   噪声底：二阶差分 x[n]-2x[n-1]+x[n-2] 绝对值的中位数（同样用 P²），踩踏过程中的匀速变化不计入噪声
+// 死区按噪声自动确定，取代固定的 5%
+#pragma once
+#include <stdint.h>
+
+#define CALIB_QUANTILE_LOW 0.005f
+#define CALIB_QUANTILE_HIGH 0.995f
+// 死区 = Calib_DeadZone_Sigma × 噪声标准差 + Calib_DeadZone_BaseMv，并限制在范围的 [MIN, MAX] 比例内
+#define Calib_DeadZone_Sigma 6
+#define Calib_DeadZone_BaseMv 2
+#define Calib_DeadZone_MinPct 0.01f
+#define Calib_DeadZone_MaxPct 0.15f
+
+struct P2Quantile
+{
+  float p;
+  int count;
+  float q[5];  // 标记高度
+  int n[5];    // 标记实际位置
+  float np[5]; // 标记期望位置
+};
+
+void P2QuantileReset(P2Quantile &e, float p);
+void P2QuantileAdd(P2Quantile &e, float x);
+// 不足 5 个样本时返回已有样本中按位置最接近的值
+float P2QuantileValue(const P2Quantile &e);
+
+struct CalibEstimator
+{
+  P2Quantile low;
+  P2Quantile high;
+  P2Quantile noise; // 二阶差分绝对值的中位数
+  int prev1;
+  int prev2;
+  uint32_t count;
+  int rawMin; // 原始 min/max，仅用于对比
+  int rawMax;
+};
+
+struct CalibResult
+{
+  int minV;
+  int maxV;
+  float noiseMv;  // 估计的噪声标准差（mV）
+  int deadZoneMv; // 两端各自的死区（mV）
+};
+
+void CalibEstimatorReset(CalibEstimator &c);
+void CalibEstimatorAdd(CalibEstimator &c, int mv);
+// 当前估计；样本太少（< 5）时端点退回原始 min/max
+CalibResult CalibEstimatorResult(const CalibEstimator &c);
+// 死区（mV）换算成 AdcRemap 使用的比例；deadZoneMv <= 0（旧版校准数据）时沿用 5%
+float CalibDeadZonePct(int minV, int maxV, int deadZoneMv);
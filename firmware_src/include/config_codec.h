@@ -0,0 +1,56 @@
+// config_codec.h
+// 持久化配置的单块编码：所有参数打包成一个带版本号与 CRC 的二进制块，NVS 中只占一个 blob 键
+// 一次 putBytes 写入即整体替换（掉电时要么是旧块要么是新块），CRC 不符时整块丢弃、回到默认值
+// 同时负责从旧固件的逐键布局（sustainmin/sustainmax/.../blactive）迁移（可在主机上编译运行）
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "output_curve.h"
+#include "pedal.h"
+
+// 编码（小端）：
+//   头部   "PCFG" | uint16 版本 | uint16 负载长度 | uint32 负载 CRC-32
+//   负载   每个踏板（按 PEDAL_ 索引）int16 {min, max, 死区} | uint8 标志（bit0 蓝牙开关）|
+//          每个踏板的输出曲线（output_curve.h）：
+//          uint16 gamma | uint8 {类型, x0, x1, y0, y1, 点数} | uint8 px[8] | uint8 py[8] | uint8 {开关阈值 on, off}
+#define CONFIG_VERSION 1
+#define CONFIG_HEADER_SIZE 12
+#define CONFIG_CALIB_SIZE (PEDAL_COUNT * 3 * 2 + 1)
+#define CONFIG_CURVE_SIZE (2 + 6 + CURVE_POINTS_MAX * 2 + 2)
+#define CONFIG_PAYLOAD_SIZE (CONFIG_CALIB_SIZE + PEDAL_COUNT * CONFIG_CURVE_SIZE)
+#define CONFIG_BLOB_MAX (CONFIG_HEADER_SIZE + CONFIG_PAYLOAD_SIZE)
+
+struct ConfigData
+{
+  int minV[PEDAL_COUNT]; // 霍尔范围（mV）
+  int maxV[PEDAL_COUNT];
+  int deadZone[PEDAL_COUNT]; // 死区（mV），0 表示沿用 5%
+  bool bluetoothActive;
+  OutputCurve curve[PEDAL_COUNT]; // 输出曲线
+};
+
+enum ConfigStatus
+{
+  CONFIG_OK,
+  CONFIG_TRUNCATED,   // 长度不足（含未写入过）
+  CONFIG_BAD_MAGIC,
+  CONFIG_BAD_VERSION, // 比固件更新的版本
+  CONFIG_BAD_CRC,
+};
+
+// 未校准时的默认值（min > max，AdcRemap 输出 0）
+void ConfigDefaults(ConfigData &c);
+// 返回写入长度，缓冲不足时返回 0
+size_t ConfigEncode(const ConfigData &c, uint8_t *buf, size_t len);
+// 失败时 c 保持为默认值；以后增加版本时，旧版本的负载在这里逐版本升级
+// 单条曲线参数无效（CurveValid）时只把该曲线恢复为默认值，不影响其余配置
+ConfigStatus ConfigDecode(const uint8_t *buf, size_t len, ConfigData &c);
+const char *ConfigStatusName(ConfigStatus s);
+
+// 旧固件的逐键布局（每个踏板 putInt min/max，putBool 蓝牙开关；没有死区与曲线）：
+// 读取函数在键存在时写入 value 并返回 true
+typedef bool (*ConfigLegacyRead)(void *ctx, const char *key, int32_t &value);
+#define CONFIG_LEGACY_KEY_COUNT (PEDAL_COUNT * 2 + 1)
+extern const char *const configLegacyKeys[CONFIG_LEGACY_KEY_COUNT];
+// 从旧键填充 c（缺失的键与死区、曲线取默认值），至少存在一个旧键时返回 true
+bool ConfigMigrateLegacy(ConfigData &c, ConfigLegacyRead read, void *ctx);
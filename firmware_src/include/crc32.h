@@ -0,0 +1,8 @@
+// crc32.h
+// CRC-32（IEEE 802.3，与 gzip/zlib 相同），用于 gzip 结尾、配置块与采样日志的校验（可在主机上编译运行）
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// crc 初值为 0，可分段连续调用
+uint32_t Crc32Update(uint32_t crc, const uint8_t *data, size_t len);
@@ -0,0 +1,17 @@
+// dac_dither.h
+// 抖动 DAC 输出的调制核心：目标码值带 8 位小数（Q8），以远高于踏板带宽的速率输出相邻两个码值，
+// 一阶 sigma-delta（误差反馈）使平均值等于目标，量化噪声被推到高频，由钢琴输入端的 RC 滤除（可在主机上编译运行）
+#pragma once
+#include <stdint.h>
+
+// 0..255 映射值（Q8）→ DAC 码值（Q8），满量程对应 Max_DAC_Voltage（与 dacWrite(value * Max_DAC_Voltage / 3.3) 同一比例）
+int DacCodeQ8(int valueQ8);
+
+struct DacDither
+{
+  int32_t errQ8; // 累计的量化误差，|err| ≤ 128
+};
+
+void DacDitherReset(DacDither &d);
+// 输出下一个样本的码值（0-255），只会是目标码值向下或向上取整的两个值之一
+uint8_t DacDitherNext(DacDither &d, int targetQ8);
@@ -0,0 +1,8 @@
+// dac_stream.h
+// 抖动 DAC 的输出级：I2S0 内置 DAC 模式，DMA 以 Dac_Dither_Rate_Hz 连续输出两路 DAC（GPIO25/26），
+// 独立任务用 dac_dither.h 填充 DMA 缓冲；采样任务只更新目标码值，不等待输出
+#pragma once
+
+void DacStreamBegin();
+// 设置某个 DAC 引脚的目标码值（Q8），下一个 DMA 缓冲开始生效
+void DacStreamSet(int pin, int codeQ8);
@@ -0,0 +1,60 @@
+// delta_patch.h
+// 差分升级补丁的流式应用（bsdiff 式）：旧镜像来自正在运行的分区，补丁按任意大小分块送入，
+// 生成的新镜像按顺序交给 sink。内存占用固定（约 DELTA_BLOCK_SIZE + 200 字节），可在主机上编译运行。
+//
+// 补丁格式（小端）：
+//   头部 DELTA_HEADER_SIZE 字节：magic "PDLT"，uint32 旧镜像长度，uint32 新镜像长度，
+//                                旧镜像 SHA-256，新镜像 SHA-256
+//   随后是若干记录，直到新镜像写满：
+//     varint diffLen，varint extraLen，zigzag varint seek
+//     diffLen 字节差值：new[i] = old[oldPos + i] + diff[i]（逐字节相加，模 256）
+//     extraLen 字节直接写入新镜像
+//     oldPos += diffLen + seek
+// 补丁本身可再用 gzip 压缩（差值大多为 0，压缩率很高），由 ota_stream 先解压再交给这里。
+// 生成补丁：pio run -e native && .pio/build/native/program delta 旧.bin 新.bin 补丁.bin
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "sha256.h"
+
+#define DELTA_MAGIC "PDLT"
+#define DELTA_HEADER_SIZE (4 + 4 + 4 + SHA256_DIGEST_SIZE * 2)
+#define DELTA_BLOCK_SIZE 256
+
+// 从旧镜像 offset 处读取 len 字节
+typedef bool (*DeltaReadFn)(void *ctx, uint32_t offset, uint8_t *buf, size_t len);
+typedef bool (*DeltaSink)(void *ctx, const uint8_t *data, size_t len);
+
+struct DeltaPatch
+{
+  DeltaReadFn read;
+  void *readCtx;
+  uint32_t oldLimit; // 可读取的旧镜像范围（运行分区大小）
+  DeltaSink sink;
+  void *sinkCtx;
+
+  int state;
+  uint8_t header[DELTA_HEADER_SIZE];
+  size_t headerLen;
+  uint32_t oldSize;
+  uint32_t newSize;
+
+  uint64_t varint;
+  int varShift;
+  int field;        // 正在解析的记录字段：0 diffLen，1 extraLen，2 seek
+  uint32_t diffLen;
+  uint32_t extraLen;
+  int64_t seek;     // 本条记录结束后 oldPos 的额外偏移
+  int64_t oldPos;
+  uint32_t newPos;
+
+  Sha256Ctx sha; // 新镜像
+  uint8_t block[DELTA_BLOCK_SIZE];
+  const char *error;
+};
+
+void DeltaPatchBegin(DeltaPatch &p, DeltaReadFn read, void *readCtx, uint32_t oldLimit, DeltaSink sink, void *sinkCtx);
+// 送入一块补丁数据；返回 false 表示补丁无效（不适用于当前固件、格式错误或写入失败）
+bool DeltaPatchWrite(DeltaPatch &p, const uint8_t *data, size_t len);
+// 补丁结束：新镜像完整且 SHA-256 与补丁头一致时返回 true
+bool DeltaPatchEnd(DeltaPatch &p);
@@ -0,0 +1,44 @@
+// drift_tracker.h
+// 演奏中的端点漂移跟踪（霍尔传感器随温度漂移）：
+// 按固定长度的窗口统计电压，窗口内足够平稳且均值落在松开/踩到底端点附近时，
+// 用慢速 EMA 跟随该位置相对首次观测的偏移，并把同样的偏移加到校准端点上。
+// 半踏板、踩踏过程中的窗口不平稳或不在端点附近，不参与跟踪；总偏移限制在校准范围的一定比例内
+#pragma once
+#include <stdint.h>
+
+// 每个窗口的采样数（1kHz 约 256ms，loop() 采样的 200Hz 约 1.3s）
+#define DRIFT_WINDOW_SAMPLES 256
+// EMA 系数 1/2^DRIFT_EMA_SHIFT（每个符合条件的窗口），时间常数约 16 个窗口
+#define DRIFT_EMA_SHIFT 4
+// 窗口均值与当前端点的距离不超过 DRIFT_BAND_DZ × 死区时视为处于该端点
+#define DRIFT_BAND_DZ 2
+// 窗口内峰峰值不超过 max(DRIFT_STABLE_DZ × 死区, DRIFT_STABLE_MIN_MV) 时视为平稳（排除踩踏过程）
+#define DRIFT_STABLE_DZ 2
+#define DRIFT_STABLE_MIN_MV 4
+// 端点相对校准值的最大偏移（校准范围的比例）
+#define DRIFT_MAX_PCT 0.10f
+
+struct DriftEndpoint
+{
+  bool seen;      // 校准后是否已观测到该端点
+  int refMv;      // 首次观测到的窗口均值
+  int32_t emaQ8;  // 之后窗口均值的 EMA（Q8 mV）
+};
+
+struct DriftTracker
+{
+  int anchorMin; // 校准得到的端点（mV）
+  int anchorMax;
+  DriftEndpoint rest;
+  DriftEndpoint bottom;
+  // 当前窗口统计
+  int count;
+  int32_t sum;
+  int lo;
+  int hi;
+};
+
+// 以校准端点为锚点重新开始跟踪
+void DriftTrackerReset(DriftTracker &d, int minV, int maxV);
+// 输入一次电压采样；窗口结束且端点移动时写回 minV/maxV 并返回 true
+bool DriftTrackerAdd(DriftTracker &d, int mv, int deadZoneMv, int &minV, int &maxV);
@@ -0,0 +1,97 @@
+// filter_policy.h
+// 可替换的平滑策略：死区映射后的 0-255 输入 → 输出值与细分值（写回 PedalFilter 的 lastOut/fineQ8，细分值供抖动 DAC）
+//   FILTER_ADAPTIVE_EMA  原自适应 EMA（定点，见 pedal_filter.h）：大幅变化 α=0.7，否则 0.2，步进限幅 + ±1 死区
+//   FILTER_ONE_EURO      One-Euro：一阶低通，截止频率随速度升高（静止时强平滑，快速踩踏时跟得上）
+//   FILTER_KALMAN        一维匀速模型（位置 + 速度）的卡尔曼滤波，按实际采样间隔预测
+// 每个踏板在编译时选择（pedal_config.h 的 *_Filter_Policy），采样路径上没有间接调用；
+// One-Euro 与卡尔曼使用单精度浮点（ESP32 有硬件 FPU），输出经过滞回量化，静止时不会在两个整数之间跳动（可在主机上编译运行）
+#pragma once
+#include <stdint.h>
+#include "pedal_config.h"
+#include "pedal_filter.h"
+
+enum FilterPolicy
+{
+  FILTER_ADAPTIVE_EMA,
+  FILTER_ONE_EURO,
+  FILTER_KALMAN,
+  FILTER_POLICY_COUNT,
+};
+
+// 采样间隔上限：采样降频或长时间未调用后的第一帧按此计算，避免预测发散
+#define FILTER_POLICY_MAX_DT_US 100000
+// 输出滞回：滤波值偏离当前输出超过此值（LSB）才改变输出
+constexpr float FILTER_POLICY_HOLD_LSB = 0.75f;
+
+struct OneEuroParams
+{
+  float minCutoffHz; // 静止时的截止频率
+  float beta;        // 截止频率随速度（LSB/s）的增量
+  float dCutoffHz;   // 速度估计的截止频率
+};
+
+struct KalmanParams
+{
+  float accelNoise; // 加速度噪声谱密度（(LSB/s²)²·s），越大越相信新测量
+  float measNoise;  // 测量噪声方差（LSB²）
+};
+
+struct OneEuroState
+{
+  OneEuroParams params = {One_Euro_Min_Cutoff_Hz, One_Euro_Beta, One_Euro_D_Cutoff_Hz};
+  bool inited = false;
+  float x = 0;  // 滤波后的位置（LSB）
+  float dx = 0; // 滤波后的速度（LSB/s）
+};
+
+struct KalmanState
+{
+  KalmanParams params = {Kalman_Accel_Noise, Kalman_Meas_Noise};
+  bool inited = false;
+  float x = 0; // 位置（LSB）
+  float v = 0; // 速度（LSB/s）
+  float p00 = 0, p01 = 0, p11 = 0; // 协方差
+};
+
+// 一次更新（z 为映射后的输入，dtUs 为距上一次的间隔），返回滤波后的位置（LSB）
+float OneEuroUpdate(OneEuroState &s, float z, uint32_t dtUs);
+float KalmanUpdate(KalmanState &s, float z, uint32_t dtUs);
+// 滤波值 → PedalFilter 的输出值（滞回量化）与细分值（限制在输出值 ±1 以内，与 PedalFilterFineQ8 相同），返回输出值
+int FilterPolicyOutput(PedalFilter &f, float x);
+
+template <FilterPolicy P>
+struct SmoothPolicy;
+
+template <>
+struct SmoothPolicy<FILTER_ADAPTIVE_EMA>
+{
+  static constexpr bool timed = false; // 不需要采样间隔
+  struct State
+  {
+  };
+  static int Smooth(PedalFilter &f, State &, int valueRaw, uint32_t) { return PedalFilterSmooth(f, valueRaw); }
+};
+
+template <>
+struct SmoothPolicy<FILTER_ONE_EURO>
+{
+  static constexpr bool timed = true;
+  typedef OneEuroState State;
+  static int Smooth(PedalFilter &f, State &s, int valueRaw, uint32_t dtUs)
+  {
+    return FilterPolicyOutput(f, OneEuroUpdate(s, (float)valueRaw, dtUs));
+  }
+};
+
+template <>
+struct SmoothPolicy<FILTER_KALMAN>
+{
+  static constexpr bool timed = true;
+  typedef KalmanState State;
+  static int Smooth(PedalFilter &f, State &s, int valueRaw, uint32_t dtUs)
+  {
+    return FilterPolicyOutput(f, KalmanUpdate(s, (float)valueRaw, dtUs));
+  }
+};
+
+const char *FilterPolicyName(FilterPolicy p);
@@ -0,0 +1,63 @@
+// gesture.h
+// 表驱动的踏板手势识别（每个踏板一个实例，可在主机上编译运行）
+// 输入滤波后的 0-255 映射值与当前时刻，按滞回阈值得到踩下/松开边沿，再查状态转移表输出事件：
+//   PRESS / RELEASE  踩下 / 松开边沿
+//   SHORT            短踩（松开时未到 longMs；开启双击时要等双击窗口结束才确定）
+//   LONG             踩住到 longMs（在踩住期间立即触发，不等松开）
+//   DOUBLE           第一次短踩松开后 doubleMs 内再次踩下（在第二次踩下边沿触发）
+//   REPEAT           长按后继续踩住，每 repeatMs 触发一次
+#pragma once
+#include <stdint.h>
+
+enum GestureEvent
+{
+  GESTURE_PRESS = 1 << 0,
+  GESTURE_RELEASE = 1 << 1,
+  GESTURE_SHORT = 1 << 2,
+  GESTURE_LONG = 1 << 3,
+  GESTURE_DOUBLE = 1 << 4,
+  GESTURE_REPEAT = 1 << 5,
+};
+
+struct GestureConfig
+{
+  uint8_t pressLevel;      // 映射值高于该值视为踩下
+  uint8_t releaseLevel;    // 踩下后低于该值才视为松开（滞回）
+  uint16_t longMs;         // 长按时间
+  uint16_t doubleMs;       // 双击窗口，0 = 不识别双击（短踩在松开时立即确定）
+  uint16_t repeatDelayMs;  // 长按后到第一次 REPEAT 的时间，0 = 不重复
+  uint16_t repeatMs;       // REPEAT 间隔
+};
+
+enum GestureState
+{
+  GESTURE_IDLE,        // 松开
+  GESTURE_DOWN,        // 踩下，尚未到长按
+  GESTURE_HELD,        // 已触发长按，仍踩住
+  GESTURE_WAIT_DOUBLE, // 短踩松开，等待可能的第二次踩下
+  GESTURE_DOWN_SECOND, // 双击的第二次踩下，等待松开
+  GESTURE_STATE_COUNT,
+};
+
+struct Gesture
+{
+  uint8_t state;
+  bool down;         // 滞回后的踩下状态
+  uint32_t deadline; // 当前状态的超时时刻（ms），0 表示无超时
+};
+
+void GestureReset(Gesture &g);
+// 每次采样调用，返回本次产生的 GestureEvent 组合（无事件为 0）
+uint8_t GestureUpdate(Gesture &g, const GestureConfig &cfg, int value, uint32_t nowMs);
+
+// 翻页映射：短踩下一页，长按上一页（长按后继续踩住则按 repeat 持续上一页）
+//   eager=false  下一页在松开时发出（延迟 = 踩下时长）
+//   eager=true   下一页在踩下边沿立即发出；若这次踩踏变成长按，先补一次上一页撤销，再上一页
+enum PageKey
+{
+  PAGE_NEXT,
+  PAGE_PREV,
+};
+#define GESTURE_PAGE_KEYS_MAX 3
+// 返回写入 keys 的按键数
+int GesturePageKeys(uint8_t events, bool eager, PageKey keys[GESTURE_PAGE_KEYS_MAX]);
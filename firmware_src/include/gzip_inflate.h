@@ -0,0 +1,77 @@
+// gzip_inflate.h
+// 流式 gzip 解压（RFC 1951/1952），输入可以按任意大小分块送入，内存占用固定，窗口 INFLATE_WINDOW_SIZE 字节由调用方提供。
+// 解压结果按顺序交给 sink；结尾校验 gzip 的 CRC32 与 ISIZE。
+//   设备上：deflate 交给 ROM 中的 miniz tinfl（不占 flash，约 11KB 状态），这里只逐字节解析 gzip 头，
+//          结尾在 InflateFinish 时按输入的最后 8 字节校验
+//   主机上：可移植实现（[env:native]），输入暂存 INFLATE_STAGE_SIZE 字节，Huffman 表约 1.3KB；
+//          解码以“单元”为粒度（块头 / 一个符号 / 一个存储字节），输入不足时回退到单元起点，剩余字节留到下一块再解
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#ifdef ESP_PLATFORM
+#include "esp32/rom/miniz.h"
+#endif
+
+#define INFLATE_WINDOW_SIZE 32768
+#define INFLATE_STAGE_SIZE 1024
+
+enum InflateStatus
+{
+  INFLATE_NEED_INPUT, // 已处理完本次输入，等待更多数据
+  INFLATE_DONE,       // gzip 流结束且 CRC32/ISIZE 校验通过（设备上只由 InflateFinish 返回）
+  INFLATE_ERROR,      // 数据损坏或 sink 写入失败，见 Inflater::error
+};
+
+// 返回 false 表示写入失败，解压随即中止
+typedef bool (*InflateSink)(void *ctx, const uint8_t *data, size_t len);
+
+#ifndef ESP_PLATFORM
+struct InflateHuffman
+{
+  uint16_t count[16];  // 各码长的码字数量
+  uint16_t symbol[288]; // 按规范码顺序排列的符号
+};
+#endif
+
+struct Inflater
+{
+  uint8_t *window;
+  InflateSink sink;
+  void *sinkCtx;
+
+#ifdef ESP_PLATFORM
+  tinfl_decompressor tinfl;
+  int state;
+  uint8_t flags;     // gzip 头标志
+  uint8_t head[10];  // gzip 固定头 / FEXTRA 长度
+  uint32_t count;    // 当前头部字段已读字节数（FEXTRA 为剩余字节数）
+  uint8_t tail[8];   // 最近 8 字节输入：deflate 结束后即 CRC32 与 ISIZE
+  uint8_t tailLen;
+  uint32_t wpos;     // 窗口写入位置（tinfl 按 2 的幂回绕）
+#else
+  uint8_t stage[INFLATE_STAGE_SIZE];
+  size_t stageLen;
+  size_t pos;
+  uint32_t bitBuf;
+  int bitCount;
+  bool underflow;
+
+  int state;
+  bool lastBlock;
+  uint32_t storedLeft;
+  InflateHuffman lit;
+  InflateHuffman dist;
+
+  uint32_t wpos;     // 窗口写入位置
+  uint32_t flushPos; // 窗口中尚未交给 sink 的起点
+#endif
+  uint32_t crc;
+  uint32_t total;    // 已解压字节数
+  const char *error;
+};
+
+void InflateBegin(Inflater &z, uint8_t *window, InflateSink sink, void *sinkCtx);
+// 送入一块压缩数据；解压出的数据在返回前全部交给 sink
+InflateStatus InflateWrite(Inflater &z, const uint8_t *data, size_t len);
+// 输入结束：未到达 gzip 结尾（截断）时返回 INFLATE_ERROR
+InflateStatus InflateFinish(Inflater &z);
@@ -0,0 +1,50 @@
+// hid_queue.h
+// 翻页按键的发送队列：loop() 识别到翻页手势后只入队，由低优先级的 HID 任务（hid_task.h）发给蓝牙协议栈，
+// 协议栈拥塞时 loop() 不会被阻塞（可在主机上编译运行）
+//   合并：同一按键在 Hid_Coalesce_Ms 内重复入队、且前一个还未发出时合并为一个（踏板抖动造成的重复触发）
+//   丢弃：队列满时按 Hid_Queue_Policy 丢弃新事件或覆盖最旧事件；等待超过 Hid_Max_Age_Ms 的事件不再发送
+//   统计：入队 → 协议栈发出通知的延迟直方图
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#define HID_QUEUE_SIZE 8
+// 延迟直方图（us），最后一档为溢出
+#define HID_LATENCY_BUCKETS 8
+extern const uint32_t hidLatencyBoundsUs[HID_LATENCY_BUCKETS - 1];
+
+struct HidEvent
+{
+  uint8_t key;
+  uint32_t enqueueUs;
+};
+
+struct HidQueueStats
+{
+  uint32_t queued;    // 成功入队
+  uint32_t coalesced; // 被合并
+  uint32_t dropped;   // 队列满被丢弃或覆盖
+  uint32_t stale;     // 等待过久未发送
+  uint32_t unsent;    // 发送时蓝牙已断开
+  uint32_t sent;
+  uint32_t latency[HID_LATENCY_BUCKETS];
+  uint32_t latencyMaxUs;
+  uint32_t latencySumUs; // 32 位足够（累计约 70 分钟的延迟才会溢出）
+};
+
+// 生产者（loop()）：入队成功返回 true，被合并或丢弃返回 false
+// coalesce=false 用于有意连续发送的同一按键（如提前翻页被撤销时的两次上一页）
+bool HidQueuePush(uint8_t key, uint32_t nowUs, bool coalesce = true);
+// 消费者（HID 任务）：取出下一个未过期的事件，过期事件直接计入 stale
+bool HidQueuePop(HidEvent &ev, uint32_t nowUs);
+// 消费者：事件已交给协议栈（ok=true）或因断开未发送
+void HidQueueDone(const HidEvent &ev, bool ok, uint32_t nowUs);
+// 队列中等待的事件数
+uint32_t HidQueuePending();
+
+// 读取统计（各计数独立读取，不保证彼此严格一致）
+void HidQueueReadStats(HidQueueStats &out);
+// 清空队列与统计（主机测试用）
+void HidQueueReset();
+// 文本报告（追加到 /metrics），每行 "名称 值..."，返回写入长度
+size_t HidQueueFormat(char *buf, size_t len);
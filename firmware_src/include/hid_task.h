@@ -0,0 +1,12 @@
+// hid_task.h
+// 低优先级的蓝牙 HID 发送任务：从 hid_queue.h 的队列取出翻页按键交给协议栈，
+// 协议栈拥塞时只有这个任务等待，loop() 与采样任务不受影响
+#pragma once
+#include <stdint.h>
+
+// 发送一个按键；蓝牙未连接时返回 false
+typedef bool (*HidSendFunc)(uint8_t key);
+
+void HidTaskBegin(HidSendFunc send);
+// loop() 调用：入队并唤醒发送任务，立即返回
+void HidTaskPush(uint8_t key, bool coalesce = true);
@@ -0,0 +1,57 @@
+// jitter_stats.h
+// 采样周期抖动统计：记录相邻两次采样的间隔（us），给出最小/最大/平均与 RMS 抖动
+#pragma once
+#include <math.h>
+#include <stdint.h>
+
+struct JitterStats
+{
+  uint32_t count; // 已记录的周期数
+  uint32_t minUs;
+  uint32_t maxUs;
+  uint64_t sumUs;
+  uint64_t sumSqUs;
+  uint32_t lastUs; // 上一次采样时刻，0 表示尚未开始
+};
+
+static inline void JitterStatsReset(JitterStats &s)
+{
+  s.count = 0;
+  s.minUs = UINT32_MAX;
+  s.maxUs = 0;
+  s.sumUs = 0;
+  s.sumSqUs = 0;
+  s.lastUs = 0;
+}
+
+// 在每次采样开始时调用，nowUs 为微秒时间戳
+static inline void JitterStatsMark(JitterStats &s, uint32_t nowUs)
+{
+  if (s.lastUs != 0)
+  {
+    uint32_t period = nowUs - s.lastUs;
+    if (period < s.minUs)
+      s.minUs = period;
+    if (period > s.maxUs)
+      s.maxUs = period;
+    s.sumUs += period;
+    s.sumSqUs += (uint64_t)period * period;
+    s.count++;
+  }
+  s.lastUs = nowUs ? nowUs : 1;
+}
+
+static inline float JitterStatsMeanUs(const JitterStats &s)
+{
+  return s.count ? (float)s.sumUs / s.count : 0.0f;
+}
+
+// 周期的标准差（us）
+static inline float JitterStatsRmsUs(const JitterStats &s)
+{
+  if (s.count == 0)
+    return 0.0f;
+  float mean = (float)s.sumUs / s.count;
+  float var = (float)s.sumSqUs / s.count - mean * mean;
+  return var > 0.0f ? sqrtf(var) : 0.0f;
+}
@@ -0,0 +1,19 @@
+// log_task.h
+// 采样记录器：把踏板帧按 Sample_Log_Rate_Hz 抽样编码（sample_log.h），写入未使用的 spiffs 分区（环形覆盖）；
+// 闪存擦写由低优先级任务完成，loop() 只做编码，每写满一块（4KB）唤醒一次写入任务；
+// 擦写会让采样任务停顿（闪存 cache 关闭），只在门户模式下启动
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "pedal.h"
+
+// 查找分区并启动写入任务（任务中扫描已有记录后才开始接收帧，不占用启动时间）
+void LogTaskBegin();
+// loop() 对每一帧调用
+void LogTaskRecord(const PedalFrame &frame);
+// 按时间顺序（最旧的块在前）把分区中的有效块、最后是尚未写满的当前块依次交给 fn，fn 返回 false 时停止；
+// 与 LogTaskRecord 在同一任务（loop()）中调用，返回交出的块数
+typedef bool (*LogBlockFn)(void *ctx, const uint8_t *block, size_t len);
+uint32_t LogTaskRead(LogBlockFn fn, void *ctx);
+// 文本报告（追加到 /metrics）：块数、已写块、记录数、丢弃的帧与写入耗时，返回写入长度
+size_t LogTaskFormat(char *buf, size_t len);
@@ -0,0 +1,53 @@
+// metrics.h
+// 常驻的低开销性能统计：各阶段耗时（CPU 周期）、踏板→DAC 延迟直方图、采样周期抖动、主循环超时
+// 每组统计只有一个写入方（采样路径、loop() 或 HID 发送任务），读取方通过序号重试得到一致的快照
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "jitter_stats.h"
+
+enum MetricStage
+{
+  METRIC_ADC,    // 三次 analogRead
+  METRIC_FILTER, // 查表 + 平滑
+  METRIC_DAC,    // dacWrite + 弱音开关
+  METRIC_PORTAL, // otaPortalHandle（DNS + HTTP）
+  METRIC_HID,    // bleKeyboard.write（HID 发送任务中）
+  METRIC_MIDI,   // BLE-MIDI 通知（loop() 中）
+  METRIC_STAGE_COUNT,
+};
+
+// 延迟直方图：采样开始 → DAC 写入完成（us），最后一档为溢出
+#define METRIC_LATENCY_BUCKETS 8
+extern const uint32_t metricLatencyBoundsUs[METRIC_LATENCY_BUCKETS - 1];
+
+struct MetricStageStats
+{
+  uint32_t count;
+  uint32_t maxCycles;
+  uint64_t totalCycles;
+};
+
+struct MetricsSnapshot
+{
+  MetricStageStats stage[METRIC_STAGE_COUNT];
+  uint32_t latency[METRIC_LATENCY_BUCKETS];
+  uint32_t latencyMaxUs;
+  JitterStats jitter;         // 采样周期
+  uint32_t loops;             // loop() 次数
+  uint32_t loopMisses;        // 超出 Main_Loop_DelayMs 的次数
+  uint32_t loopOverrunMaxUs;  // 最大超出量
+};
+
+// 采样路径（采样任务或 loop() 内采样）调用
+void MetricsStage(MetricStage stage, uint32_t cycles);
+void MetricsSampleStart(uint32_t nowUs);
+// 采样频率改变（sense_governor.h）：下一次采样不计入采样周期统计，低频期间每帧调用，周期统计只反映全速采样
+void MetricsSampleSkip();
+void MetricsLatency(uint32_t us);
+// loop() 结束时调用
+void MetricsLoop(uint32_t loopUs, uint32_t budgetUs);
+
+void MetricsRead(MetricsSnapshot &out);
+// 生成紧凑的文本报告（每行 "名称 值..."），返回写入长度；cpuMhz 为阶段耗时所用周期的频率
+size_t MetricsFormat(char *buf, size_t len, uint32_t cpuMhz);
@@ -0,0 +1,78 @@
+// midi_codec.h
+// 踏板 → MIDI 控制器消息：延音 CC64、持音 CC66、弱音 CC67，7 位值取自滤波后的 0-255 映射值
+// 只在 7 位值变化时发送；同一批次内多个控制器打包成一个 BLE-MIDI 通知（可在主机上编译运行）
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "pedal.h"
+
+#define MIDI_CC_SUSTAIN 64
+#define MIDI_CC_SOSTENUTO 66
+#define MIDI_CC_SOFT 67
+#define MIDI_STATUS_CC 0xB0
+
+// 按 PEDAL_ 索引的控制器号
+extern const uint8_t midiPedalCc[PEDAL_COUNT];
+
+struct MidiCc
+{
+  uint8_t cc;
+  uint8_t value;    // 0-127
+  uint16_t timeMs;  // 最后一次变化所在采样帧的时刻（ms，回绕）
+};
+
+// 变化检测：每个采样帧更新一次，发送时取出自上次发送以来变化过的控制器（每个只取最新值）
+struct MidiCcTracker
+{
+  int8_t sent[PEDAL_COUNT];    // 最近发出的值，-1 表示尚未发送（连接后先发一次全部当前值）
+  int8_t pending[PEDAL_COUNT]; // 待发送的值，-1 表示无
+  uint16_t pendingMs[PEDAL_COUNT];
+};
+
+void MidiCcReset(MidiCcTracker &t);
+void MidiCcUpdate(MidiCcTracker &t, const PedalFrame &frame);
+// 取出待发送的控制器（按时间先后），并视为已发送；返回个数
+int MidiCcTake(MidiCcTracker &t, MidiCc out[PEDAL_COUNT]);
+
+// BLE-MIDI 数据包（BLE-MIDI 1.0）：
+//   头部 1 字节  10hhhhhh          时间戳高 6 位
+//   每条消息     1ttttttt status data...  时间戳低 7 位
+// 同一状态字节的后续消息使用运行状态：时间戳变化时为 [1ttttttt data...]，不变时只有 [data...]
+// 包内时间戳只能向后走且跨度不超过 127ms（低 7 位回绕时接收方自动进位）
+// 默认 ATT MTU 23 时一个通知最多 20 字节；三个控制器同一时刻变化只需 9 字节
+#define BLE_MIDI_PACKET_MAX 20
+
+struct BleMidiPacket
+{
+  uint8_t buf[BLE_MIDI_PACKET_MAX];
+  uint8_t len;
+  uint8_t capacity;
+  uint8_t status;   // 最近一条消息的状态字节（运行状态），0 表示无
+  uint16_t firstMs; // 头部时间戳
+  uint16_t lastMs;
+};
+
+// capacity 为协商后的 MTU - 3，超过 BLE_MIDI_PACKET_MAX 时按 BLE_MIDI_PACKET_MAX
+void BleMidiPacketBegin(BleMidiPacket &p, size_t capacity = BLE_MIDI_PACKET_MAX);
+// 追加一条控制器消息；包已满或时间戳不能放进本包时返回 false（先发送本包，再从新包开始）
+bool BleMidiPacketAddCc(BleMidiPacket &p, uint8_t channel, uint8_t cc, uint8_t value, uint16_t timeMs);
+
+// 串口 MIDI（31250 波特 8N1，每字节 10 位 = 320us）：同一状态字节的连续消息使用运行状态，
+// 每条控制器消息只需 2 字节；距上次发出状态字节超过 MIDI_STATUS_REFRESH_MS 时重发一次，
+// 中途接入的接收端最迟在这之后同步
+#define MIDI_UART_BAUD 31250
+#define MIDI_UART_BYTE_US (10 * 1000000UL / MIDI_UART_BAUD)
+#define MIDI_STATUS_REFRESH_MS 1000
+// 一批最多 PEDAL_COUNT 条消息：状态 + 每条 2 数据字节
+#define MIDI_SERIAL_BATCH_MAX (1 + PEDAL_COUNT * 2)
+
+struct MidiSerialState
+{
+  uint8_t status;    // 接收端当前的运行状态，0 表示未知（开机或重新同步）
+  uint32_t statusMs; // 最近一次发出状态字节的时刻
+};
+
+void MidiSerialReset(MidiSerialState &s);
+// 编码一批控制器消息，返回写入长度；缓冲不足时返回 0 且不改变状态
+size_t MidiSerialEncode(MidiSerialState &s, uint8_t channel, const MidiCc *cc, int n, uint32_t nowMs, uint8_t *buf,
+                        size_t len);
@@ -1,10 +1,15 @@
 // ota_portal.h
 #pragma once
 #include <Arduino.h>
+#include "pedal.h"
 
 void otaPortalBegin();
 void otaPortalHandle();
 void otaPortalStop();
 bool otaPortalActive();
-// 更新 OTA 页面上踏板状态：index 0=soft,1=sostenuto,2=sustain
-extern "C" void otaPortalSetPedalStatus(int index, int mv, int minv, int maxv, int mapped);
+// 更新 OTA 页面上踏板状态（整帧替换，/status 总是返回同一次采样的数据）；
+// 有 /events 订阅者时每一帧都会进入推送缓冲，应对每个采样帧调用
+void otaPortalSetPedalFrame(const PedalFrame &frame);
+// 网页上修改输出曲线后（已经通过 PedalSetCurve 生效）调用，用于持久化
+typedef void (*OtaCurveSaveFn)(int pedal, const OutputCurve &c);
+void otaPortalSetCurveSave(OtaCurveSaveFn fn);
@@ -0,0 +1,53 @@
+// ota_stream.h
+// OTA 上传的流式处理：按首字节识别 gzip 压缩或原始数据，边接收边解压；解压后的内容按首字节识别
+// 完整镜像（.bin）或差分补丁（delta_patch.h，基于运行分区生成新镜像）。
+// 新镜像边生成边计算 SHA-256，并按顺序交给 write（写入 Update）。OtaStreamEnd 校验通过之前不应切换启动分区。
+// 校验内容：gzip 的 CRC32/ISIZE；补丁头中的旧/新镜像 SHA-256；
+// ESP32 镜像头 hash_appended=1 时，末尾 32 字节必须等于之前全部数据的 SHA-256。
+// （可在主机上编译运行）
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "delta_patch.h"
+#include "gzip_inflate.h"
+#include "sha256.h"
+
+// ESP32 应用镜像头（esp_image_header_t）
+#define OTA_IMAGE_MAGIC 0xE9
+#define OTA_IMAGE_HEADER_SIZE 24
+#define OTA_IMAGE_HASH_APPENDED_OFFSET 23
+
+typedef bool (*OtaWriteFn)(void *ctx, const uint8_t *data, size_t len);
+
+struct OtaStream
+{
+  OtaWriteFn write;
+  void *writeCtx;
+  uint8_t *window; // gzip 解压窗口，INFLATE_WINDOW_SIZE 字节
+  int format;
+  int payload;
+  Inflater inflater;
+  DeltaPatch patch;
+  DeltaReadFn readOld; // 差分补丁的旧镜像（运行分区），未设置时不接受补丁
+  void *readOldCtx;
+  uint32_t oldLimit;
+  Sha256Ctx sha;
+  uint8_t header[OTA_IMAGE_HEADER_SIZE];
+  uint8_t tail[SHA256_DIGEST_SIZE]; // 最近 32 字节，暂不计入哈希
+  size_t tailLen;
+  uint32_t received; // 收到的字节数（压缩后）
+  uint32_t imageSize; // 写入的镜像字节数（解压后）
+  const char *error;
+};
+
+void OtaStreamBegin(OtaStream &s, uint8_t *window, OtaWriteFn write, void *writeCtx);
+// 允许差分补丁：read 读取正在运行的镜像，limit 为运行分区大小（OtaStreamBegin 之后调用）
+void OtaStreamSetBase(OtaStream &s, DeltaReadFn read, void *readCtx, uint32_t limit);
+// 送入一块上传数据；返回 false 表示镜像已判定无效，应中止更新
+bool OtaStreamWrite(OtaStream &s, const uint8_t *data, size_t len);
+// 上传结束：镜像完整且校验通过时返回 true
+bool OtaStreamEnd(OtaStream &s);
+// 是否为 gzip 上传（收到首字节之后有效）
+bool OtaStreamCompressed(const OtaStream &s);
+// 是否为差分补丁
+bool OtaStreamIsDelta(const OtaStream &s);
@@ -0,0 +1,82 @@
+// output_curve.h
+// 输出传递曲线：滤波后的映射值 0-255 → 输出电平，适配不同数码钢琴对半踏板电压的非线性响应（可在主机上编译运行）
+//   CURVE_LINEAR 折线：输入 x0..x1 线性对应输出 y0..y1，两端之外保持端点值（默认 0..255 → 0..255，即原固定比例）
+//   CURVE_GAMMA  幂函数：端点同上，中间按 t^gamma 弯曲（gamma > 1 前段平缓、后段陡峭，< 1 相反）
+//   CURVE_POINTS 自定义点：2..CURVE_POINTS_MAX 个 (x, y) 点，x 严格递增，点之间线性插值，两端之外保持端点值
+// 曲线改变时编译为 256 项查表，采样路径上只查一次表；开关型输出（弱音）在曲线输出上再加滞回
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+enum CurveType
+{
+  CURVE_LINEAR,
+  CURVE_GAMMA,
+  CURVE_POINTS,
+  CURVE_TYPE_COUNT,
+};
+
+#define CURVE_POINTS_MAX 8
+// gamma 以 ×100 存储
+#define CURVE_GAMMA_MIN 10
+#define CURVE_GAMMA_MAX 1000
+
+// 字段按大小排列，没有填充字节（配置块按字段逐个编码，见 config_codec.h）
+struct OutputCurve
+{
+  uint16_t gamma; // ×100，仅 CURVE_GAMMA
+  uint8_t type;
+  uint8_t x0, x1; // 输入端点（CURVE_LINEAR / CURVE_GAMMA），x0 < x1
+  uint8_t y0, y1; // 输出端点（0-255 对应满量程），可以 y0 > y1（反向）
+  uint8_t count;  // 自定义点个数，仅 CURVE_POINTS
+  uint8_t px[CURVE_POINTS_MAX];
+  uint8_t py[CURVE_POINTS_MAX];
+  uint8_t switchOn;  // 开关型输出：曲线输出超过此值时闭合
+  uint8_t switchOff; // 低于此值时断开（switchOff < switchOn，两者之间保持原状态）
+};
+
+// 编译结果：下标为映射值，值为输出（Q8）；开关阈值随表一起发布，采样路径不再读取曲线本身
+struct CurveLut
+{
+  uint16_t q8[256];
+  uint8_t switchOn;
+  uint8_t switchOff;
+};
+
+// 默认曲线：线性 0..255 → 0..255，开关阈值 Soft_Switch_On_Level / Soft_Switch_Off_Level
+void CurveDefault(OutputCurve &c);
+// 检查参数范围（来自网页或 NVS 的曲线先检查再编译）
+bool CurveValid(const OutputCurve &c);
+// 曲线 → 查表；scale 把 0..255 电平（Q8）换算为输出单位（如 DacCodeQ8），为空时保持电平
+void CurveCompile(const OutputCurve &c, CurveLut &lut, int (*scale)(int q8) = nullptr);
+
+// 整数映射值查表
+static inline int CurveLookup(const CurveLut &lut, int value)
+{
+  return lut.q8[value < 0 ? 0 : value > 255 ? 255 : value];
+}
+
+// 细分映射值（Q8）查表：相邻两项之间线性插值，保留抖动 DAC 的小数部分
+static inline int CurveLookupQ8(const CurveLut &lut, int valueQ8)
+{
+  if (valueQ8 <= 0)
+    return lut.q8[0];
+  if (valueQ8 >= 255 << 8)
+    return lut.q8[255];
+  int i = valueQ8 >> 8;
+  int a = lut.q8[i];
+  return a + (((lut.q8[i + 1] - a) * (valueQ8 & 0xFF)) >> 8);
+}
+
+// 开关型输出的滞回判断：返回新的开关状态
+static inline bool CurveSwitch(const CurveLut &lut, bool on, int value)
+{
+  int level = CurveLookup(lut, value);
+  return on ? level >= lut.switchOff << 8 : level > lut.switchOn << 8;
+}
+
+// 网页接口用的 JSON：{"t":类型,"x0":..,"x1":..,"y0":..,"y1":..,"g":gamma×100,"pts":[[x,y],...],"on":..,"off":..}
+// 返回写入长度（不含结尾 0），缓冲不足时截断
+size_t CurveFormatJson(char *buf, size_t len, const OutputCurve &c);
+// 解析自定义点 "x:y,x:y,..."，成功时写入 count/px/py（不检查递增，由 CurveValid 检查）
+bool CurveParsePoints(const char *text, OutputCurve &c);
@@ -0,0 +1,67 @@
+// pedal.h
+// 踏板采样 → 滤波 → DAC 输出流水线（只依赖 pedal_hal.h，可在主机上编译运行）
+#pragma once
+#include <stdint.h>
+#include "output_curve.h"
+
+// 踏板索引（与 AdcRemap 内部滤波状态的下标一致）
+#define PEDAL_SUSTAIN 0
+#define PEDAL_SOSTENUTO 1
+#define PEDAL_SOFT 2
+#define PEDAL_COUNT 3
+
+// 霍尔范围校准参数（单位 mV），由 loop()/校准读写，经 PedalApplyCalibration 生效；
+// 采样路径不访问它们，演奏中的漂移修正也不改写它们（修正后的范围见 PedalFrame::minv/maxv）
+extern int Sustain_Pedal_MIN;
+extern int Sustain_Pedal_MAX;
+extern int Sostenuto_Pedal_MIN;
+extern int Sostenuto_Pedal_MAX;
+extern int Soft_Pedal_MIN;
+extern int Soft_Pedal_MAX;
+// 两端死区（mV），由校准时估计的噪声决定；0 表示沿用 5%（旧版校准数据）
+extern int Sustain_Pedal_DEADZONE;
+extern int Sostenuto_Pedal_DEADZONE;
+extern int Soft_Pedal_DEADZONE;
+
+// 一次采样的结果（作为整体传递，读取方不会看到不一致的 min/max/映射值）
+struct PedalFrame
+{
+  uint32_t timeUs;        // 采样开始时刻（us）
+  int mv[PEDAL_COUNT];    // 平均后的电压（mV）
+  int minv[PEDAL_COUNT];  // 采样时使用的校准范围（mV）
+  int maxv[PEDAL_COUNT];
+  int value[PEDAL_COUNT]; // 滤波后的映射值 0-255
+  int fine[PEDAL_COUNT];  // 细分映射值（Q8，0..255×256），抖动 DAC 输出用
+};
+
+// 初始化 ADC 并生成 raw→mV 校准表
+void PedalBegin();
+
+// 死区为 mV（≤0 时沿用 5%，见 PedalFilterSetRangeMv）；范围与当前映射不同时先重建查表，只在采样任务启动前使用
+int AdcRemap(int pin, int minV, int maxV, int deadZoneMv = 0);
+// 最近一次 AdcRemap 读到的电压（mV）
+int AdcLastMillivolts(int pin);
+
+// 采样三个踏板
+void PedalSample(PedalFrame &frame);
+// 在 loop() 中调用：漂移跟踪移动了端点时，按新范围重建该踏板的映射查表并切换（约 4096 次映射，不占用采样周期）
+void PedalMaintain();
+// 输出延音/持音 DAC 与弱音开关（各经过自己的输出曲线）；sostenutoEnabled=false 时不输出持音信号
+void PedalOutput(const PedalFrame &frame, bool sostenutoEnabled);
+
+// 设置一个踏板的输出曲线（按 PEDAL_ 索引，调用前先 CurveValid）：编译为查表后立即生效
+// 查表双缓冲，可在采样任务运行时调用（两次调用之间需间隔一次采样以上，网页请求远大于此）
+// PedalBegin 时尚未设置过的踏板使用默认曲线
+void PedalSetCurve(int pedal, const OutputCurve &c);
+const OutputCurve &PedalCurve(int pedal);
+
+// 校准模式下采样一次，更新稳健估计（calib_estimator.h）并写入 min/max/死区
+void CalibrationSample();
+// 将 min/max 与估计器重置为待校准状态
+void CalibrationReset();
+// 让当前 min/max/死区立即生效（无需重启）：以其为锚点重新开始漂移跟踪，下一次采样按新范围映射
+// 调用时采样任务不能在运行（开机读取参数后、校准结束时）
+void PedalApplyCalibration();
+
+bool CheckButton(int pin);
+bool CheckButtonLong(int pin, unsigned long holdMs);
@@ -0,0 +1,114 @@
+// pedal_config.h
+// 引脚与常量配置（main.cpp 与踏板处理流水线共用）
+#pragma once
+
+// DAC配置
+#define DAC_Sustain_PIN 25   // 延音踏板电压输出
+#define DAC_Sostenuto_PIN 26 // 持音踏板电压输出
+#define Switch_Soft_PIN 17   // 开关型踏板输出（因为只有俩DAC，所以还有一个踏板只能用开关了）
+
+// ADC配置
+#define ADC_Sustain_PIN 35   // ADC1_CH4 (GPIO32)延音踏板检测霍尔
+#define ADC_Sostenuto_PIN 32 // ADC1_CH5 (GPIO33)持音踏板检测霍尔
+#define ADC_Soft_PIN 33      // ADC1_CH7 (GPIO35)弱音踏板检测霍尔
+
+// 按钮配置（低电平有效）
+#define Sustain_BUTTON_PIN 27   // 延音踏板检测按钮
+#define Sostenuto_BUTTON_PIN 14 // 持音踏板检测按钮
+#define Soft_BUTTON_PIN 13      // 弱音踏板检测按钮
+
+// 功能按键绑定
+#define Calibrate_Button Sostenuto_BUTTON_PIN // 持音踏板按钮触发校准功能
+
+// 主循环延时
+#define Main_Loop_DelayMs 5
+
+// 启动预算：进入 setup() 到第一次 DAC 输出（boot_profile.h 的 setup → first_dac）不超过此值（ms），
+// 主机上 bench_boot 按 setup() 的顺序回放并检查，设备上调试输出中超出时给出警告
+#define Boot_First_Dac_Budget_Ms 50
+
+// 独立采样任务：1 = 采样/DAC 输出在定时器驱动的高优先级任务中运行，0 = 沿用 loop() 中采样
+#define Sense_Task_Enable 1
+// 采样任务频率（Hz）；滤波参数按每次采样生效，频率越高响应越快
+#define Sense_Rate_Hz 1000
+// 采样帧环形缓冲的满载策略：RING_DROP_NEWEST（丢弃新帧）或 RING_OVERWRITE_OLDEST（覆盖旧帧，loop() 总能拿到最新数据）
+#define Sense_Ring_Policy RING_OVERWRITE_OLDEST
+
+// 采样频率调节（sense_governor.h，仅采样任务）：任一踏板在动时按 Sense_Rate_Hz 采样，全部静止 Sense_Idle_After_Ms 后
+// 降到 Sense_Idle_Rate_Hz，loop() 同时放慢到 Main_Loop_Idle_DelayMs，CPU 在两次唤醒之间进入轻睡眠；
+// 检测到运动的那一帧之后立即恢复全速并唤醒 loop()。最坏唤醒延迟约为一个低频周期 + 一个全速周期
+#define Sense_Governor_Enable 1
+#define Sense_Idle_Rate_Hz 50
+#define Sense_Idle_After_Ms 2000
+#define Main_Loop_Idle_DelayMs 100
+// 运动阈值（mV）：任一踏板偏离静止位置超过此值即恢复全速（需高于静止时的 ADC 噪声）
+#define Sense_Motion_Mv 40
+
+// 漂移跟踪：演奏中踏板明显松开/踩到底时缓慢修正两端端点（霍尔温漂），见 drift_tracker.h
+#define Drift_Track_Enable 1
+
+// 平滑策略（filter_policy.h），每个踏板编译时选择：FILTER_ADAPTIVE_EMA（原自适应EMA，定点）、
+// FILTER_ONE_EURO 或 FILTER_KALMAN（浮点）。主机上 program filters 记录.bin 用下载的采样记录比较三种策略的
+// 阶跃延迟、静止抖动与开销（filter_harness.h），设备上每次平滑的周期数见 /metrics 的 filter 阶段
+#define Sustain_Filter_Policy FILTER_ADAPTIVE_EMA
+#define Sostenuto_Filter_Policy FILTER_ADAPTIVE_EMA
+#define Soft_Filter_Policy FILTER_ADAPTIVE_EMA
+// One-Euro 参数：静止截止频率（Hz）、截止频率随速度（LSB/s）的增量、速度估计的截止频率（Hz）
+#define One_Euro_Min_Cutoff_Hz 1.0f
+#define One_Euro_Beta 0.02f
+#define One_Euro_D_Cutoff_Hz 1.0f
+// 卡尔曼参数：加速度噪声谱密度（越大越跟手）、测量噪声方差（LSB²）
+#define Kalman_Accel_Noise 1.0e6f
+#define Kalman_Meas_Noise 16.0f
+
+const float Max_DAC_Voltage = 1.7f; // DAC输出的最大电压
+
+// 弱音开关的默认滞回阈值（0-255，作用于弱音踏板输出曲线之后，见 output_curve.h）：超过 On 闭合，低于 Off 断开
+// 每个踏板的输出曲线与弱音阈值保存在配置块中，可在网页门户上修改
+#define Soft_Switch_On_Level 135
+#define Soft_Switch_Off_Level 119
+
+// 抖动 DAC 输出：1 = 两路 DAC 由 I2S DMA 以 Dac_Dither_Rate_Hz 连续输出，在相邻码值间做 sigma-delta 调制，
+// 经钢琴踏板输入端的 RC 滤波后分辨率高于 8 位（1.7V 上限只用到约 131 个码值）；0 = 每次采样 dacWrite 一次
+// 取舍：开启后 I2S 驱动一直持有 APB 频率锁，CPU 不再进入轻睡眠，采样频率调节只减少采样次数，
+// 静止电流按 bench_governor 的“不睡眠”一列计算（省电效果基本消失），因此默认关闭
+#define Dac_Dither_Enable 0
+#define Dac_Dither_Rate_Hz 40000
+
+// 采样记录（log_task.h，调试用）：踏板电压与输出按 Sample_Log_Rate_Hz 抽样，差值编码后写入 spiffs 分区（环形覆盖，每 4KB 一次擦写），
+// 在网页门户下载（/log），主机上用 program log 解码为 CSV。只在门户模式（开机踩住弱音踏板）下记录；
+// 200Hz 下每条约 5 字节，512KB 保存最近约 9 分钟，约每 4 秒擦写一个扇区（见 bench_log）
+// 注意：擦写闪存期间两个核的 cache 都被关闭，采样任务与 esp_timer 不在 IRAM 中，每次擦除会让 1kHz 采样停顿数十毫秒；
+// 开启前先在设备上确认 /metrics 的 jitter 最大值（log 行的擦写耗时即停顿长度）
+#define Sample_Log_Enable 0
+#define Sample_Log_Rate_Hz 200
+
+// 蓝牙模式（开机踩住延音踏板切换蓝牙开关，开启时按此模式运行）
+#define BLUETOOTH_MIDI 1     // BLE-MIDI：延音/持音/弱音以 CC64/CC66/CC67 连续发送（midi_codec.h）
+#define BLUETOOTH_KEYBOARD 2 // 蓝牙键盘：持音踏板翻页
+#define Bluetooth_Mode_Default BLUETOOTH_KEYBOARD
+// MIDI 通道（0-15 对应通道 1-16）
+#define Midi_Channel 0
+
+// 有线 MIDI 输出（Serial2 只用 TX，经 220Ω 接 5 针 DIN 的 5 脚），与 DAC、蓝牙同时工作；需要外接 MIDI 口，默认关闭
+#define Midi_Uart_Enable 0
+#define Midi_Uart_TX_PIN 18
+// 两批之间的最小间隔（ms）：一批最多 7 字节 = 2.24ms，间隔大于它串口就不会积压
+// 最坏延迟（采样 → 最后一个控制器的最后一位发出）= 采样周期 1ms + 主循环 Main_Loop_DelayMs + 7 × 320us ≈ 8.2ms
+#define Midi_Uart_Interval_Ms 3
+
+// 翻页手势（gesture.h）：踩下/松开阈值（0-255，滞回）、长按时间
+#define LongPressTimeMs 500
+#define Page_Press_Level 100
+#define Page_Release_Level 90
+// 1 = 踩下边沿立即下一页（变成长按时撤销并上一页），0 = 松开时才下一页
+#define Page_Turn_Eager 1
+// 长按后继续踩住时连续上一页的延迟与间隔，0 = 关闭
+#define Page_Repeat_Delay_Ms 0
+#define Page_Repeat_Ms 400
+
+// 翻页按键发送队列（hid_queue.h）：满载策略、重复触发合并窗口、过期时间
+// 拥塞时最旧的翻页最先过期，满载时覆盖最旧事件，恢复后优先发出最近的翻页
+#define Hid_Queue_Policy RING_OVERWRITE_OLDEST
+#define Hid_Coalesce_Ms 150
+#define Hid_Max_Age_Ms 1000
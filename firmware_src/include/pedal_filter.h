@@ -0,0 +1,72 @@
+// pedal_filter.h
+// AdcRemap 的滤波核心：电压(mV) → 死区映射 → 自适应EMA + 步进限幅 + 微抖动死区 → 0-255
+// 主路径为纯整数定点实现；浮点版本保留作为参考，用于主机上对比误差与开销
+#pragma once
+#include <stdint.h>
+
+// 定点参数（EMA 状态为 Q16，系数为 Q26）
+#define PEDAL_FILTER_SHIFT 16
+#define PEDAL_FILTER_ALPHA_SHIFT 26
+
+// 系数取浮点常量的精确值（0.7f/0.2f 都是 24 位尾数 × 2^-26），两种实现的 EMA 只差各自的舍入
+constexpr int32_t PedalFilterAlpha(float a) { return (int32_t)(a * (float)(1L << PEDAL_FILTER_ALPHA_SHIFT)); }
+
+constexpr float PEDAL_FILTER_ALPHA_FAST_F = 0.7f; // 大幅变化快速跟随
+constexpr float PEDAL_FILTER_ALPHA_SLOW_F = 0.2f; // 小抖动更稳
+constexpr int32_t PEDAL_FILTER_ALPHA_FAST = PedalFilterAlpha(PEDAL_FILTER_ALPHA_FAST_F);
+constexpr int32_t PEDAL_FILTER_ALPHA_SLOW = PedalFilterAlpha(PEDAL_FILTER_ALPHA_SLOW_F);
+constexpr int PEDAL_FILTER_FAST_DELTA = 15; // 输入与取整后的 EMA 相差超过该值使用快速系数
+constexpr int PEDAL_FILTER_MAX_STEP = 12;                         // 0..255 空间下单次最大变化
+constexpr int PEDAL_FILTER_FINE_SHIFT = 4;                        // 细分值的再平滑（1/16），压住死区内的噪声
+
+struct PedalFilter
+{
+  // 校准范围（用于判断是否需要重新计算映射参数）
+  int minV;
+  int maxV;
+  int deadZoneMv; // PedalFilterSetRangeMv 传入的死区（mV）；按比例设置时为 PEDAL_FILTER_DEAD_ZONE_PCT
+  // 由校准范围预先计算的映射参数
+  int reminV;
+  int span;          // remaxV - reminV
+  uint32_t recipQ32; // floor(255 * 2^32 / span) + 1，每次采样只需一次乘法
+  // 滤波状态
+  bool inited;
+  int32_t emaQ16;
+  int lastOut;
+  int32_t fineQ8; // 细分值（Q8），见 PedalFilterFineQ8
+};
+
+// PedalFilter::deadZoneMv 的取值：死区由比例直接给出（不会与任何 mV 死区相等）
+#define PEDAL_FILTER_DEAD_ZONE_PCT INT32_MIN
+
+// 加载校准范围并预计算映射参数（只在范围变化时调用）；死区为 mV（≤0 时沿用 5%），换算成比例只在这里进行，
+// 采样路径上只需比较整数的范围与死区
+void PedalFilterSetRangeMv(PedalFilter &f, int minV, int maxV, int deadZoneMv);
+// 同上，死区直接给出比例（主机工具与基准测试用）
+void PedalFilterSetRange(PedalFilter &f, int minV, int maxV, float deadZonePct);
+// 死区映射：电压 → 平滑前的 0-255（可预先展开成查表，见 adc_lut.h）
+int PedalFilterMap(const PedalFilter &f, int mv);
+// 平滑：映射值 → 自适应EMA + 步进限幅 + 微抖动死区后的 0-255
+int PedalFilterSmooth(PedalFilter &f, int valueRaw);
+// 输入一次电压采样，返回 0-255（Map + Smooth）
+int PedalFilterUpdate(PedalFilter &f, int mv);
+// 最近一次 Smooth 的细分值（Q8，0..255×256）：EMA 再经 1/16 平滑后限制在输出值 ±1 以内，
+// 大幅变化仍跟随输出值（保留步进限幅），微抖动死区内被丢弃的小数部分交给抖动 DAC 输出（dac_dither.h）
+int PedalFilterFineQ8(const PedalFilter &f);
+
+// 浮点参考实现（原 AdcRemap）。快慢系数原先按截断后的 (int)(输入 - EMA) 选择：EMA 停在整数附近、输入恰好相差 16 时，
+// 结果取决于 EMA 比整数略大还是略小（浮点与 Q16 的舍入不同），两种实现会选中不同系数并分叉数个 LSB；
+// 现在两种实现都比较输入与取整后的 EMA（整数，两边一致），阈值相差不到 0.5 LSB
+struct PedalFilterFloat
+{
+  bool inited;
+  float ema;
+  int lastOut;
+};
+
+int PedalFilterFloatUpdate(PedalFilterFloat &f, int mv, int minV, int maxV, float deadZonePct);
+
+// 在同一段电压序列上分别运行定点与浮点实现（死区 5%），输出写入 outFixed/outFloat，
+// 各自的总开销以 halCycleCount 计（设备上为 CPU 周期，主机上为纳秒）
+void PedalFilterBenchmark(const int *mv, int n, int minV, int maxV, uint8_t *outFixed, uint8_t *outFloat,
+                          uint32_t &fixedCycles, uint32_t &floatCycles);
@@ -0,0 +1,28 @@
+// pedal_hal.h
+// 硬件抽象层：踏板流水线只通过这里访问 ADC/DAC/GPIO/时钟
+// ESP32 实现见 src/hal_esp32.cpp，主机（native）模拟实现见 src/native/hal_native.cpp
+#pragma once
+#include <stdint.h>
+
+#define HAL_LOW 0
+#define HAL_HIGH 1
+
+// 初始化 ADC 衰减、位宽与电压校准特性
+void halAdcBegin();
+// 读取 ADC 原始值（0-4095）
+int halAnalogRead(int pin);
+// ADC 原始值转换为电压（mV），使用 halAdcBegin 得到的校准特性
+int halRawToMillivolts(int raw);
+
+int halDigitalRead(int pin);
+void halDigitalWrite(int pin, int level);
+void halDacWrite(int pin, uint8_t value);
+// 抖动 DAC 输出（Dac_Dither_Enable）：halDacBegin 启动高频输出级，halDacWriteQ8 设置目标码值（Q8，码值×256）
+void halDacBegin();
+void halDacWriteQ8(int pin, int codeQ8);
+
+unsigned long halMillis();
+uint32_t halMicros();
+void halDelay(unsigned long ms);
+// CPU 周期计数（ESP32 为 CCOUNT，主机为纳秒计数），用于测量开销
+uint32_t halCycleCount();
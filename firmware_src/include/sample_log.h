@@ -0,0 +1,94 @@
+// sample_log.h
+// 采样记录的块编码：踏板电压（AdcRemap 滤波前，mV）、滤波后的映射值与校准范围按时间顺序写成定长块，
+// 每块对应一个闪存扇区、写满后一次写入，块之间在分区内循环覆盖（环形日志）；
+// 每块自带起点，任意一块都能单独解码，写到一半掉电或被覆盖的块 CRC 不符时整块跳过（可在主机上编译运行）
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "pedal.h"
+
+// 编码（小端）：
+//   块头   "PLG1" | uint32 CRC-32（块头其余部分与负载）| uint32 块序号 | uint16 开机序号 | uint16 记录数
+//          | uint16 负载长度 | uint16 时间单位(us) | uint32 第一条记录的时刻（时间单位计，自开机起）
+//   记录   uint8 标志 | [变长整数...]，标志的每一位表示后面跟着哪个字段相对上一条记录的差值（zigzag 变长整数）：
+//          bit0-2 电压 mv[i]  bit3-5 映射值 value[i]  bit6 校准范围 minv[0..2] maxv[0..2]
+//          bit7 采样间隔（相对上一个间隔的变化，间隔不变时省略）
+//   每块的第一条记录相对全 0 编码；静止时每条记录约 1 + 3 字节
+#define SAMPLE_LOG_BLOCK_SIZE 4096
+#define SAMPLE_LOG_HEADER_SIZE 24
+#define SAMPLE_LOG_PAYLOAD_MAX (SAMPLE_LOG_BLOCK_SIZE - SAMPLE_LOG_HEADER_SIZE)
+// 记录的时间分辨率：采样时刻量化到此单位，间隔基本不变时不占字节
+#define SAMPLE_LOG_TICK_US 100
+// 一条记录的最大长度：标志 + 间隔 + 3 电压 + 3 映射值 + 6 范围，每个变长整数最多 5 字节
+#define SAMPLE_LOG_RECORD_MAX (1 + 5 * (1 + PEDAL_COUNT * 4))
+
+struct SampleLogHeader
+{
+  uint32_t seq;       // 块序号，跨开机连续递增，决定块的先后
+  uint16_t session;   // 开机序号，同一次开机的块时间连续
+  uint16_t count;     // 记录数
+  uint16_t used;      // 负载长度
+  uint16_t tickUs;    // 时间单位
+  uint32_t startTick; // 第一条记录的时刻
+};
+
+// 编码状态（一个正在填充的块）
+struct SampleLogWriter
+{
+  uint8_t block[SAMPLE_LOG_BLOCK_SIZE];
+  SampleLogHeader header;
+  bool started;        // 已收到过第一帧（extUs 有效）
+  uint32_t lastUs;     // 上一帧的 timeUs，用于把 32 位时刻展开
+  uint64_t extUs;      // 自第一帧起的累计时刻（us）
+  uint32_t lastTick;   // 块内上一条记录的时刻与间隔
+  uint32_t lastDt;
+  int last[PEDAL_COUNT * 4]; // 块内上一条记录：mv[3] value[3] minv[3] maxv[3]
+};
+
+// 从 seq 号块开始编码；session 为本次开机序号
+void SampleLogBegin(SampleLogWriter &w, uint32_t seq, uint16_t session);
+// 追加一帧；当前块放不下时不写入并返回 false，此时应 SampleLogSeal 取出整块、SampleLogNext 后重新追加
+bool SampleLogAppend(SampleLogWriter &w, const PedalFrame &f);
+// 把当前块（块头 + 负载，其余字节填 0xFF）写入 out[SAMPLE_LOG_BLOCK_SIZE]，编码状态不变；
+// 也用于在块写满前取出快照。当前块没有记录时返回 false
+bool SampleLogSeal(const SampleLogWriter &w, uint8_t *out);
+// 开始下一块（序号 + 1）
+void SampleLogNext(SampleLogWriter &w);
+
+// 检查一块：标识、长度与 CRC 都正确时填充 h 并返回 true（已擦除的 0xFF 块返回 false）
+bool SampleLogHeaderRead(const uint8_t *block, SampleLogHeader &h);
+// 解码一块中的所有记录，逐条交给 fn（frame.timeUs 为量化后的时刻 tick × tickUs，只取低 32 位；
+// fine 为 value × 256），fn 返回 false 时停止；块无效时返回 -1，否则返回解码的记录数
+typedef bool (*SampleLogFrameFn)(void *ctx, const SampleLogHeader &h, uint32_t tick, const PedalFrame &f);
+int SampleLogDecode(const uint8_t *block, SampleLogFrameFn fn, void *ctx);
+
+// 分区内的环形位置：开机时扫描所有块，从最新块之后继续写
+struct SampleLogRing
+{
+  uint32_t blocks;  // 分区中的块数
+  uint32_t next;    // 下一个要写的块
+  uint32_t seq;     // 下一块的序号
+  uint16_t session; // 本次开机序号
+  uint32_t valid;   // 扫描时的有效块数
+};
+// read 读取第 index 块的块头（调用 SampleLogHeaderRead），无效时返回 false
+typedef bool (*SampleLogHeaderFn)(void *ctx, uint32_t index, SampleLogHeader &h);
+void SampleLogRingScan(SampleLogRing &r, uint32_t blocks, SampleLogHeaderFn read, void *ctx);
+// 取出下一个要写的块号并前移
+static inline uint32_t SampleLogRingTake(SampleLogRing &r)
+{
+  uint32_t index = r.next;
+  r.next = (r.next + 1) % r.blocks;
+  return index;
+}
+
+// 抽样：timeUs 到达 nextUs（允许提前 1/4 周期的抖动）时返回 true 并推进 nextUs；
+// 输入帧间隔大于 periodUs（采样降频时）时每一帧都记录
+static inline bool SampleLogDue(uint32_t &nextUs, uint32_t timeUs, uint32_t periodUs)
+{
+  int32_t late = (int32_t)(timeUs - nextUs);
+  if (late < -(int32_t)(periodUs / 4))
+    return false;
+  nextUs = late > (int32_t)periodUs ? timeUs + periodUs : nextUs + periodUs;
+  return true;
+}
@@ -0,0 +1,121 @@
+// sample_ring.h
+// 单生产者/单消费者无锁环形缓冲：采样任务写入，loop() 读取
+// 生产者（采样路径）在两种策略下都是无等待的：
+//   RING_DROP_NEWEST      缓冲已满时丢弃新数据，已有数据按顺序完整送达
+//   RING_OVERWRITE_OLDEST 缓冲已满时覆盖最旧数据，消费者总能读到最近 N 帧；
+//                         每个槽位带序号（seqlock），消费者据此发现被覆盖的帧并跳过
+#pragma once
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+
+enum RingPolicy
+{
+  RING_DROP_NEWEST,
+  RING_OVERWRITE_OLDEST,
+};
+
+template <typename T, size_t N, RingPolicy Policy = RING_DROP_NEWEST>
+class SampleRing
+{
+  static_assert((N & (N - 1)) == 0, "SampleRing 容量必须是 2 的幂");
+  static_assert(std::is_trivially_copyable<T>::value, "SampleRing 只存放可平凡复制的数据");
+
+public:
+  // 生产者调用；RING_DROP_NEWEST 下缓冲已满时返回 false
+  bool push(const T &item)
+  {
+    uint32_t head = head_.load(std::memory_order_relaxed);
+    Slot &slot = slots_[head & (N - 1)];
+    if (Policy == RING_DROP_NEWEST)
+    {
+      if (head - tail_.load(std::memory_order_acquire) >= N)
+      {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+      slot.item = item;
+    }
+    else
+    {
+      // 奇数序号表示正在写入，写完后为 2 * head + 2
+      slot.seq.store(head * 2 + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+      slot.item = item;
+      slot.seq.store(head * 2 + 2, std::memory_order_release);
+    }
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // 消费者调用；无数据时返回 false
+  bool pop(T &item)
+  {
+    uint32_t tail = tail_.load(std::memory_order_relaxed);
+    for (;;)
+    {
+      uint32_t head = head_.load(std::memory_order_acquire);
+      if (tail == head)
+      {
+        tail_.store(tail, std::memory_order_release);
+        return false;
+      }
+
+      if (Policy == RING_DROP_NEWEST)
+      {
+        item = slots_[tail & (N - 1)].item;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+      }
+
+      // 落后超过一圈：最旧的帧已被覆盖，直接跳到仍然有效的最早一帧
+      if (head - tail > N)
+      {
+        lost_.fetch_add(head - N - tail, std::memory_order_relaxed);
+        tail = head - N;
+      }
+
+      Slot &slot = slots_[tail & (N - 1)];
+      uint32_t expected = tail * 2 + 2;
+      if (slot.seq.load(std::memory_order_acquire) == expected)
+      {
+        item = slot.item;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) == expected)
+        {
+          tail_.store(tail + 1, std::memory_order_release);
+          return true;
+        }
+      }
+      // 读取过程中被生产者覆盖，丢弃这一帧继续读下一帧（最多 N 次）
+      lost_.fetch_add(1, std::memory_order_relaxed);
+      tail++;
+    }
+  }
+
+  // 当前可读帧数（消费者视角，覆盖模式下最多为 N）
+  uint32_t available() const
+  {
+    uint32_t n = head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_relaxed);
+    return n > N ? N : n;
+  }
+
+  // RING_DROP_NEWEST：因缓冲已满被丢弃的帧数
+  uint32_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+  // RING_OVERWRITE_OLDEST：消费者来不及读取而被覆盖的帧数
+  uint32_t lost() const { return lost_.load(std::memory_order_relaxed); }
+
+private:
+  struct Slot
+  {
+    std::atomic<uint32_t> seq{0};
+    T item;
+  };
+
+  Slot slots_[N];
+  std::atomic<uint32_t> head_{0};
+  std::atomic<uint32_t> tail_{0};
+  std::atomic<uint32_t> dropped_{0};
+  std::atomic<uint32_t> lost_{0};
+};
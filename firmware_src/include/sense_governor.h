@@ -0,0 +1,69 @@
+// sense_governor.h
+// 采样频率调节：任一踏板在动时全速采样，全部静止一段时间后降到低频，两次采样之间 CPU 可以进入轻睡眠；
+// 低频下检测到运动的那一帧立即切回全速（可在主机上编译运行）
+//   运动判定：任一踏板的电压偏离静止参考超过 motionMv（参考值在运动时跟随当前电压）
+//   唤醒延迟：运动越过阈值 → 第一次全速采样。越过阈值的时刻落在两次低频采样之间，看不到，
+//            按检测帧之后 GOVERNOR_SPEED_WINDOW_US 内的平均速度向前外推，以及在上一次静止采样与检测帧
+//            之间线性插值（运动若在两次采样之间才开始，插值偏早），取两者中较晚的时刻
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "pedal.h"
+
+enum GovernorMode
+{
+  GOVERNOR_ACTIVE,
+  GOVERNOR_IDLE,
+};
+
+struct GovernorConfig
+{
+  uint32_t activePeriodUs; // 全速采样周期
+  uint32_t idlePeriodUs;   // 静止时的采样周期
+  uint32_t idleAfterUs;    // 静止多久后降频
+  int motionMv;            // 运动阈值
+};
+
+// 估计唤醒延迟时测速的时长（全速下多帧平均，避免单帧噪声）
+#define GOVERNOR_SPEED_WINDOW_US 4000
+
+// 唤醒延迟直方图（us），最后一档为溢出
+#define GOVERNOR_WAKE_BUCKETS 6
+extern const uint32_t governorWakeBoundsUs[GOVERNOR_WAKE_BUCKETS - 1];
+
+struct GovernorStats
+{
+  uint64_t activeUs; // 各模式下经过的时间
+  uint64_t idleUs;
+  uint32_t activeSamples;
+  uint32_t idleSamples;
+  uint32_t wakes; // 低频 → 全速次数
+  uint32_t wake[GOVERNOR_WAKE_BUCKETS];
+  uint32_t wakeMaxUs;
+  uint64_t wakeSumUs;
+};
+
+struct SenseGovernor
+{
+  uint8_t mode;
+  bool started;
+  bool waking;             // 已检测到运动，正在测速以估计唤醒延迟
+  int refMv[PEDAL_COUNT];  // 静止参考电压
+  uint32_t lastUs;         // 上一帧时刻
+  uint32_t motionUs;       // 最近一次检测到运动的时刻
+  uint32_t idleSampleUs;   // 低频下最后一次静止采样的时刻
+  uint32_t detectUs;       // 检测到运动的低频采样时刻
+  uint32_t fullUs;         // 之后第一次全速采样的时刻（0 表示还没有）
+  int wakePedal;           // 检测帧中越过阈值最多的踏板
+  int wakeMv;              // 该踏板在检测帧的电压
+  int wakeDevMv;           // 及其偏离静止参考的量
+  int wakeExcessMv;        // 其中超出阈值的部分
+  GovernorStats stats;
+};
+
+void GovernorReset(SenseGovernor &g);
+// 每个采样帧调用一次（只使用 frame.timeUs 与 frame.mv），返回到下一次采样的间隔（us）
+uint32_t GovernorUpdate(SenseGovernor &g, const GovernorConfig &cfg, const PedalFrame &frame);
+static inline bool GovernorIdle(const SenseGovernor &g) { return g.mode == GOVERNOR_IDLE; }
+// 文本报告（追加到 /metrics），每行 "名称 值..."，返回写入长度；fullRateHz 用于计算平均采样率占全速的比例
+size_t GovernorFormat(char *buf, size_t len, const GovernorStats &s, uint32_t fullRateHz);
@@ -0,0 +1,21 @@
+// sense_task.h
+// 独立的高优先级采样任务：定时器按固定频率唤醒，执行 采样 → 滤波 → dacWrite，
+// 结果通过无锁环形缓冲交给 loop()（网页状态、蓝牙翻页）
+#pragma once
+#include <stdint.h>
+#include "pedal.h"
+#include "sense_governor.h"
+
+// 启动采样任务（固定在 APP_CPU，避开运行 WiFi/BLE 协议栈的 PRO_CPU）
+void SenseTaskBegin(uint32_t rateHz);
+bool SenseTaskActive();
+// loop() 调用：取出一帧采样结果，无数据返回 false
+bool SenseTaskPop(PedalFrame &frame);
+// 蓝牙翻页连接时关闭持音踏板输出
+void SenseTaskSetSostenutoEnabled(bool enabled);
+// 采样频率调节（Sense_Governor_Enable）：当前是否处于低频采样
+bool SenseTaskIdle();
+// loop() 的延时：等待 ms 毫秒，采样任务从低频恢复全速时提前返回
+void SenseTaskWait(uint32_t ms);
+void SenseTaskGovernorStats(GovernorStats &out);
+// 采样周期抖动等统计见 metrics.h（PedalSample 中记录，与是否使用采样任务无关；低频采样期间不计入）
@@ -0,0 +1,30 @@
+// sha256.h
+// 增量 SHA-256，用于 OTA 镜像边接收边校验
+//   设备上：交给 mbedtls，ESP32 上由 SHA 硬件加速器计算（加速器被另一个上下文占用时自动退回软件，
+//          例如差分升级同时校验旧镜像与新镜像）
+//   主机上：纯软件实现（[env:native]）
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#ifdef ESP_PLATFORM
+#include "mbedtls/sha256.h"
+#endif
+
+#define SHA256_DIGEST_SIZE 32
+
+struct Sha256Ctx
+{
+#ifdef ESP_PLATFORM
+  mbedtls_sha256_context mbed;
+#else
+  uint32_t state[8];
+  uint64_t bytes;
+  uint8_t block[64];
+  size_t fill;
+#endif
+};
+
+void Sha256Init(Sha256Ctx &ctx);
+void Sha256Update(Sha256Ctx &ctx, const uint8_t *data, size_t len);
+// 结束并释放上下文（设备上同时释放加速器）
+void Sha256Final(Sha256Ctx &ctx, uint8_t digest[SHA256_DIGEST_SIZE]);
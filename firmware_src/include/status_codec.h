@@ -0,0 +1,19 @@
+// status_codec.h
+// 门户 /status 的序列化：写入调用方提供的缓冲，不使用堆（可在主机上编译运行）
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "pedal.h"
+
+// 网页上的踏板顺序：p0=弱音，p1=持音，p2=延音
+extern const int statusPageOrder[PEDAL_COUNT];
+
+// JSON：{"p0":{"mv":..,"min":..,"max":..,"mapped":..},"p1":{..},"p2":{..}}
+// 电压在 0-5000mV 时约 160 字节；返回写入长度（不含结尾 0），缓冲不足时返回 0
+#define STATUS_JSON_MAX 192
+size_t StatusFormatJson(char *buf, size_t len, const PedalFrame &frame);
+
+// 二进制（小端）：uint32 timeUs，随后按页面顺序每个踏板 int16 {mv, min, max, mapped}
+// 网页端用 DataView 解码：getUint32(0, true)，getInt16(4 + (i * 4 + k) * 2, true)
+#define STATUS_BINARY_SIZE (4 + PEDAL_COUNT * 4 * 2)
+size_t StatusFormatBinary(uint8_t *buf, size_t len, const PedalFrame &frame);
@@ -0,0 +1,12 @@
+// tone_player.h
+// 非阻塞蜂鸣器：esp_timer 单次定时器逐个播放 tone_seq.h 队列中的音符，调用方立即返回，
+// 提示音期间采样、DAC 输出与校准都不会停顿
+#pragma once
+#include <stddef.h>
+#include "tone_seq.h"
+
+// channel 为已配置并连接蜂鸣器引脚的 LEDC 通道
+void TonePlayerBegin(int channel);
+// 放入一段旋律，队列放不下时丢弃并返回 false
+bool TonePlay(const ToneNote *notes, size_t n);
+bool TonePlaying();
@@ -0,0 +1,32 @@
+// tone_seq.h
+// 蜂鸣器旋律的调度：调用方把一串音符放进队列后立即返回，由定时器回调逐个推进（可在主机上编译运行）
+// 播放中再放入的旋律排在后面接着播放；驱动见 tone_player.h
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+struct ToneNote
+{
+  uint8_t degree; // 1-7 对应 C 大调音阶（C4..B4），0 为休止
+  uint16_t ms;    // 持续时间
+};
+
+#define TONE_QUEUE_SIZE 16
+#define TONE_COUNT(notes) (sizeof(notes) / sizeof((notes)[0]))
+
+struct ToneSequencer
+{
+  ToneNote queue[TONE_QUEUE_SIZE];
+  uint8_t head;
+  uint8_t count;
+  bool playing; // 定时器正在计时（当前音符或结尾的静音）
+};
+
+void ToneSeqReset(ToneSequencer &s);
+// 整段旋律放入队列；放不下时整段丢弃并返回 false（不会只播放半段）
+// 返回 true 且 start=true 时调用方需要启动定时器（立即调用一次 ToneSeqStep）
+bool ToneSeqPlay(ToneSequencer &s, const ToneNote *notes, size_t n, bool &start);
+// 定时器回调：给出现在应输出的频率（0 = 静音），返回到下一次回调的时间（ms），0 表示播放结束、不再需要定时器
+uint32_t ToneSeqStep(ToneSequencer &s, uint16_t &freqHz);
+bool ToneSeqPlaying(const ToneSequencer &s);
+uint16_t ToneFrequency(uint8_t degree);
@@ -0,0 +1,68 @@
+# embed_web.py
+# 构建前把 web/index.html 精简并 gzip 压缩为 include/portal_assets.h（字节数组 + ETag）。
+# 由 platformio.ini 的 extra_scripts 在每次编译前调用，也可以单独运行：python scripts/embed_web.py
+# 内容未变化时不改写头文件，避免触发重新编译。
+import gzip
+import hashlib
+import os
+import re
+import sys
+
+
+def minify(html):
+    # 去掉 HTML 注释、整行的 JS 注释、每行首尾空白与空行；保留换行，不改变脚本的自动分号行为
+    html = re.sub(r"<!--.*?-->", "", html, flags=re.S)
+    lines = []
+    for line in html.splitlines():
+        line = line.strip()
+        if not line or line.startswith("//"):
+            continue
+        lines.append(line)
+    return "\n".join(lines) + "\n"
+
+
+def render(name, gz, etag):
+    rows = []
+    for i in range(0, len(gz), 16):
+        rows.append("  " + ",".join("0x%02x" % b for b in gz[i:i + 16]) + ",")
+    return (
+        "// portal_assets.h\n"
+        "// 由 scripts/embed_web.py 根据 web/%s 生成，请勿手动修改\n"
+        "#pragma once\n"
+        "#include <Arduino.h>\n"
+        "\n"
+        "#define INDEX_HTML_ETAG \"\\\"%s\\\"\"\n"
+        "const size_t index_html_gz_len = %d;\n"
+        "const uint8_t index_html_gz[] PROGMEM = {\n"
+        "%s\n"
+        "};\n" % (name, etag, len(gz), "\n".join(rows))
+    )
+
+
+def embed(project_dir):
+    src = os.path.join(project_dir, "web", "index.html")
+    dst = os.path.join(project_dir, "include", "portal_assets.h")
+    with open(src, encoding="utf-8") as f:
+        html = f.read()
+    small = minify(html).encode("utf-8")
+    # mtime=0 使输出只取决于内容，ETag 与头文件在重复构建时保持不变
+    gz = gzip.compress(small, compresslevel=9, mtime=0)
+    etag = hashlib.sha256(gz).hexdigest()[:16]
+    text = render("index.html", gz, etag)
+
+    old = None
+    if os.path.exists(dst):
+        with open(dst, encoding="utf-8") as f:
+            old = f.read()
+    if old != text:
+        with open(dst, "w", encoding="utf-8", newline="\n") as f:
+            f.write(text)
+    print("embed_web: index.html %d -> 精简 %d -> gzip %d 字节，ETag %s"
+          % (len(html.encode("utf-8")), len(small), len(gz), etag))
+
+
+try:
+    Import("env")  # noqa: F821  PlatformIO (SCons) 环境
+    embed(env.subst("$PROJECT_DIR"))  # noqa: F821
+except NameError:
+    embed(os.path.dirname(os.path.dirname(os.path.abspath(sys.argv[0]))))
@@ -0,0 +1,37 @@
+// adc_lut.cpp
+#include "adc_lut.h"
+#include "pedal_hal.h"
+
+uint16_t adcRawToMv[ADC_LUT_SIZE];
+
+void AdcLutBegin()
+{
+  for (int raw = 0; raw < ADC_LUT_SIZE; ++raw)
+    adcRawToMv[raw] = (uint16_t)halRawToMillivolts(raw);
+}
+
+void PedalMapLutBuild(PedalMapLut &lut, const PedalFilter &f)
+{
+  for (int raw = 0; raw < ADC_LUT_SIZE; ++raw)
+    lut.value[raw] = (uint8_t)PedalFilterMap(f, adcRawToMv[raw]);
+}
+
+void AdcLutBenchmark(int iterations, uint32_t &directCycles, uint32_t &lutCycles)
+{
+  // 累加结果防止编译器把循环优化掉
+  volatile uint32_t sink = 0;
+  uint32_t acc = 0;
+  uint32_t t0 = halCycleCount();
+  for (int i = 0; i < iterations; ++i)
+    acc += halRawToMillivolts(i & (ADC_LUT_SIZE - 1));
+  directCycles = halCycleCount() - t0;
+  sink = acc;
+
+  acc = 0;
+  t0 = halCycleCount();
+  for (int i = 0; i < iterations; ++i)
+    acc += AdcLutMillivolts(i & (ADC_LUT_SIZE - 1));
+  lutCycles = halCycleCount() - t0;
+  sink = sink + acc;
+  (void)sink;
+}
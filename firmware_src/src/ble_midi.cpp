@@ -0,0 +1,77 @@
+// ble_midi.cpp
+#include <Arduino.h>
+#include <BLEDevice.h>
+#include <BLEServer.h>
+#include <BLE2902.h>
+#include "ble_midi.h"
+
+// BLE-MIDI 1.0 规定的服务与特征 UUID
+#define BLE_MIDI_SERVICE_UUID "03B80E5A-EDE8-4B33-A751-6CE34EC4C700"
+#define BLE_MIDI_CHAR_UUID "7772E5DB-3868-4112-A1A9-F2669D106BF3"
+
+// 连接参数（单位 1.25ms）：请求 7.5-15ms 连接间隔，半踏板变化尽快到达；监督超时 4s
+#define BLE_MIDI_INTERVAL_MIN 6
+#define BLE_MIDI_INTERVAL_MAX 12
+#define BLE_MIDI_TIMEOUT 400
+
+static BLEServer *midiServer = NULL;
+static BLECharacteristic *midiChar = NULL;
+static volatile bool midiConnected = false;
+
+class MidiServerCallbacks : public BLEServerCallbacks
+{
+  void onConnect(BLEServer *server, esp_ble_gatts_cb_param_t *param) override
+  {
+    midiConnected = true;
+    server->updateConnParams(param->connect.remote_bda, BLE_MIDI_INTERVAL_MIN, BLE_MIDI_INTERVAL_MAX, 0,
+                             BLE_MIDI_TIMEOUT);
+  }
+
+  void onDisconnect(BLEServer *server) override
+  {
+    midiConnected = false;
+    // 断开后重新广播，等待再次连接
+    BLEDevice::startAdvertising();
+  }
+};
+
+void BleMidiBegin(const char *name)
+{
+  if (midiServer != NULL)
+    return;
+  BLEDevice::init(name);
+  midiServer = BLEDevice::createServer();
+  midiServer->setCallbacks(new MidiServerCallbacks());
+
+  BLEService *service = midiServer->createService(BLE_MIDI_SERVICE_UUID);
+  midiChar = service->createCharacteristic(BLE_MIDI_CHAR_UUID, BLECharacteristic::PROPERTY_READ |
+                                                                   BLECharacteristic::PROPERTY_WRITE_NR |
+                                                                   BLECharacteristic::PROPERTY_NOTIFY);
+  midiChar->addDescriptor(new BLE2902());
+  service->start();
+
+  BLEAdvertising *adv = BLEDevice::getAdvertising();
+  adv->addServiceUUID(BLE_MIDI_SERVICE_UUID);
+  adv->setScanResponse(true);
+  adv->setMinPreferred(BLE_MIDI_INTERVAL_MIN);
+  adv->setMaxPreferred(BLE_MIDI_INTERVAL_MAX);
+  BLEDevice::startAdvertising();
+}
+
+bool BleMidiConnected() { return midiConnected; }
+
+size_t BleMidiPayloadMax()
+{
+  if (midiServer == NULL || !midiConnected)
+    return 20;
+  uint16_t mtu = midiServer->getPeerMTU(midiServer->getConnId());
+  return mtu > 3 ? mtu - 3 : 20;
+}
+
+void BleMidiSend(const uint8_t *buf, size_t len)
+{
+  if (midiChar == NULL || !midiConnected || len == 0)
+    return;
+  midiChar->setValue((uint8_t *)buf, len);
+  midiChar->notify();
+}
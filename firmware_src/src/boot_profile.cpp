@@ -0,0 +1,83 @@
+// boot_profile.cpp
+#include <stdio.h>
+#include <string.h>
+#include "boot_profile.h"
+#include "pedal_hal.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_attr.h"
+#define BOOT_PROFILE_ATTR RTC_NOINIT_ATTR
+#else
+#define BOOT_PROFILE_ATTR
+#endif
+
+#define BOOT_PROFILE_MAGIC 0x42545046u // "BTPF"
+
+static BOOT_PROFILE_ATTR BootProfile s_current;
+static BootProfile s_previous;
+static bool s_hasPrevious = false;
+
+static const char *const bootPhaseNames[BOOT_PHASE_COUNT] = {
+    "setup", "pm", "nvs", "adc", "sense", "first_dac", "radio", "ble", "tones", "ready"};
+
+void BootProfileBegin(uint32_t resetReason)
+{
+  uint32_t now = halMicros();
+  s_hasPrevious = s_current.magic == BOOT_PROFILE_MAGIC;
+  if (s_hasPrevious)
+    s_previous = s_current;
+  uint32_t bootCount = s_hasPrevious ? s_previous.bootCount + 1 : 1;
+
+  memset(&s_current, 0, sizeof(s_current));
+  s_current.magic = BOOT_PROFILE_MAGIC;
+  s_current.bootCount = bootCount;
+  s_current.resetReason = resetReason;
+  s_current.us[BOOT_SETUP] = now ? now : 1;
+}
+
+void BootMark(BootPhase phase)
+{
+  if (s_current.us[phase] != 0)
+    return;
+  uint32_t now = halMicros();
+  s_current.us[phase] = now ? now : 1;
+}
+
+const BootProfile &BootProfileCurrent() { return s_current; }
+
+bool BootProfilePrevious(BootProfile &out)
+{
+  if (!s_hasPrevious)
+    return false;
+  out = s_previous;
+  return true;
+}
+
+static size_t FormatOne(char *buf, size_t len, const BootProfile &p, const char *prefix)
+{
+  size_t n = 0;
+  int w = snprintf(buf, len, "%sboot %u %u\n", prefix, (unsigned)p.bootCount, (unsigned)p.resetReason);
+  n += w > 0 ? (size_t)w : 0;
+  uint32_t last = 0;
+  for (int i = 0; i < BOOT_PHASE_COUNT && n < len; ++i)
+  {
+    if (p.us[i] == 0)
+      continue;
+    w = snprintf(buf + n, len - n, "%sboot_%s %u %d\n", prefix, bootPhaseNames[i], (unsigned)p.us[i],
+                 last ? (int)(p.us[i] - last) : 0);
+    n += w > 0 ? (size_t)w : 0;
+    last = p.us[i];
+  }
+  return n;
+}
+
+size_t BootProfileFormat(char *buf, size_t len)
+{
+  if (len == 0)
+    return 0;
+  buf[0] = '\0';
+  size_t n = FormatOne(buf, len, s_current, "");
+  if (s_hasPrevious && n < len)
+    n += FormatOne(buf + n, len - n, s_previous, "prev_");
+  return n < len ? n : len - 1;
+}
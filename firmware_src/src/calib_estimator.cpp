@@ -0,0 +1,158 @@
+// calib_estimator.cpp
+#include <math.h>
+#include <stdlib.h>
+#include "calib_estimator.h"
+
+void P2QuantileReset(P2Quantile &e, float p)
+{
+  e.p = p;
+  e.count = 0;
+}
+
+static float Parabolic(const P2Quantile &e, int i, int d)
+{
+  float a = (float)(e.n[i] - e.n[i - 1] + d) * (e.q[i + 1] - e.q[i]) / (float)(e.n[i + 1] - e.n[i]);
+  float b = (float)(e.n[i + 1] - e.n[i] - d) * (e.q[i] - e.q[i - 1]) / (float)(e.n[i] - e.n[i - 1]);
+  return e.q[i] + (float)d / (float)(e.n[i + 1] - e.n[i - 1]) * (a + b);
+}
+
+void P2QuantileAdd(P2Quantile &e, float x)
+{
+  if (e.count < 5)
+  {
+    // 前 5 个样本插入排序，作为初始标记
+    int i = e.count++;
+    while (i > 0 && e.q[i - 1] > x)
+    {
+      e.q[i] = e.q[i - 1];
+      i--;
+    }
+    e.q[i] = x;
+    if (e.count == 5)
+    {
+      for (int k = 0; k < 5; ++k)
+        e.n[k] = k;
+      e.np[0] = 0;
+      e.np[1] = 2 * e.p;
+      e.np[2] = 4 * e.p;
+      e.np[3] = 2 + 2 * e.p;
+      e.np[4] = 4;
+    }
+    return;
+  }
+  e.count++;
+
+  int k;
+  if (x < e.q[0])
+  {
+    e.q[0] = x;
+    k = 0;
+  }
+  else if (x >= e.q[4])
+  {
+    e.q[4] = x;
+    k = 3;
+  }
+  else
+  {
+    k = 0;
+    while (k < 3 && x >= e.q[k + 1])
+      k++;
+  }
+  for (int i = k + 1; i < 5; ++i)
+    e.n[i]++;
+  const float dn[5] = {0, e.p / 2, e.p, (1 + e.p) / 2, 1};
+  for (int i = 0; i < 5; ++i)
+    e.np[i] += dn[i];
+
+  // 中间三个标记偏离期望位置超过 1 时，按抛物线（或退回线性）插值调整高度
+  for (int i = 1; i <= 3; ++i)
+  {
+    float d = e.np[i] - e.n[i];
+    if ((d >= 1 && e.n[i + 1] - e.n[i] > 1) || (d <= -1 && e.n[i - 1] - e.n[i] < -1))
+    {
+      int s = d > 0 ? 1 : -1;
+      float q = Parabolic(e, i, s);
+      if (e.q[i - 1] < q && q < e.q[i + 1])
+        e.q[i] = q;
+      else
+        e.q[i] += s * (e.q[i + s] - e.q[i]) / (float)(e.n[i + s] - e.n[i]);
+      e.n[i] += s;
+    }
+  }
+}
+
+float P2QuantileValue(const P2Quantile &e)
+{
+  if (e.count == 0)
+    return 0;
+  if (e.count < 5)
+  {
+    int i = (int)(e.p * (e.count - 1) + 0.5f);
+    return e.q[i];
+  }
+  return e.q[2];
+}
+
+void CalibEstimatorReset(CalibEstimator &c)
+{
+  P2QuantileReset(c.low, CALIB_QUANTILE_LOW);
+  P2QuantileReset(c.high, CALIB_QUANTILE_HIGH);
+  P2QuantileReset(c.noise, 0.5f);
+  c.prev1 = 0;
+  c.prev2 = 0;
+  c.count = 0;
+  c.rawMin = 5000;
+  c.rawMax = 0;
+}
+
+void CalibEstimatorAdd(CalibEstimator &c, int mv)
+{
+  P2QuantileAdd(c.low, (float)mv);
+  P2QuantileAdd(c.high, (float)mv);
+  if (c.count >= 2)
+    P2QuantileAdd(c.noise, (float)abs(mv - 2 * c.prev1 + c.prev2));
+  c.prev2 = c.prev1;
+  c.prev1 = mv;
+  c.count++;
+  if (mv < c.rawMin)
+    c.rawMin = mv;
+  if (mv > c.rawMax)
+    c.rawMax = mv;
+}
+
+CalibResult CalibEstimatorResult(const CalibEstimator &c)
+{
+  CalibResult r;
+  if (c.count < 5)
+  {
+    r.minV = c.rawMin;
+    r.maxV = c.rawMax;
+  }
+  else
+  {
+    r.minV = (int)lroundf(P2QuantileValue(c.low));
+    r.maxV = (int)lroundf(P2QuantileValue(c.high));
+  }
+  // 高斯噪声下二阶差分的标准差为 √6σ，其绝对值的中位数为 0.6745·√6σ
+  r.noiseMv = P2QuantileValue(c.noise) / (0.6745f * 2.449490f);
+
+  int span = r.maxV - r.minV;
+  if (span <= 0)
+  {
+    r.deadZoneMv = 0;
+    return r;
+  }
+  int dz = (int)lroundf(Calib_DeadZone_Sigma * r.noiseMv) + Calib_DeadZone_BaseMv;
+  int lo = (int)ceilf(span * Calib_DeadZone_MinPct);
+  int hi = (int)(span * Calib_DeadZone_MaxPct);
+  r.deadZoneMv = dz < lo ? lo : (dz > hi ? hi : dz);
+  return r;
+}
+
+float CalibDeadZonePct(int minV, int maxV, int deadZoneMv)
+{
+  if (deadZoneMv <= 0 || maxV <= minV)
+    return 0.05f;
+  return (float)deadZoneMv / (float)(maxV - minV);
+}
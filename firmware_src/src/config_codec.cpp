@@ -0,0 +1,201 @@
+// config_codec.cpp
+#include <string.h>
+#include "config_codec.h"
+#include "crc32.h"
+
+static const uint8_t configMagic[4] = {'P', 'C', 'F', 'G'};
+
+// 旧布局的键名：每个踏板 min/max，最后是蓝牙开关（putBool 写入的 uint8）
+const char *const configLegacyKeys[CONFIG_LEGACY_KEY_COUNT] = {
+    "sustainmin", "sustainmax",
+    "sostenutomin", "sostenutomax",
+    "softmin", "softmax",
+    "blactive"};
+
+void ConfigDefaults(ConfigData &c)
+{
+  for (int i = 0; i < PEDAL_COUNT; ++i)
+  {
+    c.minV[i] = 5000;
+    c.maxV[i] = 0;
+    c.deadZone[i] = 0;
+    CurveDefault(c.curve[i]);
+  }
+  c.bluetoothActive = false;
+}
+
+static inline uint8_t *PutLe16(uint8_t *p, int v)
+{
+  // 超出 int16 的值截断到边界（电压不会超过 5000mV）
+  if (v > 32767)
+    v = 32767;
+  else if (v < -32768)
+    v = -32768;
+  uint16_t u = (uint16_t)(int16_t)v;
+  p[0] = (uint8_t)u;
+  p[1] = (uint8_t)(u >> 8);
+  return p + 2;
+}
+
+static inline uint8_t *PutLe32(uint8_t *p, uint32_t v)
+{
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+  p[2] = (uint8_t)(v >> 16);
+  p[3] = (uint8_t)(v >> 24);
+  return p + 4;
+}
+
+static inline int GetLe16s(const uint8_t *p) { return (int16_t)(uint16_t)(p[0] | (p[1] << 8)); }
+
+static inline uint32_t GetLe32(const uint8_t *p)
+{
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint8_t *PutCurve(uint8_t *p, const OutputCurve &c)
+{
+  p[0] = (uint8_t)c.gamma;
+  p[1] = (uint8_t)(c.gamma >> 8);
+  p[2] = c.type;
+  p[3] = c.x0;
+  p[4] = c.x1;
+  p[5] = c.y0;
+  p[6] = c.y1;
+  p[7] = c.count;
+  memcpy(p + 8, c.px, CURVE_POINTS_MAX);
+  memcpy(p + 8 + CURVE_POINTS_MAX, c.py, CURVE_POINTS_MAX);
+  p[8 + CURVE_POINTS_MAX * 2] = c.switchOn;
+  p[9 + CURVE_POINTS_MAX * 2] = c.switchOff;
+  return p + CONFIG_CURVE_SIZE;
+}
+
+static void GetCurve(const uint8_t *p, OutputCurve &c)
+{
+  OutputCurve d;
+  d.gamma = (uint16_t)(p[0] | (p[1] << 8));
+  d.type = p[2];
+  d.x0 = p[3];
+  d.x1 = p[4];
+  d.y0 = p[5];
+  d.y1 = p[6];
+  d.count = p[7];
+  memcpy(d.px, p + 8, CURVE_POINTS_MAX);
+  memcpy(d.py, p + 8 + CURVE_POINTS_MAX, CURVE_POINTS_MAX);
+  d.switchOn = p[8 + CURVE_POINTS_MAX * 2];
+  d.switchOff = p[9 + CURVE_POINTS_MAX * 2];
+  // CRC 正确但参数超出范围（如更新的固件增加了曲线类型后降级）：保持默认曲线
+  if (CurveValid(d))
+    c = d;
+}
+
+size_t ConfigEncode(const ConfigData &c, uint8_t *buf, size_t len)
+{
+  if (len < CONFIG_BLOB_MAX)
+    return 0;
+  uint8_t *payload = buf + CONFIG_HEADER_SIZE;
+  uint8_t *p = payload;
+  for (int i = 0; i < PEDAL_COUNT; ++i)
+  {
+    p = PutLe16(p, c.minV[i]);
+    p = PutLe16(p, c.maxV[i]);
+    p = PutLe16(p, c.deadZone[i]);
+  }
+  *p++ = c.bluetoothActive ? 1 : 0;
+  for (int i = 0; i < PEDAL_COUNT; ++i)
+    p = PutCurve(p, c.curve[i]);
+
+  memcpy(buf, configMagic, 4);
+  buf[4] = (uint8_t)CONFIG_VERSION;
+  buf[5] = (uint8_t)(CONFIG_VERSION >> 8);
+  buf[6] = (uint8_t)CONFIG_PAYLOAD_SIZE;
+  buf[7] = (uint8_t)(CONFIG_PAYLOAD_SIZE >> 8);
+  PutLe32(buf + 8, Crc32Update(0, payload, CONFIG_PAYLOAD_SIZE));
+  return CONFIG_BLOB_MAX;
+}
+
+static void DecodeCalib(const uint8_t *p, ConfigData &c)
+{
+  for (int i = 0; i < PEDAL_COUNT; ++i)
+  {
+    c.minV[i] = GetLe16s(p);
+    c.maxV[i] = GetLe16s(p + 2);
+    c.deadZone[i] = GetLe16s(p + 4);
+    p += 6;
+  }
+  c.bluetoothActive = (*p & 1) != 0;
+}
+
+ConfigStatus ConfigDecode(const uint8_t *buf, size_t len, ConfigData &c)
+{
+  ConfigDefaults(c);
+  if (len < CONFIG_HEADER_SIZE)
+    return CONFIG_TRUNCATED;
+  if (memcmp(buf, configMagic, 4) != 0)
+    return CONFIG_BAD_MAGIC;
+  unsigned version = buf[4] | (buf[5] << 8);
+  size_t payloadLen = buf[6] | (buf[7] << 8);
+  if (len < CONFIG_HEADER_SIZE + payloadLen)
+    return CONFIG_TRUNCATED;
+  const uint8_t *payload = buf + CONFIG_HEADER_SIZE;
+  if (Crc32Update(0, payload, payloadLen) != GetLe32(buf + 8))
+    return CONFIG_BAD_CRC;
+
+  // 新增版本时在这里加分支：先按旧版本解出，再把新字段补成默认值
+  switch (version)
+  {
+  case 1:
+    if (payloadLen != CONFIG_PAYLOAD_SIZE)
+      return CONFIG_TRUNCATED;
+    DecodeCalib(payload, c);
+    for (int i = 0; i < PEDAL_COUNT; ++i)
+      GetCurve(payload + CONFIG_CALIB_SIZE + i * CONFIG_CURVE_SIZE, c.curve[i]);
+    return CONFIG_OK;
+  default:
+    return CONFIG_BAD_VERSION;
+  }
+}
+
+const char *ConfigStatusName(ConfigStatus s)
+{
+  switch (s)
+  {
+  case CONFIG_OK:
+    return "ok";
+  case CONFIG_TRUNCATED:
+    return "truncated";
+  case CONFIG_BAD_MAGIC:
+    return "bad magic";
+  case CONFIG_BAD_VERSION:
+    return "bad version";
+  case CONFIG_BAD_CRC:
+    return "bad crc";
+  }
+  return "?";
+}
+
+bool ConfigMigrateLegacy(ConfigData &c, ConfigLegacyRead read, void *ctx)
+{
+  ConfigDefaults(c);
+  bool found = false;
+  int32_t v;
+  for (int i = 0; i < PEDAL_COUNT; ++i)
+  {
+    if (read(ctx, configLegacyKeys[i * 2], v))
+    {
+      c.minV[i] = (int)v;
+      found = true;
+    }
+    if (read(ctx, configLegacyKeys[i * 2 + 1], v))
+    {
+      c.maxV[i] = (int)v;
+      found = true;
+    }
+  }
+  if (read(ctx, configLegacyKeys[PEDAL_COUNT * 2], v))
+  {
+    c.bluetoothActive = v != 0;
+    found = true;
+  }
+  return found;
+}
@@ -0,0 +1,27 @@
+// crc32.cpp
+// 按字节查表，表在编译期生成
+#include "crc32.h"
+
+struct Crc32Table
+{
+  uint32_t v[256];
+  constexpr Crc32Table() : v()
+  {
+    for (uint32_t i = 0; i < 256; ++i)
+    {
+      uint32_t c = i;
+      for (int k = 0; k < 8; ++k)
+        c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+      v[i] = c;
+    }
+  }
+};
+static constexpr Crc32Table crcTable;
+
+uint32_t Crc32Update(uint32_t crc, const uint8_t *data, size_t len)
+{
+  crc = ~crc;
+  while (len--)
+    crc = crcTable.v[(crc ^ *data++) & 0xFF] ^ (crc >> 8);
+  return ~crc;
+}
@@ -0,0 +1,32 @@
+// dac_dither.cpp
+#include "dac_dither.h"
+#include "pedal_config.h"
+
+// 比例系数（Q16）：Max_DAC_Voltage / 3.3V
+static const uint32_t dacScaleQ16 = (uint32_t)(Max_DAC_Voltage / 3.3f * 65536.0f + 0.5f);
+
+int DacCodeQ8(int valueQ8)
+{
+  if (valueQ8 <= 0)
+    return 0;
+  if (valueQ8 > 255 << 8)
+    valueQ8 = 255 << 8;
+  return (int)(((uint32_t)valueQ8 * dacScaleQ16) >> 16);
+}
+
+void DacDitherReset(DacDither &d) { d.errQ8 = 0; }
+
+uint8_t DacDitherNext(DacDither &d, int targetQ8)
+{
+  if (targetQ8 < 0)
+    targetQ8 = 0;
+  else if (targetQ8 > 255 << 8)
+    targetQ8 = 255 << 8;
+  int32_t v = targetQ8 + d.errQ8;
+  int32_t code = (v + 128) >> 8;
+  if (code > 255)
+    code = 255;
+  // 误差留给下一个样本补偿：输出与目标之差是误差的一阶差分（噪声传递函数 1 - z^-1）
+  d.errQ8 = v - (code << 8);
+  return (uint8_t)code;
+}
@@ -0,0 +1,73 @@
+// dac_stream.cpp
+#include <Arduino.h>
+#include <atomic>
+#include "driver/i2s.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "dac_dither.h"
+#include "dac_stream.h"
+#include "pedal_config.h"
+
+// 每个 DMA 缓冲 32 帧（40kHz 下 0.8ms），两个缓冲轮换：目标码值变化到输出最多延后约 1.6ms
+#define DAC_STREAM_BUF_COUNT 2
+#define DAC_STREAM_BUF_FRAMES 32
+#define DAC_STREAM_TASK_STACK 2048
+// 低于采样任务（configMAX_PRIORITIES - 5），高于 loop()
+#define DAC_STREAM_TASK_PRIORITY (configMAX_PRIORITIES - 6)
+#define DAC_STREAM_CORE APP_CPU_NUM
+// 内置 DAC：DAC1 = GPIO25，DAC2 = GPIO26
+#define DAC1_GPIO 25
+
+static std::atomic<int> streamTarget[2]; // [0] = DAC1，[1] = DAC2
+static DacDither streamDither[2];
+static TaskHandle_t streamTask = NULL;
+
+static void DacStreamLoop(void *arg)
+{
+  // 16 位样本只取高 8 位；每帧两个样本，低半字为右声道（DAC1），高半字为左声道（DAC2）
+  static uint16_t buf[DAC_STREAM_BUF_FRAMES * 2];
+  for (;;)
+  {
+    int t1 = streamTarget[0].load(std::memory_order_relaxed);
+    int t2 = streamTarget[1].load(std::memory_order_relaxed);
+    for (int i = 0; i < DAC_STREAM_BUF_FRAMES; ++i)
+    {
+      buf[i * 2] = (uint16_t)(DacDitherNext(streamDither[0], t1) << 8);
+      buf[i * 2 + 1] = (uint16_t)(DacDitherNext(streamDither[1], t2) << 8);
+    }
+    // DMA 缓冲都在使用中时在这里等待，输出速率由 I2S 时钟决定
+    size_t written;
+    i2s_write(I2S_NUM_0, buf, sizeof(buf), &written, portMAX_DELAY);
+  }
+}
+
+void DacStreamBegin()
+{
+  if (streamTask != NULL)
+    return;
+  DacDitherReset(streamDither[0]);
+  DacDitherReset(streamDither[1]);
+
+  i2s_config_t cfg = {};
+  cfg.mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_TX | I2S_MODE_DAC_BUILT_IN);
+  cfg.sample_rate = Dac_Dither_Rate_Hz;
+  cfg.bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT;
+  cfg.channel_format = I2S_CHANNEL_FMT_RIGHT_LEFT;
+  cfg.communication_format = I2S_COMM_FORMAT_STAND_MSB;
+  cfg.dma_buf_count = DAC_STREAM_BUF_COUNT;
+  cfg.dma_buf_len = DAC_STREAM_BUF_FRAMES;
+  cfg.use_apll = false;
+  // 填充任务来不及时 DMA 重复上一个缓冲（平均值仍接近目标），而不是输出 0V
+  cfg.tx_desc_auto_clear = false;
+  i2s_driver_install(I2S_NUM_0, &cfg, 0, NULL);
+  i2s_set_pin(I2S_NUM_0, NULL);
+  i2s_set_dac_mode(I2S_DAC_CHANNEL_BOTH_EN);
+
+  xTaskCreatePinnedToCore(DacStreamLoop, "dac", DAC_STREAM_TASK_STACK, NULL, DAC_STREAM_TASK_PRIORITY, &streamTask,
+                          DAC_STREAM_CORE);
+}
+
+void DacStreamSet(int pin, int codeQ8)
+{
+  streamTarget[pin == DAC1_GPIO ? 0 : 1].store(codeQ8, std::memory_order_relaxed);
+}
@@ -0,0 +1,213 @@
+// delta_patch.cpp
+#include <string.h>
+#include "delta_patch.h"
+
+enum
+{
+  STATE_HEADER,
+  STATE_CONTROL,
+  STATE_DIFF,
+  STATE_EXTRA,
+  STATE_DONE,
+  STATE_ERROR,
+};
+
+static bool Fail(DeltaPatch &p, const char *error)
+{
+  p.state = STATE_ERROR;
+  if (!p.error)
+    p.error = error;
+  return false;
+}
+
+static inline uint32_t GetLe32(const uint8_t *b)
+{
+  return (uint32_t)b[0] | (uint32_t)b[1] << 8 | (uint32_t)b[2] << 16 | (uint32_t)b[3] << 24;
+}
+
+static bool Emit(DeltaPatch &p, const uint8_t *data, size_t len)
+{
+  if (len > p.newSize - p.newPos)
+    return Fail(p, "补丁输出超出新镜像长度");
+  Sha256Update(p.sha, data, len);
+  p.newPos += len;
+  if (!p.sink(p.sinkCtx, data, len))
+    return Fail(p, "写入失败");
+  return true;
+}
+
+// 头部收齐后先校验旧镜像：补丁只能用于生成它时的那个版本
+static bool Header(DeltaPatch &p)
+{
+  if (memcmp(p.header, DELTA_MAGIC, 4) != 0)
+    return Fail(p, "不是差分补丁");
+  p.oldSize = GetLe32(p.header + 4);
+  p.newSize = GetLe32(p.header + 8);
+  if (p.oldSize > p.oldLimit)
+    return Fail(p, "补丁的旧镜像长度超出运行分区");
+
+  Sha256Ctx sha;
+  Sha256Init(sha);
+  for (uint32_t off = 0; off < p.oldSize; off += DELTA_BLOCK_SIZE)
+  {
+    size_t n = p.oldSize - off < DELTA_BLOCK_SIZE ? p.oldSize - off : DELTA_BLOCK_SIZE;
+    if (!p.read(p.readCtx, off, p.block, n))
+      return Fail(p, "读取运行分区失败");
+    Sha256Update(sha, p.block, n);
+  }
+  uint8_t digest[SHA256_DIGEST_SIZE];
+  Sha256Final(sha, digest);
+  if (memcmp(digest, p.header + 12, SHA256_DIGEST_SIZE) != 0)
+    return Fail(p, "补丁不适用于当前运行的固件");
+
+  p.state = p.newSize ? STATE_CONTROL : STATE_DONE;
+  return true;
+}
+
+// 解析一个字节的记录头；三个字段都读完后进入 DIFF
+static bool Control(DeltaPatch &p, uint8_t b)
+{
+  if (p.varShift > 63)
+    return Fail(p, "记录头格式错误");
+  p.varint |= (uint64_t)(b & 0x7F) << p.varShift;
+  p.varShift += 7;
+  if (b & 0x80)
+    return true;
+
+  uint64_t v = p.varint;
+  p.varint = 0;
+  p.varShift = 0;
+  if (p.field == 0)
+    p.diffLen = (uint32_t)v;
+  else if (p.field == 1)
+    p.extraLen = (uint32_t)v;
+  if (p.field < 2)
+  {
+    if (v > p.newSize - p.newPos)
+      return Fail(p, "记录长度超出新镜像");
+    p.field++;
+    return true;
+  }
+  p.field = 0;
+
+  // 差值段必须完全落在旧镜像内
+  if (p.oldPos < 0 || p.oldPos + p.diffLen > p.oldSize || (uint64_t)p.diffLen + p.extraLen > p.newSize - p.newPos)
+    return Fail(p, "记录超出镜像范围");
+  // seek 在差值与新增数据都处理完后生效
+  p.seek = (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+  p.state = p.diffLen ? STATE_DIFF : STATE_EXTRA;
+  return true;
+}
+
+static void EndRecord(DeltaPatch &p)
+{
+  p.oldPos += p.seek;
+  p.state = p.newPos == p.newSize ? STATE_DONE : STATE_CONTROL;
+}
+
+void DeltaPatchBegin(DeltaPatch &p, DeltaReadFn read, void *readCtx, uint32_t oldLimit, DeltaSink sink, void *sinkCtx)
+{
+  p.read = read;
+  p.readCtx = readCtx;
+  p.oldLimit = oldLimit;
+  p.sink = sink;
+  p.sinkCtx = sinkCtx;
+  p.state = STATE_HEADER;
+  p.headerLen = 0;
+  p.oldSize = 0;
+  p.newSize = 0;
+  p.varint = 0;
+  p.varShift = 0;
+  p.field = 0;
+  p.diffLen = 0;
+  p.extraLen = 0;
+  p.seek = 0;
+  p.oldPos = 0;
+  p.newPos = 0;
+  Sha256Init(p.sha);
+  p.error = nullptr;
+}
+
+bool DeltaPatchWrite(DeltaPatch &p, const uint8_t *data, size_t len)
+{
+  while (len > 0)
+  {
+    switch (p.state)
+    {
+    case STATE_HEADER:
+    {
+      size_t n = DELTA_HEADER_SIZE - p.headerLen;
+      if (n > len)
+        n = len;
+      memcpy(p.header + p.headerLen, data, n);
+      p.headerLen += n;
+      data += n;
+      len -= n;
+      if (p.headerLen == DELTA_HEADER_SIZE && !Header(p))
+        return false;
+      break;
+    }
+    case STATE_CONTROL:
+      if (!Control(p, *data))
+        return false;
+      data++;
+      len--;
+      break;
+    case STATE_DIFF:
+    {
+      // 每次最多处理一块：读旧镜像，逐字节加上差值
+      size_t n = p.diffLen < DELTA_BLOCK_SIZE ? p.diffLen : DELTA_BLOCK_SIZE;
+      if (n > len)
+        n = len;
+      if (!p.read(p.readCtx, (uint32_t)p.oldPos, p.block, n))
+        return Fail(p, "读取运行分区失败");
+      for (size_t i = 0; i < n; ++i)
+        p.block[i] += data[i];
+      if (!Emit(p, p.block, n))
+        return false;
+      p.oldPos += n;
+      p.diffLen -= n;
+      data += n;
+      len -= n;
+      if (p.diffLen == 0)
+      {
+        if (p.extraLen)
+          p.state = STATE_EXTRA;
+        else
+          EndRecord(p);
+      }
+      break;
+    }
+    case STATE_EXTRA:
+    {
+      size_t n = p.extraLen < len ? p.extraLen : len;
+      if (n && !Emit(p, data, n))
+        return false;
+      p.extraLen -= n;
+      data += n;
+      len -= n;
+      if (p.extraLen == 0)
+        EndRecord(p);
+      break;
+    }
+    case STATE_DONE:
+      return Fail(p, "补丁结尾之后还有数据");
+    default:
+      return false;
+    }
+  }
+  return p.state != STATE_ERROR;
+}
+
+bool DeltaPatchEnd(DeltaPatch &p)
+{
+  if (p.state == STATE_ERROR)
+    return false;
+  if (p.state != STATE_DONE)
+    return Fail(p, "补丁被截断");
+  uint8_t digest[SHA256_DIGEST_SIZE];
+  Sha256Final(p.sha, digest);
+  if (memcmp(digest, p.header + 12 + SHA256_DIGEST_SIZE, SHA256_DIGEST_SIZE) != 0)
+    return Fail(p, "新镜像 SHA-256 与补丁不符");
+  return true;
+}
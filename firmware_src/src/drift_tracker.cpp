@@ -0,0 +1,85 @@
+// drift_tracker.cpp
+#include <stdlib.h>
+#include "drift_tracker.h"
+
+static void WindowReset(DriftTracker &d)
+{
+  d.count = 0;
+  d.sum = 0;
+  d.lo = 0x7fffffff;
+  d.hi = -0x7fffffff;
+}
+
+void DriftTrackerReset(DriftTracker &d, int minV, int maxV)
+{
+  d.anchorMin = minV;
+  d.anchorMax = maxV;
+  d.rest.seen = false;
+  d.bottom.seen = false;
+  WindowReset(d);
+}
+
+// 用一个落在端点附近的平稳窗口更新跟踪，返回新的端点
+static int EndpointUpdate(DriftEndpoint &e, int mean, int anchor, int maxDrift)
+{
+  if (!e.seen)
+  {
+    e.seen = true;
+    e.refMv = mean;
+    e.emaQ8 = mean << 8;
+  }
+  else
+  {
+    e.emaQ8 += ((mean << 8) - e.emaQ8) >> DRIFT_EMA_SHIFT;
+  }
+  int drift = ((e.emaQ8 + 128) >> 8) - e.refMv;
+  if (drift > maxDrift)
+    drift = maxDrift;
+  else if (drift < -maxDrift)
+    drift = -maxDrift;
+  return anchor + drift;
+}
+
+bool DriftTrackerAdd(DriftTracker &d, int mv, int deadZoneMv, int &minV, int &maxV)
+{
+  d.sum += mv;
+  if (mv < d.lo)
+    d.lo = mv;
+  if (mv > d.hi)
+    d.hi = mv;
+  if (++d.count < DRIFT_WINDOW_SAMPLES)
+    return false;
+
+  int mean = d.sum / d.count;
+  int peak = d.hi - d.lo;
+  WindowReset(d);
+
+  int span = d.anchorMax - d.anchorMin;
+  if (span <= 0 || maxV <= minV)
+    return false; // 尚未校准
+  // 旧版校准数据没有死区，按 5% 估算
+  if (deadZoneMv <= 0)
+    deadZoneMv = span / 20;
+  int stable = DRIFT_STABLE_DZ * deadZoneMv;
+  if (stable < DRIFT_STABLE_MIN_MV)
+    stable = DRIFT_STABLE_MIN_MV;
+  if (peak > stable)
+    return false;
+
+  int band = DRIFT_BAND_DZ * deadZoneMv;
+  int maxDrift = (int)(span * DRIFT_MAX_PCT);
+  int newMin = minV;
+  int newMax = maxV;
+  if (abs(mean - minV) <= band)
+    newMin = EndpointUpdate(d.rest, mean, d.anchorMin, maxDrift);
+  else if (abs(mean - maxV) <= band)
+    newMax = EndpointUpdate(d.bottom, mean, d.anchorMax, maxDrift);
+  else
+    return false;
+
+  if (newMin == minV && newMax == maxV)
+    return false;
+  minV = newMin;
+  maxV = newMax;
+  return true;
+}
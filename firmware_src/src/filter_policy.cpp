@@ -0,0 +1,109 @@
+// filter_policy.cpp
+#include <math.h>
+#include "filter_policy.h"
+
+static inline float DtSeconds(uint32_t dtUs)
+{
+  if (dtUs == 0)
+    dtUs = 1;
+  else if (dtUs > FILTER_POLICY_MAX_DT_US)
+    dtUs = FILTER_POLICY_MAX_DT_US;
+  return dtUs * 1e-6f;
+}
+
+// 一阶低通在截止频率 fc、间隔 dt 下的系数：r / (1 + r)，r = 2π·fc·dt
+static inline float LowPassAlpha(float cutoffHz, float dt)
+{
+  float r = 6.2831853f * cutoffHz * dt;
+  return r / (1.0f + r);
+}
+
+float OneEuroUpdate(OneEuroState &s, float z, uint32_t dtUs)
+{
+  if (!s.inited)
+  {
+    s.inited = true;
+    s.x = z;
+    s.dx = 0;
+    return z;
+  }
+  float dt = DtSeconds(dtUs);
+  // 速度取自上一次的滤波值，单独低通后决定这一次的截止频率
+  float dz = (z - s.x) / dt;
+  s.dx += LowPassAlpha(s.params.dCutoffHz, dt) * (dz - s.dx);
+  float cutoff = s.params.minCutoffHz + s.params.beta * fabsf(s.dx);
+  s.x += LowPassAlpha(cutoff, dt) * (z - s.x);
+  return s.x;
+}
+
+float KalmanUpdate(KalmanState &s, float z, uint32_t dtUs)
+{
+  const float r = s.params.measNoise;
+  if (!s.inited)
+  {
+    s.inited = true;
+    s.x = z;
+    s.v = 0;
+    // 初始位置的不确定度等于测量噪声，速度未知（按满量程 / 100ms 估计）
+    s.p00 = r;
+    s.p01 = 0;
+    s.p11 = 2550.0f * 2550.0f;
+    return z;
+  }
+  float dt = DtSeconds(dtUs);
+  float q = s.params.accelNoise;
+
+  // 预测：x += v·dt，P = F·P·Fᵀ + Q（Q 为连续白噪声加速度模型的离散化）
+  s.x += s.v * dt;
+  float dt2 = dt * dt;
+  s.p00 += dt * (2.0f * s.p01 + dt * s.p11) + q * dt2 * dt / 3.0f;
+  s.p01 += dt * s.p11 + q * dt2 / 2.0f;
+  s.p11 += q * dt;
+
+  // 更新：只测量位置
+  float k0 = s.p00 / (s.p00 + r);
+  float k1 = s.p01 / (s.p00 + r);
+  float y = z - s.x;
+  s.x += k0 * y;
+  s.v += k1 * y;
+  s.p11 -= k1 * s.p01;
+  s.p01 -= k0 * s.p01;
+  s.p00 -= k0 * s.p00;
+  return s.x;
+}
+
+int FilterPolicyOutput(PedalFilter &f, float x)
+{
+  if (x < 0)
+    x = 0;
+  else if (x > 255)
+    x = 255;
+  if (!f.inited)
+  {
+    f.inited = true;
+    f.lastOut = (int)(x + 0.5f);
+  }
+  else if (fabsf(x - f.lastOut) > FILTER_POLICY_HOLD_LSB)
+  {
+    f.lastOut = (int)(x + 0.5f);
+  }
+  int fine = (int)(x * 256.0f + 0.5f);
+  int lo = (f.lastOut - 1) << 8, hi = (f.lastOut + 1) << 8;
+  f.fineQ8 = fine < lo ? lo : (fine > hi ? hi : fine);
+  return f.lastOut;
+}
+
+const char *FilterPolicyName(FilterPolicy p)
+{
+  switch (p)
+  {
+  case FILTER_ADAPTIVE_EMA:
+    return "自适应EMA";
+  case FILTER_ONE_EURO:
+    return "One-Euro";
+  case FILTER_KALMAN:
+    return "卡尔曼";
+  default:
+    return "?";
+  }
+}
@@ -0,0 +1,151 @@
+// gesture.cpp
+#include "gesture.h"
+
+enum GestureInput
+{
+  GIN_PRESS,
+  GIN_RELEASE,
+  GIN_TIMEOUT,
+};
+
+// 转移条件（取决于配置）
+enum GestureCond
+{
+  COND_ANY,
+  COND_DOUBLE_ON,
+  COND_DOUBLE_OFF,
+  COND_REPEAT_ON,
+};
+
+// 进入新状态时启动的超时
+enum GestureTimer
+{
+  TIMER_NONE,
+  TIMER_LONG,
+  TIMER_DOUBLE,
+  TIMER_REPEAT_DELAY,
+  TIMER_REPEAT,
+};
+
+struct GestureTransition
+{
+  uint8_t state;
+  uint8_t input;
+  uint8_t cond;
+  uint8_t next;
+  uint8_t events;
+  uint8_t timer;
+};
+
+// 按顺序匹配，第一条满足的生效；表中没有的 (状态, 输入) 组合不产生事件
+static const GestureTransition gestureTable[] = {
+    {GESTURE_IDLE, GIN_PRESS, COND_ANY, GESTURE_DOWN, GESTURE_PRESS, TIMER_LONG},
+    {GESTURE_DOWN, GIN_RELEASE, COND_DOUBLE_OFF, GESTURE_IDLE, GESTURE_RELEASE | GESTURE_SHORT, TIMER_NONE},
+    {GESTURE_DOWN, GIN_RELEASE, COND_DOUBLE_ON, GESTURE_WAIT_DOUBLE, GESTURE_RELEASE, TIMER_DOUBLE},
+    {GESTURE_DOWN, GIN_TIMEOUT, COND_REPEAT_ON, GESTURE_HELD, GESTURE_LONG, TIMER_REPEAT_DELAY},
+    {GESTURE_DOWN, GIN_TIMEOUT, COND_ANY, GESTURE_HELD, GESTURE_LONG, TIMER_NONE},
+    {GESTURE_HELD, GIN_TIMEOUT, COND_ANY, GESTURE_HELD, GESTURE_REPEAT, TIMER_REPEAT},
+    {GESTURE_HELD, GIN_RELEASE, COND_ANY, GESTURE_IDLE, GESTURE_RELEASE, TIMER_NONE},
+    {GESTURE_WAIT_DOUBLE, GIN_PRESS, COND_ANY, GESTURE_DOWN_SECOND, GESTURE_PRESS | GESTURE_DOUBLE, TIMER_NONE},
+    {GESTURE_WAIT_DOUBLE, GIN_TIMEOUT, COND_ANY, GESTURE_IDLE, GESTURE_SHORT, TIMER_NONE},
+    {GESTURE_DOWN_SECOND, GIN_RELEASE, COND_ANY, GESTURE_IDLE, GESTURE_RELEASE, TIMER_NONE},
+};
+
+static bool CondHolds(uint8_t cond, const GestureConfig &cfg)
+{
+  switch (cond)
+  {
+  case COND_DOUBLE_ON:
+    return cfg.doubleMs != 0;
+  case COND_DOUBLE_OFF:
+    return cfg.doubleMs == 0;
+  case COND_REPEAT_ON:
+    return cfg.repeatDelayMs != 0;
+  default:
+    return true;
+  }
+}
+
+static uint32_t TimerMs(uint8_t timer, const GestureConfig &cfg)
+{
+  switch (timer)
+  {
+  case TIMER_LONG:
+    return cfg.longMs;
+  case TIMER_DOUBLE:
+    return cfg.doubleMs;
+  case TIMER_REPEAT_DELAY:
+    return cfg.repeatDelayMs;
+  case TIMER_REPEAT:
+    return cfg.repeatMs;
+  default:
+    return 0;
+  }
+}
+
+static uint8_t GestureStep(Gesture &g, const GestureConfig &cfg, uint8_t input, uint32_t nowMs)
+{
+  for (const GestureTransition &t : gestureTable)
+  {
+    if (t.state != g.state || t.input != input || !CondHolds(t.cond, cfg))
+      continue;
+    g.state = t.next;
+    uint32_t ms = TimerMs(t.timer, cfg);
+    // 超时从上一个截止时刻起算（REPEAT 间隔不随采样时刻漂移），0 保留为“无超时”
+    uint32_t deadline = (input == GIN_TIMEOUT ? g.deadline : nowMs) + ms;
+    g.deadline = ms == 0 ? 0 : (deadline ? deadline : 1);
+    return t.events;
+  }
+  if (input == GIN_TIMEOUT)
+    g.deadline = 0;
+  return 0;
+}
+
+void GestureReset(Gesture &g)
+{
+  g.state = GESTURE_IDLE;
+  g.down = false;
+  g.deadline = 0;
+}
+
+uint8_t GestureUpdate(Gesture &g, const GestureConfig &cfg, int value, uint32_t nowMs)
+{
+  uint8_t events = 0;
+  // 先处理已到期的超时：在截止时刻之后才松开，仍算长按
+  if (g.deadline != 0 && (int32_t)(nowMs - g.deadline) >= 0)
+    events |= GestureStep(g, cfg, GIN_TIMEOUT, nowMs);
+
+  bool down = g.down ? value >= cfg.releaseLevel : value > cfg.pressLevel;
+  if (down != g.down)
+  {
+    g.down = down;
+    events |= GestureStep(g, cfg, down ? GIN_PRESS : GIN_RELEASE, nowMs);
+  }
+  return events;
+}
+
+int GesturePageKeys(uint8_t events, bool eager, PageKey keys[GESTURE_PAGE_KEYS_MAX])
+{
+  int n = 0;
+  if (eager)
+  {
+    if (events & GESTURE_PRESS)
+      keys[n++] = PAGE_NEXT;
+    if (events & GESTURE_LONG)
+    {
+      // 踩下时已经翻到下一页：撤销它，再翻到上一页
+      keys[n++] = PAGE_PREV;
+      keys[n++] = PAGE_PREV;
+    }
+  }
+  else
+  {
+    if (events & GESTURE_SHORT)
+      keys[n++] = PAGE_NEXT;
+    if (events & GESTURE_LONG)
+      keys[n++] = PAGE_PREV;
+  }
+  if ((events & GESTURE_REPEAT) && n < GESTURE_PAGE_KEYS_MAX)
+    keys[n++] = PAGE_PREV;
+  return n;
+}
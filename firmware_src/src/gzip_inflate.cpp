@@ -0,0 +1,641 @@
+// gzip_inflate.cpp
+// 设备上 deflate 由 ROM 中的 miniz tinfl 解码；主机上的可移植实现中 Huffman 解码参照 zlib 的 puff：
+// 规范码逐位比较，表小且不需要二级查找
+#include <string.h>
+#include "crc32.h"
+#include "gzip_inflate.h"
+
+#ifdef ESP_PLATFORM
+
+static inline uint32_t GetLe32(const uint8_t *p)
+{
+  return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+enum
+{
+  STATE_GZIP_HEADER, // 固定 10 字节
+  STATE_EXTRA_LEN,   // 可选字段（RFC 1952 2.3），按标志依次出现
+  STATE_EXTRA,
+  STATE_NAME,
+  STATE_COMMENT,
+  STATE_HEADER_CRC,
+  STATE_DEFLATE,
+  STATE_TRAILER, // deflate 已结束，等待输入结束后校验结尾
+  STATE_ERROR,
+};
+
+static void Fail(Inflater &z, const char *error)
+{
+  z.state = STATE_ERROR;
+  if (!z.error)
+    z.error = error;
+}
+
+// 从 state 开始跳过标志中没有的可选字段
+static void NextHeaderField(Inflater &z, int state)
+{
+  z.count = 0;
+  if (state == STATE_EXTRA_LEN && !(z.flags & 0x04))
+    state = STATE_NAME;
+  if (state == STATE_NAME && !(z.flags & 0x08))
+    state = STATE_COMMENT;
+  if (state == STATE_COMMENT && !(z.flags & 0x10))
+    state = STATE_HEADER_CRC;
+  if (state == STATE_HEADER_CRC && !(z.flags & 0x02))
+    state = STATE_DEFLATE;
+  z.state = state;
+}
+
+// 逐字节解析 gzip 头，返回消耗的字节数（到达 deflate 数据或出错时停止）
+static size_t GzipHeader(Inflater &z, const uint8_t *data, size_t len)
+{
+  size_t i = 0;
+  while (i < len && z.state < STATE_DEFLATE)
+  {
+    uint8_t b = data[i++];
+    switch (z.state)
+    {
+    case STATE_GZIP_HEADER:
+      z.head[z.count++] = b;
+      if (z.count < 10)
+        break;
+      z.flags = z.head[3];
+      if (z.head[0] != 0x1f || z.head[1] != 0x8b || z.head[2] != 8)
+        Fail(z, "不是 gzip 数据");
+      else if (z.flags & 0xE0)
+        Fail(z, "gzip 头标志无效");
+      else
+        NextHeaderField(z, STATE_EXTRA_LEN);
+      break;
+    case STATE_EXTRA_LEN:
+      z.head[z.count++] = b;
+      if (z.count < 2)
+        break;
+      z.count = z.head[0] | (uint32_t)z.head[1] << 8;
+      if (z.count == 0)
+        NextHeaderField(z, STATE_NAME);
+      else
+        z.state = STATE_EXTRA;
+      break;
+    case STATE_EXTRA:
+      if (--z.count == 0)
+        NextHeaderField(z, STATE_NAME);
+      break;
+    case STATE_NAME:
+    case STATE_COMMENT:
+      // 以 0 结尾
+      if (b == 0)
+        NextHeaderField(z, z.state + 1);
+      break;
+    case STATE_HEADER_CRC:
+      if (++z.count == 2)
+        NextHeaderField(z, STATE_DEFLATE);
+      break;
+    }
+  }
+  return i;
+}
+
+// 把输入全部交给 tinfl，解出的数据直接从窗口交给 sink
+static void Deflate(Inflater &z, const uint8_t *data, size_t len)
+{
+  for (;;)
+  {
+    size_t in = len, out = INFLATE_WINDOW_SIZE - z.wpos;
+    tinfl_status status =
+        tinfl_decompress(&z.tinfl, data, &in, z.window, z.window + z.wpos, &out, TINFL_FLAG_HAS_MORE_INPUT);
+    data += in;
+    len -= in;
+    if (out > 0)
+    {
+      const uint8_t *p = z.window + z.wpos;
+      z.crc = Crc32Update(z.crc, p, out);
+      z.total += out;
+      if (!z.sink(z.sinkCtx, p, out))
+        return Fail(z, "写入失败");
+      z.wpos = (z.wpos + out) & (INFLATE_WINDOW_SIZE - 1);
+    }
+    if (status == TINFL_STATUS_DONE)
+    {
+      z.state = STATE_TRAILER;
+      return;
+    }
+    if (status < 0)
+      return Fail(z, "deflate 数据损坏");
+    if (status == TINFL_STATUS_NEEDS_MORE_INPUT)
+      return;
+    // TINFL_STATUS_HAS_MORE_OUTPUT：窗口写到末尾，回绕后继续
+  }
+}
+
+void InflateBegin(Inflater &z, uint8_t *window, InflateSink sink, void *sinkCtx)
+{
+  z.window = window;
+  z.sink = sink;
+  z.sinkCtx = sinkCtx;
+  tinfl_init(&z.tinfl);
+  z.state = STATE_GZIP_HEADER;
+  z.flags = 0;
+  z.count = 0;
+  z.tailLen = 0;
+  z.wpos = 0;
+  z.crc = 0;
+  z.total = 0;
+  z.error = nullptr;
+}
+
+InflateStatus InflateWrite(Inflater &z, const uint8_t *data, size_t len)
+{
+  // tinfl 可能预读结尾的字节，结尾按整个输入的最后 8 字节校验
+  if (len >= sizeof(z.tail))
+  {
+    memcpy(z.tail, data + len - sizeof(z.tail), sizeof(z.tail));
+    z.tailLen = sizeof(z.tail);
+  }
+  else
+  {
+    size_t keep = z.tailLen + len > sizeof(z.tail) ? sizeof(z.tail) - len : z.tailLen;
+    memmove(z.tail, z.tail + z.tailLen - keep, keep);
+    memcpy(z.tail + keep, data, len);
+    z.tailLen = (uint8_t)(keep + len);
+  }
+
+  if (z.state < STATE_DEFLATE)
+  {
+    size_t n = GzipHeader(z, data, len);
+    data += n;
+    len -= n;
+  }
+  if (z.state == STATE_DEFLATE && len > 0)
+    Deflate(z, data, len);
+  return z.state == STATE_ERROR ? INFLATE_ERROR : INFLATE_NEED_INPUT;
+}
+
+InflateStatus InflateFinish(Inflater &z)
+{
+  if (z.state == STATE_ERROR)
+    return INFLATE_ERROR;
+  if (z.state != STATE_TRAILER || z.tailLen < sizeof(z.tail))
+  {
+    Fail(z, "gzip 数据被截断");
+    return INFLATE_ERROR;
+  }
+  if (GetLe32(z.tail) != z.crc)
+  {
+    Fail(z, "CRC32 校验失败");
+    return INFLATE_ERROR;
+  }
+  if (GetLe32(z.tail + 4) != z.total)
+  {
+    Fail(z, "解压长度与 ISIZE 不符");
+    return INFLATE_ERROR;
+  }
+  return INFLATE_DONE;
+}
+
+#else
+
+enum
+{
+  STATE_GZIP_HEADER,
+  STATE_BLOCK_HEADER,
+  STATE_STORED,
+  STATE_HUFFMAN,
+  STATE_GZIP_TRAILER,
+  STATE_DONE,
+  STATE_ERROR,
+};
+
+// 长度/距离码的基数与扩展位数（RFC 1951 3.2.5）
+static const uint16_t lengthBase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                        35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const uint8_t lengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                        3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const uint16_t distBase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                      257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+static const uint8_t distExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                      7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+// 解码单元的起点，输入不足时回退到这里
+struct Checkpoint
+{
+  size_t pos;
+  uint32_t bitBuf;
+  int bitCount;
+};
+
+static inline Checkpoint Save(const Inflater &z) { return {z.pos, z.bitBuf, z.bitCount}; }
+
+static inline void Restore(Inflater &z, const Checkpoint &c)
+{
+  z.pos = c.pos;
+  z.bitBuf = c.bitBuf;
+  z.bitCount = c.bitCount;
+  z.underflow = false;
+}
+
+// 读取 n 位（n <= 16）；暂存区数据不足时置 underflow 并返回 0
+static inline uint32_t Bits(Inflater &z, int n)
+{
+  while (z.bitCount < n)
+  {
+    if (z.pos >= z.stageLen)
+    {
+      z.underflow = true;
+      return 0;
+    }
+    z.bitBuf |= (uint32_t)z.stage[z.pos++] << z.bitCount;
+    z.bitCount += 8;
+  }
+  uint32_t v = z.bitBuf & ((1u << n) - 1);
+  z.bitBuf >>= n;
+  z.bitCount -= n;
+  return v;
+}
+
+static inline void AlignByte(Inflater &z)
+{
+  z.bitBuf >>= z.bitCount & 7;
+  z.bitCount -= z.bitCount & 7;
+}
+
+static void Fail(Inflater &z, const char *error)
+{
+  z.state = STATE_ERROR;
+  if (!z.error)
+    z.error = error;
+}
+
+// 把窗口中 [flushPos, wpos) 交给 sink
+static void Flush(Inflater &z)
+{
+  if (z.wpos == z.flushPos)
+    return;
+  const uint8_t *p = z.window + z.flushPos;
+  size_t n = z.wpos - z.flushPos;
+  z.crc = Crc32Update(z.crc, p, n);
+  if (!z.sink(z.sinkCtx, p, n))
+    Fail(z, "写入失败");
+  z.flushPos = z.wpos;
+}
+
+static inline void Put(Inflater &z, uint8_t b)
+{
+  z.window[z.wpos++] = b;
+  z.total++;
+  if (z.wpos == INFLATE_WINDOW_SIZE)
+  {
+    Flush(z);
+    z.wpos = 0;
+    z.flushPos = 0;
+  }
+}
+
+static bool Build(InflateHuffman &h, const uint8_t *lengths, int n)
+{
+  memset(h.count, 0, sizeof(h.count));
+  for (int i = 0; i < n; ++i)
+    h.count[lengths[i]]++;
+  // 检查码长是否超额分配
+  int left = 1;
+  for (int len = 1; len < 16; ++len)
+  {
+    left <<= 1;
+    left -= h.count[len];
+    if (left < 0)
+      return false;
+  }
+  uint16_t offs[16];
+  offs[1] = 0;
+  for (int len = 1; len < 15; ++len)
+    offs[len + 1] = offs[len] + h.count[len];
+  for (int i = 0; i < n; ++i)
+    if (lengths[i])
+      h.symbol[offs[lengths[i]]++] = i;
+  return true;
+}
+
+// 返回符号；-1 表示输入不足，-2 表示无效码
+static int Decode(Inflater &z, const InflateHuffman &h)
+{
+  int code = 0, first = 0, index = 0;
+  for (int len = 1; len < 16; ++len)
+  {
+    code |= Bits(z, 1);
+    if (z.underflow)
+      return -1;
+    int count = h.count[len];
+    if (code - count < first)
+      return h.symbol[index + (code - first)];
+    index += count;
+    first += count;
+    first <<= 1;
+    code <<= 1;
+  }
+  return -2;
+}
+
+// gzip 头（RFC 1952 2.3），整个头作为一个单元
+static void GzipHeader(Inflater &z)
+{
+  uint32_t id1 = Bits(z, 8), id2 = Bits(z, 8), cm = Bits(z, 8), flags = Bits(z, 8);
+  for (int i = 0; i < 6; ++i) // MTIME、XFL、OS
+    Bits(z, 8);
+  if (z.underflow)
+    return;
+  if (id1 != 0x1f || id2 != 0x8b || cm != 8)
+    return Fail(z, "不是 gzip 数据");
+  if (flags & 0xE0)
+    return Fail(z, "gzip 头标志无效");
+  if (flags & 0x04) // FEXTRA
+  {
+    uint32_t xlen = Bits(z, 16);
+    while (xlen-- && !z.underflow)
+      Bits(z, 8);
+  }
+  for (uint32_t mask = 0x08; mask <= 0x10; mask <<= 1) // FNAME、FCOMMENT，以 0 结尾
+    if (flags & mask)
+      while (Bits(z, 8) != 0 && !z.underflow)
+      {
+      }
+  if (flags & 0x02) // FHCRC
+    Bits(z, 16);
+  if (!z.underflow)
+    z.state = STATE_BLOCK_HEADER;
+}
+
+static void DynamicTables(Inflater &z)
+{
+  static const uint8_t order[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+  uint8_t lengths[286 + 30];
+  int nlen = Bits(z, 5) + 257;
+  int ndist = Bits(z, 5) + 1;
+  int ncode = Bits(z, 4) + 4;
+  if (z.underflow)
+    return;
+  if (nlen > 286 || ndist > 30)
+    return Fail(z, "动态块码表长度无效");
+
+  memset(lengths, 0, 19);
+  for (int i = 0; i < ncode; ++i)
+    lengths[order[i]] = Bits(z, 3);
+  if (z.underflow)
+    return;
+  // 码长码表暂存在 lit 中，随后被字面量/长度表覆盖
+  if (!Build(z.lit, lengths, 19))
+    return Fail(z, "码长码表无效");
+
+  int index = 0;
+  while (index < nlen + ndist)
+  {
+    int sym = Decode(z, z.lit);
+    if (sym == -1)
+      return;
+    if (sym < 0)
+      return Fail(z, "码长编码无效");
+    if (sym < 16)
+    {
+      lengths[index++] = sym;
+      continue;
+    }
+    int len = 0, repeat;
+    if (sym == 16)
+    {
+      if (index == 0)
+        return Fail(z, "重复码长缺少前值");
+      len = lengths[index - 1];
+      repeat = 3 + Bits(z, 2);
+    }
+    else if (sym == 17)
+      repeat = 3 + Bits(z, 3);
+    else
+      repeat = 11 + Bits(z, 7);
+    if (z.underflow)
+      return;
+    if (index + repeat > nlen + ndist)
+      return Fail(z, "码长重复越界");
+    while (repeat--)
+      lengths[index++] = len;
+  }
+  if (lengths[256] == 0)
+    return Fail(z, "缺少块结束码");
+  if (!Build(z.lit, lengths, nlen) || !Build(z.dist, lengths + nlen, ndist))
+    return Fail(z, "Huffman 码表无效");
+  z.state = STATE_HUFFMAN;
+}
+
+static void FixedTables(Inflater &z)
+{
+  uint8_t lengths[288];
+  memset(lengths, 8, 144);
+  memset(lengths + 144, 9, 112);
+  memset(lengths + 256, 7, 24);
+  memset(lengths + 280, 8, 8);
+  Build(z.lit, lengths, 288);
+  memset(lengths, 5, 30);
+  Build(z.dist, lengths, 30);
+  z.state = STATE_HUFFMAN;
+}
+
+static void BlockHeader(Inflater &z)
+{
+  bool last = Bits(z, 1);
+  uint32_t type = Bits(z, 2);
+  if (z.underflow)
+    return;
+  if (type == 0)
+  {
+    AlignByte(z);
+    uint32_t len = Bits(z, 16);
+    uint32_t nlen = Bits(z, 16);
+    if (z.underflow)
+      return;
+    if (len != (~nlen & 0xFFFF))
+      return Fail(z, "存储块长度校验失败");
+    z.storedLeft = len;
+    z.state = STATE_STORED;
+  }
+  else if (type == 1)
+    FixedTables(z);
+  else if (type == 2)
+    DynamicTables(z);
+  else
+    return Fail(z, "块类型无效");
+  if (!z.underflow)
+    z.lastBlock = last;
+}
+
+static inline void EndBlock(Inflater &z)
+{
+  z.state = z.lastBlock ? STATE_GZIP_TRAILER : STATE_BLOCK_HEADER;
+}
+
+// 一个字面量或一次长度/距离复制；全部读取成功后才写入窗口，回退时不会留下半个符号
+static void Symbol(Inflater &z)
+{
+  int sym = Decode(z, z.lit);
+  if (sym == -1)
+    return;
+  if (sym < 0)
+    return Fail(z, "字面量编码无效");
+  if (sym < 256)
+    return Put(z, (uint8_t)sym);
+  if (sym == 256)
+    return EndBlock(z);
+
+  sym -= 257;
+  if (sym >= 29)
+    return Fail(z, "长度码无效");
+  uint32_t len = lengthBase[sym] + Bits(z, lengthExtra[sym]);
+  int dsym = Decode(z, z.dist);
+  if (dsym == -1 || z.underflow)
+    return;
+  if (dsym < 0 || dsym >= 30)
+    return Fail(z, "距离码无效");
+  uint32_t dist = distBase[dsym] + Bits(z, distExtra[dsym]);
+  if (z.underflow)
+    return;
+  if (dist > z.total)
+    return Fail(z, "距离超出已解压数据");
+
+  uint32_t src = (z.wpos - dist) & (INFLATE_WINDOW_SIZE - 1);
+  while (len--)
+  {
+    Put(z, z.window[src]);
+    src = (src + 1) & (INFLATE_WINDOW_SIZE - 1);
+  }
+}
+
+static void GzipTrailer(Inflater &z)
+{
+  AlignByte(z);
+  uint32_t crc = Bits(z, 16);
+  crc |= Bits(z, 16) << 16;
+  uint32_t size = Bits(z, 16);
+  size |= Bits(z, 16) << 16;
+  if (z.underflow)
+    return;
+  // 结尾之前的数据必须先全部送入 CRC
+  Flush(z);
+  if (z.state == STATE_ERROR)
+    return;
+  if (crc != z.crc)
+    return Fail(z, "CRC32 校验失败");
+  if (size != z.total)
+    return Fail(z, "解压长度与 ISIZE 不符");
+  z.state = STATE_DONE;
+}
+
+// 在暂存区内尽量多地解码完整单元
+static void Run(Inflater &z)
+{
+  while (z.state != STATE_DONE && z.state != STATE_ERROR)
+  {
+    Checkpoint c = Save(z);
+    switch (z.state)
+    {
+    case STATE_GZIP_HEADER:
+      GzipHeader(z);
+      break;
+    case STATE_BLOCK_HEADER:
+      BlockHeader(z);
+      break;
+    case STATE_STORED:
+      if (z.storedLeft == 0)
+      {
+        EndBlock(z);
+        continue;
+      }
+      {
+        uint32_t b = Bits(z, 8);
+        if (!z.underflow)
+        {
+          Put(z, (uint8_t)b);
+          z.storedLeft--;
+        }
+      }
+      break;
+    case STATE_HUFFMAN:
+      Symbol(z);
+      break;
+    case STATE_GZIP_TRAILER:
+      GzipTrailer(z);
+      break;
+    }
+    if (z.underflow)
+    {
+      Restore(z, c);
+      return;
+    }
+  }
+}
+
+void InflateBegin(Inflater &z, uint8_t *window, InflateSink sink, void *sinkCtx)
+{
+  z.window = window;
+  z.sink = sink;
+  z.sinkCtx = sinkCtx;
+  z.stageLen = 0;
+  z.pos = 0;
+  z.bitBuf = 0;
+  z.bitCount = 0;
+  z.underflow = false;
+  z.state = STATE_GZIP_HEADER;
+  z.lastBlock = false;
+  z.storedLeft = 0;
+  z.wpos = 0;
+  z.flushPos = 0;
+  z.crc = 0;
+  z.total = 0;
+  z.error = nullptr;
+}
+
+InflateStatus InflateWrite(Inflater &z, const uint8_t *data, size_t len)
+{
+  while (len > 0 && z.state != STATE_DONE && z.state != STATE_ERROR)
+  {
+    // 把未解码的剩余字节移到暂存区开头，再补入新数据
+    if (z.pos > 0)
+    {
+      memmove(z.stage, z.stage + z.pos, z.stageLen - z.pos);
+      z.stageLen -= z.pos;
+      z.pos = 0;
+    }
+    size_t n = INFLATE_STAGE_SIZE - z.stageLen;
+    if (n == 0)
+    {
+      // 一个单元比暂存区还大（只可能是超长的 gzip 文件名/注释）
+      Fail(z, "gzip 头过长");
+      break;
+    }
+    if (n > len)
+      n = len;
+    memcpy(z.stage + z.stageLen, data, n);
+    z.stageLen += n;
+    data += n;
+    len -= n;
+    Run(z);
+  }
+  if (z.state == STATE_DONE && (len > 0 || z.pos < z.stageLen))
+    Fail(z, "gzip 结尾之后还有数据");
+  if (z.state != STATE_ERROR)
+    Flush(z);
+  if (z.state == STATE_ERROR)
+    return INFLATE_ERROR;
+  return z.state == STATE_DONE ? INFLATE_DONE : INFLATE_NEED_INPUT;
+}
+
+InflateStatus InflateFinish(Inflater &z)
+{
+  if (z.state == STATE_ERROR)
+    return INFLATE_ERROR;
+  if (z.state != STATE_DONE)
+  {
+    Fail(z, "gzip 数据被截断");
+    return INFLATE_ERROR;
+  }
+  return INFLATE_DONE;
+}
+
+#endif
@@ -0,0 +1,46 @@
+// hal_esp32.cpp
+// pedal_hal.h 的 ESP32 实现，直接转发到 Arduino / ESP-IDF 接口
+#include <Arduino.h>
+#include "esp_adc_cal.h"
+#include "dac_stream.h"
+#include "pedal_config.h"
+#include "pedal_hal.h"
+
+// ADC 校准结构
+static esp_adc_cal_characteristics_t adc_chars;
+
+void halAdcBegin()
+{
+  analogSetPinAttenuation(ADC_Sustain_PIN, ADC_11db);
+  analogSetPinAttenuation(ADC_Sostenuto_PIN, ADC_11db);
+  analogSetPinAttenuation(ADC_Soft_PIN, ADC_11db);
+  analogSetWidth(12);
+  esp_adc_cal_characterize(ADC_UNIT_1, (adc_atten_t)ADC_11db, ADC_WIDTH_BIT_12, 1100, &adc_chars);
+}
+
+int halAnalogRead(int pin) { return analogRead(pin); }
+
+int halRawToMillivolts(int raw) { return esp_adc_cal_raw_to_voltage(raw, &adc_chars); }
+
+int halDigitalRead(int pin) { return digitalRead(pin); }
+
+void halDigitalWrite(int pin, int level) { digitalWrite(pin, level); }
+
+void halDacWrite(int pin, uint8_t value) { dacWrite(pin, value); }
+
+void halDacBegin()
+{
+#if Dac_Dither_Enable
+  DacStreamBegin();
+#endif
+}
+
+void halDacWriteQ8(int pin, int codeQ8) { DacStreamSet(pin, codeQ8); }
+
+unsigned long halMillis() { return millis(); }
+
+uint32_t halMicros() { return micros(); }
+
+void halDelay(unsigned long ms) { delay(ms); }
+
+uint32_t halCycleCount() { return ESP.getCycleCount(); }
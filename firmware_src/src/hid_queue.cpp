@@ -0,0 +1,139 @@
+// hid_queue.cpp
+#include <atomic>
+#include <new>
+#include <stdio.h>
+#include "hid_queue.h"
+#include "pedal_config.h"
+#include "sample_ring.h"
+
+const uint32_t hidLatencyBoundsUs[HID_LATENCY_BUCKETS - 1] = {1000, 2000, 5000, 10000, 20000, 50000, 100000};
+
+typedef SampleRing<HidEvent, HID_QUEUE_SIZE, Hid_Queue_Policy> HidRing;
+static HidRing ring;
+
+// 生产者状态：最近一次入队的按键与时刻，用于合并
+static uint8_t lastKey = 0;
+static uint32_t lastUs = 0;
+
+// 生产者与消费者各自写入自己的计数，读取方只做原子读
+static std::atomic<uint32_t> queued{0};
+static std::atomic<uint32_t> coalesced{0};
+static std::atomic<uint32_t> stale{0};
+static std::atomic<uint32_t> unsent{0};
+static std::atomic<uint32_t> sent{0};
+static std::atomic<uint32_t> latency[HID_LATENCY_BUCKETS];
+static std::atomic<uint32_t> latencyMaxUs{0};
+static std::atomic<uint32_t> latencySumUs{0};
+
+bool HidQueuePush(uint8_t key, uint32_t nowUs, bool coalesce)
+{
+  // 前一个相同按键仍在队列中（队列非空时最新入队的一定还没取出）且间隔很短：视为重复触发
+  if (coalesce && key == lastKey && ring.available() > 0 && nowUs - lastUs < Hid_Coalesce_Ms * 1000UL)
+  {
+    coalesced.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  HidEvent ev = {key, nowUs};
+  if (!ring.push(ev))
+    return false; // 队列满（RING_DROP_NEWEST），由 ring.dropped() 计数；覆盖模式下由 ring.lost() 计数
+  lastKey = key;
+  lastUs = nowUs;
+  queued.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+bool HidQueuePop(HidEvent &ev, uint32_t nowUs)
+{
+  while (ring.pop(ev))
+  {
+    if (nowUs - ev.enqueueUs <= Hid_Max_Age_Ms * 1000UL)
+      return true;
+    // 协议栈长时间拥塞或刚恢复连接：过时的翻页不再补发
+    stale.fetch_add(1, std::memory_order_relaxed);
+  }
+  return false;
+}
+
+void HidQueueDone(const HidEvent &ev, bool ok, uint32_t nowUs)
+{
+  if (!ok)
+  {
+    unsent.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  uint32_t us = nowUs - ev.enqueueUs;
+  int bucket = 0;
+  while (bucket < HID_LATENCY_BUCKETS - 1 && us >= hidLatencyBoundsUs[bucket])
+    bucket++;
+  latency[bucket].fetch_add(1, std::memory_order_relaxed);
+  latencySumUs.fetch_add(us, std::memory_order_relaxed);
+  if (us > latencyMaxUs.load(std::memory_order_relaxed))
+    latencyMaxUs.store(us, std::memory_order_relaxed);
+  sent.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint32_t HidQueuePending() { return ring.available(); }
+
+void HidQueueReadStats(HidQueueStats &out)
+{
+  out.queued = queued.load(std::memory_order_relaxed);
+  out.coalesced = coalesced.load(std::memory_order_relaxed);
+  out.dropped = ring.dropped() + ring.lost();
+  out.stale = stale.load(std::memory_order_relaxed);
+  out.unsent = unsent.load(std::memory_order_relaxed);
+  out.sent = sent.load(std::memory_order_relaxed);
+  for (int i = 0; i < HID_LATENCY_BUCKETS; ++i)
+    out.latency[i] = latency[i].load(std::memory_order_relaxed);
+  out.latencyMaxUs = latencyMaxUs.load(std::memory_order_relaxed);
+  out.latencySumUs = latencySumUs.load(std::memory_order_relaxed);
+}
+
+void HidQueueReset()
+{
+  ring.~HidRing();
+  new (&ring) HidRing();
+  lastKey = 0;
+  lastUs = 0;
+  queued = 0;
+  coalesced = 0;
+  stale = 0;
+  unsent = 0;
+  sent = 0;
+  for (int i = 0; i < HID_LATENCY_BUCKETS; ++i)
+    latency[i] = 0;
+  latencyMaxUs = 0;
+  latencySumUs = 0;
+}
+
+size_t HidQueueFormat(char *buf, size_t len)
+{
+  HidQueueStats s;
+  HidQueueReadStats(s);
+  size_t n = 0;
+#define HID_APPEND(...)                                \
+  do                                                   \
+  {                                                    \
+    if (n < len)                                       \
+    {                                                  \
+      int w = snprintf(buf + n, len - n, __VA_ARGS__); \
+      n += w > 0 ? (size_t)w : 0;                      \
+    }                                                  \
+  } while (0)
+
+  // 翻页事件：入队 合并 丢弃 过期 断开未发 已发送 当前排队
+  HID_APPEND("hid %u %u %u %u %u %u %u\n", (unsigned)s.queued, (unsigned)s.coalesced, (unsigned)s.dropped,
+             (unsigned)s.stale, (unsigned)s.unsent, (unsigned)s.sent, (unsigned)HidQueuePending());
+  // 入队 → 发出的延迟直方图：每档上限(us):次数，最后一档为 inf
+  HID_APPEND("hid_latency_us");
+  for (int i = 0; i < HID_LATENCY_BUCKETS; ++i)
+  {
+    if (i < HID_LATENCY_BUCKETS - 1)
+      HID_APPEND(" %u:%u", (unsigned)hidLatencyBoundsUs[i], (unsigned)s.latency[i]);
+    else
+      HID_APPEND(" inf:%u", (unsigned)s.latency[i]);
+  }
+  HID_APPEND("\nhid_latency_mean_max_us %u %u\n", (unsigned)(s.sent ? s.latencySumUs / s.sent : 0),
+             (unsigned)s.latencyMaxUs);
+#undef HID_APPEND
+  return n < len ? n : (len ? len - 1 : 0);
+}
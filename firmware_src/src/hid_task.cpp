@@ -0,0 +1,47 @@
+// hid_task.cpp
+#include <Arduino.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "hid_queue.h"
+#include "hid_task.h"
+#include "metrics.h"
+
+#define HID_TASK_STACK 4096
+#define HID_TASK_PRIORITY (tskIDLE_PRIORITY + 1)
+// 与蓝牙协议栈同在 PRO_CPU，APP_CPU 留给采样任务与 loop()
+#define HID_TASK_CORE PRO_CPU_NUM
+
+static TaskHandle_t hidTask = NULL;
+static HidSendFunc hidSend = NULL;
+
+static void HidTaskLoop(void *arg)
+{
+  HidEvent ev;
+  for (;;)
+  {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    while (HidQueuePop(ev, micros()))
+    {
+      uint32_t t0 = ESP.getCycleCount();
+      bool ok = hidSend(ev.key);
+      MetricsStage(METRIC_HID, ESP.getCycleCount() - t0);
+      HidQueueDone(ev, ok, micros());
+    }
+  }
+}
+
+void HidTaskBegin(HidSendFunc send)
+{
+  if (hidTask != NULL || send == NULL)
+    return;
+  hidSend = send;
+  xTaskCreatePinnedToCore(HidTaskLoop, "hid", HID_TASK_STACK, NULL, HID_TASK_PRIORITY, &hidTask, HID_TASK_CORE);
+}
+
+void HidTaskPush(uint8_t key, bool coalesce)
+{
+  if (hidTask == NULL)
+    return;
+  if (HidQueuePush(key, micros(), coalesce))
+    xTaskNotifyGive(hidTask);
+}
@@ -0,0 +1,159 @@
+// log_task.cpp
+#include <Arduino.h>
+#include <atomic>
+#include <stdio.h>
+#include "esp_partition.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "log_task.h"
+#include "pedal_config.h"
+#include "sample_log.h"
+
+#define LOG_TASK_STACK 4096
+#define LOG_TASK_PRIORITY (tskIDLE_PRIORITY + 1)
+// 与 HID 发送任务一样放在 PRO_CPU。注意这只是让出 CPU 时间：擦写期间闪存 cache 在两个核上都被关闭，
+// APP_CPU 上的采样任务（代码不在 IRAM）同样停住，停顿长度即 writeMaxUs，因此只在门户模式下记录（见 pedal_config.h）
+#define LOG_TASK_CORE PRO_CPU_NUM
+
+static TaskHandle_t logTask = NULL;
+static const esp_partition_t *logPartition = NULL;
+// 以下由 loop() 读写（写入任务只在 ready 之前初始化它们）
+static SampleLogRing ring;
+static SampleLogWriter writer;
+static uint32_t nextUs = 0;
+static bool nextUsValid = false;
+// 写满的块：loop() 填入后交给写入任务，写完之前 loop() 不会改动
+static uint8_t pending[SAMPLE_LOG_BLOCK_SIZE];
+static uint32_t pendingIndex = 0;
+static bool pendingValid = false;
+static std::atomic<bool> pendingBusy(false);
+// 写入任务扫描完已有记录后置位
+static std::atomic<bool> ready(false);
+
+// 统计：loop() 写 records/dropped，写入任务写其余各项
+static uint32_t records = 0;
+static uint32_t droppedFrames = 0;
+static uint32_t blocksWritten = 0;
+static uint32_t writeErrors = 0;
+static uint32_t writeSumUs = 0;
+static uint32_t writeMaxUs = 0;
+
+// 读取整块并检查（ctx 为块缓冲）
+static bool ReadBlock(void *ctx, uint32_t index, SampleLogHeader &h)
+{
+  uint8_t *buf = (uint8_t *)ctx;
+  if (esp_partition_read(logPartition, index * SAMPLE_LOG_BLOCK_SIZE, buf, SAMPLE_LOG_BLOCK_SIZE) != ESP_OK)
+    return false;
+  return SampleLogHeaderRead(buf, h);
+}
+
+static void LogTaskLoop(void *arg)
+{
+  // 512KB 分区的扫描约几十毫秒，放在这里不推迟开机；借用 pending 作读缓冲（此时还没有写满的块）
+  SampleLogRingScan(ring, logPartition->size / SAMPLE_LOG_BLOCK_SIZE, ReadBlock, pending);
+  SampleLogBegin(writer, ring.seq, ring.session);
+  ready.store(true, std::memory_order_release);
+
+  for (;;)
+  {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    if (!pendingBusy.load(std::memory_order_acquire))
+      continue;
+    // 一块对应一个扇区：擦除后一次写入
+    uint32_t t0 = micros();
+    uint32_t offset = pendingIndex * SAMPLE_LOG_BLOCK_SIZE;
+    bool ok = esp_partition_erase_range(logPartition, offset, SAMPLE_LOG_BLOCK_SIZE) == ESP_OK &&
+              esp_partition_write(logPartition, offset, pending, SAMPLE_LOG_BLOCK_SIZE) == ESP_OK;
+    uint32_t us = micros() - t0;
+    writeSumUs += us;
+    if (us > writeMaxUs)
+      writeMaxUs = us;
+    if (ok)
+      blocksWritten++;
+    else
+      writeErrors++;
+    pendingBusy.store(false, std::memory_order_release);
+  }
+}
+
+void LogTaskBegin()
+{
+  if (logTask != NULL)
+    return;
+  logPartition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_SPIFFS, NULL);
+  if (logPartition == NULL || logPartition->size < SAMPLE_LOG_BLOCK_SIZE * 2)
+    return;
+  xTaskCreatePinnedToCore(LogTaskLoop, "log", LOG_TASK_STACK, NULL, LOG_TASK_PRIORITY, &logTask, LOG_TASK_CORE);
+}
+
+void LogTaskRecord(const PedalFrame &frame)
+{
+  if (!ready.load(std::memory_order_acquire))
+    return;
+  if (!nextUsValid)
+  {
+    nextUs = frame.timeUs;
+    nextUsValid = true;
+  }
+  if (!SampleLogDue(nextUs, frame.timeUs, 1000000UL / Sample_Log_Rate_Hz))
+    return;
+  if (!SampleLogAppend(writer, frame))
+  {
+    // 当前块已满；上一块还没写完（一块约几秒才写满，正常不会发生）时丢弃这一帧，下一帧再试
+    if (pendingBusy.load(std::memory_order_acquire))
+    {
+      droppedFrames++;
+      return;
+    }
+    SampleLogSeal(writer, pending);
+    pendingIndex = SampleLogRingTake(ring);
+    pendingValid = true;
+    pendingBusy.store(true, std::memory_order_release);
+    xTaskNotifyGive(logTask);
+    SampleLogNext(writer);
+    SampleLogAppend(writer, frame);
+  }
+  records++;
+}
+
+uint32_t LogTaskRead(LogBlockFn fn, void *ctx)
+{
+  if (!ready.load(std::memory_order_acquire))
+    return 0;
+  static uint8_t buf[SAMPLE_LOG_BLOCK_SIZE];
+  SampleLogHeader h;
+  uint32_t sent = 0;
+  for (uint32_t k = 0; k < ring.blocks; ++k)
+  {
+    uint32_t index = (ring.next + k) % ring.blocks;
+    const uint8_t *block = buf;
+    // 最近写满的块直接取内存中的副本（可能正在擦写）；其余块读出后检查，已擦除或损坏的块跳过
+    if (pendingValid && index == pendingIndex)
+      block = pending;
+    else if (!ReadBlock(buf, index, h))
+      continue;
+    if (!fn(ctx, block, SAMPLE_LOG_BLOCK_SIZE))
+      return sent;
+    sent++;
+  }
+  if (SampleLogSeal(writer, buf) && fn(ctx, buf, SAMPLE_LOG_BLOCK_SIZE))
+    sent++;
+  return sent;
+}
+
+size_t LogTaskFormat(char *buf, size_t len)
+{
+  if (len == 0)
+    return 0;
+  buf[0] = 0;
+  if (!ready.load(std::memory_order_acquire))
+    return 0;
+  uint32_t written = blocksWritten;
+  // 采样记录：分区块数 开机时的有效块 开机序号 当前块序号 已写块 写入失败 记录数 丢弃帧 当前块已用字节 擦写耗时 平均/最大(us)
+  int w = snprintf(buf, len, "log %u %u %u %u %u %u %u %u %u %u %u\n", (unsigned)ring.blocks, (unsigned)ring.valid,
+                   (unsigned)ring.session, (unsigned)writer.header.seq, (unsigned)written, (unsigned)writeErrors,
+                   (unsigned)records, (unsigned)droppedFrames, (unsigned)writer.header.used,
+                   (unsigned)(written ? writeSumUs / written : 0), (unsigned)writeMaxUs);
+  size_t n = w > 0 ? (size_t)w : 0;
+  return n < len ? n : len - 1;
+}
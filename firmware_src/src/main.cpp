@@ -2,13 +2,28 @@
 #include <Preferences.h>
 #include <BleKeyboard.h>
 #include "ota_portal.h"
+#include "adc_lut.h"
+#include "ble_midi.h"
+#include "boot_profile.h"
+#include "config_codec.h"
+#include "gesture.h"
+#include "hid_queue.h"
+#include "hid_task.h"
+#include "log_task.h"
+#include "metrics.h"
+#include "midi_codec.h"
+#include "pedal.h"
+#include "pedal_config.h"
+#include "pedal_hal.h"
+#include "sense_task.h"
+#include "tone_player.h"
 #include <WiFi.h>
 #include <esp_wifi.h>
-#include "esp_adc_cal.h"
 #include "esp_bt.h"
 #include "esp_bt_main.h"
 #include "esp_pm.h"
 #include "esp_task_wdt.h"
+#include "esp_system.h"
 
 // #define DEBUG
 
@@ -33,30 +48,11 @@
   并且将三个踏板作为开关触发其他功能
 **/
 
-// 参数持久化
+// 参数持久化：所有参数编码为 config 命名空间下的一个 blob（格式见 config_codec.h），开机时读取一次
 Preferences prefs;
-// DAC配置
-#define DAC_Sustain_PIN 25   // 延音踏板电压输出
-#define DAC_Sostenuto_PIN 26 // 持音踏板电压输出
-#define Switch_Soft_PIN 17   // 开关型踏板输出（因为只有俩DAC，所以还有一个踏板只能用开关了）
-
-// ADC配置
-#define ADC_Sustain_PIN 35   // ADC1_CH4 (GPIO32)延音踏板检测霍尔
-#define ADC_Sostenuto_PIN 32 // ADC1_CH5 (GPIO33)持音踏板检测霍尔
-#define ADC_Soft_PIN 33      // ADC1_CH7 (GPIO35)弱音踏板检测霍尔
-
-// 按钮配置（低电平有效）
-#define Sustain_BUTTON_PIN 27   // 延音踏板检测按钮
-#define Sostenuto_BUTTON_PIN 14 // 持音踏板检测按钮
-#define Soft_BUTTON_PIN 13      // 弱音踏板检测按钮
-
-// 功能按键绑定
-#define Calibrate_Button Sostenuto_BUTTON_PIN // 持音踏板按钮触发校准功能
-
-// 主循环延时
-#define Main_Loop_DelayMs 5
-
-const float Max_DAC_Voltage = 1.7f; // DAC输出的最大电压
+#define CONFIG_BLOB_KEY "cfg"
+// 已保存配置的内存副本；校准结果只在校准结束时更新，演奏中的漂移修正不写回
+static ConfigData config;
 
 // 蜂鸣器PWM配置
 #define BUZZER_PIN 16
@@ -64,13 +60,12 @@ const int PWM_CHANNEL = 0;    // LEDC通道0
 const int PWM_FREQ = 2000;    // 2KHz频率
 const int PWM_RESOLUTION = 8; // 8位分辨率 (0-255)
 
-// 霍尔范围校准参数
-int Sustain_Pedal_MIN;
-int Sustain_Pedal_MAX;
-int Sostenuto_Pedal_MIN;
-int Sostenuto_Pedal_MAX;
-int Soft_Pedal_MIN;
-int Soft_Pedal_MAX;
+// 提示音（非阻塞，见 tone_player.h）
+static const ToneNote otaMelody[] = {{1, 120}, {2, 120}, {3, 120}, {5, 120}, {6, 120}}; // Do Re Mi Sol La
+static const ToneNote bluetoothMelody[] = {{3, 120}, {5, 120}, {7, 120}}; // Mi Sol Si
+static const ToneNote calibStartMelody[] = {{1, 120}, {5, 120}}; // Do Sol
+static const ToneNote calibDoneMelody[] = {{5, 240}}; // Sol 长音
+static const ToneNote calibTimeoutMelody[] = {{5, 120}, {1, 120}}; // Sol Do
 
 // 校准功能相关参数
 bool InCalibration = false;
@@ -78,34 +73,44 @@ unsigned long calibrationStartMs = 0;
 const unsigned long calibrationTimeoutMs = 20000; // 20 秒超时
 bool calibrationCanceled = false;
 
-// 翻页功能踩下计时
-#define LongPressTimeMs 500
-
 // 蓝牙模式
-int Bluetooth_Mode; // 0:关闭 1:蓝牙MIDI 2:蓝牙键盘
+int Bluetooth_Mode = Bluetooth_Mode_Default; // 1:蓝牙MIDI 2:蓝牙键盘（Bluetooth_Active 为关闭时不生效）
 bool Bluetooth_Active = false;
 
 // 蓝牙键盘
 BleKeyboard bleKeyboard("翻页器", "Ning", 100);
 
-// ADC 校准结构
-static esp_adc_cal_characteristics_t adc_chars;
+// 蓝牙 MIDI：loop() 中收集变化的控制器，每次循环最多发送一个通知
+MidiCcTracker midiTracker;
+
+#if Midi_Uart_Enable
+// 有线 MIDI：独立的变化检测（与蓝牙 MIDI 的发送时机不同）与运行状态
+MidiCcTracker midiUartTracker;
+MidiSerialState midiUartState;
+#endif
 
-bool CheckButton(int pin);
 void SaveCalibration();
-void ReadCalibration();
+void SaveConfig();
+void ReadConfig();
+void ConfigFromGlobals(ConfigData &c);
+void ConfigToGlobals(const ConfigData &c);
+void SaveCurve(int pedal, const OutputCurve &c);
 void StartCalibration();
 void FinishCalibration();
-bool CheckButtonLong(int pin, unsigned long holdMs);
-int AdcRemap(int pin, int minV, int maxV, float deadZonePct = 0.05f);
-void BeepTone(int degree, int duration_ms);
-unsigned long GetPageturnerContinueTime(bool isDown);
-void ReadBluetoothActive();
 void SaveBluetoothActive();
 void ShutdownBluetooth();
+void ShutdownWiFi();
+void StartRunMode(bool portal);
+void HandlePedalFrame(const PedalFrame &frame);
+bool SendPageKey(uint8_t key);
+void SendMidiControllers();
+void SendMidiUart();
+void ReportSampleJitter();
 
 void setup()
 {
+  BootProfileBegin(esp_reset_reason());
+
   // 功耗优化：配置动态电源管理
   esp_pm_config_esp32_t pm_config = {
       .max_freq_mhz = 80,
@@ -117,12 +122,13 @@ void setup()
   // 启用看门狗定时器，防止系统卡死
   esp_task_wdt_init(30, true); // 30秒超时
   esp_task_wdt_add(NULL);
+  BootMark(BOOT_PM);
 
   DBG_BEGIN(115200);
 
-  // 读取配置
-  ReadCalibration();
-  ReadBluetoothActive();
+  // 读取配置（校准参数与蓝牙开关，只打开一次 NVS）
+  ReadConfig();
+  BootMark(BOOT_NVS);
 
   // 配置按钮引脚（启用内部上拉）
   pinMode(Sustain_BUTTON_PIN, INPUT_PULLUP);
@@ -137,21 +143,20 @@ void setup()
   ledcSetup(PWM_CHANNEL, PWM_FREQ, PWM_RESOLUTION);
   ledcAttachPin(BUZZER_PIN, PWM_CHANNEL);
   ledcWrite(PWM_CHANNEL, 0);
+  TonePlayerBegin(PWM_CHANNEL);
 
   // ADC初始化
-  analogSetPinAttenuation(ADC_Sustain_PIN, ADC_11db);
-  analogSetPinAttenuation(ADC_Sostenuto_PIN, ADC_11db);
-  analogSetPinAttenuation(ADC_Soft_PIN, ADC_11db);
-  analogSetWidth(12);
-  esp_adc_cal_characterize(ADC_UNIT_1, (adc_atten_t)ADC_11db, ADC_WIDTH_BIT_12, 1100, &adc_chars);
+  PedalBegin();
+  PedalApplyCalibration();
+  BootMark(BOOT_ADC);
 
   /**
   校准功能
   开机时踩住[持音踏板]，进入校准模式并蜂鸣(Do Sol)提示开始校准
-  将三个踏板分别踩到底和松开，记录最大最小值
+  将三个踏板分别踩到底和松开，以 0.5%/99.5% 分位数估计两端（偶发尖峰不影响），并按噪声自动确定死区
   踩住[持音踏板]2秒完成校准并保存，蜂鸣(Do长音)提示
   如果没有主动结束校准，则校准模式会在20秒后自动关闭，蜂鸣(Sol Do)提示，并且不保存本次校准结果
-  校准完成后自动重启
+  校准结束后参数立即生效，直接进入正常运行，无需重启
   **/
   if (digitalRead(Calibrate_Button) == LOW)
   {
@@ -159,32 +164,12 @@ void setup()
     return;
   }
 
+  // 开机功能选择只需各读一次踏板位置；先记下结果，提示音与无线初始化放到 DAC 开始输出之后
+  // （必须在采样任务启动前读取，AdcRemap 的滤波状态只能有一个使用者）
+
   // OTA更新功能
   // 开机时踩住[弱音踏板]，则启动 OTA 上传固件网页
-  int softValue = AdcRemap(ADC_Soft_PIN, Soft_Pedal_MIN, Soft_Pedal_MAX);
-  if (softValue > 127)
-  {
-    BeepTone(1, 120);
-    BeepTone(2, 120);
-    BeepTone(3, 120);
-    BeepTone(5, 120);
-    BeepTone(6, 120);
-    // 禁用蓝牙堆栈以避免 WiFi OTA 时与 BLE 冲突导致卡死
-    ShutdownBluetooth();
-    delay(100);
-    otaPortalBegin();
-  }
-  else
-  {
-    // 关闭WIFI节约功耗，保留 BLE
-    // 先断开并关闭 WiFi
-    WiFi.disconnect(true);
-    delay(50);
-    WiFi.mode(WIFI_OFF);
-    // 停止并反初始化底层 wifi 驱动（确保无线子系统彻底关闭）
-    esp_wifi_stop();
-    esp_wifi_deinit();
-  }
+  bool otaRequested = AdcRemap(ADC_Soft_PIN, Soft_Pedal_MIN, Soft_Pedal_MAX) > 127;
 
   /**
   蓝牙翻页功能（开启OTA模式时，需要关闭蓝牙，避免内存溢出死机）
@@ -192,28 +177,125 @@ void setup()
   使用平板或手机等设备连接名为[翻页器]的蓝牙设备
   短踩持音踏板下一页，长踩踏板上一页
   当连接蓝牙之后，踏板的持音功能将不可用，断开蓝牙后恢复正常
+  蓝牙模式为 MIDI（Bluetooth_Mode_Default）时改为名为[踏板MIDI]的 BLE-MIDI 设备，三个踏板以 CC64/66/67 连续输出，
+  DAC 输出不受影响
   **/
-  int sustainValue = AdcRemap(ADC_Sustain_PIN, Sustain_Pedal_MIN, Sustain_Pedal_MAX);
-  if (!otaPortalActive() && sustainValue > 127)
-  {
+  bool toggleBluetooth = !otaRequested && AdcRemap(ADC_Sustain_PIN, Sustain_Pedal_MIN, Sustain_Pedal_MAX) > 127;
+  if (toggleBluetooth)
     Bluetooth_Active = !Bluetooth_Active;
+
+  StartRunMode(otaRequested);
+  // 写闪存放在踏板开始输出之后
+  if (toggleBluetooth)
     SaveBluetoothActive();
-    if (Bluetooth_Active)
+
+  // 提示音
+  if (otaRequested)
+  {
+    TonePlay(otaMelody, TONE_COUNT(otaMelody));
+  }
+  else if (toggleBluetooth && Bluetooth_Active)
+  {
+    TonePlay(bluetoothMelody, TONE_COUNT(bluetoothMelody));
+  }
+  BootMark(BOOT_TONES);
+
+#ifdef DEBUG
+  {
+    uint32_t directCycles, lutCycles;
+    AdcLutBenchmark(4096, directCycles, lutCycles);
+    DBG_PRINTF("[ADC查表] 4096 次 raw→mV：esp_adc_cal %u 周期，查表 %u 周期\n", (unsigned)directCycles, (unsigned)lutCycles);
+  }
+  {
+    // 定点与浮点滤波的每次调用周期数：延音踏板校准范围内的往返扫动，叠加 ±4mV 的抖动
+    static int mv[1024];
+    static uint8_t outFixed[1024], outFloat[1024];
+    int span = Sustain_Pedal_MAX - Sustain_Pedal_MIN;
+    for (int i = 0; i < 1024; ++i)
     {
-      BeepTone(3, 120);
-      BeepTone(5, 120);
-      BeepTone(7, 120);
+      int phase = i < 512 ? i : 1023 - i;
+      mv[i] = Sustain_Pedal_MIN + span * phase / 511 + (i * 7) % 9 - 4;
     }
+    uint32_t fixedCycles, floatCycles;
+    PedalFilterBenchmark(mv, 1024, Sustain_Pedal_MIN, Sustain_Pedal_MAX, outFixed, outFloat, fixedCycles, floatCycles);
+    DBG_PRINTF("[滤波] 每次调用：定点 %u 周期，浮点 %u 周期\n", (unsigned)(fixedCycles / 1024), (unsigned)(floatCycles / 1024));
+  }
+#endif
+  BootMark(BOOT_READY);
+#ifdef DEBUG
+  {
+    static char bootText[512];
+    BootProfileFormat(bootText, sizeof(bootText));
+    DBG_PRINTF("[启动计时]\n%s", bootText);
+    const BootProfile &boot = BootProfileCurrent();
+    uint32_t firstDacUs = boot.us[BOOT_FIRST_DAC] ? boot.us[BOOT_FIRST_DAC] - boot.us[BOOT_SETUP] : 0;
+    if (firstDacUs > Boot_First_Dac_Budget_Ms * 1000UL)
+      DBG_PRINTF("[启动计时] setup → 第一次 DAC 输出 %uus，超出预算 %dms\n", (unsigned)firstDacUs, Boot_First_Dac_Budget_Ms);
+  }
+#endif
+}
+
+// 开机功能选择之后进入正常运行（校准结束时也从这里继续，不再重启）；portal 为 true 时启动 OTA 门户，否则关闭 WiFi
+// 采样任务只在这里启动：校准期间由 loop() 直接采样，不能与采样任务同时读 ADC
+void StartRunMode(bool portal)
+{
+  // 踏板输出优先：从这里开始延音/持音 DAC 就跟随踏板，之后的无线初始化都不会阻塞它
+#if Sense_Task_Enable
+  // 采样 → 滤波 → DAC 输出交给独立任务，loop() 只处理网页与蓝牙
+  SenseTaskBegin(Sense_Rate_Hz);
+  BootMark(BOOT_SENSE);
+#else
+  PedalFrame frame;
+  PedalSample(frame);
+  PedalOutput(frame, true);
+#endif
+
+  if (portal)
+  {
+    // 禁用蓝牙堆栈以避免 WiFi OTA 时与 BLE 冲突导致卡死
+    ShutdownBluetooth();
+    delay(100);
+    otaPortalSetCurveSave(SaveCurve);
+    otaPortalBegin();
+  }
+  else
+  {
+    // 关闭WIFI节约功耗，保留 BLE
+    ShutdownWiFi();
   }
+  BootMark(BOOT_RADIO);
 
-  if (!otaPortalActive() && Bluetooth_Active)
+  if (!otaPortalActive() && Bluetooth_Active && Bluetooth_Mode == BLUETOOTH_MIDI)
+  {
+    MidiCcReset(midiTracker);
+    BleMidiBegin("踏板MIDI");
+  }
+  else if (!otaPortalActive() && Bluetooth_Active)
   {
     bleKeyboard.begin();
+    // 翻页按键由独立任务发送，loop() 只负责入队
+    HidTaskBegin(SendPageKey);
   }
   else
   {
     ShutdownBluetooth();
   }
+  BootMark(BOOT_BLE);
+
+#if Midi_Uart_Enable
+  // 有线 MIDI：写入 TX 环形缓冲后立即返回，由 UART 中断搬入硬件 FIFO，loop() 不等待发送完成
+  MidiCcReset(midiUartTracker);
+  MidiSerialReset(midiUartState);
+  Serial2.setTxBufferSize(256);
+  Serial2.begin(MIDI_UART_BAUD, SERIAL_8N1, -1, Midi_Uart_TX_PIN);
+#endif
+
+#if Sample_Log_Enable
+  // 采样记录：loop() 只编码，扫描分区与擦写都在记录任务中进行；
+  // 擦写期间采样会停顿，只在门户模式（调试、下载记录）下记录，演奏时不写闪存
+  if (otaPortalActive())
+    LogTaskBegin();
+#endif
 }
 
 void loop()
@@ -222,29 +304,12 @@ void loop()
   esp_task_wdt_reset();
 
   unsigned long loopStartMs = millis();
+  uint32_t loopStartUs = micros();
 
   // 校准模式
   if (InCalibration)
   {
-    int susVoltage = esp_adc_cal_raw_to_voltage(analogRead(ADC_Sustain_PIN), &adc_chars);
-    int sosVoltage = esp_adc_cal_raw_to_voltage(analogRead(ADC_Sostenuto_PIN), &adc_chars);
-    int sofVoltage = esp_adc_cal_raw_to_voltage(analogRead(ADC_Soft_PIN), &adc_chars);
-
-    // 更新 min/max
-    if (susVoltage < Sustain_Pedal_MIN)
-      Sustain_Pedal_MIN = susVoltage;
-    if (susVoltage > Sustain_Pedal_MAX)
-      Sustain_Pedal_MAX = susVoltage;
-
-    if (sosVoltage < Sostenuto_Pedal_MIN)
-      Sostenuto_Pedal_MIN = sosVoltage;
-    if (sosVoltage > Sostenuto_Pedal_MAX)
-      Sostenuto_Pedal_MAX = sosVoltage;
-
-    if (sofVoltage < Soft_Pedal_MIN)
-      Soft_Pedal_MIN = sofVoltage;
-    if (sofVoltage > Soft_Pedal_MAX)
-      Soft_Pedal_MAX = sofVoltage;
+    CalibrationSample();
 
     // 检查是否超时
     if (calibrationStartMs != 0 && (millis() - calibrationStartMs >= calibrationTimeoutMs))
@@ -252,23 +317,15 @@ void loop()
       // 超时：取消本次校准，恢复上次保存的参数
       InCalibration = false;
       calibrationCanceled = true;
-      // 重新读取配置
-      prefs.begin("config");
-      Sustain_Pedal_MIN = prefs.getUInt("sustainmin", 3300);
-      Sustain_Pedal_MAX = prefs.getUInt("sustainmax", 0);
-      Sostenuto_Pedal_MIN = prefs.getUInt("sostenutomin", 3300);
-      Sostenuto_Pedal_MAX = prefs.getUInt("sostenutomax", 0);
-      Soft_Pedal_MIN = prefs.getUInt("softmin", 3300);
-      Soft_Pedal_MAX = prefs.getUInt("softmax", 0);
-      prefs.end();
+      // 恢复开机时读取的配置（无需再访问 NVS）
+      ConfigToGlobals(config);
       DBG_PRINTLN("校准超时：已取消本次校准并恢复上次参数");
       DBG_PRINTF("[重新读取配置] Sustain MIN=%dmV MAX=%dmV | Sostenuto MIN=%dmV MAX=%dmV | Soft MIN=%dmV MAX=%dmV\n",
                  Sustain_Pedal_MIN, Sustain_Pedal_MAX, Sostenuto_Pedal_MIN, Sostenuto_Pedal_MAX, Soft_Pedal_MIN, Soft_Pedal_MAX);
       // 给出蜂鸣提示
-      BeepTone(5, 120);
-      BeepTone(1, 120);
-      // 清空起始时间
-      calibrationStartMs = 0;
+      TonePlay(calibTimeoutMelody, TONE_COUNT(calibTimeoutMelody));
+      FinishCalibration();
+      return;
     }
 
     // 长按3秒完成校准
@@ -282,116 +339,324 @@ void loop()
   // OTA更新处理
   if (otaPortalActive())
   {
+    uint32_t t0 = ESP.getCycleCount();
     otaPortalHandle();
+    MetricsStage(METRIC_PORTAL, ESP.getCycleCount() - t0);
     // return;
   }
 
-  // 读取踏板数值 0 - 255
-  int sustainValue = AdcRemap(ADC_Sustain_PIN, Sustain_Pedal_MIN, Sustain_Pedal_MAX);
-  int sostenutoValue = AdcRemap(ADC_Sostenuto_PIN, Sostenuto_Pedal_MIN, Sostenuto_Pedal_MAX);
-  int softValue = AdcRemap(ADC_Soft_PIN, Soft_Pedal_MIN, Soft_Pedal_MAX);
+#if Sense_Task_Enable
+  // 如果连接蓝牙翻页，就不再输出持音踏板信号
+  SenseTaskSetSostenutoEnabled(!bleKeyboard.isConnected());
 
-  // 输出延音信号
-  dacWrite(DAC_Sustain_PIN, (uint8_t)(sustainValue * Max_DAC_Voltage / 3.3));
+  // 处理采样任务送来的所有帧
+  PedalFrame frame;
+  while (SenseTaskPop(frame))
+  {
+    HandlePedalFrame(frame);
+  }
+  SendMidiControllers();
+  SendMidiUart();
+#else
+  // 读取踏板数值 0 - 255
+  PedalFrame frame;
+  PedalSample(frame);
 
-  // 输出持音信号
+  // 输出延音/持音/弱音信号
   // 如果连接蓝牙翻页，就不再输出持音踏板信号
-  if (!bleKeyboard.isConnected())
-    dacWrite(DAC_Sostenuto_PIN, (uint8_t)(sostenutoValue * Max_DAC_Voltage / 3.3));
+  PedalOutput(frame, !bleKeyboard.isConnected());
+
+  HandlePedalFrame(frame);
+  SendMidiControllers();
+  SendMidiUart();
+#endif
+  // 漂移跟踪移动了端点时在这里重建映射查表，不占用采样周期
+  PedalMaintain();
 
-  // 输出弱音开关信号
-  // 控制 Switch_Soft: 若 Soft_BUTTON 按下则高电平，否则低
-  digitalWrite(Switch_Soft_PIN, softValue > 127 ? HIGH : LOW);
+  ReportSampleJitter();
 
-  // 翻页功能
-  if (bleKeyboard.isConnected())
+  unsigned long loopMs = millis() - loopStartMs;
+  MetricsLoop(micros() - loopStartUs, Main_Loop_DelayMs * 1000);
+  // DBG_PRINTF("[状态] 延音输入:%03d | 持音输入:%03d | 弱音输入:%03d | 开销:%dms\n", frame.value[PEDAL_SUSTAIN], frame.value[PEDAL_SOSTENUTO], frame.value[PEDAL_SOFT], loopMs);
+  // 踏板全部静止、采样任务降频时 loop() 也放慢（门户开启时不放慢，网页需要及时响应），踏板一动即被唤醒
+  unsigned long loopDelayMs = SenseTaskIdle() && !otaPortalActive() ? Main_Loop_Idle_DelayMs : Main_Loop_DelayMs;
+  if (loopMs < loopDelayMs)
+  {
+    SenseTaskWait(loopDelayMs - loopMs);
+  }
+  else
   {
-    bool pageTurnerDown = false;
-    if (sostenutoValue > 100)
-      pageTurnerDown = true;
-    else if (sostenutoValue < 90)
-      pageTurnerDown = false;
+    delay(0);
+  }
+}
 
-    unsigned long downTime = GetPageturnerContinueTime(pageTurnerDown);
+// 处理一帧踏板数据：网页状态、采样记录与蓝牙翻页
+void HandlePedalFrame(const PedalFrame &frame)
+{
+  int sostenutoValue = frame.value[PEDAL_SOSTENUTO];
 
-    if (downTime == LongPressTimeMs)
-    {
-      bleKeyboard.write(KEY_PAGE_UP);
-      // DBG_PRINTF("[状态] 踩下时间%d\n", downTime);
-    }
-    else if (downTime > 0 && downTime < LongPressTimeMs)
-    {
-      bleKeyboard.write(KEY_PAGE_DOWN);
-      // DBG_PRINTF("[状态] 踩下时间%d\n", downTime);
-    }
+  // 更新网页上的踏板实时数据
+  if (otaPortalActive())
+  {
+    otaPortalSetPedalFrame(frame);
   }
 
-  unsigned long loopMs = millis() - loopStartMs;
-  // DBG_PRINTF("[状态] 延音输入:%03d | 持音输入:%03d | 弱音输入:%03d | 开销:%dms\n", sustainValue, sostenutoValue, softValue, loopMs);
-  if (loopMs < Main_Loop_DelayMs)
+#if Sample_Log_Enable
+  LogTaskRecord(frame);
+#endif
+
+  // 蓝牙 MIDI：只记录变化，本次循环的所有帧处理完后统一发送
+  if (Bluetooth_Active && Bluetooth_Mode == BLUETOOTH_MIDI)
   {
-    delay(Main_Loop_DelayMs - loopMs);
+    MidiCcUpdate(midiTracker, frame);
   }
-  else
+
+#if Midi_Uart_Enable
+  MidiCcUpdate(midiUartTracker, frame);
+#endif
+
+  // 翻页功能：手势在蓝牙未连接时也持续更新，连接瞬间不会把正踩着的踏板误判为一次踩下
+  static Gesture pageGesture = {GESTURE_IDLE, false, 0};
+  static const GestureConfig pageConfig = {Page_Press_Level, Page_Release_Level, LongPressTimeMs, 0,
+                                           Page_Repeat_Delay_Ms, Page_Repeat_Ms};
+  uint8_t events = GestureUpdate(pageGesture, pageConfig, sostenutoValue, millis());
+  PageKey keys[GESTURE_PAGE_KEYS_MAX];
+  int n = GesturePageKeys(events, Page_Turn_Eager, keys);
+  if (n > 0 && bleKeyboard.isConnected())
   {
-    delay(0);
+    // 同一帧内的多个按键是有意连续发送的（撤销 + 上一页），不参与抖动合并
+    for (int i = 0; i < n; ++i)
+      HidTaskPush(keys[i] == PAGE_NEXT ? KEY_PAGE_DOWN : KEY_PAGE_UP, i == 0);
   }
 }
 
-// 带防抖的按钮检测函数
-bool CheckButton(int pin)
+// HID 发送任务中调用：协议栈拥塞时在这里等待，不影响 loop()
+bool SendPageKey(uint8_t key)
 {
-  if (digitalRead(pin) == LOW)
+  if (!bleKeyboard.isConnected())
+    return false;
+  bleKeyboard.write(key);
+  return true;
+}
+
+// 把本次循环中变化过的控制器打包成一个 BLE-MIDI 通知（每个控制器只发最新值，带各自的变化时刻）
+void SendMidiControllers()
+{
+  if (!Bluetooth_Active || Bluetooth_Mode != BLUETOOTH_MIDI)
+    return;
+  if (!BleMidiConnected())
   {
-    delay(10);
-    if (digitalRead(pin) == LOW)
+    // 未连接时不积累；连接后第一批发送全部当前值，DAW 立即得到踏板状态
+    MidiCcReset(midiTracker);
+    return;
+  }
+  MidiCc cc[PEDAL_COUNT];
+  int n = MidiCcTake(midiTracker, cc);
+  if (n == 0)
+    return;
+
+  uint32_t t0 = ESP.getCycleCount();
+  BleMidiPacket packet;
+  BleMidiPacketBegin(packet, BleMidiPayloadMax());
+  for (int i = 0; i < n; ++i)
+  {
+    if (!BleMidiPacketAddCc(packet, Midi_Channel, cc[i].cc, cc[i].value, cc[i].timeMs))
     {
-      return true;
+      // 三条消息最多 11 字节，只有 MTU 异常小或时间跨度超过 127ms 时才会分包
+      BleMidiSend(packet.buf, packet.len);
+      BleMidiPacketBegin(packet, BleMidiPayloadMax());
+      BleMidiPacketAddCc(packet, Midi_Channel, cc[i].cc, cc[i].value, cc[i].timeMs);
     }
   }
-  return false;
+  BleMidiSend(packet.buf, packet.len);
+  MetricsStage(METRIC_MIDI, ESP.getCycleCount() - t0);
 }
 
-void SaveCalibration()
+// 有线 MIDI：限速后把变化过的控制器以运行状态写入串口（每条 2 字节）
+void SendMidiUart()
+{
+#if Midi_Uart_Enable
+  static unsigned long lastSendMs = 0;
+  if (millis() - lastSendMs < Midi_Uart_Interval_Ms)
+    return;
+  // 环形缓冲放不下一整批时先不取出，变化保留到下次（只取最新值，不会越积越多）
+  if (Serial2.availableForWrite() < MIDI_SERIAL_BATCH_MAX)
+    return;
+  MidiCc cc[PEDAL_COUNT];
+  int n = MidiCcTake(midiUartTracker, cc);
+  if (n == 0)
+    return;
+  uint8_t buf[MIDI_SERIAL_BATCH_MAX];
+  size_t len = MidiSerialEncode(midiUartState, Midi_Channel, cc, n, millis(), buf, sizeof(buf));
+  Serial2.write(buf, len);
+  lastSendMs = millis();
+#endif
+}
+
+// 每 2 秒输出一次采样周期抖动、采样频率调节与翻页发送队列统计（自启动以来累计；对比采样任务与 loop() 内采样，开启 OTA 门户时差异最明显）
+// 完整统计见网页门户的 /metrics
+void ReportSampleJitter()
+{
+  static unsigned long lastReportMs = 0;
+  if (millis() - lastReportMs < 2000)
+    return;
+  lastReportMs = millis();
+
+  MetricsSnapshot m;
+  MetricsRead(m);
+  const JitterStats &stats = m.jitter;
+  DBG_PRINTF("[采样抖动] %s 门户:%d | 周期 平均:%.1fus 最小:%uus 最大:%uus RMS:%.1fus | 样本:%u\n",
+             Sense_Task_Enable ? "采样任务" : "loop()", otaPortalActive(), JitterStatsMeanUs(stats),
+             (unsigned)stats.minUs, (unsigned)stats.maxUs, JitterStatsRmsUs(stats), (unsigned)stats.count);
+  (void)stats;
+
+#ifdef DEBUG
+  // 采样频率调节：全速/低频时间、唤醒次数与唤醒延迟
+  {
+    static char governorText[256];
+    GovernorStats g;
+    SenseTaskGovernorStats(g);
+    GovernorFormat(governorText, sizeof(governorText), g, Sense_Rate_Hz);
+    DBG_PRINTF("[采样调节]\n%s", governorText);
+  }
+
+  // 翻页发送队列（蓝牙开启时门户不可用，只能从串口查看）：计数与入队 → 发出的延迟
+  if (Bluetooth_Active)
+  {
+    static char hidText[256];
+    HidQueueFormat(hidText, sizeof(hidText));
+    DBG_PRINTF("[翻页队列]\n%s", hidText);
+  }
+#endif
+}
+
+// 全局参数 → 配置副本（校准部分）
+void ConfigFromGlobals(ConfigData &c)
+{
+  c.minV[PEDAL_SUSTAIN] = Sustain_Pedal_MIN;
+  c.maxV[PEDAL_SUSTAIN] = Sustain_Pedal_MAX;
+  c.deadZone[PEDAL_SUSTAIN] = Sustain_Pedal_DEADZONE;
+  c.minV[PEDAL_SOSTENUTO] = Sostenuto_Pedal_MIN;
+  c.maxV[PEDAL_SOSTENUTO] = Sostenuto_Pedal_MAX;
+  c.deadZone[PEDAL_SOSTENUTO] = Sostenuto_Pedal_DEADZONE;
+  c.minV[PEDAL_SOFT] = Soft_Pedal_MIN;
+  c.maxV[PEDAL_SOFT] = Soft_Pedal_MAX;
+  c.deadZone[PEDAL_SOFT] = Soft_Pedal_DEADZONE;
+}
+
+void ConfigToGlobals(const ConfigData &c)
+{
+  Sustain_Pedal_MIN = c.minV[PEDAL_SUSTAIN];
+  Sustain_Pedal_MAX = c.maxV[PEDAL_SUSTAIN];
+  Sustain_Pedal_DEADZONE = c.deadZone[PEDAL_SUSTAIN];
+  Sostenuto_Pedal_MIN = c.minV[PEDAL_SOSTENUTO];
+  Sostenuto_Pedal_MAX = c.maxV[PEDAL_SOSTENUTO];
+  Sostenuto_Pedal_DEADZONE = c.deadZone[PEDAL_SOSTENUTO];
+  Soft_Pedal_MIN = c.minV[PEDAL_SOFT];
+  Soft_Pedal_MAX = c.maxV[PEDAL_SOFT];
+  Soft_Pedal_DEADZONE = c.deadZone[PEDAL_SOFT];
+  Bluetooth_Active = c.bluetoothActive;
+  // 输出曲线编译为查表后立即生效
+  for (int i = 0; i < PEDAL_COUNT; ++i)
+    PedalSetCurve(i, c.curve[i]);
+}
+
+// 旧的逐键布局读取（迁移用）：按实际存储类型读取，兼容 putInt / putUInt / putBool 写入的键
+static bool PrefsLegacyRead(void *ctx, const char *key, int32_t &value)
+{
+  Preferences &p = *(Preferences *)ctx;
+  switch (p.getType(key))
+  {
+  case PT_I32:
+    value = p.getInt(key);
+    return true;
+  case PT_U32:
+    value = (int32_t)p.getUInt(key);
+    return true;
+  case PT_U8:
+    value = p.getUChar(key);
+    return true;
+  default:
+    return false;
+  }
+}
+
+// 写入配置块（prefs 已打开）；与已存内容相同时不写，减少闪存擦写
+static bool PutConfigBlob(const ConfigData &c)
+{
+  uint8_t blob[CONFIG_BLOB_MAX];
+  uint8_t stored[CONFIG_BLOB_MAX];
+  size_t n = ConfigEncode(c, blob, sizeof(blob));
+  if (prefs.getType(CONFIG_BLOB_KEY) == PT_BLOB && prefs.getBytesLength(CONFIG_BLOB_KEY) == n &&
+      prefs.getBytes(CONFIG_BLOB_KEY, stored, sizeof(stored)) == n && memcmp(blob, stored, n) == 0)
+    return true;
+  // 单个 blob 一次写入，NVS 先写新条目再擦除旧条目，掉电不会留下写了一半的校准参数
+  return prefs.putBytes(CONFIG_BLOB_KEY, blob, n) == n;
+}
+
+void SaveConfig()
 {
   prefs.begin("config", false);
-  prefs.putInt("sustainmin", Sustain_Pedal_MIN);
-  prefs.putInt("sustainmax", Sustain_Pedal_MAX);
-  prefs.putInt("sostenutomin", Sostenuto_Pedal_MIN);
-  prefs.putInt("sostenutomax", Sostenuto_Pedal_MAX);
-  prefs.putInt("softmin", Soft_Pedal_MIN);
-  prefs.putInt("softmax", Soft_Pedal_MAX);
+  bool ok = PutConfigBlob(config);
   prefs.end();
+  DBG_PRINTF("[保存参数] %s\n", ok ? "完成" : "失败");
+  (void)ok;
+}
+
+void SaveCalibration()
+{
+  ConfigFromGlobals(config);
+  SaveConfig();
   DBG_PRINTF("[保存参数] Sustain MIN=%dmV MAX=%dmV | Sostenuto MIN=%dmV MAX=%dmV | Soft MIN=%dmV MAX=%dmV\n",
              Sustain_Pedal_MIN, Sustain_Pedal_MAX, Sostenuto_Pedal_MIN, Sostenuto_Pedal_MAX, Soft_Pedal_MIN, Soft_Pedal_MAX);
+  DBG_PRINTF("[保存参数] 死区 Sustain=%dmV Sostenuto=%dmV Soft=%dmV\n",
+             Sustain_Pedal_DEADZONE, Sostenuto_Pedal_DEADZONE, Soft_Pedal_DEADZONE);
 }
 
-void ReadCalibration()
+void ReadConfig()
 {
+  uint8_t blob[CONFIG_BLOB_MAX];
   prefs.begin("config", false);
-  Sustain_Pedal_MIN = prefs.getInt("sustainmin", 5000);
-  Sustain_Pedal_MAX = prefs.getInt("sustainmax", 0);
-  Sostenuto_Pedal_MIN = prefs.getInt("sostenutomin", 5000);
-  Sostenuto_Pedal_MAX = prefs.getInt("sostenutomax", 0);
-  Soft_Pedal_MIN = prefs.getInt("softmin", 5000);
-  Soft_Pedal_MAX = prefs.getInt("softmax", 0);
+  size_t n = prefs.getType(CONFIG_BLOB_KEY) == PT_BLOB ? prefs.getBytes(CONFIG_BLOB_KEY, blob, sizeof(blob)) : 0;
+  ConfigStatus status = ConfigDecode(blob, n, config);
+  if (status != CONFIG_OK && ConfigMigrateLegacy(config, PrefsLegacyRead, &prefs))
+  {
+    // 旧固件的逐键布局：转换为配置块，写入成功后才删除旧键
+    if (PutConfigBlob(config))
+    {
+      for (int i = 0; i < CONFIG_LEGACY_KEY_COUNT; ++i)
+        prefs.remove(configLegacyKeys[i]);
+    }
+    DBG_PRINTLN("[读取参数] 已从逐键布局迁移");
+  }
   prefs.end();
+  ConfigToGlobals(config);
+  DBG_PRINTF("[读取参数] 配置块 %s\n", ConfigStatusName(status));
   DBG_PRINTF("[读取参数] Sustain MIN=%dmV MAX=%dmV | Sostenuto MIN=%dmV MAX=%dmV | Soft MIN=%dmV MAX=%dmV\n",
              Sustain_Pedal_MIN, Sustain_Pedal_MAX, Sostenuto_Pedal_MIN, Sostenuto_Pedal_MAX, Soft_Pedal_MIN, Soft_Pedal_MAX);
 }
 
+// 网页门户修改输出曲线（已生效）：写入配置块
+void SaveCurve(int pedal, const OutputCurve &c)
+{
+  config.curve[pedal] = c;
+  SaveConfig();
+}
+
 void SaveBluetoothActive()
 {
-  prefs.begin("config", false);
-  prefs.putBool("blactive", Bluetooth_Active);
-  prefs.end();
+  config.bluetoothActive = Bluetooth_Active;
+  SaveConfig();
 }
 
-void ReadBluetoothActive()
+// 关闭 WiFi：先断开并关闭，再停止并反初始化底层驱动（确保无线子系统彻底关闭）
+void ShutdownWiFi()
 {
-  prefs.begin("config", false);
-  Bluetooth_Active = prefs.getBool("blactive", false);
-  prefs.end();
+  WiFi.disconnect(true);
+  delay(50);
+  WiFi.mode(WIFI_OFF);
+  esp_wifi_stop();
+  esp_wifi_deinit();
 }
 
 // 统一的蓝牙关闭函数
@@ -411,16 +676,9 @@ void StartCalibration()
   calibrationCanceled = false;
   calibrationStartMs = millis();
   // 初始化 min/max 确保后续采样能正确更新范围
-  // ADC 电压单位为 mV，设置初始 min 为较大值，max 为 0
-  Sustain_Pedal_MIN = 5000;
-  Sustain_Pedal_MAX = 0;
-  Sostenuto_Pedal_MIN = 5000;
-  Sostenuto_Pedal_MAX = 0;
-  Soft_Pedal_MIN = 5000;
-  Soft_Pedal_MAX = 0;
-  // 蜂鸣提示
-  BeepTone(1, 120);
-  BeepTone(5, 120);
+  CalibrationReset();
+  // 蜂鸣提示（不阻塞，校准采样立即开始）
+  TonePlay(calibStartMelody, TONE_COUNT(calibStartMelody));
 }
 
 // 完成校准
@@ -432,177 +690,17 @@ void FinishCalibration()
   {
     SaveCalibration();
     // 蜂鸣提示
-    BeepTone(5, 240);
-    DBG_PRINTLN("校准完成，3秒后自动重启...");
+    TonePlay(calibDoneMelody, TONE_COUNT(calibDoneMelody));
+    DBG_PRINTLN("校准完成，参数已生效");
   }
   else
   {
-    DBG_PRINTLN("校准已被取消，未保存本次参数，3秒后自动重启...");
+    DBG_PRINTLN("校准已被取消，未保存本次参数，继续使用上次参数");
   }
   calibrationStartMs = 0;
   calibrationCanceled = false;
 
-  delay(3000);
-  ESP.restart();
-}
-
-// 检测长按
-bool CheckButtonLong(int pin, unsigned long holdMs)
-{
-  // 优化：只使用实际使用的引脚索引
-  static unsigned long pinStartTimes[3] = {0};
-  int idx = (pin == Sustain_BUTTON_PIN) ? 0 : (pin == Sostenuto_BUTTON_PIN) ? 1
-                                                                            : 2;
-  if (digitalRead(pin) == LOW)
-  {
-    if (pinStartTimes[idx] == 0)
-      pinStartTimes[idx] = millis();
-    else if (millis() - pinStartTimes[idx] >= holdMs)
-    {
-      // 一次性触发：重置时间戳，等待松开再可触发下一次
-      pinStartTimes[idx] = 0;
-      return true;
-    }
-  }
-  else
-  {
-    pinStartTimes[idx] = 0;
-  }
-  return false;
-}
-
-unsigned long GetPageturnerContinueTime(bool isDown)
-{
-  static unsigned long downStartMs = 0;
-  static bool downing = false;
-  static bool checked = false;
-
-  if (isDown && !downing)
-  {
-    downStartMs = millis();
-    downing = true;
-    checked = false;
-  }
-
-  if (!isDown && downing)
-  {
-    downing = false;
-    if (!checked)
-      return millis() - downStartMs;
-  }
-
-  if ((millis() - downStartMs) >= LongPressTimeMs && downing && !checked)
-  {
-    checked = true;
-    return LongPressTimeMs;
-  }
-
-  return 0;
-}
-
-// 将 ADC（基于校准范围）映射到 0 -255
-int AdcRemap(int pin, int minV, int maxV, float deadZonePct)
-{
-  // 快速多次采样，降低量化与瞬时噪声（低延迟：无额外delay）
-  int raw0 = analogRead(pin);
-  int raw1 = analogRead(pin);
-  int raw2 = analogRead(pin);
-  int adcValue = (raw0 + raw1 + raw2) / 3;
-  int adcVoltage = esp_adc_cal_raw_to_voltage(adcValue, &adc_chars);
-  if (maxV <= minV)
-    return 0;
-
-  // 应用死区 (deadZonePct 例如 0.05 表示 5%)
-  float dz = constrain(deadZonePct, 0.0f, 0.45f); // 防止死区重叠
-
-  int reminV = minV + (maxV - minV) * dz;
-  int remaxV = maxV - (maxV - minV) * dz;
-  int adcVol = constrain(adcVoltage, reminV, remaxV);
-  // 计算百分比
-  float pct = (float)(adcVol - reminV) / (float)(remaxV - reminV);
-  int valueRaw = 255 * pct;
-
-  // 低延迟平滑与消抖：自适应EMA + 步进限幅 + 微抖动死区
-  // 优化：只使用3个踏板对应的索引，减少内存占用
-  int idx = (pin == ADC_Sustain_PIN) ? 0 : (pin == ADC_Sostenuto_PIN) ? 1
-                                                                      : 2;
-  static bool s_inited[3] = {false};
-  static float s_ema[3] = {0};
-  static int s_lastOut[3] = {0};
-
-  if (!s_inited[idx])
-  {
-    s_inited[idx] = true;
-    s_ema[idx] = (float)valueRaw;
-    s_lastOut[idx] = valueRaw;
-  }
-  else
-  {
-    float delta = (float)valueRaw - s_ema[idx];
-    float alpha = (abs((int)delta) > 15) ? 0.7f : 0.2f; // 大幅变化快速跟随，小抖动更稳
-    s_ema[idx] = s_ema[idx] + alpha * delta;
-
-    int emaInt = (int)(s_ema[idx] + (s_ema[idx] >= 0 ? 0.5f : -0.5f));
-
-    // 微抖动死区：差值≤1 不更新，避免1级跳动
-    if (abs(emaInt - s_lastOut[idx]) <= 1)
-    {
-      // 保持上次输出
-    }
-    else
-    {
-      // 限制单次步进，避免过快跳变但保持低延迟响应
-      const int maxStep = 12; // 0..255 空间下单次最大变化
-      int step = emaInt - s_lastOut[idx];
-      if (step > maxStep)
-        step = maxStep;
-      else if (step < -maxStep)
-        step = -maxStep;
-      s_lastOut[idx] = s_lastOut[idx] + step;
-    }
-  }
-
-  int value = constrain(s_lastOut[idx], 0, 255);
-  // if (pin == ADC_Sostenuto_PIN)
-  //   DBG_PRINTF("[状态] adc%d | 电压:%d | 死区:%f | 范围:%d-%d | 重设电压:%d | 百分比:%f | 映射:%d\n", adcValue, adcVoltage, value, dz, reminV, remaxV, adcVol, pct);
-
-  // 更新网页上的踏板实时数据
-  if (otaPortalActive())
-  {
-    // 传递：index, mv, min, max, mapped
-    if (pin == ADC_Sustain_PIN)
-    {
-      otaPortalSetPedalStatus(2, adcVoltage, minV, maxV, value);
-    }
-    else if (pin == ADC_Sostenuto_PIN)
-    {
-      otaPortalSetPedalStatus(1, adcVoltage, minV, maxV, value);
-    }
-    else if (pin == ADC_Soft_PIN)
-    {
-      otaPortalSetPedalStatus(0, adcVoltage, minV, maxV, value);
-    }
-  }
-
-  return value;
-}
-
-// 蜂鸣器音调控制：degree 1-7 对应 C 大调音阶（C D E F G A B）
-// duration_ms 为持续时间（毫秒），若 duration_ms<=0 则持续播放直到再次调用停止
-void BeepTone(int degree, int duration_ms)
-{
-  // 基础音阶（C4..B4）频率，单位 Hz
-  const uint16_t freqs[7] = {262, 294, 330, 349, 392, 440, 494};
-  if (degree < 1 || degree > 7)
-    return;
-
-  uint16_t freq = freqs[degree - 1];
-  // 使用 ledcWriteTone 产生指定频率
-  ledcWriteTone(PWM_CHANNEL, freq);
-  if (duration_ms > 0)
-  {
-    delay(duration_ms);
-    // 停止蜂鸣
-    ledcWrite(PWM_CHANNEL, 0);
-  }
+  // 新参数直接交给采样流水线，进入正常运行
+  PedalApplyCalibration();
+  StartRunMode(false);
 }
\ No newline at end of file
@@ -0,0 +1,154 @@
+// metrics.cpp
+#include <atomic>
+#include <stdio.h>
+#include <string.h>
+#include "metrics.h"
+
+const uint32_t metricLatencyBoundsUs[METRIC_LATENCY_BUCKETS - 1] = {50, 100, 200, 500, 1000, 2000, 5000};
+
+static MetricsSnapshot metrics;
+// 奇数表示正在写入；采样路径、loop() 与 HID 发送任务各用一个序号
+static std::atomic<uint32_t> sampleSeq{0};
+static std::atomic<uint32_t> loopSeq{0};
+static std::atomic<uint32_t> hidSeq{0};
+
+static inline std::atomic<uint32_t> &SeqOf(MetricStage stage)
+{
+  switch (stage)
+  {
+  case METRIC_PORTAL:
+  case METRIC_MIDI:
+    return loopSeq;
+  case METRIC_HID:
+    return hidSeq;
+  default:
+    return sampleSeq;
+  }
+}
+
+static inline void WriteBegin(std::atomic<uint32_t> &seq)
+{
+  seq.store(seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+}
+
+static inline void WriteEnd(std::atomic<uint32_t> &seq)
+{
+  seq.store(seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void MetricsStage(MetricStage stage, uint32_t cycles)
+{
+  std::atomic<uint32_t> &seq = SeqOf(stage);
+  WriteBegin(seq);
+  MetricStageStats &s = metrics.stage[stage];
+  s.count++;
+  s.totalCycles += cycles;
+  if (cycles > s.maxCycles)
+    s.maxCycles = cycles;
+  WriteEnd(seq);
+}
+
+void MetricsSampleStart(uint32_t nowUs)
+{
+  WriteBegin(sampleSeq);
+  if (metrics.jitter.count == 0 && metrics.jitter.lastUs == 0)
+    JitterStatsReset(metrics.jitter);
+  JitterStatsMark(metrics.jitter, nowUs);
+  WriteEnd(sampleSeq);
+}
+
+void MetricsSampleSkip()
+{
+  WriteBegin(sampleSeq);
+  metrics.jitter.lastUs = 0;
+  WriteEnd(sampleSeq);
+}
+
+void MetricsLatency(uint32_t us)
+{
+  int bucket = 0;
+  while (bucket < METRIC_LATENCY_BUCKETS - 1 && us >= metricLatencyBoundsUs[bucket])
+    bucket++;
+  WriteBegin(sampleSeq);
+  metrics.latency[bucket]++;
+  if (us > metrics.latencyMaxUs)
+    metrics.latencyMaxUs = us;
+  WriteEnd(sampleSeq);
+}
+
+void MetricsLoop(uint32_t loopUs, uint32_t budgetUs)
+{
+  WriteBegin(loopSeq);
+  metrics.loops++;
+  if (loopUs > budgetUs)
+  {
+    metrics.loopMisses++;
+    if (loopUs - budgetUs > metrics.loopOverrunMaxUs)
+      metrics.loopOverrunMaxUs = loopUs - budgetUs;
+  }
+  WriteEnd(loopSeq);
+}
+
+void MetricsRead(MetricsSnapshot &out)
+{
+  // 各组统计都未在写入中、且复制前后序号不变时快照才一致；
+  // 写入方优先级不高于读取方时可能一直读不到一致快照，因此限制重试次数
+  for (int retry = 0; retry < 100; ++retry)
+  {
+    uint32_t s1 = sampleSeq.load(std::memory_order_acquire);
+    uint32_t l1 = loopSeq.load(std::memory_order_acquire);
+    uint32_t h1 = hidSeq.load(std::memory_order_acquire);
+    memcpy(&out, &metrics, sizeof(out));
+    if ((s1 | l1 | h1) & 1)
+      continue;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (sampleSeq.load(std::memory_order_relaxed) == s1 && loopSeq.load(std::memory_order_relaxed) == l1 &&
+        hidSeq.load(std::memory_order_relaxed) == h1)
+      return;
+  }
+}
+
+size_t MetricsFormat(char *buf, size_t len, uint32_t cpuMhz)
+{
+  static const char *stageNames[METRIC_STAGE_COUNT] = {"adc", "filter", "dac", "portal", "hid", "midi"};
+  MetricsSnapshot m;
+  MetricsRead(m);
+
+  size_t n = 0;
+#define METRICS_APPEND(...)                                   \
+  do                                                          \
+  {                                                           \
+    if (n < len)                                              \
+    {                                                         \
+      int w = snprintf(buf + n, len - n, __VA_ARGS__);        \
+      n += w > 0 ? (size_t)w : 0;                             \
+    }                                                         \
+  } while (0)
+
+  METRICS_APPEND("cpu_mhz %u\n", (unsigned)cpuMhz);
+  // 阶段耗时：次数 平均周期 最大周期
+  for (int i = 0; i < METRIC_STAGE_COUNT; ++i)
+  {
+    const MetricStageStats &s = m.stage[i];
+    METRICS_APPEND("stage_%s %u %u %u\n", stageNames[i], (unsigned)s.count,
+                   (unsigned)(s.count ? s.totalCycles / s.count : 0), (unsigned)s.maxCycles);
+  }
+  // 延迟直方图：每档上限(us):次数，最后一档为 inf
+  METRICS_APPEND("latency_us");
+  for (int i = 0; i < METRIC_LATENCY_BUCKETS; ++i)
+  {
+    if (i < METRIC_LATENCY_BUCKETS - 1)
+      METRICS_APPEND(" %u:%u", (unsigned)metricLatencyBoundsUs[i], (unsigned)m.latency[i]);
+    else
+      METRICS_APPEND(" inf:%u", (unsigned)m.latency[i]);
+  }
+  METRICS_APPEND("\nlatency_max_us %u\n", (unsigned)m.latencyMaxUs);
+  // 采样周期：次数 平均 最小 最大 RMS（us）
+  METRICS_APPEND("sample_period_us %u %.1f %u %u %.1f\n", (unsigned)m.jitter.count, JitterStatsMeanUs(m.jitter),
+                 (unsigned)(m.jitter.count ? m.jitter.minUs : 0), (unsigned)m.jitter.maxUs, JitterStatsRmsUs(m.jitter));
+  // 主循环：次数 超时次数 最大超出(us)
+  METRICS_APPEND("loop %u %u %u\n", (unsigned)m.loops, (unsigned)m.loopMisses, (unsigned)m.loopOverrunMaxUs);
+#undef METRICS_APPEND
+  return n < len ? n : (len ? len - 1 : 0);
+}
@@ -0,0 +1,142 @@
+// midi_codec.cpp
+#include "midi_codec.h"
+
+const uint8_t midiPedalCc[PEDAL_COUNT] = {MIDI_CC_SUSTAIN, MIDI_CC_SOSTENUTO, MIDI_CC_SOFT};
+
+// BLE-MIDI 时间戳为 13 位毫秒
+#define BLE_MIDI_TIME_MASK 0x1FFF
+
+void MidiCcReset(MidiCcTracker &t)
+{
+  for (int i = 0; i < PEDAL_COUNT; ++i)
+  {
+    t.sent[i] = -1;
+    t.pending[i] = -1;
+    t.pendingMs[i] = 0;
+  }
+}
+
+void MidiCcUpdate(MidiCcTracker &t, const PedalFrame &frame)
+{
+  uint16_t ms = (uint16_t)(frame.timeUs / 1000);
+  for (int i = 0; i < PEDAL_COUNT; ++i)
+  {
+    int v = frame.value[i] >> 1;
+    if (v == t.pending[i])
+      continue;
+    // 批次内先变化又回到已发送的值：无需发送
+    t.pending[i] = v == t.sent[i] ? -1 : (int8_t)v;
+    t.pendingMs[i] = ms;
+  }
+}
+
+int MidiCcTake(MidiCcTracker &t, MidiCc out[PEDAL_COUNT])
+{
+  int n = 0;
+  for (int i = 0; i < PEDAL_COUNT; ++i)
+  {
+    if (t.pending[i] < 0)
+      continue;
+    // 插入排序：按变化时刻先后（回绕比较）
+    MidiCc cc = {midiPedalCc[i], (uint8_t)t.pending[i], t.pendingMs[i]};
+    int j = n++;
+    while (j > 0 && (int16_t)(out[j - 1].timeMs - cc.timeMs) > 0)
+    {
+      out[j] = out[j - 1];
+      j--;
+    }
+    out[j] = cc;
+    t.sent[i] = t.pending[i];
+    t.pending[i] = -1;
+  }
+  return n;
+}
+
+void BleMidiPacketBegin(BleMidiPacket &p, size_t capacity)
+{
+  p.len = 0;
+  p.capacity = (uint8_t)(capacity < BLE_MIDI_PACKET_MAX ? capacity : BLE_MIDI_PACKET_MAX);
+  p.status = 0;
+  p.firstMs = 0;
+  p.lastMs = 0;
+}
+
+bool BleMidiPacketAddCc(BleMidiPacket &p, uint8_t channel, uint8_t cc, uint8_t value, uint16_t timeMs)
+{
+  uint8_t status = (uint8_t)(MIDI_STATUS_CC | (channel & 0x0F));
+  timeMs &= BLE_MIDI_TIME_MASK;
+
+  size_t need;
+  bool stamp;
+  if (p.len == 0)
+  {
+    need = 5; // 头部 + 时间戳 + 状态 + 两个数据字节
+    stamp = true;
+  }
+  else
+  {
+    // 时间戳不能倒退，也不能超出头部所在的 128ms 窗口（低 7 位最多回绕一次）
+    uint16_t ahead = (uint16_t)((timeMs - p.lastMs) & BLE_MIDI_TIME_MASK);
+    uint16_t span = (uint16_t)((timeMs - p.firstMs) & BLE_MIDI_TIME_MASK);
+    if (ahead > BLE_MIDI_TIME_MASK / 2)
+    {
+      // 比本包最近时刻更早：按最近时刻发送
+      timeMs = p.lastMs;
+      ahead = 0;
+    }
+    else if (span > 127)
+    {
+      return false;
+    }
+    stamp = ahead != 0 || status != p.status;
+    need = (stamp ? 1 : 0) + (status != p.status ? 1 : 0) + 2;
+  }
+  if (p.len + need > p.capacity)
+    return false;
+
+  uint8_t *w = p.buf + p.len;
+  if (p.len == 0)
+  {
+    *w++ = (uint8_t)(0x80 | ((timeMs >> 7) & 0x3F));
+    p.firstMs = timeMs;
+  }
+  if (stamp)
+    *w++ = (uint8_t)(0x80 | (timeMs & 0x7F));
+  if (status != p.status)
+    *w++ = status;
+  *w++ = (uint8_t)(cc & 0x7F);
+  *w++ = (uint8_t)(value & 0x7F);
+  p.len = (uint8_t)(w - p.buf);
+  p.status = status;
+  p.lastMs = timeMs;
+  return true;
+}
+
+void MidiSerialReset(MidiSerialState &s)
+{
+  s.status = 0;
+  s.statusMs = 0;
+}
+
+size_t MidiSerialEncode(MidiSerialState &s, uint8_t channel, const MidiCc *cc, int n, uint32_t nowMs, uint8_t *buf,
+                        size_t len)
+{
+  uint8_t status = (uint8_t)(MIDI_STATUS_CC | (channel & 0x0F));
+  bool sendStatus = status != s.status || nowMs - s.statusMs >= MIDI_STATUS_REFRESH_MS;
+  size_t need = (sendStatus ? 1 : 0) + (size_t)n * 2;
+  if (n <= 0 || need > len)
+    return 0;
+  uint8_t *w = buf;
+  if (sendStatus)
+  {
+    *w++ = status;
+    s.status = status;
+    s.statusMs = nowMs;
+  }
+  for (int i = 0; i < n; ++i)
+  {
+    *w++ = (uint8_t)(cc[i].cc & 0x7F);
+    *w++ = (uint8_t)(cc[i].value & 0x7F);
+  }
+  return (size_t)(w - buf);
+}
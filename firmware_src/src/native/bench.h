@@ -0,0 +1,58 @@
+// bench.h
+// 主机基准测试（由 main_native.cpp 调用），开销以 halCycleCount 计（主机上为纳秒）
+// 每个测试返回失败的检查项数，main() 汇总后以非零退出码结束（pio run -e native 后可直接用于 CI）
+#pragma once
+
+// 打印一项检查的结果：[tag] name 通过/失败，detail；返回失败数（0 或 1），用于累加
+int BenchReport(const char *tag, const char *name, bool pass, const char *detail = nullptr);
+
+// 定点与浮点滤波的误差对比与每次调用开销
+int BenchFilter();
+
+// raw→mV 查表与融合映射表相对逐次转换的开销
+int BenchAdcLut();
+
+// SampleRing 两种策略的多线程压力测试与吞吐量
+int BenchSampleRing();
+
+// /status 各序列化方式的每帧堆分配次数、字节数与开销
+int BenchStatus();
+
+// OTA 流水线：gzip 流式解压与 SHA-256 校验的正确性（含截断/损坏）与吞吐量
+int BenchOta();
+
+// 差分升级：补丁大小与完整镜像对比、应用正确性与拒绝无效补丁
+int BenchDelta();
+
+// 配置块：往返、损坏/截断/新版本拒绝、无效曲线恢复、旧逐键布局迁移与读取开销
+int BenchConfig();
+
+// 翻页按键发送队列：合并、丢弃、过期、延迟统计与双线程计数守恒
+int BenchHidQueue();
+
+// 手势识别：短踩/长按/双击/重复、滞回抖动、长按边界与提前翻页的撤销
+int BenchGesture();
+
+// BLE-MIDI 打包：逐字节对照、运行状态、分包边界、变化检测与扫动时的通知数/字节数
+int BenchMidi();
+
+// 提示音调度：音符时刻、播放中追加、休止符与队列满
+int BenchTone();
+
+// 抖动 DAC：平均误差、量化误差频谱、RC 滤波后的纹波与等效分辨率
+int BenchDither();
+
+// 输出曲线：默认曲线与原比例一致、gamma/自定义点、细分插值、弱音滞回与查表开销
+int BenchCurve();
+
+// 采样频率调节：合成会话上的唤醒延迟、低频占比与平均电流估算，以及低频频率/等待时间的取舍
+int BenchGovernor();
+
+// 采样记录：编码往返、环形覆盖与重启续写、损坏块跳过、每条记录的字节数与闪存擦写频率
+int BenchLog();
+
+// 启动阶段计时：上电丢弃、阶段顺序、复位后上一次记录的交接、报告截断与 setup → 第一次 DAC 输出的预算
+int BenchBootProfile();
+
+// 平滑策略：EMA 策略与原滤波一致、评测器的阶跃检出，以及三种策略在演奏轨迹上的延迟/抖动/开销与参数取舍
+int BenchFilterPolicy();
@@ -0,0 +1,52 @@
+// bench_adc_lut.cpp
+// 对比 halRawToMillivolts 逐次转换与查表，以及 raw→mV→死区映射 与融合 raw→0..255 表
+#include <stdio.h>
+#include "adc_lut.h"
+#include "bench.h"
+#include "pedal_hal.h"
+
+#define BENCH_ADC_LUT_ITERATIONS 1000000
+
+static PedalMapLut s_map;
+
+int BenchAdcLut()
+{
+  uint32_t directCycles, lutCycles;
+  AdcLutBenchmark(BENCH_ADC_LUT_ITERATIONS, directCycles, lutCycles);
+  printf("[查表] raw→mV 每次：逐次转换 %.2f，查表 %.2f\n",
+         (double)directCycles / BENCH_ADC_LUT_ITERATIONS, (double)lutCycles / BENCH_ADC_LUT_ITERATIONS);
+
+  PedalFilter f = {};
+  PedalFilterSetRange(f, 580, 2420, 0.05f);
+  PedalMapLutBuild(s_map, f);
+
+  // 融合表必须与逐次计算完全一致
+  int mismatches = 0;
+  for (int raw = 0; raw < ADC_LUT_SIZE; ++raw)
+    if (s_map.value[raw] != PedalFilterMap(f, halRawToMillivolts(raw)))
+      mismatches++;
+
+  volatile uint32_t sink = 0;
+  uint32_t acc = 0;
+  uint32_t t0 = halCycleCount();
+  for (int i = 0; i < BENCH_ADC_LUT_ITERATIONS; ++i)
+    acc += PedalFilterMap(f, halRawToMillivolts(i & (ADC_LUT_SIZE - 1)));
+  uint32_t directMap = halCycleCount() - t0;
+  sink = acc;
+
+  acc = 0;
+  t0 = halCycleCount();
+  for (int i = 0; i < BENCH_ADC_LUT_ITERATIONS; ++i)
+    acc += s_map.value[i & (ADC_LUT_SIZE - 1)];
+  uint32_t lutMap = halCycleCount() - t0;
+  sink = sink + acc;
+  (void)sink;
+
+  t0 = halCycleCount();
+  PedalMapLutBuild(s_map, f);
+  uint32_t rebuild = halCycleCount() - t0;
+
+  printf("[查表] raw→0..255 每次：转换+映射 %.2f，融合表 %.2f；重建一张表 %u，不一致 %d 项\n",
+         (double)directMap / BENCH_ADC_LUT_ITERATIONS, (double)lutMap / BENCH_ADC_LUT_ITERATIONS, (unsigned)rebuild, mismatches);
+  return mismatches ? 1 : 0;
+}
@@ -0,0 +1,188 @@
+// bench_boot.cpp
+// 启动阶段计时：上电时 RTC 内容无效则丢弃、阶段时刻按顺序且只记录第一次、复位后上一次记录的交接，
+// 以及文本报告的内容与任意缓冲区长度下的截断（主机上 RTC_NOINIT 退化为普通静态变量，进程内多次 Begin 即模拟多次复位），
+// 最后按 setup() 的顺序回放到第一次 DAC 输出，检查 Boot_First_Dac_Budget_Ms
+#include <stdio.h>
+#include <string.h>
+#include "bench.h"
+#include "boot_profile.h"
+#include "config_codec.h"
+#include "hal_sim.h"
+#include "pedal.h"
+#include "pedal_config.h"
+#include "pedal_hal.h"
+
+#define BOOT_REPORT_MAX 1024
+
+// 启动回放的设备模型（估计值，设备上的实测见 /boot）：
+//   可移植部分在主机上实测，按 ESP32 80MHz 相对主机的倍数折算
+#define BOOT_HOST_SLOWDOWN 50
+//   主机上没有的部分：电源管理与看门狗配置、打开 NVS 并读取配置块
+#define BOOT_DEVICE_PM_US 1000
+#define BOOT_DEVICE_NVS_US 5000
+
+// 从 startNs 到现在的主机开销折算成设备时间并推进虚拟时钟
+static void ChargeHost(uint32_t startNs)
+{
+  simAdvanceUs((unsigned long)((uint64_t)(halCycleCount() - startNs) * BOOT_HOST_SLOWDOWN / 1000));
+}
+
+int BenchBootProfile()
+{
+  int failed = 0;
+  char detail[96];
+
+  // 1. 上电：RTC 慢速内存为随机内容，校验失败，不产生上一次记录
+  {
+    const_cast<BootProfile &>(BootProfileCurrent()).magic ^= 0xA5A5A5A5u;
+    BootProfileBegin(1);
+    BootProfile prev;
+    const BootProfile &cur = BootProfileCurrent();
+    bool pass = !BootProfilePrevious(prev) && cur.bootCount == 1 && cur.resetReason == 1 && cur.us[BOOT_SETUP] != 0;
+    for (int i = BOOT_SETUP + 1; i < BOOT_PHASE_COUNT; ++i)
+      pass = pass && cur.us[i] == 0;
+    snprintf(detail, sizeof(detail), "启动次数 %u", (unsigned)cur.bootCount);
+    failed += BenchReport("启动", "上电丢弃", pass, detail);
+  }
+
+  // 2. 阶段时刻：按调用顺序递增；重复标记保留第一次；未经过的阶段（这里是 radio）保持 0
+  BootProfile first;
+  {
+    static const BootPhase kOrder[] = {BOOT_PM,        BOOT_NVS, BOOT_ADC,   BOOT_SENSE,
+                                       BOOT_FIRST_DAC, BOOT_BLE, BOOT_TONES, BOOT_READY};
+    for (BootPhase p : kOrder)
+    {
+      simAdvanceUs(1500);
+      BootMark(p);
+    }
+    simAdvanceUs(1500);
+    BootMark(BOOT_SENSE);
+    first = BootProfileCurrent();
+    bool pass = first.us[BOOT_RADIO] == 0;
+    uint32_t last = first.us[BOOT_SETUP];
+    for (BootPhase p : kOrder)
+    {
+      pass = pass && first.us[p] > last;
+      last = first.us[p];
+    }
+    pass = pass && first.us[BOOT_SENSE] - first.us[BOOT_ADC] == 1500;
+    snprintf(detail, sizeof(detail), "setup→ready %uus", (unsigned)(first.us[BOOT_READY] - first.us[BOOT_SETUP]));
+    failed += BenchReport("启动", "阶段顺序", pass, detail);
+  }
+
+  // 3. 软件/看门狗复位：上一次记录原样交接，启动次数递增，本次记录重新开始
+  {
+    simAdvanceUs(20000);
+    BootProfileBegin(4);
+    BootProfile prev;
+    const BootProfile &cur = BootProfileCurrent();
+    bool pass = BootProfilePrevious(prev) && memcmp(&prev, &first, sizeof(prev)) == 0 && cur.bootCount == 2 &&
+                cur.resetReason == 4;
+    for (int i = BOOT_SETUP + 1; i < BOOT_PHASE_COUNT; ++i)
+      pass = pass && cur.us[i] == 0;
+    simAdvanceUs(800);
+    BootMark(BOOT_PM);
+    snprintf(detail, sizeof(detail), "上一次启动次数 %u，复位原因 %u", (unsigned)prev.bootCount,
+             (unsigned)prev.resetReason);
+    failed += BenchReport("启动", "复位交接", pass, detail);
+  }
+
+  // 4. 文本报告：本次与上一次的表头、阶段行的到达时刻与间隔，未经过的阶段不输出
+  static char full[BOOT_REPORT_MAX];
+  size_t fullLen = BootProfileFormat(full, sizeof(full));
+  {
+    const BootProfile &cur = BootProfileCurrent();
+    char line[64];
+    bool pass = fullLen == strlen(full) && fullLen + 1 < sizeof(full) && strncmp(full, "boot 2 4\n", 9) == 0 &&
+                strstr(full, "\nprev_boot 1 1\n") != nullptr && strstr(full, "boot_radio") == nullptr &&
+                strstr(full, "\nboot_ready") == nullptr;
+    snprintf(line, sizeof(line), "\nboot_pm %u 800\n", (unsigned)cur.us[BOOT_PM]);
+    pass = pass && strstr(full, line) != nullptr;
+    // 跳过的阶段不占行，间隔从上一个输出的阶段算起
+    snprintf(line, sizeof(line), "\nprev_boot_ble %u 1500\n", (unsigned)first.us[BOOT_BLE]);
+    pass = pass && strstr(full, line) != nullptr;
+    snprintf(line, sizeof(line), "\nprev_boot_setup %u 0\n", (unsigned)first.us[BOOT_SETUP]);
+    pass = pass && strstr(full, line) != nullptr;
+    snprintf(detail, sizeof(detail), "%u 字节", (unsigned)fullLen);
+    failed += BenchReport("启动", "报告格式", pass, detail);
+  }
+
+  // 5. 截断：任意长度下返回值 = 写入的字符数 < len，结果是完整报告的前缀，不越界
+  {
+    static char buf[BOOT_REPORT_MAX + 16];
+    int bad = 0;
+    for (size_t len = 0; len <= fullLen + 1; ++len)
+    {
+      memset(buf, 0x5A, sizeof(buf));
+      size_t n = BootProfileFormat(buf, len);
+      bool ok = len == 0 ? n == 0 && (unsigned char)buf[0] == 0x5A
+                         : n < len && buf[n] == '\0' && strlen(buf) == n && memcmp(buf, full, n) == 0 &&
+                               n == (len > fullLen ? fullLen : len - 1);
+      for (size_t k = len; k < sizeof(buf); ++k)
+        ok = ok && (unsigned char)buf[k] == 0x5A;
+      bad += !ok;
+    }
+    snprintf(detail, sizeof(detail), "长度 0..%u 中不符 %d 个", (unsigned)fullLen + 1, bad);
+    failed += BenchReport("启动", "报告截断", bad == 0, detail);
+  }
+
+  // 6. 启动预算：setup() 到第一次 DAC 输出（校准与 OTA 等开机功能不触发、踏板松开）
+  {
+    simSetMillivolts(ADC_Sustain_PIN, Sustain_Pedal_MIN);
+    simSetMillivolts(ADC_Sostenuto_PIN, Sostenuto_Pedal_MIN);
+    simSetMillivolts(ADC_Soft_PIN, Soft_Pedal_MIN);
+    // 前面场景留下的滤波状态先回到松开（设备上开机时为零）
+    for (int i = 0; i < 100; ++i)
+    {
+      PedalFrame warm;
+      PedalSample(warm);
+    }
+    BootProfileBegin(4);
+    simAdvanceUs(BOOT_DEVICE_PM_US);
+    BootMark(BOOT_PM);
+
+    // ReadConfig：解码配置块（NVS 读取按固定开销计）
+    uint32_t t0 = halCycleCount();
+    static ConfigData config;
+    static uint8_t blob[CONFIG_BLOB_MAX];
+    ConfigDefaults(config);
+    size_t n = ConfigEncode(config, blob, sizeof(blob));
+    bool decoded = ConfigDecode(blob, n, config) == CONFIG_OK;
+    ChargeHost(t0);
+    simAdvanceUs(BOOT_DEVICE_NVS_US);
+    BootMark(BOOT_NVS);
+
+    // ADC 查表、输出曲线与映射表
+    t0 = halCycleCount();
+    PedalBegin();
+    PedalApplyCalibration();
+    ChargeHost(t0);
+    BootMark(BOOT_ADC);
+
+    // 开机功能选择：弱音、延音各读一次
+    t0 = halCycleCount();
+    bool idle = AdcRemap(ADC_Soft_PIN, Soft_Pedal_MIN, Soft_Pedal_MAX) <= 127 &&
+                AdcRemap(ADC_Sustain_PIN, Sustain_Pedal_MIN, Sustain_Pedal_MAX) <= 127;
+    ChargeHost(t0);
+
+    // StartRunMode：采样任务的第一次定时器触发后采样并输出
+#if Sense_Task_Enable
+    BootMark(BOOT_SENSE);
+    simAdvanceUs(1000000UL / Sense_Rate_Hz);
+#endif
+    t0 = halCycleCount();
+    PedalFrame frame;
+    PedalSample(frame);
+    ChargeHost(t0);
+    PedalOutput(frame, true);
+
+    const BootProfile &cur = BootProfileCurrent();
+    uint32_t firstDacUs = cur.us[BOOT_FIRST_DAC] - cur.us[BOOT_SETUP];
+    bool pass = decoded && idle && cur.us[BOOT_FIRST_DAC] != 0 && firstDacUs <= Boot_First_Dac_Budget_Ms * 1000UL;
+    snprintf(detail, sizeof(detail), "setup → first_dac %uus（主机开销 ×%d），预算 %dms", (unsigned)firstDacUs,
+             BOOT_HOST_SLOWDOWN, Boot_First_Dac_Budget_Ms);
+    failed += BenchReport("启动", "首次输出预算", pass, detail);
+  }
+
+  return failed;
+}
@@ -0,0 +1,149 @@
+// bench_config.cpp
+// 配置块编解码：往返一致、损坏/截断/新版本的拒绝、无效曲线的恢复、旧逐键布局的迁移，以及读取开销
+#include <map>
+#include <stdio.h>
+#include <string>
+#include <string.h>
+#include "bench.h"
+#include "config_codec.h"
+#include "pedal_hal.h"
+
+#define BENCH_CONFIG_ITERATIONS 200000
+
+// 模拟 NVS 命名空间中旧固件写下的键
+typedef std::map<std::string, int32_t> LegacyKeys;
+
+static bool LegacyRead(void *ctx, const char *key, int32_t &value)
+{
+  const LegacyKeys &keys = *(const LegacyKeys *)ctx;
+  auto it = keys.find(key);
+  if (it == keys.end())
+    return false;
+  value = it->second;
+  return true;
+}
+
+static bool CurveEqual(const OutputCurve &a, const OutputCurve &b)
+{
+  return a.gamma == b.gamma && a.type == b.type && a.x0 == b.x0 && a.x1 == b.x1 && a.y0 == b.y0 && a.y1 == b.y1 &&
+         a.count == b.count && memcmp(a.px, b.px, sizeof(a.px)) == 0 && memcmp(a.py, b.py, sizeof(a.py)) == 0 &&
+         a.switchOn == b.switchOn && a.switchOff == b.switchOff;
+}
+
+static bool ConfigEqual(const ConfigData &a, const ConfigData &b)
+{
+  for (int i = 0; i < PEDAL_COUNT; ++i)
+  {
+    if (a.minV[i] != b.minV[i] || a.maxV[i] != b.maxV[i] || a.deadZone[i] != b.deadZone[i] ||
+        !CurveEqual(a.curve[i], b.curve[i]))
+      return false;
+  }
+  return a.bluetoothActive == b.bluetoothActive;
+}
+
+int BenchConfig()
+{
+  int failed = 0;
+  ConfigData c;
+  ConfigDefaults(c);
+  for (int i = 0; i < PEDAL_COUNT; ++i)
+  {
+    c.minV[i] = 592 + i * 13;
+    c.maxV[i] = 2404 - i * 7;
+    c.deadZone[i] = 51 + i;
+  }
+  c.bluetoothActive = true;
+  c.curve[PEDAL_SUSTAIN].type = CURVE_GAMMA;
+  c.curve[PEDAL_SUSTAIN].gamma = 180;
+  c.curve[PEDAL_SOSTENUTO].type = CURVE_POINTS;
+  CurveParsePoints("0:0,100:20,200:200,255:255", c.curve[PEDAL_SOSTENUTO]);
+  c.curve[PEDAL_SOFT].switchOn = 150;
+  c.curve[PEDAL_SOFT].switchOff = 100;
+
+  uint8_t blob[CONFIG_BLOB_MAX];
+  size_t n = ConfigEncode(c, blob, sizeof(blob));
+  ConfigData d;
+  failed += BenchReport("配置", "往返", n == CONFIG_BLOB_MAX && ConfigDecode(blob, n, d) == CONFIG_OK && ConfigEqual(c, d));
+
+  // 任意一位翻转都必须被拒绝（头部由魔数/版本/长度检查，负载由 CRC 检查）
+  int accepted = 0;
+  for (size_t bit = 0; bit < n * 8; ++bit)
+  {
+    blob[bit / 8] ^= (uint8_t)(1 << (bit % 8));
+    if (ConfigDecode(blob, n, d) == CONFIG_OK)
+      accepted++;
+    blob[bit / 8] ^= (uint8_t)(1 << (bit % 8));
+  }
+  char detail[64];
+  snprintf(detail, sizeof(detail), "%u 种单比特损坏中误接受 %d 种", (unsigned)(n * 8), accepted);
+  failed += BenchReport("配置", "单比特损坏", accepted == 0, detail);
+
+  // 写了一半（任意长度截断）
+  bool truncated = true;
+  for (size_t len = 0; len < n; ++len)
+    truncated = truncated && ConfigDecode(blob, len, d) == CONFIG_TRUNCATED;
+  failed += BenchReport("配置", "截断", truncated);
+
+  // 由更新的固件写入：不认识的版本回到默认值
+  uint8_t newer[CONFIG_BLOB_MAX];
+  memcpy(newer, blob, n);
+  newer[4] = CONFIG_VERSION + 1;
+  ConfigData defaults;
+  ConfigDefaults(defaults);
+  failed += BenchReport("配置", "未知版本", ConfigDecode(newer, n, d) == CONFIG_BAD_VERSION && ConfigEqual(d, defaults));
+
+  // CRC 正确但曲线参数无效：只有这条曲线回到默认值
+  ConfigData invalid = c;
+  invalid.curve[PEDAL_SUSTAIN].type = CURVE_TYPE_COUNT;
+  uint8_t invalidBlob[CONFIG_BLOB_MAX];
+  ConfigEncode(invalid, invalidBlob, sizeof(invalidBlob));
+  ConfigData expectedInvalid = c;
+  CurveDefault(expectedInvalid.curve[PEDAL_SUSTAIN]);
+  failed += BenchReport("配置", "无效曲线", ConfigDecode(invalidBlob, n, d) == CONFIG_OK && ConfigEqual(expectedInvalid, d));
+
+  // 旧固件的逐键布局（putInt 写校准参数，putBool 写蓝牙开关）：死区取 0（沿用 5%），输出曲线取默认值
+  LegacyKeys legacy;
+  const char *const *keys = configLegacyKeys;
+  ConfigData migrated = defaults;
+  for (int i = 0; i < PEDAL_COUNT; ++i)
+  {
+    legacy[keys[i * 2]] = c.minV[i];
+    legacy[keys[i * 2 + 1]] = c.maxV[i];
+    migrated.minV[i] = c.minV[i];
+    migrated.maxV[i] = c.maxV[i];
+  }
+  legacy[keys[PEDAL_COUNT * 2]] = 1;
+  migrated.bluetoothActive = true;
+  failed += BenchReport("配置", "迁移旧布局", ConfigMigrateLegacy(d, LegacyRead, &legacy) && ConfigEqual(migrated, d));
+
+  // 只保存过蓝牙开关（从未校准）：校准参数保持默认
+  LegacyKeys bluetoothOnly;
+  bluetoothOnly[keys[PEDAL_COUNT * 2]] = 1;
+  ConfigData expected = defaults;
+  expected.bluetoothActive = true;
+  failed += BenchReport("配置", "迁移仅蓝牙开关", ConfigMigrateLegacy(d, LegacyRead, &bluetoothOnly) && ConfigEqual(expected, d));
+
+  LegacyKeys empty;
+  failed += BenchReport("配置", "全新设备", !ConfigMigrateLegacy(d, LegacyRead, &empty) && ConfigEqual(d, defaults));
+
+  // 开机读取开销：一次解码 vs 逐键读取（主机上以 map 查找代替 NVS 查找，仅作相对比较）
+  uint32_t t0 = halCycleCount();
+  volatile int sink = 0;
+  for (int i = 0; i < BENCH_CONFIG_ITERATIONS; ++i)
+  {
+    ConfigDecode(blob, n, d);
+    sink += d.minV[0];
+  }
+  uint32_t t1 = halCycleCount();
+  for (int i = 0; i < BENCH_CONFIG_ITERATIONS; ++i)
+  {
+    ConfigMigrateLegacy(d, LegacyRead, &legacy);
+    sink += d.minV[0];
+  }
+  uint32_t t2 = halCycleCount();
+  (void)sink;
+  printf("[配置] 配置块 %u 字节，每次保存 1 次写入（逐键布局 %d 个键、校准保存 6 次写入）；解码 %.0fns，逐键读取 %.0fns\n",
+         (unsigned)n, CONFIG_LEGACY_KEY_COUNT, (double)(t1 - t0) / BENCH_CONFIG_ITERATIONS,
+         (double)(t2 - t1) / BENCH_CONFIG_ITERATIONS);
+  return failed;
+}
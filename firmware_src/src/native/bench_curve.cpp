@@ -0,0 +1,168 @@
+// bench_curve.cpp
+// 输出曲线：默认曲线与原固定比例一致、gamma/自定义点的形状、细分插值、弱音开关滞回、
+// 网页接口的格式与参数检查，以及查表相对逐次计算的开销
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "dac_dither.h"
+#include "output_curve.h"
+#include "pedal_config.h"
+#include "pedal_hal.h"
+
+#define BENCH_CURVE_ITERATIONS 1000000
+
+int BenchCurve()
+{
+  int failed = 0;
+  char detail[128];
+  OutputCurve c;
+  CurveLut lut;
+
+  // 默认曲线编译为 DAC 码值：与原先 (uint8_t)(value * Max_DAC_Voltage / 3.3) 逐项比较
+  {
+    CurveDefault(c);
+    CurveCompile(c, lut, DacCodeQ8);
+    int mismatch = 0, maxDiff = 0;
+    for (int v = 0; v < 256; ++v)
+    {
+      int old = (uint8_t)(v * Max_DAC_Voltage / 3.3);
+      int d = abs((CurveLookup(lut, v) >> 8) - old);
+      mismatch += d != 0;
+      maxDiff = d > maxDiff ? d : maxDiff;
+    }
+    bool pass = CurveValid(c) && maxDiff <= 1;
+    snprintf(detail, sizeof(detail), "256 个映射值中 %d 个不同，最大差 %d 个码值", mismatch, maxDiff);
+    failed += BenchReport("曲线", "默认=原比例", pass, detail);
+  }
+
+  // gamma 2.2：端点不变、单调、中点约 (0.5)^2.2
+  {
+    CurveDefault(c);
+    c.type = CURVE_GAMMA;
+    c.gamma = 220;
+    c.x0 = 20;
+    c.x1 = 235;
+    c.y0 = 10;
+    c.y1 = 250;
+    CurveCompile(c, lut);
+    bool monotonic = true;
+    for (int v = 1; v < 256; ++v)
+      monotonic = monotonic && lut.q8[v] >= lut.q8[v - 1];
+    double mid = (CurveLookup(lut, (20 + 235) / 2) / 256.0 - 10) / 240;
+    bool pass = CurveValid(c) && monotonic && lut.q8[0] == 10 << 8 && lut.q8[20] == 10 << 8 && lut.q8[235] == 250 << 8 &&
+                lut.q8[255] == 250 << 8 && fabs(mid - pow(107.5 / 215, 2.2)) < 0.01;
+    snprintf(detail, sizeof(detail), "中点输出 %.3f（理论 %.3f）", mid, pow(107.5 / 215, 2.2));
+    failed += BenchReport("曲线", "gamma", pass, detail);
+  }
+
+  // 自定义点：经过每个点，点之间线性，两端保持
+  {
+    CurveDefault(c);
+    c.type = CURVE_POINTS;
+    bool parsed = CurveParsePoints("16:0, 96:30,160:90,230:255", c);
+    CurveCompile(c, lut);
+    bool through = parsed && c.count == 4;
+    for (int i = 0; through && i < c.count; ++i)
+      through = lut.q8[c.px[i]] == c.py[i] << 8;
+    bool pass = CurveValid(c) && through && lut.q8[0] == 0 && lut.q8[255] == 255 << 8 && lut.q8[128] == 60 << 8;
+    failed += BenchReport("曲线", "自定义点", pass);
+  }
+
+  // 细分插值：相邻项之间单调、端点与整数查表一致
+  {
+    CurveDefault(c);
+    c.type = CURVE_GAMMA;
+    c.gamma = 50;
+    CurveCompile(c, lut, DacCodeQ8);
+    bool pass = true;
+    int prev = CurveLookupQ8(lut, 0);
+    for (int q8 = 1; q8 <= 255 << 8; ++q8)
+    {
+      int v = CurveLookupQ8(lut, q8);
+      pass = pass && v >= prev && ((q8 & 0xFF) != 0 || v == CurveLookup(lut, q8 >> 8));
+      prev = v;
+    }
+    failed += BenchReport("曲线", "细分插值", pass);
+  }
+
+  // 弱音开关：半踩停在 127 附近（±4 抖动）时原先 > 127 反复开合，滞回后保持不变；真正踩下/松开各切换一次
+  {
+    CurveDefault(c);
+    CurveCompile(c, lut);
+    srand(7);
+    bool oldOn = false, on = false;
+    int oldToggles = 0, toggles = 0;
+    for (int i = 0; i < 6000; ++i)
+    {
+      int base = i < 2000 ? 127 : i < 4000 ? 200 : 40;
+      int v = base + rand() % 9 - 4;
+      bool o = v > 127;
+      oldToggles += o != oldOn;
+      oldOn = o;
+      bool n = CurveSwitch(lut, on, v);
+      toggles += n != on;
+      on = n;
+    }
+    bool pass = toggles == 2;
+    snprintf(detail, sizeof(detail), "切换 %d 次（原先 > 127：%d 次）", toggles, oldToggles);
+    failed += BenchReport("曲线", "弱音滞回", pass, detail);
+  }
+
+  // 网页接口：JSON 格式与无效参数
+  {
+    CurveDefault(c);
+    char json[192];
+    CurveFormatJson(json, sizeof(json), c);
+    bool format = strcmp(json, "{\"t\":0,\"x0\":0,\"x1\":255,\"y0\":0,\"y1\":255,\"g\":100,\"pts\":[[0,0],[255,255]],"
+                               "\"on\":135,\"off\":119}") == 0;
+    OutputCurve bad = c;
+    bad.type = CURVE_POINTS;
+    bool rejected = CurveParsePoints("0:0,10:20,10:30", bad) && !CurveValid(bad);     // x 不递增
+    rejected = rejected && !CurveParsePoints("0:0,256:20", bad);                      // 超出 0-255
+    rejected = rejected && !CurveParsePoints("0:0,1:1,2:2,3:3,4:4,5:5,6:6,7:7,8:8", bad); // 超过 8 个点
+    rejected = rejected && !CurveParsePoints("0:0;255:255", bad);
+    bad = c;
+    bad.switchOff = bad.switchOn;
+    rejected = rejected && !CurveValid(bad);
+    bad = c;
+    bad.type = CURVE_GAMMA;
+    bad.gamma = 5;
+    rejected = rejected && !CurveValid(bad);
+    bad = c;
+    bad.x0 = bad.x1;
+    rejected = rejected && !CurveValid(bad);
+    failed += BenchReport("曲线", "接口格式与检查", format && rejected, format ? nullptr : json);
+  }
+
+  // 开销：采样路径上查表 vs 每次按 gamma 曲线计算
+  {
+    CurveDefault(c);
+    c.type = CURVE_GAMMA;
+    c.gamma = 180;
+    CurveCompile(c, lut, DacCodeQ8);
+    volatile int sink = 0;
+    uint32_t t0 = halCycleCount();
+    for (int i = 0; i < BENCH_CURVE_ITERATIONS; ++i)
+      sink += CurveLookupQ8(lut, (i * 7) & 0xFFFF);
+    uint32_t t1 = halCycleCount();
+    for (int i = 0; i < BENCH_CURVE_ITERATIONS; ++i)
+    {
+      float t = ((i * 7) & 0xFFFF) / 65535.0f;
+      sink += DacCodeQ8((int)(powf(t, 1.8f) * (255 << 8)));
+    }
+    uint32_t t2 = halCycleCount();
+    (void)sink;
+    uint32_t c0 = halCycleCount();
+    for (int i = 0; i < 1000; ++i)
+      CurveCompile(c, lut, DacCodeQ8);
+    uint32_t c1 = halCycleCount();
+    printf("[曲线] 每次输出：查表 %.2fns，逐次计算 %.2fns；编译一条曲线 %.1fus，查表 %u 字节/踏板（双缓冲 ×2）\n",
+           (double)(t1 - t0) / BENCH_CURVE_ITERATIONS, (double)(t2 - t1) / BENCH_CURVE_ITERATIONS, (c1 - c0) / 1000.0 / 1000.0,
+           (unsigned)sizeof(CurveLut));
+  }
+
+  printf("[曲线] %s\n", failed ? "存在失败项" : "全部通过");
+  return failed;
+}
@@ -0,0 +1,81 @@
+// bench_delta.cpp
+// 差分升级：在合成镜像上模拟两类常见修改，比较补丁与完整镜像（均 gzip -9）的上传量，
+// 并确认补丁经 ota_stream 应用后与新镜像逐字节一致、用于错误的旧镜像或被截断时会被拒绝
+#include <stdio.h>
+#include <string.h>
+#include "bench.h"
+#include "delta_diff.h"
+#include "pedal_hal.h"
+
+#define BENCH_DELTA_IMAGE_SIZE (1024 * 1024)
+// 估算空中传输时间用的 SoftAP 有效上传速率（字节/秒）
+#define BENCH_DELTA_LINK_BPS 100000
+#define BENCH_DELTA_CHUNK 1436
+
+static int Scenario(const char *name, const Bytes &oldImg, const Bytes &newImg)
+{
+  uint32_t t0 = halCycleCount();
+  Bytes patch = DeltaDiff(oldImg, newImg);
+  uint32_t diffNs = halCycleCount() - t0;
+  Bytes patchGz = ImageGzip(patch, 9);
+  Bytes fullGz = ImageGzip(newImg, 9);
+
+  Bytes out;
+  const char *error = nullptr;
+  t0 = halCycleCount();
+  bool ok = DeltaApply(oldImg, patchGz.empty() ? patch : patchGz, BENCH_DELTA_CHUNK, out, &error);
+  uint32_t applyNs = halCycleCount() - t0;
+  ok = ok && out == newImg;
+
+  size_t upload = patchGz.empty() ? patch.size() : patchGz.size();
+  printf("[差分] %s：补丁 %u 字节，gzip 后 %u 字节；完整镜像 gzip 后 %u 字节（%.1f 倍），"
+         "上传约 %.2fs → %.2fs；应用%s，%.1f MB/s，生成补丁 %.0fms\n",
+         name, (unsigned)patch.size(), (unsigned)patchGz.size(), (unsigned)fullGz.size(),
+         (double)fullGz.size() / upload, (double)fullGz.size() / BENCH_DELTA_LINK_BPS,
+         (double)upload / BENCH_DELTA_LINK_BPS, ok ? "正确" : "错误",
+         newImg.size() / (applyNs / 1e3), diffNs / 1e6);
+  if (error)
+    printf("[差分] 拒绝原因：%s\n", error);
+  return ok ? 0 : 1;
+}
+
+static int Expect(const char *name, const Bytes &oldImg, const Bytes &upload)
+{
+  Bytes out;
+  const char *error = nullptr;
+  bool ok = DeltaApply(oldImg, upload, BENCH_DELTA_CHUNK, out, &error);
+  printf("[差分] %-20s %s，拒绝原因：%s\n", name, ok ? "失败（未被拒绝）" : "通过", error ? error : "无");
+  return ok ? 1 : 0;
+}
+
+int BenchDelta()
+{
+  int failed = 0;
+  std::vector<ImageFunc> layout = ImageLayout(2024, BENCH_DELTA_IMAGE_SIZE);
+  Bytes oldImg = ImageRender(layout);
+
+  // 修改一个函数的实现，长度不变
+  std::vector<ImageFunc> edit = layout;
+  edit[edit.size() / 2].seed ^= 0x1234;
+  Bytes editImg = ImageRender(edit);
+  failed += Scenario("原地修改 1 个函数", oldImg, editImg);
+
+  // 修改 3 个函数，其中一个变长，并新增一个函数：之后的代码整体移位，指向它们的指针全部改变
+  std::vector<ImageFunc> grow = layout;
+  grow[grow.size() / 4].seed ^= 0x55;
+  grow[grow.size() / 2].seed ^= 0x66;
+  grow[grow.size() / 2].size += 128;
+  grow[grow.size() * 3 / 4].seed ^= 0x77;
+  grow.insert(grow.begin() + grow.size() / 3, ImageFunc{0xC0FFEE, 512, false});
+  Bytes growImg = ImageRender(grow);
+  failed += Scenario("修改 3 个+新增 1 个", oldImg, growImg);
+
+  Bytes patch = DeltaDiff(oldImg, growImg);
+  failed += Expect("补丁用于其他固件", editImg, patch);
+  Bytes cut(patch.begin(), patch.end() - 100);
+  failed += Expect("补丁截断", oldImg, cut);
+  Bytes bad = patch;
+  bad[bad.size() - 10] ^= 0x20;
+  failed += Expect("补丁数据损坏", oldImg, bad);
+  return failed;
+}
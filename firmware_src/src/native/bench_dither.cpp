@@ -0,0 +1,172 @@
+// bench_dither.cpp
+// 抖动 DAC 调制核心：平均误差、只在相邻码值间切换、量化误差频谱（低频段能量），
+// 以及经一阶 RC 低通（模拟钢琴踏板输入）后的纹波与等效分辨率，对比直接截断输出
+#include <math.h>
+#include <stdio.h>
+#include "bench.h"
+#include "dac_dither.h"
+#include "pedal_config.h"
+#include "pedal_hal.h"
+
+#define DITHER_N 2048
+// DAC 满量程 3.3V，每个码值约 12.9mV
+#define DITHER_CODE_MV (3300.0 / 256.0)
+
+// 误差序列（码值）在 [0, cutoffHz) 内的能量占总能量的比例（直接 DFT）
+static double LowBandFraction(const double *err, int n, double rateHz, double cutoffHz)
+{
+  double total = 0, low = 0;
+  int maxBin = (int)(cutoffHz * n / rateHz);
+  for (int k = 0; k <= n / 2; ++k)
+  {
+    double re = 0, im = 0;
+    for (int i = 0; i < n; ++i)
+    {
+      double a = 2 * M_PI * k * i / n;
+      re += err[i] * cos(a);
+      im -= err[i] * sin(a);
+    }
+    double p = re * re + im * im;
+    total += p;
+    if (k < maxBin)
+      low += p;
+  }
+  return total > 0 ? low / total : 0;
+}
+
+// 一阶 RC 低通（截止 cutoffHz）稳定后的输出：返回平均值，peakToPeak 为纹波
+static double RcFiltered(const uint8_t *codes, int n, double rateHz, double cutoffHz, double start, double &peakToPeak)
+{
+  double a = 1 - exp(-2 * M_PI * cutoffHz / rateHz);
+  double y = start, lo = 1e9, hi = -1e9, sum = 0;
+  int counted = 0;
+  for (int rep = 0; rep < 8; ++rep)
+  {
+    for (int i = 0; i < n; ++i)
+    {
+      y += a * (codes[i] - y);
+      if (rep >= 4)
+      {
+        lo = y < lo ? y : lo;
+        hi = y > hi ? y : hi;
+        sum += y;
+        counted++;
+      }
+    }
+  }
+  peakToPeak = hi - lo;
+  return sum / counted;
+}
+
+int BenchDither()
+{
+  const double rate = Dac_Dither_Rate_Hz;
+  static uint8_t codes[DITHER_N];
+  static double err[DITHER_N];
+  int failed = 0;
+
+  // 平均误差与相邻码值：扫过 0..255 映射值的所有 Q8 细分（步长 37/256）
+  {
+    double maxMeanErr = 0;
+    bool adjacent = true;
+    for (int valueQ8 = 0; valueQ8 <= 255 << 8; valueQ8 += 37)
+    {
+      int target = DacCodeQ8(valueQ8);
+      DacDither d;
+      DacDitherReset(d);
+      long sum = 0;
+      for (int i = 0; i < DITHER_N; ++i)
+      {
+        int c = DacDitherNext(d, target);
+        sum += c;
+        if (c != target >> 8 && c != (target + 255) >> 8)
+          adjacent = false;
+      }
+      double meanErr = fabs((double)sum / DITHER_N - target / 256.0);
+      maxMeanErr = meanErr > maxMeanErr ? meanErr : maxMeanErr;
+    }
+    bool pass = adjacent && maxMeanErr <= 1.0 / DITHER_N + 1e-9;
+    printf("[抖动DAC] %d 个样本平均：最大误差 %.5f 码值（≤1/%d），只在相邻码值间切换%s %s\n", DITHER_N, maxMeanErr,
+           DITHER_N, adjacent ? "" : "（否）", pass ? "通过" : "失败");
+    failed += !pass;
+  }
+
+  // 频谱：目标 100.3 码值，量化误差在 1kHz 以下的能量占比；截断输出的误差全部是直流
+  {
+    int target = (int)(100.3 * 256);
+    DacDither d;
+    DacDitherReset(d);
+    for (int i = 0; i < DITHER_N; ++i)
+    {
+      codes[i] = DacDitherNext(d, target);
+      err[i] = codes[i] - target / 256.0;
+    }
+    double low = LowBandFraction(err, DITHER_N, rate, 1000);
+    printf("[抖动DAC] 目标 100.3 码值，%.0fkHz 输出：量化误差在 1kHz 以下的能量占 %.2f%%（截断输出为 100%%）%s\n",
+           rate / 1000, low * 100, low < 0.05 ? "通过" : "失败");
+    failed += !(low < 0.05);
+  }
+
+  // RC 滤波后：截止 100Hz / 1kHz 的纹波，以及慢速扫过 1/64 码值细分时输出与目标的最大偏差
+  {
+    printf("[抖动DAC] RC 滤波后纹波（最坏目标）：");
+    const double cutoffs[] = {100, 1000};
+    for (double fc : cutoffs)
+    {
+      double worst = 0;
+      for (int frac = 1; frac < 256; frac += 5)
+      {
+        int target = 64 * 256 + frac;
+        DacDither d;
+        DacDitherReset(d);
+        for (int i = 0; i < DITHER_N; ++i)
+          codes[i] = DacDitherNext(d, target);
+        double pp;
+        RcFiltered(codes, DITHER_N, rate, fc, target / 256.0, pp);
+        worst = pp > worst ? pp : worst;
+      }
+      printf(" 截止 %.0fHz %.3f 码值（%.2fmV）", fc, worst, worst * DITHER_CODE_MV);
+    }
+    printf("\n");
+
+    double maxErr = 0;
+    for (int step = 0; step < 64; ++step)
+    {
+      int target = 80 * 256 + step * 4;
+      DacDither d;
+      DacDitherReset(d);
+      for (int i = 0; i < DITHER_N; ++i)
+        codes[i] = DacDitherNext(d, target);
+      double pp;
+      double mean = RcFiltered(codes, DITHER_N, rate, 100, target / 256.0, pp);
+      // 偏差 = 平均值误差 + 残余纹波的一半
+      double e = fabs(mean - target / 256.0) + pp / 2;
+      maxErr = e > maxErr ? e : maxErr;
+    }
+    // 码值范围 0..131 内可分辨的级数：满量程 / 最大偏差
+    double fullScale = DacCodeQ8(255 << 8) / 256.0;
+    double bits = log2(fullScale / maxErr);
+    double truncBits = log2(fullScale);
+    bool pass = bits >= 10;
+    printf("[抖动DAC] 1/64 码值细分经 100Hz RC：最大偏差 %.4f 码值，等效 %.1f 位（直接输出 %.0f 个码值约 %.1f 位）%s\n", maxErr,
+           bits, fullScale, truncBits, pass ? "通过" : "失败");
+    failed += !pass;
+  }
+
+  // 开销：每个 DMA 样本一次调用
+  {
+    DacDither d;
+    DacDitherReset(d);
+    volatile uint8_t sink = 0;
+    const int iters = 4000000;
+    uint32_t t0 = halCycleCount();
+    for (int i = 0; i < iters; ++i)
+      sink = sink + DacDitherNext(d, 12345 + (i & 255));
+    uint32_t cycles = halCycleCount() - t0;
+    printf("[抖动DAC] 每个样本 %.2fns，%.0fkHz 两路约占 %.2f%% CPU（主机）\n", (double)cycles / iters, rate / 1000,
+           (double)cycles / iters * rate * 2 / 1e7);
+  }
+
+  printf("[抖动DAC] %s\n", failed ? "存在失败项" : "全部通过");
+  return failed;
+}
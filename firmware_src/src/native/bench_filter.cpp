@@ -0,0 +1,42 @@
+// bench_filter.cpp
+// 在同一条轨迹上运行定点与浮点滤波：逐采样要求在 ±1 LSB 内，并给出每次调用开销
+// （主机上 halCycleCount 为纳秒；ESP32 上的周期数由 DEBUG 固件启动时以同一个 PedalFilterBenchmark 打印）
+#include <stdio.h>
+#include <stdlib.h>
+#include "bench.h"
+#include "pedal_filter.h"
+#include "trace.h"
+
+#define BENCH_FILTER_SAMPLES 200000
+
+static int s_trace[BENCH_FILTER_SAMPLES];
+static uint8_t s_outFixed[BENCH_FILTER_SAMPLES];
+static uint8_t s_outFloat[BENCH_FILTER_SAMPLES];
+
+int BenchFilter()
+{
+  const int minV = TRACE_REST_MV - 20;
+  const int maxV = TRACE_PRESSED_MV + 20;
+  TraceGenerate(s_trace, BENCH_FILTER_SAMPLES, 2024, 15);
+
+  uint32_t fixedCycles, floatCycles;
+  PedalFilterBenchmark(s_trace, BENCH_FILTER_SAMPLES, minV, maxV, s_outFixed, s_outFloat, fixedCycles, floatCycles);
+
+  int maxDiff = 0;
+  int beyondOne = 0;
+  for (int i = 0; i < BENCH_FILTER_SAMPLES; ++i)
+  {
+    int d = abs((int)s_outFixed[i] - (int)s_outFloat[i]);
+    if (d > maxDiff)
+      maxDiff = d;
+    if (d > 1)
+      beyondOne++;
+  }
+
+  char detail[96];
+  snprintf(detail, sizeof(detail), "%d 个采样超出 %d 个，最大偏差 %d LSB", BENCH_FILTER_SAMPLES, beyondOne, maxDiff);
+  int failed = BenchReport("滤波", "定点 ±1 LSB", beyondOne == 0, detail);
+  printf("[滤波] 每次调用开销（主机 ns/次）：定点 %.2f，浮点 %.2f\n", (double)fixedCycles / BENCH_FILTER_SAMPLES,
+         (double)floatCycles / BENCH_FILTER_SAMPLES);
+  return failed;
+}
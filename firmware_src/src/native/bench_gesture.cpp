@@ -0,0 +1,166 @@
+// bench_gesture.cpp
+// 手势识别状态机：用虚拟时间逐毫秒回放踏板曲线，检查各手势的事件序列与触发时刻
+#include <stdio.h>
+#include <string.h>
+#include "bench.h"
+#include "gesture.h"
+#include "pedal_hal.h"
+
+#define GESTURE_LOG_MAX 16
+
+struct GestureLog
+{
+  int count;
+  uint8_t events[GESTURE_LOG_MAX];
+  uint32_t atMs[GESTURE_LOG_MAX];
+};
+
+// 踏板曲线中的一段：持续 ms 毫秒保持 value
+struct Segment
+{
+  int value;
+  uint32_t ms;
+};
+
+static const GestureConfig baseConfig = {100, 90, 500, 0, 0, 0};
+
+// 每 1ms 采样一次回放曲线，记录每次非零的事件组合
+static GestureLog Replay(const GestureConfig &cfg, const Segment *seg, int segs)
+{
+  GestureLog log = {};
+  Gesture g;
+  GestureReset(g);
+  uint32_t now = 1;
+  for (int s = 0; s < segs; ++s)
+  {
+    for (uint32_t t = 0; t < seg[s].ms; ++t, ++now)
+    {
+      uint8_t ev = GestureUpdate(g, cfg, seg[s].value, now);
+      if (ev && log.count < GESTURE_LOG_MAX)
+      {
+        log.events[log.count] = ev;
+        log.atMs[log.count++] = now;
+      }
+    }
+  }
+  return log;
+}
+
+static bool Expect(const char *name, const GestureLog &log, const uint8_t *events, int count)
+{
+  bool pass = log.count == count && memcmp(log.events, events, (size_t)count) == 0;
+  printf("[手势] %s：%d 个事件", name, log.count);
+  for (int i = 0; i < log.count; ++i)
+    printf(" %02x@%u", log.events[i], (unsigned)log.atMs[i]);
+  printf(" %s\n", pass ? "通过" : "失败");
+  return pass;
+}
+
+int BenchGesture()
+{
+  int failed = 0;
+
+  // 短踩 200ms：踩下边沿 PRESS，松开时 RELEASE|SHORT
+  {
+    const Segment seg[] = {{0, 10}, {255, 200}, {0, 100}};
+    const uint8_t want[] = {GESTURE_PRESS, GESTURE_RELEASE | GESTURE_SHORT};
+    failed += !Expect("短踩", Replay(baseConfig, seg, 3), want, 2);
+  }
+
+  // 长按：LONG 在踩住满 500ms 时触发（不等松开），松开只有 RELEASE
+  {
+    const Segment seg[] = {{0, 10}, {255, 800}, {0, 100}};
+    const uint8_t want[] = {GESTURE_PRESS, GESTURE_LONG, GESTURE_RELEASE};
+    GestureLog log = Replay(baseConfig, seg, 3);
+    failed += !Expect("长按", log, want, 3);
+    if (log.count == 3 && log.atMs[1] - log.atMs[0] != 500)
+    {
+      printf("[手势] 长按触发时刻偏差 %ums 失败\n", (unsigned)(log.atMs[1] - log.atMs[0]));
+      failed++;
+    }
+  }
+
+  // 长按边界：踩住 499ms 松开是短踩，踩住 500ms 松开（同一采样既到期又松开）是长按
+  {
+    const Segment shortSeg[] = {{0, 10}, {255, 499}, {0, 100}};
+    const uint8_t wantShort[] = {GESTURE_PRESS, GESTURE_RELEASE | GESTURE_SHORT};
+    failed += !Expect("踩住 499ms", Replay(baseConfig, shortSeg, 3), wantShort, 2);
+    const Segment longSeg[] = {{0, 10}, {255, 500}, {0, 100}};
+    const uint8_t wantLong[] = {GESTURE_PRESS, GESTURE_LONG | GESTURE_RELEASE};
+    failed += !Expect("踩住 500ms", Replay(baseConfig, longSeg, 3), wantLong, 2);
+  }
+
+  // 滞回：在 90-100 之间来回抖动不产生新边沿；只有越过 100 才踩下，低于 90 才松开
+  {
+    const Segment seg[] = {{95, 50},  {101, 20}, {92, 10}, {99, 10}, {91, 10},
+                           {100, 10}, {95, 10},  {89, 20}, {95, 30}, {100, 30}};
+    const uint8_t want[] = {GESTURE_PRESS, GESTURE_RELEASE | GESTURE_SHORT};
+    failed += !Expect("90-100 间抖动", Replay(baseConfig, seg, 10), want, 2);
+  }
+
+  // 双击：开启 250ms 双击窗口后，第一次短踩的 SHORT 被推迟；窗口内再次踩下为 DOUBLE
+  {
+    GestureConfig cfg = baseConfig;
+    cfg.doubleMs = 250;
+    const Segment seg[] = {{0, 10}, {255, 100}, {0, 150}, {255, 100}, {0, 100}};
+    const uint8_t want[] = {GESTURE_PRESS, GESTURE_RELEASE, GESTURE_PRESS | GESTURE_DOUBLE, GESTURE_RELEASE};
+    failed += !Expect("双击", Replay(cfg, seg, 5), want, 4);
+    const Segment single[] = {{0, 10}, {255, 100}, {0, 400}};
+    const uint8_t wantSingle[] = {GESTURE_PRESS, GESTURE_RELEASE, GESTURE_SHORT};
+    failed += !Expect("开启双击时的单击", Replay(cfg, single, 3), wantSingle, 3);
+  }
+
+  // 长按重复：500ms 长按，再 300ms 后第一次 REPEAT，此后每 100ms 一次（按截止时刻累计，不漂移）
+  {
+    GestureConfig cfg = baseConfig;
+    cfg.repeatDelayMs = 300;
+    cfg.repeatMs = 100;
+    const Segment seg[] = {{0, 10}, {255, 1050}, {0, 100}};
+    const uint8_t want[] = {GESTURE_PRESS,  GESTURE_LONG,   GESTURE_REPEAT,
+                            GESTURE_REPEAT, GESTURE_REPEAT, GESTURE_RELEASE};
+    GestureLog log = Replay(cfg, seg, 3);
+    failed += !Expect("长按重复", log, want, 6);
+    if (log.count == 6 && (log.atMs[2] - log.atMs[0] != 800 || log.atMs[4] - log.atMs[2] != 200))
+    {
+      printf("[手势] 重复间隔错误 失败\n");
+      failed++;
+    }
+  }
+
+  // 翻页映射：提前翻页在踩下时就下一页，长按时补一次上一页撤销再上一页；非提前模式松开才下一页
+  {
+    PageKey keys[GESTURE_PAGE_KEYS_MAX];
+    int n = GesturePageKeys(GESTURE_PRESS, true, keys);
+    bool pass = n == 1 && keys[0] == PAGE_NEXT;
+    n = GesturePageKeys(GESTURE_LONG, true, keys);
+    pass = pass && n == 2 && keys[0] == PAGE_PREV && keys[1] == PAGE_PREV;
+    n = GesturePageKeys(GESTURE_RELEASE | GESTURE_SHORT, true, keys);
+    pass = pass && n == 0;
+    n = GesturePageKeys(GESTURE_PRESS, false, keys);
+    pass = pass && n == 0;
+    n = GesturePageKeys(GESTURE_RELEASE | GESTURE_SHORT, false, keys);
+    pass = pass && n == 1 && keys[0] == PAGE_NEXT;
+    n = GesturePageKeys(GESTURE_LONG | GESTURE_RELEASE, false, keys);
+    pass = pass && n == 1 && keys[0] == PAGE_PREV;
+    n = GesturePageKeys(GESTURE_REPEAT, true, keys);
+    pass = pass && n == 1 && keys[0] == PAGE_PREV;
+    printf("[手势] 翻页映射（提前/松开） %s\n", pass ? "通过" : "失败");
+    failed += !pass;
+  }
+
+  // 开销：每次采样调用一次，绝大多数调用没有边沿也没有到期
+  {
+    Gesture g;
+    GestureReset(g);
+    const int iters = 1000000;
+    volatile uint8_t sink = 0;
+    uint32_t t0 = halCycleCount();
+    for (int i = 0; i < iters; ++i)
+      sink = sink | GestureUpdate(g, baseConfig, (i >> 9) & 1 ? 255 : 0, (uint32_t)i + 1);
+    uint32_t cycles = halCycleCount() - t0;
+    printf("[手势] 每次更新 %.1fns\n", (double)cycles / iters);
+  }
+
+  printf("[手势] %s\n", failed ? "存在失败项" : "全部通过");
+  return failed;
+}
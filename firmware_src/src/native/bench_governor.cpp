@@ -0,0 +1,318 @@
+// bench_governor.cpp
+// 采样频率调节：在合成的演奏会话（1ms 分辨率的三路踏板电压）上回放调节策略，
+// 统计唤醒延迟（运动越过阈值 → 第一次全速采样，并与调节器写进 /metrics 的估计逐次对比）、误唤醒与平均采样率，
+// 按下面的功耗模型估算平均电流，对比固定 1kHz 采样，以及不同低频频率/降频等待时间的取舍
+#include <math.h>
+#include <stdio.h>
+#include <vector>
+#include <algorithm>
+#include "bench.h"
+#include "pedal_config.h"
+#include "sense_governor.h"
+
+// 功耗模型（ESP32 80MHz、无线关闭时的量级估计，只用于比较策略）：
+//   一次采样 + 滤波 + 输出的运行时间；loop() 每次唤醒的运行时间
+#define GOV_SAMPLE_BUSY_US 120
+#define GOV_LOOP_BUSY_US 60
+//   运行 / 空闲等待（自动降频）/ 轻睡眠 的电流（mA）
+#define GOV_RUN_MA 30.0
+#define GOV_WAIT_MA 12.0
+#define GOV_SLEEP_MA 1.0
+//   两次唤醒的间隔至少这么长才进入轻睡眠（tickless idle 的最小睡眠时间），每次从轻睡眠唤醒的额外运行时间
+#define GOV_SLEEP_MIN_US 3000
+#define GOV_WAKE_COST_US 400
+
+// 调节器估计的唤醒延迟与真实值的容差
+#define GOV_ESTIMATE_TOL_US 3000
+
+#define GOV_SESSION_MS (10 * 60 * 1000)
+#define GOV_NOISE_MV 10
+
+struct Session
+{
+  const char *name;
+  std::vector<int16_t> clean[PEDAL_COUNT]; // 无噪声的电压，用于确定真实的运动时刻
+  std::vector<int16_t> mv[PEDAL_COUNT];    // 叠加 ADC 噪声后送入调节器
+};
+
+static uint32_t NextRandom(uint32_t &state)
+{
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+static int RandomRange(uint32_t &rng, int lo, int hi) { return lo + (int)(NextRandom(rng) % (uint32_t)(hi - lo + 1)); }
+
+// 一个踏板的一段演奏：随机目标（松开/踩到底/半踏板），随机速度与停留时间
+static void Play(std::vector<int16_t> &out, int &level, int ms, uint32_t &rng)
+{
+  int target = level, rate = 1, hold = 0;
+  for (int i = 0; i < ms; ++i)
+  {
+    if (hold > 0)
+    {
+      hold--;
+    }
+    else if (level == target)
+    {
+      uint32_t r = NextRandom(rng);
+      target = r % 3 == 0 ? 600 : r % 3 == 1 ? 2400 : 600 + (int)((r >> 8) % 1800);
+      rate = RandomRange(rng, 1, 40); // mV/ms：约 50ms 到近 2s 走完全程
+      hold = RandomRange(rng, 30, 800);
+    }
+    else
+    {
+      int diff = target - level;
+      level += diff > rate ? rate : (diff < -rate ? -rate : diff);
+    }
+    out.push_back((int16_t)level);
+  }
+}
+
+// 静止：踏板停在当前位置（松开，或长音时一直踩住）
+static void Rest(std::vector<int16_t> &out, int level, int ms)
+{
+  out.insert(out.end(), (size_t)ms, (int16_t)level);
+}
+
+// phraseMs/restMs：演奏段与静止段的长度范围；softShare：弱音/持音参与演奏段的比例（%）
+static void BuildSession(Session &s, const char *name, uint32_t seed, int phraseLo, int phraseHi, int restLo, int restHi,
+                         int otherShare)
+{
+  s.name = name;
+  uint32_t rng = seed;
+  int level[PEDAL_COUNT] = {600, 600, 600};
+  int t = 0;
+  while (t < GOV_SESSION_MS)
+  {
+    int phrase = RandomRange(rng, phraseLo, phraseHi);
+    for (int i = 0; i < PEDAL_COUNT; ++i)
+    {
+      if (i == PEDAL_SUSTAIN || RandomRange(rng, 0, 99) < otherShare)
+        Play(s.clean[i], level[i], phrase, rng);
+      else
+        Rest(s.clean[i], level[i], phrase);
+    }
+    int rest = RandomRange(rng, restLo, restHi);
+    // 静止段里延音一半时间停在踩住的位置（长音），其余踏板保持原位
+    if (RandomRange(rng, 0, 1))
+      level[PEDAL_SUSTAIN] = 600;
+    for (int i = 0; i < PEDAL_COUNT; ++i)
+      Rest(s.clean[i], level[i], rest);
+    t += phrase + rest;
+  }
+  for (int i = 0; i < PEDAL_COUNT; ++i)
+  {
+    s.clean[i].resize(GOV_SESSION_MS);
+    s.mv[i].resize(GOV_SESSION_MS);
+    for (int k = 0; k < GOV_SESSION_MS; ++k)
+      s.mv[i][k] = (int16_t)(s.clean[i][k] + RandomRange(rng, -GOV_NOISE_MV, GOV_NOISE_MV));
+  }
+}
+
+struct GovernorResult
+{
+  double meanMa;        // 允许轻睡眠
+  double meanMaNoSleep; // 轻睡眠被阻止（抖动 DAC 持有 APB 锁）
+  double idlePct;       // 低频时间占比
+  double ratePct;       // 平均采样率 / 全速
+  int wakes;
+  int falseWakes; // 没有真实运动的唤醒（噪声越过阈值）
+  int missed;     // 两次低频采样之间开始又结束的运动（快速点踩），调节器没有看到
+  uint32_t latencyP50Us, latencyP99Us, latencyMaxUs;
+  int estimateOff;        // 调节器自己估计的唤醒延迟（/metrics 直方图）与真实值相差超过 GOV_ESTIMATE_TOL_US 的次数
+  uint32_t estimateErrUs; // 最大偏差
+  int estimates;          // 参与对比的次数，及两者的平均值
+  uint32_t estimateMeanUs, truthMeanUs;
+};
+
+// 一个采样周期内的电荷（mA·us）：active=false 时两次唤醒之间可以轻睡眠
+static double IntervalCharge(uint32_t periodUs, uint32_t loopPeriodUs, bool allowSleep)
+{
+  double loopWakes = (double)periodUs / loopPeriodUs;
+  double busy = GOV_SAMPLE_BUSY_US + loopWakes * GOV_LOOP_BUSY_US;
+  double window = periodUs / (1.0 + loopWakes);
+  if (allowSleep && window >= GOV_SLEEP_MIN_US)
+  {
+    double awake = busy + (1.0 + loopWakes) * GOV_WAKE_COST_US;
+    return awake * GOV_RUN_MA + (periodUs - awake) * GOV_SLEEP_MA;
+  }
+  return busy * GOV_RUN_MA + (periodUs - busy) * GOV_WAIT_MA;
+}
+
+static GovernorResult Simulate(const Session &s, const GovernorConfig &cfg, bool governed, GovernorStats *stats = nullptr)
+{
+  GovernorResult r = {};
+  SenseGovernor g;
+  GovernorReset(g);
+  std::vector<uint32_t> latencies;
+  double charge = 0, chargeNoSleep = 0;
+  uint32_t onsetUs = 0;
+  bool onset = false, pendingWake = false;
+  uint64_t wakeSumUs = 0;
+  uint32_t truthUs = 0;
+  uint64_t estimateSum = 0, truthSum = 0;
+  uint32_t t = 0;
+  const uint32_t endUs = (uint32_t)GOV_SESSION_MS * 1000;
+  while (t < endUs)
+  {
+    PedalFrame f = {};
+    f.timeUs = t;
+    int ms = t / 1000;
+    for (int i = 0; i < PEDAL_COUNT; ++i)
+      f.mv[i] = s.mv[i][ms];
+    bool wasIdle = GovernorIdle(g);
+    uint32_t period = governed ? GovernorUpdate(g, cfg, f) : cfg.activePeriodUs;
+    bool idle = GovernorIdle(g);
+
+    if (pendingWake)
+    {
+      // 恢复全速后的第一次采样
+      pendingWake = false;
+      if (onset)
+      {
+        truthUs = t - onsetUs;
+        latencies.push_back(truthUs);
+      }
+      else
+        r.falseWakes++;
+      onset = false;
+    }
+    if (wasIdle && idle && onset)
+    {
+      r.missed++;
+      onset = false;
+    }
+    if (g.stats.wakeSumUs != wakeSumUs)
+    {
+      // 调节器测速结束，记录了这一次的估计值：与真实值对比（误唤醒不计）
+      uint32_t estimate = (uint32_t)(g.stats.wakeSumUs - wakeSumUs);
+      uint32_t err = estimate > truthUs ? estimate - truthUs : truthUs - estimate;
+      if (truthUs)
+      {
+        r.estimates++;
+        estimateSum += estimate;
+        truthSum += truthUs;
+        r.estimateOff += err > GOV_ESTIMATE_TOL_US;
+        r.estimateErrUs = err > r.estimateErrUs ? err : r.estimateErrUs;
+      }
+      truthUs = 0;
+      wakeSumUs = g.stats.wakeSumUs;
+    }
+    if (wasIdle && !idle)
+    {
+      r.wakes++;
+      pendingWake = true;
+    }
+
+    if (idle)
+    {
+      // 在下一次采样之前的每一毫秒里找真实运动越过阈值的时刻（以调节器的静止参考为准）
+      for (uint32_t k = ms + 1; !onset && k < (t + period) / 1000 && k < (uint32_t)GOV_SESSION_MS; ++k)
+      {
+        for (int i = 0; i < PEDAL_COUNT; ++i)
+        {
+          int d = s.clean[i][k] - g.refMv[i];
+          if (d > cfg.motionMv + GOV_NOISE_MV || d < -cfg.motionMv - GOV_NOISE_MV)
+          {
+            onset = true;
+            onsetUs = k * 1000;
+          }
+        }
+      }
+    }
+
+    uint32_t loopPeriodUs = (idle ? Main_Loop_Idle_DelayMs : Main_Loop_DelayMs) * 1000;
+    charge += IntervalCharge(period, loopPeriodUs, idle);
+    chargeNoSleep += IntervalCharge(period, loopPeriodUs, false);
+    t += period;
+  }
+
+  r.meanMa = charge / endUs;
+  r.meanMaNoSleep = chargeNoSleep / endUs;
+  const GovernorStats &st = g.stats;
+  uint64_t total = st.activeUs + st.idleUs;
+  r.idlePct = governed && total ? 100.0 * st.idleUs / total : 0;
+  r.ratePct = governed && total ? 100.0 * (st.activeSamples + st.idleSamples) * cfg.activePeriodUs / total : 100;
+  if (r.estimates)
+  {
+    r.estimateMeanUs = (uint32_t)(estimateSum / r.estimates);
+    r.truthMeanUs = (uint32_t)(truthSum / r.estimates);
+  }
+  std::sort(latencies.begin(), latencies.end());
+  if (!latencies.empty())
+  {
+    r.latencyP50Us = latencies[latencies.size() / 2];
+    r.latencyP99Us = latencies[latencies.size() * 99 / 100];
+    r.latencyMaxUs = latencies.back();
+  }
+  if (stats)
+    *stats = st;
+  return r;
+}
+
+static GovernorConfig MakeConfig(uint32_t idleHz, uint32_t idleAfterMs)
+{
+  GovernorConfig cfg = {1000000U / Sense_Rate_Hz, 1000000U / idleHz, idleAfterMs * 1000U, Sense_Motion_Mv};
+  return cfg;
+}
+
+int BenchGovernor()
+{
+  int failed = 0;
+  static Session sessions[3];
+  BuildSession(sessions[0], "练习（乐句间停顿）", 11, 8000, 60000, 2000, 40000, 30);
+  BuildSession(sessions[1], "演奏（几乎不停）", 23, 60000, 180000, 500, 3000, 40);
+  BuildSession(sessions[2], "待机（偶尔碰到）", 37, 300, 2000, 60000, 180000, 0);
+
+  const GovernorConfig def = MakeConfig(Sense_Idle_Rate_Hz, Sense_Idle_After_Ms);
+  printf("[调节] 功耗模型：运行 %.0fmA / 等待 %.0fmA / 轻睡眠 %.0fmA，每次采样 %dus、唤醒 %dus（估计值，仅用于比较）\n",
+         GOV_RUN_MA, GOV_WAIT_MA, GOV_SLEEP_MA, GOV_SAMPLE_BUSY_US, GOV_WAKE_COST_US);
+  for (const Session &s : sessions)
+  {
+    GovernorResult fixed = Simulate(s, def, false);
+    GovernorResult r = Simulate(s, def, true);
+    printf("[调节] %-12s 固定 %dHz %.1fmA → 调节 %.1fmA（轻睡眠被抖动 DAC 阻止时 %.1fmA）| 低频 %.0f%% 平均采样率 %.1f%% | "
+           "唤醒 %d 次（误唤醒 %d，漏检 %d）延迟 p50 %.1fms p99 %.1fms 最大 %.1fms | 调节器估计 平均 %.1fms（真实 %.1fms），偏差 >%dms %d/%d 次，最大 %.1fms\n",
+           s.name, Sense_Rate_Hz, fixed.meanMa, r.meanMa, r.meanMaNoSleep, r.idlePct, r.ratePct, r.wakes, r.falseWakes,
+           r.missed, r.latencyP50Us / 1000.0, r.latencyP99Us / 1000.0, r.latencyMaxUs / 1000.0, r.estimateMeanUs / 1000.0,
+           r.truthMeanUs / 1000.0, GOV_ESTIMATE_TOL_US / 1000, r.estimateOff, r.estimates, r.estimateErrUs / 1000.0);
+    // 最坏唤醒延迟不超过一个低频周期 + 一个全速周期；默认参数下没有漏检，误唤醒不超过唤醒的一成（另加 1 次余量）；
+    // /metrics 的估计值平均与真实值相差不超过容差，单次不超过半个低频周期
+    uint32_t meanErr = r.estimateMeanUs > r.truthMeanUs ? r.estimateMeanUs - r.truthMeanUs : r.truthMeanUs - r.estimateMeanUs;
+    bool pass = r.latencyMaxUs <= def.idlePeriodUs + def.activePeriodUs && r.meanMa <= fixed.meanMa && r.missed == 0 &&
+                r.falseWakes * 10 <= r.wakes + 10 && r.estimates > 0 && meanErr <= GOV_ESTIMATE_TOL_US &&
+                r.estimateErrUs <= def.idlePeriodUs / 2;
+    failed += !pass;
+  }
+
+  // 取舍：低频频率 × 降频等待时间（练习会话）
+  printf("[调节] 练习会话的取舍（平均电流 mA / 最坏唤醒延迟 ms / 漏检的快速点踩）：\n");
+  const uint32_t idleHz[] = {10, 25, 50, 100};
+  const uint32_t afterMs[] = {500, 2000, 5000};
+  printf("[调节]   低频\\等待");
+  for (uint32_t a : afterMs)
+    printf("  %5ums         ", (unsigned)a);
+  printf("\n");
+  for (uint32_t hz : idleHz)
+  {
+    printf("[调节]   %4uHz   ", (unsigned)hz);
+    for (uint32_t a : afterMs)
+    {
+      GovernorResult r = Simulate(sessions[0], MakeConfig(hz, a), true);
+      printf("  %5.2f / %5.1f / %d", r.meanMa, r.latencyMaxUs / 1000.0, r.missed);
+    }
+    printf("\n");
+  }
+
+  // 报告格式
+  GovernorStats stats;
+  Simulate(sessions[0], def, true, &stats);
+  static char text[256];
+  GovernorFormat(text, sizeof(text), stats, Sense_Rate_Hz);
+  printf("[调节] /metrics 报告（练习会话）：\n%s", text);
+  printf("[调节] %s\n", failed ? "存在失败项" : "全部通过");
+  return failed;
+}
@@ -0,0 +1,134 @@
+// bench_hid.cpp
+// 翻页按键发送队列：合并、满载丢弃、过期丢弃、入队 → 发出延迟，以及双线程下的顺序与不丢失
+#include <atomic>
+#include <stdio.h>
+#include <thread>
+#include "bench.h"
+#include "hid_queue.h"
+#include "pedal_config.h"
+#include "pedal_hal.h"
+#include "sample_ring.h"
+
+#define HID_KEY_NEXT 0xD6
+#define HID_KEY_PREV 0xD3
+#define BENCH_HID_EVENTS 200000
+
+// 消费者在 nowUs 时刻把队列中的事件全部发出，每个事件占用协议栈 costUs
+static int Drain(uint32_t &nowUs, uint32_t costUs)
+{
+  HidEvent ev;
+  int n = 0;
+  while (HidQueuePop(ev, nowUs))
+  {
+    nowUs += costUs;
+    HidQueueDone(ev, true, nowUs);
+    n++;
+  }
+  return n;
+}
+
+// 双线程（模拟 loop() 与 HID 任务）：事件不丢失、不重复、按入队顺序发出
+static int ThreadedCheck()
+{
+  HidQueueReset();
+  std::atomic<bool> done{false};
+  std::atomic<uint32_t> clockUs{0};
+  bool ordered = true;
+  uint32_t popped = 0;
+
+  std::thread consumer([&]() {
+    HidEvent ev;
+    uint32_t lastUs = 0;
+    for (;;)
+    {
+      bool finished = done.load(std::memory_order_acquire);
+      while (HidQueuePop(ev, clockUs.load(std::memory_order_relaxed)))
+      {
+        if (popped && ev.enqueueUs <= lastUs)
+          ordered = false;
+        lastUs = ev.enqueueUs;
+        HidQueueDone(ev, true, clockUs.load(std::memory_order_relaxed));
+        popped++;
+      }
+      if (finished)
+        break;
+      std::this_thread::yield();
+    }
+  });
+
+  // 生产者：两个按键交替（不触发合并），虚拟时间每个事件 20ms；队列满时等待消费者，
+  // 因此全部事件都应发出，且排队时间不会超过过期时间
+  uint32_t t0 = halCycleCount();
+  for (int i = 0; i < BENCH_HID_EVENTS; ++i)
+  {
+    uint32_t now = 1 + (uint32_t)i * 20000u;
+    clockUs.store(now, std::memory_order_relaxed);
+    while (HidQueuePending() >= HID_QUEUE_SIZE)
+      std::this_thread::yield();
+    HidQueuePush((i & 1) ? HID_KEY_PREV : HID_KEY_NEXT, now);
+  }
+  done.store(true, std::memory_order_release);
+  consumer.join();
+  uint32_t cycles = halCycleCount() - t0;
+
+  HidQueueStats s;
+  HidQueueReadStats(s);
+  bool pass = ordered && s.queued == BENCH_HID_EVENTS && s.sent == BENCH_HID_EVENTS && popped == s.sent &&
+              s.dropped == 0 && s.stale == 0;
+  printf("[翻页队列] 双线程 %d 个事件：发出 %u，丢弃 %u，过期 %u，顺序%s %s，平均每个事件 %.0fns\n",
+         BENCH_HID_EVENTS, (unsigned)s.sent, (unsigned)s.dropped, (unsigned)s.stale, ordered ? "正确" : "错误",
+         pass ? "通过" : "失败", (double)cycles / BENCH_HID_EVENTS);
+  return pass ? 0 : 1;
+}
+
+int BenchHidQueue()
+{
+  int failed = 0;
+  HidQueueStats s;
+  uint32_t now = 1000000;
+
+  // 正常：每个事件在一个 BLE 连接间隔（7.5ms）后发出
+  HidQueueReset();
+  HidQueuePush(HID_KEY_NEXT, now);
+  now += 7500;
+  Drain(now, 0);
+  HidQueueReadStats(s);
+  printf("[翻页队列] 正常发送：%u 个，延迟 %uus\n", (unsigned)s.sent, (unsigned)s.latencyMaxUs);
+
+  // 踏板抖动：40ms 内重复触发同一按键，前一个尚未发出 → 合并；不同按键不合并
+  HidQueueReset();
+  HidQueuePush(HID_KEY_NEXT, now);
+  HidQueuePush(HID_KEY_NEXT, now + 40000);
+  HidQueuePush(HID_KEY_PREV, now + 60000);
+  now += 70000;
+  int sent = Drain(now, 1000);
+  HidQueueReadStats(s);
+  bool pass = sent == 2 && s.coalesced == 1;
+  printf("[翻页队列] 抖动合并：入队 3 次 → 发出 %d 个，合并 %u 个 %s\n", sent, (unsigned)s.coalesced,
+         pass ? "通过" : "失败");
+  failed += !pass;
+
+  // 协议栈拥塞 3 秒：期间每 250ms 翻一页（12 次），超出队列容量的按 Hid_Queue_Policy 丢弃；
+  // 恢复后等待超过 Hid_Max_Age_Ms 的不再补发。loop() 在整个拥塞期间不受影响（入队为几十纳秒）
+  HidQueueReset();
+  uint32_t stallStart = now;
+  for (int i = 0; i < 12; ++i)
+    HidQueuePush(HID_KEY_NEXT, stallStart + (uint32_t)i * 250000u);
+  now = stallStart + 3000000;
+  sent = Drain(now, 2000);
+  HidQueueReadStats(s);
+  // 保留的是最早 8 个（丢弃新事件）或最近 8 个（覆盖旧事件）
+  int first = Hid_Queue_Policy == RING_DROP_NEWEST ? 0 : 12 - HID_QUEUE_SIZE;
+  int expectSent = 0;
+  for (int i = first; i < first + HID_QUEUE_SIZE; ++i)
+    expectSent += (3000000u - (uint32_t)i * 250000u <= Hid_Max_Age_Ms * 1000u) ? 1 : 0;
+  pass = s.dropped == 12 - HID_QUEUE_SIZE && sent == expectSent && (int)s.stale == HID_QUEUE_SIZE - expectSent;
+  printf("[翻页队列] 拥塞 3s 期间 12 次翻页（%s）：丢弃 %u 过期 %u 发出 %d，最大延迟 %uus %s\n",
+         Hid_Queue_Policy == RING_DROP_NEWEST ? "丢弃新事件" : "覆盖旧事件", (unsigned)s.dropped,
+         (unsigned)s.stale, sent, (unsigned)s.latencyMaxUs, pass ? "通过" : "失败");
+  failed += !pass;
+
+  failed += ThreadedCheck();
+  HidQueueReset();
+  return failed;
+}
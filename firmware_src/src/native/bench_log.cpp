@@ -0,0 +1,336 @@
+// bench_log.cpp
+// 采样记录：按 log_task.cpp 的方式抽样编码并写入模拟的闪存分区（环形覆盖），再按网页下载的顺序取出、用主机解码器还原，
+// 检查往返一致（含 32 位时刻回绕与校准范围变化）、重启后续写、损坏/截断的块被跳过；
+// 统计静止/演奏时每条记录的字节数、512KB 分区能回看多久与每个扇区的擦写间隔，以及每帧的编码开销
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "bench.h"
+#include "log_tool.h"
+#include "pedal_config.h"
+#include "pedal_filter.h"
+#include "pedal_hal.h"
+#include "sample_log.h"
+#include "trace.h"
+
+// 分区 0x80000 = 128 块；往返测试用小分区，让环形覆盖多次发生
+#define LOG_PARTITION_BLOCKS 128
+#define LOG_SMALL_BLOCKS 16
+#define LOG_NOISE_MV 8
+// 未压缩的定长记录：uint32 时刻 + 12 个 int16 字段
+#define LOG_RAW_RECORD_BYTES (4 + PEDAL_COUNT * 4 * 2)
+// 闪存扇区的擦写寿命（次）
+#define LOG_FLASH_CYCLES 100000
+
+struct FlashSim
+{
+  std::vector<uint8_t> data;
+  uint32_t blocks;
+};
+
+static void FlashInit(FlashSim &f, uint32_t blocks)
+{
+  f.blocks = blocks;
+  f.data.assign((size_t)blocks * SAMPLE_LOG_BLOCK_SIZE, 0xFF);
+}
+
+static bool FlashReadBlock(void *ctx, uint32_t index, SampleLogHeader &h)
+{
+  FlashSim &f = *(FlashSim *)ctx;
+  return SampleLogHeaderRead(&f.data[(size_t)index * SAMPLE_LOG_BLOCK_SIZE], h);
+}
+
+// 与 log_task.cpp 相同的抽样与换块逻辑（写入任务换成直接写模拟闪存）
+struct Recorder
+{
+  FlashSim *flash;
+  SampleLogRing ring;
+  SampleLogWriter w;
+  uint32_t nextUs;
+  bool nextValid;
+  uint32_t records;
+  uint32_t sealed;
+  uint64_t bytes; // 已写满块的负载 + 块头
+};
+
+static void RecorderBegin(Recorder &r, FlashSim &f)
+{
+  r.flash = &f;
+  SampleLogRingScan(r.ring, f.blocks, FlashReadBlock, &f);
+  SampleLogBegin(r.w, r.ring.seq, r.ring.session);
+  r.nextValid = false;
+  r.records = 0;
+  r.sealed = 0;
+  r.bytes = 0;
+}
+
+static bool RecorderFrame(Recorder &r, const PedalFrame &frame, uint32_t periodUs)
+{
+  if (!r.nextValid)
+  {
+    r.nextUs = frame.timeUs;
+    r.nextValid = true;
+  }
+  if (!SampleLogDue(r.nextUs, frame.timeUs, periodUs))
+    return false;
+  if (!SampleLogAppend(r.w, frame))
+  {
+    uint32_t index = SampleLogRingTake(r.ring);
+    SampleLogSeal(r.w, &r.flash->data[(size_t)index * SAMPLE_LOG_BLOCK_SIZE]);
+    r.sealed++;
+    r.bytes += SAMPLE_LOG_HEADER_SIZE + r.w.header.used;
+    SampleLogNext(r.w);
+    SampleLogAppend(r.w, frame);
+  }
+  r.records++;
+  return true;
+}
+
+// 与 LogTaskRead 相同的顺序：从最旧的块开始，最后是当前块的快照
+static Bytes RecorderDownload(Recorder &r)
+{
+  Bytes out;
+  SampleLogHeader h;
+  for (uint32_t k = 0; k < r.ring.blocks; ++k)
+  {
+    uint32_t index = (r.ring.next + k) % r.ring.blocks;
+    const uint8_t *block = &r.flash->data[(size_t)index * SAMPLE_LOG_BLOCK_SIZE];
+    if (SampleLogHeaderRead(block, h))
+      out.insert(out.end(), block, block + SAMPLE_LOG_BLOCK_SIZE);
+  }
+  uint8_t snap[SAMPLE_LOG_BLOCK_SIZE];
+  if (SampleLogSeal(r.w, snap))
+    out.insert(out.end(), snap, snap + SAMPLE_LOG_BLOCK_SIZE);
+  return out;
+}
+
+// 帧来源：三个踏板的合成轨迹（5ms 一点，按采样时刻线性插值）加 ADC 噪声，映射值经过固件的滤波器，
+// 校准范围每 20 秒漂移 1mV（模拟漂移跟踪），采样间隔带 ±30us 抖动
+struct FrameSource
+{
+  std::vector<int> trace[PEDAL_COUNT];
+  PedalFilter filter[PEDAL_COUNT];
+  uint32_t rng;
+  uint32_t timeUs;
+  uint64_t elapsedUs;
+  bool playing;
+};
+
+static void SourceInit(FrameSource &s, bool playing, uint32_t startUs, int seconds)
+{
+  int points = seconds * 1000 / Main_Loop_DelayMs + 2;
+  for (int i = 0; i < PEDAL_COUNT; ++i)
+  {
+    s.trace[i].resize(points);
+    TraceGenerate(s.trace[i].data(), points, 101 + i * 7, 0);
+    PedalFilter f = {};
+    s.filter[i] = f;
+  }
+  s.rng = 12345;
+  s.timeUs = startUs;
+  s.elapsedUs = 0;
+  s.playing = playing;
+}
+
+static PedalFrame SourceNext(FrameSource &s, uint32_t periodUs)
+{
+  PedalFrame f = {};
+  s.rng = s.rng * 1103515245u + 12345u;
+  int jitter = (int)((s.rng >> 16) % 61) - 30;
+  f.timeUs = s.timeUs + jitter;
+  double pos = (double)s.elapsedUs / (Main_Loop_DelayMs * 1000);
+  size_t k = (size_t)pos;
+  int drift = (int)(s.elapsedUs / 20000000);
+  for (int i = 0; i < PEDAL_COUNT; ++i)
+  {
+    int level = TRACE_REST_MV;
+    if (s.playing && k + 1 < s.trace[i].size())
+      level = (int)(s.trace[i][k] + (s.trace[i][k + 1] - s.trace[i][k]) * (pos - k));
+    s.rng = s.rng * 1103515245u + 12345u;
+    f.mv[i] = level + (int)((s.rng >> 16) % (2 * LOG_NOISE_MV + 1)) - LOG_NOISE_MV;
+    f.minv[i] = TRACE_REST_MV + drift;
+    f.maxv[i] = TRACE_PRESSED_MV - drift;
+    PedalFilterSetRange(s.filter[i], f.minv[i], f.maxv[i], 0.05f);
+    f.value[i] = PedalFilterUpdate(s.filter[i], f.mv[i]);
+    f.fine[i] = f.value[i] << 8;
+  }
+  s.timeUs += periodUs;
+  s.elapsedUs += periodUs;
+  return f;
+}
+
+static bool FrameEqual(const PedalFrame &a, const PedalFrame &b)
+{
+  for (int i = 0; i < PEDAL_COUNT; ++i)
+  {
+    if (a.mv[i] != b.mv[i] || a.value[i] != b.value[i] || a.minv[i] != b.minv[i] || a.maxv[i] != b.maxv[i])
+      return false;
+  }
+  return true;
+}
+
+// 记录下来的帧（期望值）：时刻量化到 tick
+struct Expected
+{
+  uint64_t timeUs;
+  PedalFrame frame;
+};
+
+// decoded 应当是 expected 的一段连续尾部（环形覆盖掉了最旧的部分）；返回匹配的起点，不一致时返回 -1
+static long MatchTail(const std::vector<LogSample> &decoded, size_t from, size_t count,
+                      const std::vector<Expected> &expected)
+{
+  if (count == 0 || count > expected.size())
+    return -1;
+  size_t start = expected.size() - count;
+  for (size_t i = 0; i < count; ++i)
+  {
+    const LogSample &d = decoded[from + i];
+    const Expected &e = expected[start + i];
+    if (d.timeUs != e.timeUs || d.frame.timeUs != (uint32_t)e.timeUs || !FrameEqual(d.frame, e.frame))
+      return -1;
+  }
+  return (long)start;
+}
+
+int BenchLog()
+{
+  int failed = 0;
+  char detail[160];
+  static FlashSim flash;
+  static Recorder rec;
+  static FrameSource src;
+  const uint32_t periodUs = 1000000 / Sample_Log_Rate_Hz;
+
+  // 往返：16 块的小分区覆盖多次；起始时刻在 32 位回绕前 3 秒
+  FlashInit(flash, LOG_SMALL_BLOCKS);
+  RecorderBegin(rec, flash);
+  SourceInit(src, true, 0xFFFFFFFFu - 3000000u, 600);
+  std::vector<Expected> expected;
+  uint64_t ext = 0;
+  bool extStarted = false;
+  uint32_t lastUs = 0;
+  for (uint32_t t = 0; t < 600u * 1000000u; t += 1000)
+  {
+    PedalFrame f = SourceNext(src, 1000);
+    if (!RecorderFrame(rec, f, periodUs))
+      continue;
+    ext = extStarted ? ext + (uint32_t)(f.timeUs - lastUs) : f.timeUs;
+    extStarted = true;
+    lastUs = f.timeUs;
+    Expected e = {ext / SAMPLE_LOG_TICK_US * SAMPLE_LOG_TICK_US, f};
+    expected.push_back(e);
+  }
+  {
+    std::vector<LogSample> decoded;
+    int bad = 0;
+    Bytes download = RecorderDownload(rec);
+    int blocks = LogDecode(download, decoded, &bad);
+    long start = MatchTail(decoded, 0, decoded.size(), expected);
+    double coveredS = decoded.empty() ? 0 : (decoded.back().timeUs - decoded.front().timeUs) / 1e6;
+    bool wrapped = !decoded.empty() && decoded.back().timeUs > 0xFFFFFFFFull;
+    bool pass = start >= 0 && bad == 0 && blocks == LOG_SMALL_BLOCKS + 1 && wrapped;
+    snprintf(detail, sizeof(detail), "%u 帧中保留最近 %u 帧（%.1f 秒，%d 块），时刻跨过 32 位回绕", (unsigned)expected.size(),
+             (unsigned)decoded.size(), coveredS, blocks);
+    failed += BenchReport("记录", "往返", pass, detail);
+  }
+
+  // 重启：当前块未写满的部分丢失，新的开机从最新块之后续写
+  {
+    uint32_t lastSealedSeq = rec.w.header.seq - 1;
+    uint16_t oldSession = rec.ring.session;
+    // 重启前最后一个写满的块中的最后一帧
+    size_t lostTail = rec.w.header.count;
+    Expected lastSealed = expected[expected.size() - 1 - lostTail];
+    RecorderBegin(rec, flash);
+    bool resumed = rec.ring.seq == lastSealedSeq + 1 && rec.ring.session == oldSession + 1 &&
+                   rec.ring.valid == LOG_SMALL_BLOCKS;
+    SourceInit(src, true, 5000000, 30);
+    std::vector<Expected> expected2;
+    extStarted = false;
+    for (uint32_t t = 0; t < 30u * 1000000u; t += 1000)
+    {
+      PedalFrame f = SourceNext(src, 1000);
+      if (!RecorderFrame(rec, f, periodUs))
+        continue;
+      ext = extStarted ? ext + (uint32_t)(f.timeUs - lastUs) : f.timeUs;
+      extStarted = true;
+      lastUs = f.timeUs;
+      Expected e = {ext / SAMPLE_LOG_TICK_US * SAMPLE_LOG_TICK_US, f};
+      expected2.push_back(e);
+    }
+    std::vector<LogSample> decoded;
+    LogDecode(RecorderDownload(rec), decoded);
+    size_t firstNew = 0;
+    while (firstNew < decoded.size() && decoded[firstNew].session == oldSession)
+      firstNew++;
+    // 旧开机的帧止于最后一个写满的块，新开机的帧完整
+    bool oldOk = firstNew > 0 && decoded[firstNew - 1].timeUs == lastSealed.timeUs &&
+                 FrameEqual(decoded[firstNew - 1].frame, lastSealed.frame);
+    bool newOk = MatchTail(decoded, firstNew, decoded.size() - firstNew, expected2) == 0;
+    bool pass = resumed && oldOk && newOk;
+    snprintf(detail, sizeof(detail), "续写块序号 %u、开机序号 %u，丢失重启前未写满的 %u 帧", (unsigned)rec.ring.seq,
+             (unsigned)rec.ring.session, (unsigned)lostTail);
+    failed += BenchReport("记录", "重启续写", pass, detail);
+  }
+
+  // 损坏：一块中翻转一个字节、下载被截断，只丢掉相应的块
+  {
+    Bytes download = RecorderDownload(rec);
+    std::vector<LogSample> all, damaged;
+    int blocks = LogDecode(download, all);
+    Bytes bad = download;
+    bad[3 * SAMPLE_LOG_BLOCK_SIZE + 1000] ^= 0x10;
+    bad.resize(bad.size() - 100);
+    int badCount = 0;
+    int left = LogDecode(bad, damaged, &badCount);
+    SampleLogHeader h3, hLast;
+    SampleLogHeaderRead(&download[3 * SAMPLE_LOG_BLOCK_SIZE], h3);
+    SampleLogHeaderRead(&download[download.size() - SAMPLE_LOG_BLOCK_SIZE], hLast);
+    // 已擦除的块（0xFF）不是有效块
+    SampleLogHeader h;
+    uint8_t erased[SAMPLE_LOG_BLOCK_SIZE];
+    memset(erased, 0xFF, sizeof(erased));
+    bool pass = badCount == 1 && left == blocks - 2 && damaged.size() == all.size() - h3.count - hLast.count &&
+                !SampleLogHeaderRead(erased, h);
+    snprintf(detail, sizeof(detail), "%d 块中跳过 1 块损坏、1 块截断，其余 %d 块完整解码", blocks, left);
+    failed += BenchReport("记录", "损坏与截断", pass, detail);
+  }
+
+  // 记录大小与闪存擦写：128 块（512KB）的分区，10 分钟
+  printf("[记录] 每条记录（定长 %d 字节）：\n", LOG_RAW_RECORD_BYTES);
+  const uint32_t rates[] = {Sample_Log_Rate_Hz, Sense_Rate_Hz};
+  for (uint32_t rate : rates)
+  {
+    for (int playing = 0; playing < 2; ++playing)
+    {
+      FlashInit(flash, LOG_PARTITION_BLOCKS);
+      RecorderBegin(rec, flash);
+      SourceInit(src, playing != 0, 0, 600);
+      // 帧按 1000 个一批预先生成，只计抽样与编码的时间
+      static PedalFrame batch[1000];
+      uint64_t cycles = 0;
+      for (uint32_t n = 0; n < 600 * rate; n += 1000)
+      {
+        for (int i = 0; i < 1000; ++i)
+          batch[i] = SourceNext(src, 1000000 / rate);
+        uint32_t t0 = halCycleCount();
+        for (int i = 0; i < 1000; ++i)
+          RecorderFrame(rec, batch[i], 1000000 / rate);
+        cycles += halCycleCount() - t0;
+      }
+      double perRecord = (double)rec.bytes / (rec.records - rec.w.header.count);
+      double historyS = (double)LOG_PARTITION_BLOCKS * SAMPLE_LOG_BLOCK_SIZE / (perRecord * rate);
+      double lifeYears = LOG_FLASH_CYCLES * historyS / (3600.0 * 24 * 365);
+      printf("[记录]   %4uHz %s %.2f 字节（压缩 %.1f 倍），512KB 回看 %.1f 分钟 = 每个扇区的擦写间隔，"
+             "%d 次寿命约 %.1f 年连续记录；抽样+编码 %.0fns/帧\n",
+             (unsigned)rate, playing ? "演奏" : "静止", perRecord, LOG_RAW_RECORD_BYTES / perRecord, historyS / 60,
+             LOG_FLASH_CYCLES, lifeYears, (double)cycles / (600.0 * rate));
+      if (rate == Sample_Log_Rate_Hz && playing)
+        failed += perRecord > 8;
+    }
+  }
+
+  printf("[记录] %s\n", failed ? "存在失败项" : "全部通过");
+  return failed;
+}
@@ -0,0 +1,378 @@
+// bench_midi.cpp
+// BLE-MIDI 打包：与规范逐字节对照、运行状态与时间戳压缩、分包边界，并按规范解码回放校验；
+// 半踏板扫动时对比“每次变化单独通知”与“每次循环一个通知”的通知数与空中字节数
+// 串口 MIDI：运行状态字节流的逐字节对照与解析回放，以及按 31250 波特逐字节模拟的最坏延迟
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "midi_codec.h"
+#include "pedal_config.h"
+
+struct MidiEvent
+{
+  uint16_t timeMs;
+  uint8_t status;
+  uint8_t cc;
+  uint8_t value;
+};
+
+// 按 BLE-MIDI 1.0 解码（只处理 2 数据字节的通道消息），返回事件数，格式错误返回 -1
+static int DecodeBleMidi(const uint8_t *buf, size_t len, MidiEvent *out, int max)
+{
+  if (len < 2 || !(buf[0] & 0x80) || (buf[0] & 0x40))
+    return -1;
+  uint16_t high = (uint16_t)(buf[0] & 0x3F);
+  uint8_t lastLow = 0;
+  uint16_t time = 0;
+  uint8_t status = 0;
+  bool haveTime = false;
+  int n = 0;
+  size_t i = 1;
+  while (i < len)
+  {
+    if (buf[i] & 0x80)
+    {
+      // 时间戳字节；低 7 位比上一个小时高位进 1
+      uint8_t low = buf[i++] & 0x7F;
+      if (haveTime && low < lastLow)
+        high = (uint16_t)((high + 1) & 0x3F);
+      lastLow = low;
+      time = (uint16_t)((high << 7) | low);
+      haveTime = true;
+      if (i < len && (buf[i] & 0x80))
+        status = buf[i++];
+    }
+    if (!haveTime || status == 0 || i + 2 > len || (buf[i] & 0x80) || (buf[i + 1] & 0x80) || n >= max)
+      return -1;
+    out[n++] = {time, status, buf[i], buf[i + 1]};
+    i += 2;
+  }
+  return n;
+}
+
+static bool Same(const BleMidiPacket &p, const uint8_t *want, size_t len)
+{
+  return p.len == len && memcmp(p.buf, want, len) == 0;
+}
+
+static void PrintPacket(const char *name, const BleMidiPacket &p, bool pass)
+{
+  printf("[MIDI] %s：", name);
+  for (int i = 0; i < p.len; ++i)
+    printf("%02X ", p.buf[i]);
+  printf("（%u 字节）%s\n", (unsigned)p.len, pass ? "通过" : "失败");
+}
+
+static void MakeFrame(PedalFrame &f, uint32_t timeUs, int sustain, int sostenuto, int soft)
+{
+  memset(&f, 0, sizeof(f));
+  f.timeUs = timeUs;
+  f.value[PEDAL_SUSTAIN] = sustain;
+  f.value[PEDAL_SOSTENUTO] = sostenuto;
+  f.value[PEDAL_SOFT] = soft;
+}
+
+// 串口 MIDI 字节流解析（运行状态），把每条控制器消息的值写入 value[]，返回消息数；遇到非法字节返回 -1
+static int ParseSerialMidi(const uint8_t *buf, size_t len, uint8_t &status, int value[PEDAL_COUNT], int &statusBytes)
+{
+  int n = 0;
+  size_t i = 0;
+  while (i < len)
+  {
+    if (buf[i] & 0x80)
+    {
+      status = buf[i++];
+      statusBytes++;
+      continue;
+    }
+    if ((status & 0xF0) != MIDI_STATUS_CC || i + 2 > len || (buf[i + 1] & 0x80))
+      return -1;
+    for (int k = 0; k < PEDAL_COUNT; ++k)
+      if (buf[i] == midiPedalCc[k])
+        value[k] = buf[i + 1];
+    i += 2;
+    n++;
+  }
+  return n;
+}
+
+// 串口 MIDI：逐字节对照，以及与固件相同的时序（1kHz 采样、每 Main_Loop_DelayMs 一次 loop()、
+// 间隔 Midi_Uart_Interval_Ms 限速、每字节 320us 发出）下测量踏板变化 → 最后一位发出的延迟
+static int BenchMidiSerial()
+{
+  int failed = 0;
+  MidiSerialState s;
+  uint8_t buf[MIDI_SERIAL_BATCH_MAX];
+
+  {
+    MidiSerialReset(s);
+    MidiCc three[PEDAL_COUNT] = {{MIDI_CC_SUSTAIN, 100, 0}, {MIDI_CC_SOSTENUTO, 0, 0}, {MIDI_CC_SOFT, 127, 0}};
+    size_t a = MidiSerialEncode(s, 0, three, 3, 10, buf, sizeof(buf));
+    const uint8_t wantA[] = {0xB0, 64, 100, 66, 0, 67, 127};
+    bool pass = a == sizeof(wantA) && memcmp(buf, wantA, a) == 0;
+    // 运行状态：同一通道只发数据字节
+    size_t b = MidiSerialEncode(s, 0, three, 1, 20, buf, sizeof(buf));
+    pass = pass && b == 2 && buf[0] == 64 && buf[1] == 100;
+    // 超过刷新间隔重发状态；换通道也重发
+    size_t c = MidiSerialEncode(s, 0, three, 1, 10 + MIDI_STATUS_REFRESH_MS, buf, sizeof(buf));
+    pass = pass && c == 3 && buf[0] == 0xB0;
+    size_t d = MidiSerialEncode(s, 5, three, 1, 20 + MIDI_STATUS_REFRESH_MS, buf, sizeof(buf));
+    pass = pass && d == 3 && buf[0] == 0xB5;
+    // 缓冲不足：不写入、不改变运行状态
+    MidiSerialState before = s;
+    size_t e = MidiSerialEncode(s, 0, three, 3, 30 + MIDI_STATUS_REFRESH_MS, buf, 6);
+    pass = pass && e == 0 && s.status == before.status && s.statusMs == before.statusMs;
+    printf("[串口MIDI] 运行状态编码：首批 %u 字节，续发 %u 字节，刷新 %u 字节，换通道 %u 字节 %s\n", (unsigned)a,
+           (unsigned)b, (unsigned)c, (unsigned)d, pass ? "通过" : "失败");
+    failed += !pass;
+  }
+
+  // 60 秒随机演奏：每个踏板随机停留后以随机速度移动到新位置，物理变化发生在采样前 0-999us 内
+  {
+    const uint32_t simMs = 60000;
+    const uint32_t samplePeriodUs = 1000000 / Sense_Rate_Hz;
+    srand(12345);
+    MidiCcTracker t;
+    MidiCcReset(t);
+    MidiSerialReset(s);
+    int value[PEDAL_COUNT] = {0, 0, 0}, target[PEDAL_COUNT] = {0, 0, 0}, speed[PEDAL_COUNT] = {1, 1, 1};
+    int lastSeven[PEDAL_COUNT] = {-1, -1, -1};
+    uint32_t changeUs[PEDAL_COUNT] = {0, 0, 0};
+    int received[PEDAL_COUNT] = {-1, -1, -1};
+    uint8_t rxStatus = 0;
+    int statusBytes = 0, messages = 0;
+    uint32_t bytes = 0, lineFreeUs = 0, lastSendMs = 0, maxLatencyUs[PEDAL_COUNT] = {0, 0, 0};
+    bool parsed = true;
+
+    for (uint32_t ms = 1; ms <= simMs; ++ms)
+    {
+      uint32_t nowUs = ms * 1000;
+      PedalFrame f;
+      memset(&f, 0, sizeof(f));
+      f.timeUs = nowUs;
+      for (int p = 0; p < PEDAL_COUNT; ++p)
+      {
+        if (value[p] == target[p] && rand() % 200 == 0)
+        {
+          target[p] = rand() % 256;
+          speed[p] = 1 + rand() % 12;
+        }
+        int step = target[p] - value[p];
+        value[p] += step > speed[p] ? speed[p] : step < -speed[p] ? -speed[p] : step;
+        f.value[p] = value[p];
+        if ((value[p] >> 1) != lastSeven[p])
+        {
+          lastSeven[p] = value[p] >> 1;
+          changeUs[p] = nowUs - (uint32_t)(rand() % samplePeriodUs);
+        }
+      }
+      MidiCcUpdate(t, f);
+
+      // loop()：每 Main_Loop_DelayMs 处理一次
+      if (ms % Main_Loop_DelayMs != 0 || ms - lastSendMs < Midi_Uart_Interval_Ms)
+        continue;
+      // 环形缓冲（256 字节）的剩余空间
+      uint32_t queued = lineFreeUs > nowUs ? (lineFreeUs - nowUs + MIDI_UART_BYTE_US - 1) / MIDI_UART_BYTE_US : 0;
+      if (256 - queued < MIDI_SERIAL_BATCH_MAX)
+        continue;
+      MidiCc cc[PEDAL_COUNT];
+      int n = MidiCcTake(t, cc);
+      if (n == 0)
+        continue;
+      size_t len = MidiSerialEncode(s, Midi_Channel, cc, n, ms, buf, sizeof(buf));
+      lastSendMs = ms;
+      // 逐字节发出：每条消息的最后一个字节发完才算到达
+      uint32_t start = lineFreeUs > nowUs ? lineFreeUs : nowUs;
+      size_t offset = len - (size_t)n * 2;
+      for (int i = 0; i < n; ++i)
+      {
+        uint32_t doneUs = start + (uint32_t)(offset + (size_t)(i + 1) * 2) * MIDI_UART_BYTE_US;
+        for (int p = 0; p < PEDAL_COUNT; ++p)
+          if (cc[i].cc == midiPedalCc[p] && doneUs - changeUs[p] > maxLatencyUs[p])
+            maxLatencyUs[p] = doneUs - changeUs[p];
+      }
+      lineFreeUs = start + (uint32_t)len * MIDI_UART_BYTE_US;
+      bytes += (uint32_t)len;
+      int m = ParseSerialMidi(buf, len, rxStatus, received, statusBytes);
+      if (m != n)
+        parsed = false;
+      messages += n;
+    }
+
+    // 解析：与最后一次采样的 7 位值一致（最后一批可能还在等待）
+    MidiCc rest[PEDAL_COUNT];
+    int n = MidiCcTake(t, rest);
+    for (int i = 0; i < n; ++i)
+      for (int p = 0; p < PEDAL_COUNT; ++p)
+        if (rest[i].cc == midiPedalCc[p])
+          received[p] = rest[i].value;
+    bool match = true;
+    for (int p = 0; p < PEDAL_COUNT; ++p)
+      match = match && received[p] == (value[p] >> 1);
+
+    // 理论最坏：采样周期 + loop() 周期 + 一整批（状态 + 3 × 2 字节）；间隔 < loop() 周期时限速不增加延迟
+    uint32_t boundUs = samplePeriodUs + Main_Loop_DelayMs * 1000 + MIDI_SERIAL_BATCH_MAX * MIDI_UART_BYTE_US;
+    bool pass = parsed && match;
+    printf("[串口MIDI] 60s 随机演奏：%d 条消息 %u 字节（不用运行状态 %d 字节，状态字节 %d 个），链路占用 %.1f%%，"
+           "解析与最终值 %s\n",
+           messages, (unsigned)bytes, messages * 3, statusBytes,
+           100.0 * bytes * MIDI_UART_BYTE_US / (simMs * 1000.0), parsed && match ? "一致" : "不一致");
+    printf("[串口MIDI] 最坏延迟（变化 → 最后一位发出）理论 %.2fms：", boundUs / 1000.0);
+    for (int p = 0; p < PEDAL_COUNT; ++p)
+    {
+      printf(" CC%u %.2fms", midiPedalCc[p], maxLatencyUs[p] / 1000.0);
+      pass = pass && maxLatencyUs[p] <= boundUs;
+    }
+    printf(" %s\n", pass ? "通过" : "失败");
+    failed += !pass;
+  }
+  return failed;
+}
+
+int BenchMidi()
+{
+  int failed = 0;
+  BleMidiPacket p;
+
+  // 三个控制器同一时刻：头部 + 时间戳 + 状态 + 3 × (控制器, 值)
+  {
+    BleMidiPacketBegin(p);
+    BleMidiPacketAddCc(p, 0, MIDI_CC_SUSTAIN, 100, 0x0123);
+    BleMidiPacketAddCc(p, 0, MIDI_CC_SOSTENUTO, 0, 0x0123);
+    BleMidiPacketAddCc(p, 0, MIDI_CC_SOFT, 127, 0x0123);
+    const uint8_t want[] = {0x82, 0xA3, 0xB0, 64, 100, 66, 0, 67, 127};
+    bool pass = Same(p, want, sizeof(want));
+    PrintPacket("同一时刻 3 个控制器", p, pass);
+    failed += !pass;
+  }
+
+  // 时刻不同：运行状态，只补时间戳字节；低 7 位回绕（0x7F → 0x02）由接收方进位
+  {
+    BleMidiPacketBegin(p);
+    BleMidiPacketAddCc(p, 2, MIDI_CC_SUSTAIN, 10, 0x007E);
+    BleMidiPacketAddCc(p, 2, MIDI_CC_SUSTAIN, 11, 0x007F);
+    BleMidiPacketAddCc(p, 2, MIDI_CC_SOFT, 12, 0x0082);
+    const uint8_t want[] = {0x80, 0xFE, 0xB2, 64, 10, 0xFF, 64, 11, 0x82, 67, 12};
+    MidiEvent ev[8];
+    int n = DecodeBleMidi(p.buf, p.len, ev, 8);
+    bool pass = Same(p, want, sizeof(want)) && n == 3 && ev[2].timeMs == 0x0082 && ev[2].status == 0xB2 &&
+                ev[2].cc == 67 && ev[2].value == 12;
+    PrintPacket("运行状态 + 时间戳回绕", p, pass);
+    failed += !pass;
+  }
+
+  // 分包边界：20 字节容量；跨度超过 127ms 必须另起一包
+  {
+    BleMidiPacketBegin(p);
+    int added = 0;
+    while (BleMidiPacketAddCc(p, 0, MIDI_CC_SUSTAIN, (uint8_t)added, (uint16_t)(1000 + added)))
+      added++;
+    bool pass = p.len <= BLE_MIDI_PACKET_MAX && added == (BLE_MIDI_PACKET_MAX - 5) / 3 + 1;
+    BleMidiPacketBegin(p);
+    BleMidiPacketAddCc(p, 0, MIDI_CC_SUSTAIN, 1, 1000);
+    pass = pass && BleMidiPacketAddCc(p, 0, MIDI_CC_SUSTAIN, 2, 1127) &&
+           !BleMidiPacketAddCc(p, 0, MIDI_CC_SUSTAIN, 3, 1128);
+    BleMidiPacketBegin(p, 7);
+    pass = pass && BleMidiPacketAddCc(p, 0, MIDI_CC_SUSTAIN, 1, 0) && !BleMidiPacketAddCc(p, 0, MIDI_CC_SOFT, 1, 5);
+    printf("[MIDI] 分包边界（容量 20 字节可放 %d 条不同时刻消息，跨度 ≤127ms，小 MTU） %s\n", added,
+           pass ? "通过" : "失败");
+    failed += !pass;
+  }
+
+  // 变化检测：首次发送全部当前值；不变不发；批次内变化又回到原值不发；7 位值不变（255→254）不发
+  {
+    MidiCcTracker t;
+    MidiCcReset(t);
+    MidiCc cc[PEDAL_COUNT];
+    PedalFrame f;
+    MakeFrame(f, 1000, 0, 0, 0);
+    MidiCcUpdate(t, f);
+    int first = MidiCcTake(t, cc);
+    MidiCcUpdate(t, f);
+    int idle = MidiCcTake(t, cc);
+    MakeFrame(f, 2000, 40, 0, 0);
+    MidiCcUpdate(t, f);
+    MakeFrame(f, 3000, 0, 0, 0);
+    MidiCcUpdate(t, f);
+    int bounce = MidiCcTake(t, cc);
+    MakeFrame(f, 4000, 0, 255, 0);
+    MidiCcUpdate(t, f);
+    MidiCcTake(t, cc);
+    MakeFrame(f, 5000, 0, 254, 0);
+    MidiCcUpdate(t, f);
+    int sameBucket = MidiCcTake(t, cc);
+    // 先变化的排在前面
+    MakeFrame(f, 6000, 0, 254, 90);
+    MidiCcUpdate(t, f);
+    MakeFrame(f, 7000, 60, 254, 90);
+    MidiCcUpdate(t, f);
+    int two = MidiCcTake(t, cc);
+    bool pass = first == 3 && idle == 0 && bounce == 0 && sameBucket == 0 && two == 2 && cc[0].cc == MIDI_CC_SOFT &&
+                cc[0].value == 45 && cc[0].timeMs == 6 && cc[1].cc == MIDI_CC_SUSTAIN && cc[1].value == 30;
+    printf("[MIDI] 变化检测：首次 %d 个，静止 %d 个，往返 %d 个，同一 7 位值 %d 个，两个变化按时间排序 %s\n", first,
+           idle, bounce, sameBucket, pass ? "通过" : "失败");
+    failed += !pass;
+  }
+
+  // 半踏板扫动：1kHz 采样，延音 2 秒内 0→255→0，弱音同时慢速变化；loop() 每 Main_Loop_DelayMs 取一批
+  // 每次变化单独通知 = 每条消息一个包（头部 + 时间戳 + 状态 + 2 数据 = 5 字节）
+  {
+    MidiCcTracker t;
+    MidiCcReset(t);
+    int lastSeen[PEDAL_COUNT] = {-1, -1, -1};
+    int naivePackets = 0, naiveBytes = 0, packets = 0, bytes = 0, decoded = 0;
+    int finalValue[PEDAL_COUNT] = {-1, -1, -1};
+    bool ordered = true;
+    for (uint32_t ms = 0; ms < 2000; ++ms)
+    {
+      int sustain = ms < 1000 ? (int)(ms * 255 / 1000) : (int)((2000 - ms) * 255 / 1000);
+      int soft = (int)(ms * 255 / 4000);
+      PedalFrame f;
+      MakeFrame(f, ms * 1000, sustain, 0, soft);
+      MidiCcUpdate(t, f);
+      for (int i = 0; i < PEDAL_COUNT; ++i)
+      {
+        if ((f.value[i] >> 1) != lastSeen[i])
+        {
+          lastSeen[i] = f.value[i] >> 1;
+          naivePackets++;
+          naiveBytes += 5;
+        }
+      }
+      if ((ms + 1) % Main_Loop_DelayMs != 0)
+        continue;
+      MidiCc cc[PEDAL_COUNT];
+      int n = MidiCcTake(t, cc);
+      if (n == 0)
+        continue;
+      BleMidiPacket packet;
+      BleMidiPacketBegin(packet);
+      for (int i = 0; i < n; ++i)
+        BleMidiPacketAddCc(packet, Midi_Channel, cc[i].cc, cc[i].value, cc[i].timeMs);
+      MidiEvent ev[PEDAL_COUNT];
+      int m = DecodeBleMidi(packet.buf, packet.len, ev, PEDAL_COUNT);
+      for (int i = 0; i < m; ++i)
+      {
+        if (i > 0 && ev[i].timeMs < ev[i - 1].timeMs)
+          ordered = false;
+        for (int k = 0; k < PEDAL_COUNT; ++k)
+          if (ev[i].cc == midiPedalCc[k])
+            finalValue[k] = ev[i].value;
+      }
+      decoded += m;
+      packets++;
+      bytes += packet.len;
+    }
+    bool pass = ordered && finalValue[PEDAL_SUSTAIN] == 0 && finalValue[PEDAL_SOSTENUTO] == 0 &&
+                finalValue[PEDAL_SOFT] == (int)(1999 * 255 / 4000) >> 1 && packets <= 2000 / Main_Loop_DelayMs;
+    printf("[MIDI] 半踏板扫动 2s：逐次通知 %d 个/%d 字节 → 每循环一个通知 %d 个/%d 字节（%d 条消息），"
+           "最终值与采样一致 %s\n",
+           naivePackets, naiveBytes, packets, bytes, decoded, pass ? "通过" : "失败");
+    failed += !pass;
+  }
+
+  failed += BenchMidiSerial();
+  printf("[MIDI] %s\n", failed ? "存在失败项" : "全部通过");
+  return failed;
+}
@@ -0,0 +1,135 @@
+// bench_ota.cpp
+// OTA 流水线（gzip 流式解压 + 增量 SHA-256）：
+// 用合成的 ESP32 镜像（image_gen.h）及系统 gzip 压缩后的版本，按 WebServer 上传块大小或随机块大小送入，
+// 检查输出与原镜像逐字节一致，截断/损坏的数据必须被拒绝，并测量吞吐量
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "bench.h"
+#include "image_gen.h"
+#include "ota_stream.h"
+#include "pedal_hal.h"
+
+#define BENCH_OTA_IMAGE_SIZE (1024 * 1024)
+// WebServer 的 HTTP_UPLOAD_BUFLEN
+#define BENCH_OTA_CHUNK 1436
+#define BENCH_OTA_ROUNDS 5
+
+static uint8_t s_window[INFLATE_WINDOW_SIZE];
+
+struct Sink
+{
+  const Bytes *expect;
+  size_t offset;
+  bool same;
+};
+
+static bool SinkWrite(void *ctx, const uint8_t *data, size_t len)
+{
+  Sink &k = *(Sink *)ctx;
+  if (k.offset + len > k.expect->size() || memcmp(k.expect->data() + k.offset, data, len) != 0)
+    k.same = false;
+  k.offset += len;
+  return true;
+}
+
+// chunk=0 时使用随机块大小（1-4096 字节）；返回是否通过 OtaStreamEnd，sameOut 表示输出是否与 expect 一致
+static bool Feed(const Bytes &data, const Bytes &expect, size_t chunk, bool &sameOut, const char **error)
+{
+  static OtaStream s;
+  Sink k = {&expect, 0, true};
+  OtaStreamBegin(s, s_window, SinkWrite, &k);
+  uint32_t seed = 777;
+  bool ok = true;
+  for (size_t off = 0; off < data.size() && ok;)
+  {
+    size_t n = chunk;
+    if (n == 0)
+    {
+      seed = seed * 1103515245u + 12345u;
+      n = 1 + (seed >> 16) % 4096;
+    }
+    if (n > data.size() - off)
+      n = data.size() - off;
+    ok = OtaStreamWrite(s, data.data() + off, n);
+    off += n;
+  }
+  ok = ok && OtaStreamEnd(s);
+  sameOut = k.same && k.offset == expect.size();
+  if (error)
+    *error = s.error;
+  return ok;
+}
+
+static int Expect(const char *name, const Bytes &data, const Bytes &expect, size_t chunk, bool accept)
+{
+  bool same;
+  const char *error = nullptr;
+  bool ok = Feed(data, expect, chunk, same, &error);
+  bool pass = accept ? (ok && same) : !ok;
+  printf("[OTA] %-24s %s%s%s\n", name, pass ? "通过" : "失败",
+         error ? "，拒绝原因：" : "", error ? error : "");
+  return pass ? 0 : 1;
+}
+
+int BenchOta()
+{
+  int failed = 0;
+  // FIPS 180-2 测试向量 "abc"
+  static const uint8_t abcDigest[SHA256_DIGEST_SIZE] = {
+      0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+      0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c, 0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad};
+  Sha256Ctx sha;
+  uint8_t digest[SHA256_DIGEST_SIZE];
+  Sha256Init(sha);
+  Sha256Update(sha, (const uint8_t *)"abc", 3);
+  Sha256Final(sha, digest);
+  bool shaPass = memcmp(digest, abcDigest, sizeof(digest)) == 0;
+  printf("[OTA] SHA-256 测试向量 %s\n", shaPass ? "通过" : "失败");
+  failed += !shaPass;
+
+  Bytes img = ImageRender(ImageLayout(12345, BENCH_OTA_IMAGE_SIZE));
+  Bytes gz = ImageGzip(img, 9);
+  Bytes gzFast = ImageGzip(img, 1);
+
+  failed += Expect("原始镜像", img, img, BENCH_OTA_CHUNK, true);
+  Bytes bad = img;
+  bad[bad.size() / 2] ^= 0x01;
+  failed += Expect("原始镜像 1 位翻转", bad, bad, BENCH_OTA_CHUNK, false);
+  Bytes cut(img.begin(), img.end() - 4096);
+  failed += Expect("原始镜像截断", cut, cut, BENCH_OTA_CHUNK, false);
+
+  if (gz.empty() || gzFast.empty())
+  {
+    printf("[OTA] 系统中没有 gzip，跳过压缩上传测试\n");
+    return failed;
+  }
+  failed += Expect("gzip -9", gz, img, BENCH_OTA_CHUNK, true);
+  failed += Expect("gzip -1 随机分块", gzFast, img, 0, true);
+  failed += Expect("gzip -9 逐字节", gz, img, 1, true);
+  Bytes gzCut(gz.begin(), gz.end() - 1000);
+  failed += Expect("gzip 截断", gzCut, img, BENCH_OTA_CHUNK, false);
+  Bytes gzNoTrailer(gz.begin(), gz.end() - 4);
+  failed += Expect("gzip 缺少 ISIZE", gzNoTrailer, img, BENCH_OTA_CHUNK, false);
+  Bytes gzBad = gz;
+  gzBad[gzBad.size() / 2] ^= 0x10;
+  failed += Expect("gzip 1 位翻转", gzBad, img, BENCH_OTA_CHUNK, false);
+
+  bool same;
+  uint32_t t0 = halCycleCount();
+  for (int i = 0; i < BENCH_OTA_ROUNDS; ++i)
+    Feed(img, img, BENCH_OTA_CHUNK, same, nullptr);
+  uint32_t rawNs = halCycleCount() - t0;
+  t0 = halCycleCount();
+  for (int i = 0; i < BENCH_OTA_ROUNDS; ++i)
+    Feed(gz, img, BENCH_OTA_CHUNK, same, nullptr);
+  uint32_t gzNs = halCycleCount() - t0;
+
+  double mb = (double)img.size() * BENCH_OTA_ROUNDS / 1e6;
+  printf("[OTA] 镜像 %u 字节，gzip -9 后 %u 字节（%.1f%%）\n", (unsigned)img.size(), (unsigned)gz.size(),
+         100.0 * gz.size() / img.size());
+  printf("[OTA] 吞吐（按解压后字节）：原始+SHA-256 %.1f MB/s，gzip 解压+CRC32+SHA-256 %.1f MB/s\n",
+         mb / (rawNs / 1e9), mb / (gzNs / 1e9));
+  return failed;
+}
@@ -0,0 +1,162 @@
+// bench_policy.cpp
+// 平滑策略：自适应EMA 策略与原滤波逐值一致；在已知阶跃的合成轨迹上核对评测器，
+// 再在合成演奏轨迹（1kHz，叠加 ADC 噪声）上比较三种策略的阶跃延迟、静止抖动与开销，以及 One-Euro/卡尔曼参数的取舍
+#include <stdio.h>
+#include "bench.h"
+#include "filter_harness.h"
+#include "trace.h"
+
+#define POLICY_RATE_HZ 1000
+#define POLICY_NOISE_MV 8
+#define POLICY_MUSIC_MS 60000
+#define POLICY_STEP_HOLD_MS 600
+#define POLICY_STEP_RAMP_MS 15
+
+// 半踏板之间的阶跃（mV），相邻电平映射后相差都超过 FILTER_STEP_MIN_LSB
+static const int kStepLevels[] = {1000, 2200, 1500, 800, 2000, 1200, 1800, 900};
+#define POLICY_STEP_COUNT ((int)(sizeof(kStepLevels) / sizeof(kStepLevels[0])) - 1)
+
+static uint32_t NextRandom(uint32_t &state)
+{
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+static int Noise(uint32_t &rng)
+{
+  return (int)(NextRandom(rng) % (2 * POLICY_NOISE_MV + 1)) - POLICY_NOISE_MV;
+}
+
+static FilterTrace MakeTrace(const char *name)
+{
+  FilterTrace t;
+  t.name = name;
+  t.minV = TRACE_REST_MV - 20;
+  t.maxV = TRACE_PRESSED_MV + 20;
+  return t;
+}
+
+static FilterTrace StepTrace()
+{
+  FilterTrace t = MakeTrace("阶跃");
+  uint32_t rng = 99;
+  uint32_t ms = 0;
+  int level = kStepLevels[0];
+  for (int s = 0; s <= POLICY_STEP_COUNT; ++s)
+  {
+    int from = level;
+    level = kStepLevels[s];
+    for (int k = 0; k < POLICY_STEP_RAMP_MS + POLICY_STEP_HOLD_MS; ++k, ++ms)
+    {
+      int clean = k < POLICY_STEP_RAMP_MS ? from + (level - from) * k / POLICY_STEP_RAMP_MS : level;
+      t.timeUs.push_back(ms * 1000);
+      t.mv.push_back(clean + Noise(rng));
+    }
+  }
+  return t;
+}
+
+// TraceGenerate 的 5ms 轨迹线性插值到 1kHz 后叠加噪声
+static FilterTrace MusicTrace()
+{
+  FilterTrace t = MakeTrace("演奏");
+  const int step = 1000 / POLICY_RATE_HZ;
+  const int coarse = POLICY_MUSIC_MS / Main_Loop_DelayMs + 1;
+  std::vector<int> mv(coarse);
+  TraceGenerate(mv.data(), coarse, 2025, 0);
+  uint32_t rng = 7;
+  for (int ms = 0; ms < POLICY_MUSIC_MS; ms += step)
+  {
+    int i = ms / Main_Loop_DelayMs, k = ms % Main_Loop_DelayMs;
+    int clean = mv[i] + (mv[i + 1] - mv[i]) * k / Main_Loop_DelayMs;
+    t.timeUs.push_back((uint32_t)ms * 1000);
+    t.mv.push_back(clean + Noise(rng));
+  }
+  return t;
+}
+
+int BenchFilterPolicy()
+{
+  int failed = 0;
+  char detail[96];
+
+  // 1. 自适应EMA 策略 = 原 PedalFilterUpdate（输出值与细分值）
+  {
+    static int mv[100000];
+    TraceGenerate(mv, 100000, 2024, 15);
+    PedalFilter a = {}, b = {};
+    PedalFilterSetRange(a, TRACE_REST_MV - 20, TRACE_PRESSED_MV + 20, 0.05f);
+    PedalFilterSetRange(b, TRACE_REST_MV - 20, TRACE_PRESSED_MV + 20, 0.05f);
+    SmoothPolicy<FILTER_ADAPTIVE_EMA>::State s;
+    int diff = 0;
+    for (int i = 0; i < 100000; ++i)
+    {
+      int want = PedalFilterUpdate(a, mv[i]);
+      int got = SmoothPolicy<FILTER_ADAPTIVE_EMA>::Smooth(b, s, PedalFilterMap(b, mv[i]), Main_Loop_DelayMs * 1000);
+      diff += want != got || PedalFilterFineQ8(a) != PedalFilterFineQ8(b);
+    }
+    snprintf(detail, sizeof(detail), "100000 个采样不一致 %d 个", diff);
+    failed += BenchReport("策略", "EMA 等价", diff == 0, detail);
+  }
+
+  // 2. 已知阶跃：每个策略都应检出全部阶跃，静止段抖动不超过 1 LSB（原滤波的微抖动死区）
+  std::vector<FilterTrace> steps = {StepTrace()};
+  for (int p = 0; p < FILTER_POLICY_COUNT; ++p)
+  {
+    FilterScore s = FilterEvaluate((FilterPolicy)p, steps);
+    bool pass = s.steps == POLICY_STEP_COUNT && s.restRmsLsb < 1.0;
+    snprintf(detail, sizeof(detail), "阶跃 %d/%d，延迟最大 %.1fms，静止抖动 %.3f LSB", s.steps, POLICY_STEP_COUNT,
+             s.lagMaxMs, s.restRmsLsb);
+    failed += BenchReport("策略", FilterPolicyName((FilterPolicy)p), pass, detail);
+  }
+
+  // 3. 合成演奏轨迹上的比较
+  std::vector<FilterTrace> music = {MusicTrace()};
+  printf("[策略] 演奏轨迹 %d 秒，%dHz，噪声 ±%dmV\n", POLICY_MUSIC_MS / 1000, POLICY_RATE_HZ, POLICY_NOISE_MV);
+  FilterReport("策略", music);
+
+  // 4. 参数取舍：P90 延迟（ms）/ 静止抖动（输出值 LSB RMS）/ 静止时输出值每秒变化次数
+  printf("[策略] One-Euro 参数（P90 延迟 ms / 静止抖动 LSB / 输出变化 次/s，列为 beta）\n[策略]   最低截止  ");
+  static const float kBetas[] = {0.005f, 0.01f, 0.02f, 0.05f, 0.1f};
+  static const float kCutoffs[] = {0.5f, 1.0f, 2.0f, 4.0f};
+  for (float beta : kBetas)
+    printf("  %19.3f", beta);
+  printf("\n");
+  for (float cutoff : kCutoffs)
+  {
+    printf("[策略]   %5.1fHz   ", cutoff);
+    for (float beta : kBetas)
+    {
+      FilterParams params;
+      params.oneEuro.minCutoffHz = cutoff;
+      params.oneEuro.beta = beta;
+      FilterScore s = FilterEvaluate(FILTER_ONE_EURO, music, params);
+      printf("  %6.1f/%6.3f/%5.1f", s.lagP90Ms, s.restRmsLsb, s.restChangesPerS);
+    }
+    printf("\n");
+  }
+  printf("[策略] 卡尔曼参数（P90 延迟 ms / 静止抖动 LSB / 输出变化 次/s，列为测量噪声 LSB²）\n[策略]   加速度噪声");
+  static const float kMeas[] = {1.0f, 4.0f, 16.0f};
+  static const float kAccel[] = {1e4f, 1e5f, 1e6f, 1e7f};
+  for (float r : kMeas)
+    printf("  %19.2f", r);
+  printf("\n");
+  for (float q : kAccel)
+  {
+    printf("[策略]   %8.0e  ", q);
+    for (float r : kMeas)
+    {
+      FilterParams params;
+      params.kalman.accelNoise = q;
+      params.kalman.measNoise = r;
+      FilterScore s = FilterEvaluate(FILTER_KALMAN, music, params);
+      printf("  %6.1f/%6.3f/%5.1f", s.lagP90Ms, s.restRmsLsb, s.restChangesPerS);
+    }
+    printf("\n");
+  }
+
+  printf("[策略] %s\n", failed ? "存在失败项" : "全部通过");
+  return failed;
+}
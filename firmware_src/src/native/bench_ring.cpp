@@ -0,0 +1,104 @@
+// bench_ring.cpp
+// SampleRing 多线程压力与吞吐：生产者/消费者各占一个线程全速运行，
+// 检查帧是否完整（无撕裂）、是否按序，统计丢弃/覆盖帧数与吞吐量
+#include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "bench.h"
+#include "pedal.h"
+#include "sample_ring.h"
+
+#define BENCH_RING_FRAMES 5000000u
+#define BENCH_RING_SIZE 64
+
+// 帧内所有字段都由序号推导，消费者据此检测撕裂
+static void FillFrame(PedalFrame &f, uint32_t seq)
+{
+  f.timeUs = seq;
+  for (int i = 0; i < PEDAL_COUNT; ++i)
+  {
+    f.mv[i] = (int)(seq + i);
+    f.minv[i] = (int)(seq ^ 0x5a5a);
+    f.maxv[i] = (int)(seq * 3u);
+    f.value[i] = (int)(seq & 0xff);
+  }
+}
+
+static bool FrameIntact(const PedalFrame &f)
+{
+  PedalFrame expect;
+  FillFrame(expect, f.timeUs);
+  for (int i = 0; i < PEDAL_COUNT; ++i)
+    if (f.mv[i] != expect.mv[i] || f.minv[i] != expect.minv[i] || f.maxv[i] != expect.maxv[i] || f.value[i] != expect.value[i])
+      return false;
+  return true;
+}
+
+// yieldEvery：生产者每写入多少帧让出一次 CPU，0 为全速（消费者必然跟不上）
+template <RingPolicy Policy>
+static int RunRing(const char *name, uint32_t yieldEvery)
+{
+  SampleRing<PedalFrame, BENCH_RING_SIZE, Policy> ring;
+  std::atomic<bool> producerDone{false};
+  std::atomic<int> ready{0};
+  uint32_t received = 0, torn = 0, disorder = 0;
+
+  std::thread producer([&] {
+    PedalFrame f;
+    ready++;
+    while (ready.load() < 2)
+      std::this_thread::yield();
+    for (uint32_t seq = 1; seq <= BENCH_RING_FRAMES; ++seq)
+    {
+      FillFrame(f, seq);
+      ring.push(f);
+      if (yieldEvery && seq % yieldEvery == 0)
+        std::this_thread::yield();
+    }
+    producerDone = true;
+  });
+  std::thread consumer([&] {
+    PedalFrame f;
+    ready++;
+    while (ready.load() < 2)
+      std::this_thread::yield();
+    uint32_t last = 0;
+    for (;;)
+    {
+      if (!ring.pop(f))
+      {
+        if (producerDone && !ring.pop(f))
+          break;
+        std::this_thread::yield();
+        continue;
+      }
+      received++;
+      if (!FrameIntact(f))
+        torn++;
+      if (f.timeUs <= last)
+        disorder++;
+      last = f.timeUs;
+    }
+  });
+  auto start = std::chrono::steady_clock::now();
+  producer.join();
+  consumer.join();
+  double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  printf("[环形缓冲] %s%s：写入 %u 帧，读到 %u，丢弃 %u，覆盖 %u，撕裂 %u，乱序 %u，%.1f 百万帧/秒\n",
+         name, yieldEvery ? "（限速生产）" : "（全速生产）", BENCH_RING_FRAMES, received, ring.dropped(), ring.lost(), torn, disorder, BENCH_RING_FRAMES / sec / 1e6);
+  // 每一帧要么被读到，要么计入丢弃/覆盖
+  return torn || disorder || received + ring.dropped() + ring.lost() != BENCH_RING_FRAMES;
+}
+
+int BenchSampleRing()
+{
+  int failed = 0;
+  failed += RunRing<RING_DROP_NEWEST>("丢弃新帧", 0);
+  failed += RunRing<RING_OVERWRITE_OLDEST>("覆盖旧帧", 0);
+  failed += RunRing<RING_DROP_NEWEST>("丢弃新帧", 16);
+  failed += RunRing<RING_OVERWRITE_OLDEST>("覆盖旧帧", 16);
+  printf("[环形缓冲] %s\n", failed ? "存在失败项（撕裂、乱序或帧数不守恒）" : "全部通过");
+  return failed;
+}
@@ -0,0 +1,119 @@
+// bench_status.cpp
+// /status 序列化对比：原先的 String 拼接（以 std::string 模拟）、静态缓冲 JSON、二进制帧
+// 通过替换全局 operator new 统计每帧的堆分配次数
+#include <atomic>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include "bench.h"
+#include "pedal_hal.h"
+#include "status_codec.h"
+
+#define BENCH_STATUS_ITERATIONS 200000
+
+static std::atomic<uint32_t> s_allocs{0};
+
+void *operator new(size_t size)
+{
+  s_allocs.fetch_add(1, std::memory_order_relaxed);
+  void *p = malloc(size ? size : 1);
+  if (!p)
+    throw std::bad_alloc();
+  return p;
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+// 与改动前 handleStatus() 相同的拼接方式
+static std::string LegacyStatusJson(const PedalFrame &f)
+{
+  std::string json = "{";
+  for (int i = 0; i < 3; ++i)
+  {
+    int p = statusPageOrder[i];
+    json += "\"p" + std::to_string(i) + "\":{";
+    json += "\"mv\":" + std::to_string(f.mv[p]) + ",";
+    json += "\"min\":" + std::to_string(f.minv[p]) + ",";
+    json += "\"max\":" + std::to_string(f.maxv[p]) + ",";
+    json += "\"mapped\":" + std::to_string(f.value[p]);
+    json += "}";
+    if (i < 2)
+      json += ",";
+  }
+  json += "}";
+  return json;
+}
+
+static void MakeFrame(PedalFrame &f, int i)
+{
+  f.timeUs = (uint32_t)i * 1000;
+  for (int p = 0; p < PEDAL_COUNT; ++p)
+  {
+    f.mv[p] = 600 + (i * 7 + p * 300) % 1800;
+    f.minv[p] = 580;
+    f.maxv[p] = 2420;
+    f.value[p] = (i + p * 85) & 255;
+  }
+}
+
+static void Report(const char *name, uint32_t allocs, uint64_t bytes, uint32_t cycles)
+{
+  printf("[状态] %-12s 每帧 %5.2f 次分配，%6.1f 字节，%7.1f\n", name,
+         (double)allocs / BENCH_STATUS_ITERATIONS, (double)bytes / BENCH_STATUS_ITERATIONS,
+         (double)cycles / BENCH_STATUS_ITERATIONS);
+}
+
+int BenchStatus()
+{
+  PedalFrame f = {};
+  volatile size_t sink = 0;
+
+  // 静态缓冲 JSON 必须与原实现逐字节一致
+  static char json[STATUS_JSON_MAX];
+  int mismatches = 0;
+  for (int i = 0; i < 1000; ++i)
+  {
+    MakeFrame(f, i);
+    size_t n = StatusFormatJson(json, sizeof(json), f);
+    if (LegacyStatusJson(f) != std::string(json, n))
+      mismatches++;
+  }
+
+  uint64_t bytes = 0;
+  uint32_t a0 = s_allocs.load();
+  uint32_t t0 = halCycleCount();
+  for (int i = 0; i < BENCH_STATUS_ITERATIONS; ++i)
+  {
+    MakeFrame(f, i);
+    bytes += LegacyStatusJson(f).size();
+  }
+  Report("String 拼接", s_allocs.load() - a0, bytes, halCycleCount() - t0);
+
+  bytes = 0;
+  a0 = s_allocs.load();
+  t0 = halCycleCount();
+  for (int i = 0; i < BENCH_STATUS_ITERATIONS; ++i)
+  {
+    MakeFrame(f, i);
+    bytes += StatusFormatJson(json, sizeof(json), f);
+  }
+  Report("静态 JSON", s_allocs.load() - a0, bytes, halCycleCount() - t0);
+
+  static uint8_t bin[STATUS_BINARY_SIZE];
+  bytes = 0;
+  a0 = s_allocs.load();
+  t0 = halCycleCount();
+  for (int i = 0; i < BENCH_STATUS_ITERATIONS; ++i)
+  {
+    MakeFrame(f, i);
+    bytes += StatusFormatBinary(bin, sizeof(bin), f);
+    sink = sink + bin[i % STATUS_BINARY_SIZE];
+  }
+  Report("二进制", s_allocs.load() - a0, bytes, halCycleCount() - t0);
+  (void)sink;
+
+  printf("[状态] 静态 JSON 与原实现不一致 %d 帧（std::string 有短字符串优化，Arduino String 的分配只多不少）\n", mismatches);
+  return mismatches ? 1 : 0;
+}
@@ -0,0 +1,124 @@
+// bench_tone.cpp
+// 提示音调度：用虚拟时间模拟单次定时器，检查音符顺序与时刻、播放中追加、队列满丢弃，
+// 并对比原先 delay() 播放时 loop() 被阻塞的时长
+#include <stdio.h>
+#include "bench.h"
+#include "tone_seq.h"
+
+struct ToneChange
+{
+  uint32_t atMs;
+  uint16_t freq;
+};
+
+// 模拟 esp_timer：ToneSeqStep 返回的延迟到期时再次回调；loop() 在 playAt 时刻调用 ToneSeqPlay
+struct ToneSim
+{
+  ToneSequencer seq;
+  bool armed; // 定时器已启动
+  uint32_t timerAtMs;
+  ToneChange log[32];
+  int count;
+};
+
+static void SimPlay(ToneSim &sim, uint32_t nowMs, const ToneNote *notes, size_t n, bool &ok)
+{
+  bool start;
+  ok = ToneSeqPlay(sim.seq, notes, n, start);
+  if (start)
+  {
+    sim.armed = true;
+    sim.timerAtMs = nowMs;
+  }
+}
+
+static void SimRunUntil(ToneSim &sim, uint32_t endMs)
+{
+  while (sim.armed && sim.timerAtMs <= endMs)
+  {
+    uint16_t freq;
+    uint32_t next = ToneSeqStep(sim.seq, freq);
+    if (sim.count < 32)
+      sim.log[sim.count++] = {sim.timerAtMs, freq};
+    sim.armed = next != 0;
+    sim.timerAtMs += next;
+  }
+}
+
+static void SimReset(ToneSim &sim)
+{
+  ToneSeqReset(sim.seq);
+  sim.armed = false;
+  sim.timerAtMs = 0;
+  sim.count = 0;
+}
+
+int BenchTone()
+{
+  int failed = 0;
+  ToneSim sim;
+  bool ok;
+
+  // 开 OTA 提示音 Do Re Mi Sol La：立即返回，之后每 120ms 换一个音，600ms 时静音并停止定时器
+  {
+    static const ToneNote ota[] = {{1, 120}, {2, 120}, {3, 120}, {5, 120}, {6, 120}};
+    SimReset(sim);
+    SimPlay(sim, 1000, ota, TONE_COUNT(ota), ok);
+    SimRunUntil(sim, 5000);
+    static const ToneChange want[] = {{1000, 262}, {1120, 294}, {1240, 330}, {1360, 392}, {1480, 440}, {1600, 0}};
+    bool pass = ok && sim.count == 6 && !ToneSeqPlaying(sim.seq) && !sim.armed;
+    for (int i = 0; pass && i < 6; ++i)
+      pass = sim.log[i].atMs == want[i].atMs && sim.log[i].freq == want[i].freq;
+    printf("[提示音] OTA 旋律：%d 次切换，%ums 后静音，loop() 阻塞 0ms（原 delay() 播放阻塞 600ms） %s\n", sim.count,
+           sim.count ? (unsigned)(sim.log[sim.count - 1].atMs - 1000) : 0u, pass ? "通过" : "失败");
+    failed += !pass;
+  }
+
+  // 播放中追加（校准超时提示后紧接着完成）：接在当前旋律之后，中间没有多余静音；定时器不重复启动
+  {
+    static const ToneNote a[] = {{5, 120}, {1, 120}};
+    static const ToneNote b[] = {{5, 240}};
+    SimReset(sim);
+    SimPlay(sim, 0, a, TONE_COUNT(a), ok);
+    SimRunUntil(sim, 50);
+    bool start;
+    bool ok2 = ToneSeqPlay(sim.seq, b, TONE_COUNT(b), start);
+    SimRunUntil(sim, 5000);
+    bool pass = ok && ok2 && !start && sim.count == 4 && sim.log[2].atMs == 240 && sim.log[2].freq == 392 &&
+                sim.log[3].atMs == 480 && sim.log[3].freq == 0;
+    printf("[提示音] 播放中追加：第三个音在 %ums，结束于 %ums %s\n", sim.count > 2 ? (unsigned)sim.log[2].atMs : 0u,
+           sim.count > 3 ? (unsigned)sim.log[3].atMs : 0u, pass ? "通过" : "失败");
+    failed += !pass;
+  }
+
+  // 休止符与 0 时长：休止输出静音但仍占时长；0 时长的音符不会让定时器停住
+  {
+    static const ToneNote notes[] = {{1, 100}, {0, 50}, {3, 0}, {5, 100}};
+    SimReset(sim);
+    SimPlay(sim, 0, notes, TONE_COUNT(notes), ok);
+    SimRunUntil(sim, 5000);
+    bool pass = sim.count == 5 && sim.log[1].freq == 0 && sim.log[1].atMs == 100 && sim.log[3].atMs == 151 &&
+                sim.log[4].freq == 0 && sim.log[4].atMs == 251;
+    printf("[提示音] 休止与 0 时长音符 %s\n", pass ? "通过" : "失败");
+    failed += !pass;
+  }
+
+  // 队列满：整段旋律丢弃，已排队的不受影响
+  {
+    ToneNote many[TONE_QUEUE_SIZE];
+    for (int i = 0; i < TONE_QUEUE_SIZE; ++i)
+      many[i] = {(uint8_t)(1 + i % 7), 10};
+    static const ToneNote extra[] = {{1, 10}, {2, 10}};
+    SimReset(sim);
+    SimPlay(sim, 0, many, TONE_QUEUE_SIZE - 1, ok);
+    bool full;
+    SimPlay(sim, 0, extra, TONE_COUNT(extra), full);
+    SimRunUntil(sim, 5000);
+    bool pass = ok && !full && sim.count == TONE_QUEUE_SIZE;
+    printf("[提示音] 队列满时丢弃整段：已排队 %d 个音符全部播放 %s\n", sim.count - 1, pass ? "通过" : "失败");
+    failed += !pass;
+  }
+
+  printf("[提示音] %s\n", failed ? "存在失败项" : "全部通过");
+  return failed;
+}
@@ -0,0 +1,10 @@
+// bench_util.cpp
+// 各基准测试共用的结果输出
+#include <stdio.h>
+#include "bench.h"
+
+int BenchReport(const char *tag, const char *name, bool pass, const char *detail)
+{
+  printf("[%s] %-16s %s%s%s\n", tag, name, pass ? "通过" : "失败", detail ? "，" : "", detail ? detail : "");
+  return pass ? 0 : 1;
+}
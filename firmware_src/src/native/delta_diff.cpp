@@ -0,0 +1,262 @@
+// delta_diff.cpp
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include "delta_diff.h"
+#include "delta_patch.h"
+#include "ota_stream.h"
+
+// 哈希键长度与每次查找最多比较的候选位置数
+#define DIFF_KEY_LEN 8
+#define DIFF_HASH_BITS 20
+#define DIFF_MAX_CHAIN 64
+
+struct MatchIndex
+{
+  std::vector<int32_t> head; // 每个哈希桶最近的位置
+  std::vector<int32_t> prev; // 同桶中前一个位置
+};
+
+static inline uint32_t KeyHash(const uint8_t *p)
+{
+  uint64_t v;
+  memcpy(&v, p, 8);
+  return (uint32_t)((v * 0x9E3779B97F4A7C15ull) >> (64 - DIFF_HASH_BITS));
+}
+
+static void BuildIndex(MatchIndex &ix, const Bytes &old)
+{
+  ix.head.assign(1u << DIFF_HASH_BITS, -1);
+  ix.prev.assign(old.size(), -1);
+  for (size_t i = 0; i + DIFF_KEY_LEN <= old.size(); ++i)
+  {
+    uint32_t h = KeyHash(&old[i]);
+    ix.prev[i] = ix.head[h];
+    ix.head[h] = (int32_t)i;
+  }
+}
+
+// new[scan..] 在旧镜像中的最长完全匹配
+static size_t Search(const MatchIndex &ix, const Bytes &old, const Bytes &nw, size_t scan, size_t &pos)
+{
+  if (scan + DIFF_KEY_LEN > nw.size())
+    return 0;
+  size_t best = 0;
+  int chain = 0;
+  for (int32_t i = ix.head[KeyHash(&nw[scan])]; i >= 0 && chain < DIFF_MAX_CHAIN; i = ix.prev[i], ++chain)
+  {
+    size_t n = 0;
+    size_t limit = std::min(old.size() - i, nw.size() - scan);
+    while (n < limit && old[i + n] == nw[scan + n])
+      n++;
+    if (n > best)
+    {
+      best = n;
+      pos = i;
+    }
+  }
+  return best;
+}
+
+static void PutVarint(Bytes &out, uint64_t v)
+{
+  while (v >= 0x80)
+  {
+    out.push_back((uint8_t)(v | 0x80));
+    v >>= 7;
+  }
+  out.push_back((uint8_t)v);
+}
+
+static void PutLe32(Bytes &out, uint32_t v)
+{
+  for (int i = 0; i < 4; ++i)
+    out.push_back((uint8_t)(v >> (i * 8)));
+}
+
+static void PutSha(Bytes &out, const Bytes &data)
+{
+  Sha256Ctx sha;
+  uint8_t digest[SHA256_DIGEST_SIZE];
+  Sha256Init(sha);
+  Sha256Update(sha, data.data(), data.size());
+  Sha256Final(sha, digest);
+  out.insert(out.end(), digest, digest + SHA256_DIGEST_SIZE);
+}
+
+Bytes DeltaDiff(const Bytes &old, const Bytes &nw)
+{
+  Bytes out(DELTA_MAGIC, DELTA_MAGIC + 4);
+  PutLe32(out, (uint32_t)old.size());
+  PutLe32(out, (uint32_t)nw.size());
+  PutSha(out, old);
+  PutSha(out, nw);
+
+  MatchIndex ix;
+  BuildIndex(ix, old);
+
+  const int64_t oldSize = old.size(), newSize = nw.size();
+  int64_t scan = 0, len = 0, pos = 0;
+  int64_t lastScan = 0, lastPos = 0, lastOffset = 0;
+  while (scan < newSize)
+  {
+    // 向前扫描，直到找到一个明显优于沿用上一段对齐方式的匹配
+    int64_t oldScore = 0;
+    int64_t scsc;
+    for (scsc = scan += len; scan < newSize; scan++)
+    {
+      size_t p = 0;
+      len = Search(ix, old, nw, scan, p);
+      pos = p;
+      for (; scsc < scan + len; scsc++)
+        if (scsc + lastOffset < oldSize && old[scsc + lastOffset] == nw[scsc])
+          oldScore++;
+      if ((len == oldScore && len != 0) || len > oldScore + 8)
+        break;
+      if (scan + lastOffset < oldSize && old[scan + lastOffset] == nw[scan])
+        oldScore--;
+    }
+
+    if (len == oldScore && scan != newSize)
+      continue;
+
+    // 上一段匹配向后扩展（允许不一致的字节，差值写入补丁）
+    int64_t s = 0, sf = 0, lenf = 0;
+    for (int64_t i = 0; lastScan + i < scan && lastPos + i < oldSize;)
+    {
+      if (old[lastPos + i] == nw[lastScan + i])
+        s++;
+      i++;
+      if (s * 2 - i > sf * 2 - lenf)
+      {
+        sf = s;
+        lenf = i;
+      }
+    }
+    // 新匹配向前扩展
+    int64_t lenb = 0;
+    if (scan < newSize)
+    {
+      int64_t sb = 0;
+      s = 0;
+      for (int64_t i = 1; scan >= lastScan + i && pos >= i; i++)
+      {
+        if (old[pos - i] == nw[scan - i])
+          s++;
+        if (s * 2 - i > sb * 2 - lenb)
+        {
+          sb = s;
+          lenb = i;
+        }
+      }
+    }
+    // 两段重叠时选择最佳分界点
+    if (lastScan + lenf > scan - lenb)
+    {
+      int64_t overlap = (lastScan + lenf) - (scan - lenb);
+      int64_t ss = 0, lens = 0;
+      s = 0;
+      for (int64_t i = 0; i < overlap; i++)
+      {
+        if (nw[lastScan + lenf - overlap + i] == old[lastPos + lenf - overlap + i])
+          s++;
+        if (nw[scan - lenb + i] == old[pos - lenb + i])
+          s--;
+        if (s > ss)
+        {
+          ss = s;
+          lens = i + 1;
+        }
+      }
+      lenf += lens - overlap;
+      lenb -= lens;
+    }
+
+    int64_t extraLen = (scan - lenb) - (lastScan + lenf);
+    int64_t seek = (pos - lenb) - (lastPos + lenf);
+    PutVarint(out, (uint64_t)lenf);
+    PutVarint(out, (uint64_t)extraLen);
+    PutVarint(out, ((uint64_t)seek << 1) ^ (uint64_t)(seek >> 63));
+    for (int64_t i = 0; i < lenf; ++i)
+      out.push_back((uint8_t)(nw[lastScan + i] - old[lastPos + i]));
+    out.insert(out.end(), nw.begin() + lastScan + lenf, nw.begin() + scan - lenb);
+
+    lastScan = scan - lenb;
+    lastPos = pos - lenb;
+    lastOffset = pos - scan;
+  }
+  return out;
+}
+
+static bool ReadOld(void *ctx, uint32_t offset, uint8_t *buf, size_t len)
+{
+  const Bytes &old = *(const Bytes *)ctx;
+  if ((size_t)offset + len > old.size())
+    return false;
+  memcpy(buf, old.data() + offset, len);
+  return true;
+}
+
+static bool WriteOut(void *ctx, const uint8_t *data, size_t len)
+{
+  Bytes &out = *(Bytes *)ctx;
+  out.insert(out.end(), data, data + len);
+  return true;
+}
+
+bool DeltaApply(const Bytes &oldImg, const Bytes &upload, size_t chunk, Bytes &out, const char **error)
+{
+  static OtaStream s;
+  static uint8_t window[INFLATE_WINDOW_SIZE];
+  out.clear();
+  OtaStreamBegin(s, window, WriteOut, &out);
+  OtaStreamSetBase(s, ReadOld, (void *)&oldImg, (uint32_t)oldImg.size());
+  bool ok = true;
+  for (size_t off = 0; off < upload.size() && ok; off += chunk)
+    ok = OtaStreamWrite(s, upload.data() + off, std::min(chunk, upload.size() - off));
+  ok = ok && OtaStreamEnd(s);
+  if (error)
+    *error = s.error;
+  return ok;
+}
+
+int DeltaToolMain(int argc, char **argv)
+{
+  if (argc < 2 || (strcmp(argv[1], "delta") != 0 && strcmp(argv[1], "apply") != 0))
+    return -1;
+  if (argc != 5)
+  {
+    fprintf(stderr, "用法：%s delta 旧.bin 新.bin 补丁.bin\n      %s apply 旧.bin 补丁[.gz] 新.bin\n", argv[0], argv[0]);
+    return 2;
+  }
+  Bytes a, b;
+  if (!ImageLoad(argv[2], a) || !ImageLoad(argv[3], b))
+  {
+    fprintf(stderr, "无法读取输入文件\n");
+    return 1;
+  }
+
+  Bytes out;
+  if (strcmp(argv[1], "delta") == 0)
+  {
+    out = DeltaDiff(a, b);
+    printf("补丁 %u 字节（新镜像 %u 字节）；上传前可用 gzip -9 压缩，网页也会自动压缩\n",
+           (unsigned)out.size(), (unsigned)b.size());
+  }
+  else
+  {
+    const char *error = nullptr;
+    if (!DeltaApply(a, b, 1436, out, &error))
+    {
+      fprintf(stderr, "应用失败：%s\n", error ? error : "未知错误");
+      return 1;
+    }
+    printf("新镜像 %u 字节，校验通过\n", (unsigned)out.size());
+  }
+  if (!ImageSave(argv[4], out))
+  {
+    fprintf(stderr, "无法写入 %s\n", argv[4]);
+    return 1;
+  }
+  return 0;
+}
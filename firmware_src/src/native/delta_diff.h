@@ -0,0 +1,15 @@
+// delta_diff.h
+// 主机端差分补丁生成（bsdiff 的扫描与前后扩展算法，最长匹配改用哈希链查找，不需要后缀数组），
+// 输出格式见 include/delta_patch.h；以及在主机上按固件的方式（ota_stream 流水线）应用补丁或完整镜像
+#pragma once
+#include "image_gen.h"
+
+Bytes DeltaDiff(const Bytes &oldImg, const Bytes &newImg);
+
+// 把上传内容（补丁或镜像，可 gzip 压缩）按 chunk 字节分块送入 ota_stream，旧镜像取自 oldImg；
+// 成功时 out 为生成的新镜像，失败时 error 指向拒绝原因
+bool DeltaApply(const Bytes &oldImg, const Bytes &upload, size_t chunk, Bytes &out, const char **error);
+
+// 命令行：program delta 旧.bin 新.bin 补丁.bin | program apply 旧.bin 补丁.bin 新.bin
+// argv[1] 不是 delta/apply 时返回 -1
+int DeltaToolMain(int argc, char **argv);
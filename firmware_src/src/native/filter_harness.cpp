@@ -0,0 +1,264 @@
+// filter_harness.cpp
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include "filter_harness.h"
+#include "pedal_hal.h"
+
+static const char *const kPedalNames[PEDAL_COUNT] = {"延音", "持音", "弱音"};
+
+static void SetParams(SmoothPolicy<FILTER_ADAPTIVE_EMA>::State &, const FilterParams &) {}
+static void SetParams(OneEuroState &s, const FilterParams &p) { s.params = p.oneEuro; }
+static void SetParams(KalmanState &s, const FilterParams &p) { s.params = p.kalman; }
+
+// 回放一条轨迹，返回平滑部分的总耗时
+template <FilterPolicy P>
+static uint32_t RunPolicy(const FilterTrace &t, const std::vector<int> &in, const FilterParams &params,
+                          std::vector<int> &out, std::vector<int> &fine)
+{
+  PedalFilter f = {};
+  PedalFilterSetRange(f, t.minV, t.maxV, FILTER_DEAD_ZONE_PCT);
+  typename SmoothPolicy<P>::State s;
+  SetParams(s, params);
+  size_t n = in.size();
+  out.resize(n);
+  fine.resize(n);
+  uint32_t t0 = halCycleCount();
+  for (size_t i = 0; i < n; ++i)
+  {
+    uint32_t dtUs = i ? t.timeUs[i] - t.timeUs[i - 1] : 0;
+    out[i] = SmoothPolicy<P>::Smooth(f, s, in[i], dtUs);
+    fine[i] = PedalFilterFineQ8(f);
+  }
+  return halCycleCount() - t0;
+}
+
+static uint32_t Run(FilterPolicy policy, const FilterTrace &t, const std::vector<int> &in, const FilterParams &params,
+                    std::vector<int> &out, std::vector<int> &fine)
+{
+  switch (policy)
+  {
+  case FILTER_ONE_EURO:
+    return RunPolicy<FILTER_ONE_EURO>(t, in, params, out, fine);
+  case FILTER_KALMAN:
+    return RunPolicy<FILTER_KALMAN>(t, in, params, out, fine);
+  default:
+    return RunPolicy<FILTER_ADAPTIVE_EMA>(t, in, params, out, fine);
+  }
+}
+
+struct Segment
+{
+  size_t begin, end; // [begin, end)
+  double level;      // 映射值的均值
+};
+
+// 贪心划分静止段：从 begin 起尽量延长，起伏不超过 FILTER_STABLE_BAND_LSB；过短的从下一个采样重新开始
+static std::vector<Segment> FindStable(const FilterTrace &t, const std::vector<int> &in)
+{
+  std::vector<Segment> segs;
+  size_t n = in.size();
+  size_t i = 0;
+  while (i < n)
+  {
+    int lo = in[i], hi = in[i];
+    long sum = 0;
+    size_t j = i;
+    while (j < n)
+    {
+      int lo2 = std::min(lo, in[j]), hi2 = std::max(hi, in[j]);
+      if (hi2 - lo2 > FILTER_STABLE_BAND_LSB)
+        break;
+      lo = lo2;
+      hi = hi2;
+      sum += in[j];
+      ++j;
+    }
+    if (t.timeUs[j - 1] - t.timeUs[i] >= FILTER_STABLE_MIN_MS * 1000u)
+    {
+      segs.push_back({i, j, (double)sum / (j - i)});
+      i = j;
+    }
+    else
+    {
+      ++i;
+    }
+  }
+  return segs;
+}
+
+// [from, to) 内第一次越过 thr（dir 为变化方向）的时刻，相邻采样间线性插值；没有越过时返回负值
+static double CrossingUs(const FilterTrace &t, const std::vector<int> &v, size_t from, size_t to, double thr, int dir)
+{
+  for (size_t k = from; k < to; ++k)
+  {
+    if (dir * (v[k] - thr) < 0)
+      continue;
+    if (k == 0 || dir * (v[k - 1] - thr) >= 0)
+      return t.timeUs[k];
+    double frac = (thr - v[k - 1]) / (double)(v[k] - v[k - 1]);
+    return t.timeUs[k - 1] + frac * (uint32_t)(t.timeUs[k] - t.timeUs[k - 1]);
+  }
+  return -1;
+}
+
+FilterScore FilterEvaluate(FilterPolicy policy, const std::vector<FilterTrace> &traces, const FilterParams &params)
+{
+  std::vector<double> lags;
+  double restSq = 0, restFineSq = 0, restUs = 0;
+  long restN = 0, restChanges = 0;
+  double cycles = 0;
+  long samples = 0;
+  std::vector<int> in, out, fine;
+  for (const FilterTrace &t : traces)
+  {
+    if (t.mv.size() < 2 || t.maxV <= t.minV)
+      continue;
+    PedalFilter map = {};
+    PedalFilterSetRange(map, t.minV, t.maxV, FILTER_DEAD_ZONE_PCT);
+    in.resize(t.mv.size());
+    for (size_t i = 0; i < t.mv.size(); ++i)
+      in[i] = PedalFilterMap(map, t.mv[i]);
+    cycles += Run(policy, t, in, params, out, fine);
+    samples += (long)in.size();
+
+    std::vector<Segment> segs = FindStable(t, in);
+    for (size_t s = 0; s + 1 < segs.size(); ++s)
+    {
+      const Segment &a = segs[s], &b = segs[s + 1];
+      double delta = b.level - a.level;
+      if (fabs(delta) < FILTER_STEP_MIN_LSB || t.timeUs[b.begin] - t.timeUs[a.end - 1] > FILTER_STEP_MAX_GAP_MS * 1000u)
+        continue;
+      int dir = delta > 0 ? 1 : -1;
+      double thr = a.level + 0.9 * delta;
+      double tIn = CrossingUs(t, in, a.end, b.end, thr, dir);
+      if (tIn < 0)
+        continue;
+      double tOut = CrossingUs(t, out, a.end, b.end, thr, dir);
+      if (tOut < 0)
+        tOut = t.timeUs[b.end - 1]; // 整段都没有到达，按段尾计
+      lags.push_back(std::max(0.0, tOut - tIn) / 1000.0);
+    }
+    for (const Segment &s : segs)
+    {
+      if (t.timeUs[s.end - 1] - t.timeUs[s.begin] < FILTER_REST_MIN_MS * 1000u)
+        continue;
+      size_t from = s.begin;
+      while (from < s.end && t.timeUs[from] - t.timeUs[s.begin] < FILTER_REST_SKIP_MS * 1000u)
+        ++from;
+      double mean = 0, meanFine = 0;
+      for (size_t k = from; k < s.end; ++k)
+      {
+        mean += out[k];
+        meanFine += fine[k] / 256.0;
+      }
+      mean /= (double)(s.end - from);
+      meanFine /= (double)(s.end - from);
+      for (size_t k = from; k < s.end; ++k)
+      {
+        restSq += (out[k] - mean) * (out[k] - mean);
+        restFineSq += (fine[k] / 256.0 - meanFine) * (fine[k] / 256.0 - meanFine);
+        restChanges += k > from && out[k] != out[k - 1];
+      }
+      restN += (long)(s.end - from);
+      restUs += t.timeUs[s.end - 1] - t.timeUs[from];
+    }
+  }
+
+  FilterScore r = {};
+  r.steps = (int)lags.size();
+  if (!lags.empty())
+  {
+    std::sort(lags.begin(), lags.end());
+    double sum = 0;
+    for (double l : lags)
+      sum += l;
+    r.lagMeanMs = sum / lags.size();
+    r.lagP90Ms = lags[lags.size() * 9 / 10];
+    r.lagMaxMs = lags.back();
+  }
+  if (restN)
+  {
+    r.restRmsLsb = sqrt(restSq / restN);
+    r.restFineRmsLsb = sqrt(restFineSq / restN);
+    r.restChangesPerS = restUs > 0 ? restChanges * 1e6 / restUs : 0;
+  }
+  r.nsPerSample = samples ? cycles / samples : 0;
+  return r;
+}
+
+std::vector<FilterTrace> FilterTracesFromLog(const std::vector<LogSample> &samples)
+{
+  std::vector<FilterTrace> traces;
+  size_t i = 0;
+  while (i < samples.size())
+  {
+    size_t j = i;
+    while (j < samples.size() && samples[j].session == samples[i].session)
+      ++j;
+    for (int p = 0; p < PEDAL_COUNT; ++p)
+    {
+      // 校准范围取本次开机的第一帧（漂移跟踪的修正只有几 mV，不影响评测）
+      const PedalFrame &first = samples[i].frame;
+      if (first.maxv[p] <= first.minv[p])
+        continue;
+      FilterTrace t;
+      char name[48];
+      snprintf(name, sizeof(name), "开机%u %s", samples[i].session, kPedalNames[p]);
+      t.name = name;
+      t.minV = first.minv[p];
+      t.maxV = first.maxv[p];
+      for (size_t k = i; k < j; ++k)
+      {
+        t.timeUs.push_back((uint32_t)(samples[k].timeUs - samples[i].timeUs));
+        t.mv.push_back(samples[k].frame.mv[p]);
+      }
+      traces.push_back(t);
+    }
+    i = j;
+  }
+  return traces;
+}
+
+void FilterReport(const char *tag, const std::vector<FilterTrace> &traces, const FilterParams &params)
+{
+  printf("[%s] 策略       阶跃  延迟均值/P90/最大(ms)   静止抖动 输出/细分(LSB RMS)  输出变化(次/s)  开销(ns/次)\n", tag);
+  for (int p = 0; p < FILTER_POLICY_COUNT; ++p)
+  {
+    FilterScore s = FilterEvaluate((FilterPolicy)p, traces, params);
+    printf("[%s] %-10s %5d  %6.1f %6.1f %6.1f      %6.3f %6.3f              %6.2f         %6.1f\n", tag,
+           FilterPolicyName((FilterPolicy)p), s.steps, s.lagMeanMs, s.lagP90Ms, s.lagMaxMs, s.restRmsLsb,
+           s.restFineRmsLsb, s.restChangesPerS, s.nsPerSample);
+  }
+}
+
+int FilterToolMain(int argc, char **argv)
+{
+  if (argc < 2 || strcmp(argv[1], "filters") != 0)
+    return -1;
+  if (argc != 3)
+  {
+    fprintf(stderr, "用法：%s filters 记录.bin\n", argv[0]);
+    return 2;
+  }
+  std::vector<LogSample> samples;
+  if (!LogLoad(argv[2], samples))
+  {
+    fprintf(stderr, "无法读取 %s 或没有有效记录\n", argv[2]);
+    return 1;
+  }
+  std::vector<FilterTrace> traces = FilterTracesFromLog(samples);
+  if (traces.empty())
+  {
+    fprintf(stderr, "记录中没有已校准的踏板\n");
+    return 1;
+  }
+  long total = 0;
+  for (const FilterTrace &t : traces)
+    total += (long)t.mv.size();
+  // 记录按 Sample_Log_Rate_Hz 抽样，回放的采样间隔比设备上长；计时策略按实际间隔计算，自适应EMA 的系数按采样次数生效
+  printf("[回放] %u 条轨迹，%ld 个采样（%uHz 抽样）\n", (unsigned)traces.size(), total, (unsigned)Sample_Log_Rate_Hz);
+  FilterReport("回放", traces);
+  return 0;
+}
@@ -0,0 +1,59 @@
+// filter_harness.h
+// 平滑策略的回放评测：把电压轨迹（合成或从采样记录还原）按各自的时间间隔送入 filter_policy.h 的策略，统计
+//   阶跃延迟：两段静止电平（变化 ≥ FILTER_STEP_MIN_LSB，中间的过渡不超过 FILTER_STEP_MAX_GAP_MS）之间，
+//             输出越过 90% 的时刻减去输入越过 90% 的时刻（ms）
+//   静止抖动：持续 ≥ FILTER_REST_MIN_MS 的静止段（跳过开头的收敛时间）内输出值与细分值相对均值的 RMS（LSB），
+//             以及输出值每秒的变化次数
+//   开销：每次平滑的耗时（主机上为纳秒；设备上的周期数见 /metrics 的 filter 阶段）
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "filter_policy.h"
+#include "log_tool.h"
+
+#define FILTER_STABLE_BAND_LSB 6   // 静止段内映射值的最大起伏
+#define FILTER_STABLE_MIN_MS 100   // 静止段的最短持续时间
+#define FILTER_STEP_MIN_LSB 64     // 计为阶跃的最小电平变化
+#define FILTER_STEP_MAX_GAP_MS 300 // 计为阶跃的最长过渡时间
+#define FILTER_REST_MIN_MS 500     // 统计静止抖动的最短静止段
+#define FILTER_REST_SKIP_MS 200    // 静止段开头不计入抖动的时间
+#define FILTER_DEAD_ZONE_PCT 0.05f // 回放时使用的死区
+
+struct FilterTrace
+{
+  std::string name;
+  std::vector<uint32_t> timeUs; // 每个采样的时刻
+  std::vector<int> mv;          // 每个采样的电压
+  int minV;                     // 校准范围
+  int maxV;
+};
+
+struct FilterParams
+{
+  OneEuroParams oneEuro = {One_Euro_Min_Cutoff_Hz, One_Euro_Beta, One_Euro_D_Cutoff_Hz};
+  KalmanParams kalman = {Kalman_Accel_Noise, Kalman_Meas_Noise};
+};
+
+struct FilterScore
+{
+  int steps;
+  double lagMeanMs;
+  double lagP90Ms;
+  double lagMaxMs;
+  double restRmsLsb;      // 输出值
+  double restFineRmsLsb;  // 细分值（抖动 DAC 输出）
+  double restChangesPerS; // 输出值每秒变化次数
+  double nsPerSample;
+};
+
+// 在一组轨迹上评测一个策略（各轨迹的阶跃与静止段合并统计）
+FilterScore FilterEvaluate(FilterPolicy policy, const std::vector<FilterTrace> &traces,
+                           const FilterParams &params = FilterParams());
+// 由解码后的采样记录生成轨迹：每次开机、每个踏板一条，未校准的踏板跳过
+std::vector<FilterTrace> FilterTracesFromLog(const std::vector<LogSample> &samples);
+// 打印每个策略的评测结果
+void FilterReport(const char *tag, const std::vector<FilterTrace> &traces, const FilterParams &params = FilterParams());
+
+// 命令行：program filters 记录.bin；argv[1] 不是 filters 时返回 -1
+int FilterToolMain(int argc, char **argv);
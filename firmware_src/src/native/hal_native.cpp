@@ -0,0 +1,134 @@
+// hal_native.cpp
+// pedal_hal.h 的主机实现：模拟 ADC/DAC/GPIO 与虚拟时钟，时间只在 halDelay/simAdvanceMs 时前进
+#include <chrono>
+#include "pedal_hal.h"
+#include "hal_sim.h"
+
+#define SIM_PIN_COUNT 40
+#define SIM_ADC_FULL_MV 3300
+#define SIM_ADC_MAX_RAW 4095
+
+static uint64_t s_nowUs = 0;
+static int s_mv[SIM_PIN_COUNT];
+static int s_level[SIM_PIN_COUNT];
+static int s_dac[SIM_PIN_COUNT];
+static unsigned long s_dacWrites[SIM_PIN_COUNT];
+static int s_dacQ8[SIM_PIN_COUNT];
+static int s_noiseMv = 0;
+static uint32_t s_rng = 0x12345678u;
+
+static inline bool PinValid(int pin) { return pin >= 0 && pin < SIM_PIN_COUNT; }
+
+static int NextNoise()
+{
+  if (s_noiseMv <= 0)
+    return 0;
+  // xorshift32
+  s_rng ^= s_rng << 13;
+  s_rng ^= s_rng >> 17;
+  s_rng ^= s_rng << 5;
+  return (int)(s_rng % (uint32_t)(2 * s_noiseMv + 1)) - s_noiseMv;
+}
+
+void simReset()
+{
+  s_nowUs = 0;
+  s_noiseMv = 0;
+  s_rng = 0x12345678u;
+  for (int i = 0; i < SIM_PIN_COUNT; ++i)
+  {
+    s_mv[i] = 0;
+    s_level[i] = HAL_HIGH; // 按钮上拉，松开为高电平
+    s_dac[i] = 0;
+    s_dacWrites[i] = 0;
+    s_dacQ8[i] = 0;
+  }
+}
+
+void simSetMillivolts(int adcPin, int mv)
+{
+  if (PinValid(adcPin))
+    s_mv[adcPin] = mv;
+}
+
+void simSetNoise(int mvPeak) { s_noiseMv = mvPeak; }
+
+void simSetButton(int pin, bool pressed)
+{
+  if (PinValid(pin))
+    s_level[pin] = pressed ? HAL_LOW : HAL_HIGH;
+}
+
+void simAdvanceMs(unsigned long ms) { s_nowUs += (uint64_t)ms * 1000; }
+
+void simAdvanceUs(unsigned long us) { s_nowUs += us; }
+
+int simDacValue(int pin) { return PinValid(pin) ? s_dac[pin] : 0; }
+
+int simDacValueQ8(int pin) { return PinValid(pin) ? s_dacQ8[pin] : 0; }
+
+int simDigitalValue(int pin) { return PinValid(pin) ? s_level[pin] : 0; }
+
+unsigned long simDacWriteCount(int pin) { return PinValid(pin) ? s_dacWrites[pin] : 0; }
+
+void halAdcBegin() {}
+
+int halAnalogRead(int pin)
+{
+  if (!PinValid(pin))
+    return 0;
+  // 线性 ADC 模型：0..3300mV → 0..4095
+  long raw = (long)(s_mv[pin] + NextNoise()) * SIM_ADC_MAX_RAW / SIM_ADC_FULL_MV;
+  return raw < 0 ? 0 : (raw > SIM_ADC_MAX_RAW ? SIM_ADC_MAX_RAW : (int)raw);
+}
+
+int halRawToMillivolts(int raw)
+{
+  // 与 esp_adc_cal_raw_to_voltage 的线性模式同样的定点计算方式，便于对比查表前后的开销
+  const uint32_t coeffA = (uint32_t)(((uint64_t)SIM_ADC_FULL_MV << 16) / SIM_ADC_MAX_RAW);
+  const uint32_t coeffB = 0;
+  return (int)((((uint64_t)coeffA * (uint32_t)raw) + (1 << 15)) >> 16) + coeffB;
+}
+
+int halDigitalRead(int pin) { return PinValid(pin) ? s_level[pin] : HAL_HIGH; }
+
+void halDigitalWrite(int pin, int level)
+{
+  if (PinValid(pin))
+    s_level[pin] = level;
+}
+
+void halDacWrite(int pin, uint8_t value)
+{
+  if (!PinValid(pin))
+    return;
+  s_dac[pin] = value;
+  s_dacQ8[pin] = value << 8;
+  s_dacWrites[pin]++;
+}
+
+void halDacBegin() {}
+
+// 模拟的输出级：抖动后的平均值即目标码值，simDacValue 给出最接近的码值
+void halDacWriteQ8(int pin, int codeQ8)
+{
+  if (!PinValid(pin))
+    return;
+  s_dac[pin] = (codeQ8 + 128) >> 8;
+  s_dacQ8[pin] = codeQ8;
+  s_dacWrites[pin]++;
+}
+
+unsigned long halMillis() { return (unsigned long)(s_nowUs / 1000); }
+
+uint32_t halMicros() { return (uint32_t)s_nowUs; }
+
+void halDelay(unsigned long ms) { s_nowUs += (uint64_t)ms * 1000; }
+
+uint32_t halCycleCount()
+{
+  // 主机上以纳秒计数代替 CPU 周期
+  return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
@@ -0,0 +1,23 @@
+// hal_sim.h
+// 主机模拟硬件的控制接口：设置霍尔电压/按钮状态、推进虚拟时钟、读取 DAC/GPIO 输出
+#pragma once
+#include <stdint.h>
+
+// 恢复初始状态：时钟归零，所有输入为静止，按钮松开
+void simReset();
+// 设置某个 ADC 引脚上的霍尔电压（mV）
+void simSetMillivolts(int adcPin, int mv);
+// 设置 ADC 噪声幅度（±mV，均匀分布，固定种子可复现）
+void simSetNoise(int mvPeak);
+// 按下/松开按钮（低电平有效）
+void simSetButton(int pin, bool pressed);
+// 推进虚拟时钟
+void simAdvanceMs(unsigned long ms);
+void simAdvanceUs(unsigned long us);
+
+int simDacValue(int pin);
+// DAC 目标码值（Q8）：抖动输出时为平均码值，普通输出时为码值×256
+int simDacValueQ8(int pin);
+int simDigitalValue(int pin);
+// 自 simReset 以来某个 DAC 引脚的写入次数
+unsigned long simDacWriteCount(int pin);
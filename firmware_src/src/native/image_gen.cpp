@@ -0,0 +1,142 @@
+// image_gen.cpp
+#include <stdio.h>
+#include <string.h>
+#include "image_gen.h"
+#include "ota_stream.h"
+
+// 代码段在 ESP32 指令地址空间中的起点
+#define IMAGE_TEXT_BASE 0x400D0018u
+
+static uint32_t NextRandom(uint32_t &state)
+{
+  // xorshift32
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+// 把相邻的随机数打散为种子，避免各函数的 xorshift 序列相互重叠
+static uint32_t MixSeed(uint32_t x)
+{
+  x ^= x >> 16;
+  x *= 0x85EBCA6Bu;
+  x ^= x >> 13;
+  x *= 0xC2B2AE35u;
+  x ^= x >> 16;
+  return x ? x : 1;
+}
+
+std::vector<ImageFunc> ImageLayout(uint32_t seed, uint32_t size)
+{
+  std::vector<ImageFunc> funcs;
+  uint32_t rng = seed ? seed : 1;
+  uint32_t total = OTA_IMAGE_HEADER_SIZE + SHA256_DIGEST_SIZE;
+  while (total < size)
+  {
+    uint32_t r = NextRandom(rng);
+    ImageFunc f;
+    f.seed = MixSeed(NextRandom(rng));
+    f.data = r % 64 == 0;
+    f.size = f.data ? 4096 + (r >> 8) % 16384 : 64 + (r >> 8) % 960;
+    f.size &= ~3u;
+    if (total + f.size > size)
+      f.size = (size - total) & ~3u;
+    if (f.size == 0)
+      break;
+    funcs.push_back(f);
+    total += f.size;
+  }
+  return funcs;
+}
+
+Bytes ImageRender(const std::vector<ImageFunc> &funcs)
+{
+  std::vector<uint32_t> offset(funcs.size());
+  uint32_t pos = OTA_IMAGE_HEADER_SIZE;
+  for (size_t i = 0; i < funcs.size(); ++i)
+  {
+    offset[i] = pos;
+    pos += funcs[i].size;
+  }
+
+  // 固定的指令字表，所有函数共用
+  uint32_t vocab[1024];
+  uint32_t vr = 0x9E3779B9u;
+  for (uint32_t &w : vocab)
+    w = NextRandom(vr);
+
+  Bytes img(pos, 0);
+  img[0] = OTA_IMAGE_MAGIC;
+  img[1] = 4; // 段数
+  img[OTA_IMAGE_HASH_APPENDED_OFFSET] = 1;
+  for (size_t i = 0; i < funcs.size(); ++i)
+  {
+    uint32_t rng = funcs[i].seed ? funcs[i].seed : 1;
+    for (uint32_t k = 0; k < funcs[i].size; k += 4)
+    {
+      uint32_t r = NextRandom(rng);
+      uint32_t w;
+      if (funcs[i].data)
+        w = r;
+      else if (r % 8 == 0)
+        w = IMAGE_TEXT_BASE + offset[(r >> 8) % funcs.size()]; // 指向另一个函数
+      else // 常用指令更集中，部分指令的低 8 位为寄存器/立即数
+        w = vocab[(r >> 8) % 4 ? (r >> 16) % 64 : (r >> 16) % 1024] ^ ((r >> 10) % 4 ? 0 : (r >> 3) & 0xFF);
+      memcpy(&img[offset[i] + k], &w, 4);
+    }
+  }
+
+  Sha256Ctx sha;
+  uint8_t digest[SHA256_DIGEST_SIZE];
+  Sha256Init(sha);
+  Sha256Update(sha, img.data(), img.size());
+  Sha256Final(sha, digest);
+  img.insert(img.end(), digest, digest + SHA256_DIGEST_SIZE);
+  return img;
+}
+
+#define IMAGE_GZIP_TMP "/tmp/pedal_image_gzip.bin"
+
+Bytes ImageGzip(const Bytes &data, int level)
+{
+  Bytes out;
+  if (!ImageSave(IMAGE_GZIP_TMP, data))
+    return out;
+  char cmd[128];
+  snprintf(cmd, sizeof(cmd), "gzip -%d -n -c %s 2>/dev/null", level, IMAGE_GZIP_TMP);
+  FILE *p = popen(cmd, "r");
+  if (p)
+  {
+    uint8_t buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), p)) > 0)
+      out.insert(out.end(), buf, buf + n);
+    pclose(p);
+  }
+  remove(IMAGE_GZIP_TMP);
+  return out;
+}
+
+bool ImageLoad(const char *path, Bytes &out)
+{
+  FILE *f = fopen(path, "rb");
+  if (!f)
+    return false;
+  out.clear();
+  uint8_t buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+    out.insert(out.end(), buf, buf + n);
+  fclose(f);
+  return true;
+}
+
+bool ImageSave(const char *path, const Bytes &data)
+{
+  FILE *f = fopen(path, "wb");
+  if (!f)
+    return false;
+  bool ok = fwrite(data.data(), 1, data.size(), f) == data.size();
+  return fclose(f) == 0 && ok;
+}
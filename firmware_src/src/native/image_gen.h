@@ -0,0 +1,27 @@
+// image_gen.h
+// 合成的 ESP32 应用镜像（主机基准测试用）：由若干“函数”组成，代码字取自一小组指令字，
+// 字面量池中的指针指向其他函数的地址；修改或插入一个函数会使之后所有函数移位、指针随之改变，
+// 与真实固件的两次编译之间的差异相似。末尾附加 SHA-256（镜像头 hash_appended=1）
+#pragma once
+#include <stdint.h>
+#include <vector>
+
+typedef std::vector<uint8_t> Bytes;
+
+struct ImageFunc
+{
+  uint32_t seed; // 决定函数内容
+  uint32_t size; // 字节数（4 的倍数）
+  bool data;     // true 为不可压缩的数据段（如压缩过的资源）
+};
+
+// 生成总大小约为 size 字节的函数列表
+std::vector<ImageFunc> ImageLayout(uint32_t seed, uint32_t size);
+// 按函数列表生成镜像（含镜像头与附加 SHA-256）
+Bytes ImageRender(const std::vector<ImageFunc> &funcs);
+
+// 调用系统 gzip 压缩（主机工具链通常自带）；gzip 不可用时返回空
+Bytes ImageGzip(const Bytes &data, int level);
+// 读写文件，失败时返回 false
+bool ImageLoad(const char *path, Bytes &out);
+bool ImageSave(const char *path, const Bytes &data);
@@ -0,0 +1,121 @@
+// log_tool.cpp
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <map>
+#include "log_tool.h"
+#include "sample_log.h"
+
+struct DecodeCtx
+{
+  std::vector<LogSample> *out;
+  uint64_t extTick; // 本次开机内展开后的时刻
+  uint32_t lastTick;
+  bool started;
+};
+
+static bool CollectFrame(void *ctx, const SampleLogHeader &h, uint32_t tick, const PedalFrame &f)
+{
+  DecodeCtx &c = *(DecodeCtx *)ctx;
+  c.extTick = c.started ? c.extTick + (uint32_t)(tick - c.lastTick) : tick;
+  c.lastTick = tick;
+  c.started = true;
+  LogSample s;
+  s.session = h.session;
+  s.timeUs = c.extTick * h.tickUs;
+  s.frame = f;
+  c.out->push_back(s);
+  return true;
+}
+
+int LogDecode(const Bytes &data, std::vector<LogSample> &out, int *bad)
+{
+  out.clear();
+  int badBlocks = 0;
+  // 块序号 → 块起点；同一序号出现多次（如快照与写满后的同一块）时取记录较多的一份
+  std::map<uint32_t, std::pair<size_t, uint16_t>> blocks;
+  for (size_t pos = 0; pos + SAMPLE_LOG_BLOCK_SIZE <= data.size(); pos += SAMPLE_LOG_BLOCK_SIZE)
+  {
+    SampleLogHeader h;
+    if (!SampleLogHeaderRead(&data[pos], h))
+    {
+      badBlocks++;
+      continue;
+    }
+    auto it = blocks.find(h.seq);
+    if (it == blocks.end() || it->second.second < h.count)
+      blocks[h.seq] = std::make_pair(pos, h.count);
+  }
+  if (bad)
+    *bad = badBlocks;
+
+  // 按块序号依次解码（序号跨开机连续递增，32 位不会用完）
+  DecodeCtx ctx = {&out, 0, 0, false};
+  int session = -1;
+  for (const auto &b : blocks)
+  {
+    SampleLogHeader h;
+    SampleLogHeaderRead(&data[b.second.first], h);
+    if (h.session != session)
+    {
+      // 新的开机：时刻重新开始
+      ctx.started = false;
+      session = h.session;
+    }
+    SampleLogDecode(&data[b.second.first], CollectFrame, &ctx);
+  }
+  return (int)blocks.size();
+}
+
+bool LogLoad(const char *path, std::vector<LogSample> &out)
+{
+  Bytes data;
+  return ImageLoad(path, data) && LogDecode(data, out) > 0;
+}
+
+bool LogSaveCsv(const char *path, const std::vector<LogSample> &samples)
+{
+  FILE *f = fopen(path, "w");
+  if (!f)
+    return false;
+  fprintf(f, "session,time_us,mv_sustain,mv_sostenuto,mv_soft,value_sustain,value_sostenuto,value_soft,"
+             "min_sustain,min_sostenuto,min_soft,max_sustain,max_sostenuto,max_soft\n");
+  for (const LogSample &s : samples)
+  {
+    const PedalFrame &p = s.frame;
+    fprintf(f, "%u,%llu,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d\n", s.session, (unsigned long long)s.timeUs, p.mv[0], p.mv[1],
+            p.mv[2], p.value[0], p.value[1], p.value[2], p.minv[0], p.minv[1], p.minv[2], p.maxv[0], p.maxv[1],
+            p.maxv[2]);
+  }
+  return fclose(f) == 0;
+}
+
+int LogToolMain(int argc, char **argv)
+{
+  if (argc < 2 || strcmp(argv[1], "log") != 0)
+    return -1;
+  if (argc != 4)
+  {
+    fprintf(stderr, "用法：%s log 记录.bin 输出.csv\n", argv[0]);
+    return 2;
+  }
+  Bytes data;
+  if (!ImageLoad(argv[2], data))
+  {
+    fprintf(stderr, "无法读取 %s\n", argv[2]);
+    return 1;
+  }
+  std::vector<LogSample> samples;
+  int bad = 0;
+  int blocks = LogDecode(data, samples, &bad);
+  if (!LogSaveCsv(argv[3], samples))
+  {
+    fprintf(stderr, "无法写入 %s\n", argv[3]);
+    return 1;
+  }
+  int sessions = 0;
+  for (size_t i = 0; i < samples.size(); ++i)
+    sessions += i == 0 || samples[i].session != samples[i - 1].session;
+  printf("%d 块（跳过损坏 %d 块），%u 帧，%d 次开机\n", blocks, bad, (unsigned)samples.size(), sessions);
+  return 0;
+}
@@ -0,0 +1,25 @@
+// log_tool.h
+// 主机端采样记录解码：把网页门户下载的 pedal_log.bin（sample_log.h 的块序列）还原为按时间排列的踏板帧，
+// 用于主机模拟回放或导出 CSV
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include "image_gen.h"
+#include "pedal.h"
+
+struct LogSample
+{
+  uint16_t session; // 开机序号
+  uint64_t timeUs;  // 本次开机内连续的时刻（us，已展开 32 位回绕，分辨率 SAMPLE_LOG_TICK_US）
+  PedalFrame frame; // frame.timeUs 为 timeUs 的低 32 位，fine 为 value × 256
+};
+
+// 解码：按块序号排序（重复的块只取一次），跳过校验失败的块；返回有效块数，bad 为跳过的块数
+int LogDecode(const Bytes &data, std::vector<LogSample> &out, int *bad = nullptr);
+// 读取并解码记录文件，失败或没有有效块时返回 false
+bool LogLoad(const char *path, std::vector<LogSample> &out);
+// 每行一帧：session,time_us,mv×3,value×3,min×3,max×3（踏板顺序 延音 持音 弱音）
+bool LogSaveCsv(const char *path, const std::vector<LogSample> &samples);
+
+// 命令行：program log 记录.bin 输出.csv；argv[1] 不是 log 时返回 -1
+int LogToolMain(int argc, char **argv);
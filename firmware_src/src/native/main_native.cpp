@@ -0,0 +1,367 @@
+// main_native.cpp
+// 主机（pio run -e native）上运行踏板流水线的场景模拟：
+// 校准扫描、阶跃响应延迟、静止抖动、翻页短踩/长踩判定、温漂跟踪，以及各模块的基准测试。
+// 全部基于虚拟时钟，运行速度远快于真实时间。
+// 带参数运行时作为差分升级工具：program delta 旧.bin 新.bin 补丁.bin（见 delta_diff.h），
+// 采样记录解码工具：program log 记录.bin 输出.csv（见 log_tool.h），
+// 或平滑策略评测：program filters 记录.bin（见 filter_harness.h）
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include "pedal.h"
+#include "pedal_config.h"
+#include "pedal_hal.h"
+#include "bench.h"
+#include "calib_estimator.h"
+#include "delta_diff.h"
+#include "filter_harness.h"
+#include "gesture.h"
+#include "metrics.h"
+#include "hal_sim.h"
+#include "log_tool.h"
+#include "pedal_filter.h"
+#include "trace.h"
+
+// 霍尔传感器的模拟行程（mV）
+#define SIM_REST_MV 600
+#define SIM_PRESSED_MV 2400
+// 校准结果与模拟端点的容差（ADC 量化 + 估计）
+#define SIM_CALIB_TOL_MV 25
+
+static PedalFrame s_frame;
+
+// 等价于 main.cpp 中 loop() 的采样与输出部分
+static void SimLoopOnce()
+{
+  PedalSample(s_frame);
+  PedalOutput(s_frame, true);
+  PedalMaintain();
+  halDelay(Main_Loop_DelayMs);
+}
+
+static void SetAllPedals(int mv)
+{
+  simSetMillivolts(ADC_Sustain_PIN, mv);
+  simSetMillivolts(ADC_Sostenuto_PIN, mv);
+  simSetMillivolts(ADC_Soft_PIN, mv);
+}
+
+static int ScenarioCalibration()
+{
+  CalibrationReset();
+  // 2 秒内把三个踏板从松开踩到底再松开
+  for (unsigned long t = 0; t <= 2000; t += Main_Loop_DelayMs)
+  {
+    int phase = t <= 1000 ? (int)t : (int)(2000 - t);
+    SetAllPedals(SIM_REST_MV + (SIM_PRESSED_MV - SIM_REST_MV) * phase / 1000);
+    CalibrationSample();
+    halDelay(Main_Loop_DelayMs);
+  }
+  printf("[校准] Sustain %d-%dmV | Sostenuto %d-%dmV | Soft %d-%dmV\n",
+         Sustain_Pedal_MIN, Sustain_Pedal_MAX, Sostenuto_Pedal_MIN, Sostenuto_Pedal_MAX, Soft_Pedal_MIN, Soft_Pedal_MAX);
+  // 与 FinishCalibration 一致：不重启，直接生效
+  PedalApplyCalibration();
+  const int minV[PEDAL_COUNT] = {Sustain_Pedal_MIN, Sostenuto_Pedal_MIN, Soft_Pedal_MIN};
+  const int maxV[PEDAL_COUNT] = {Sustain_Pedal_MAX, Sostenuto_Pedal_MAX, Soft_Pedal_MAX};
+  bool pass = true;
+  for (int i = 0; i < PEDAL_COUNT; ++i)
+    pass = pass && abs(minV[i] - SIM_REST_MV) <= SIM_CALIB_TOL_MV && abs(maxV[i] - SIM_PRESSED_MV) <= SIM_CALIB_TOL_MV;
+  char detail[64];
+  snprintf(detail, sizeof(detail), "端点与 %d-%dmV 相差不超过 %dmV", SIM_REST_MV, SIM_PRESSED_MV, SIM_CALIB_TOL_MV);
+  return BenchReport("校准", "端点", pass, detail);
+}
+
+// 在带噪声的演奏轨迹（20 秒，每 5ms 一个采样）中插入几个 ADC 尖峰，对比原始 min/max 与稳健估计
+#define ROBUST_CALIB_SAMPLES 4000
+#define ROBUST_CALIB_NOISE_MV 12
+
+// 以给定范围与死区，返回静止噪声下的最大输出，以及踩到底时的最小输出
+static void RangeQuality(int minV, int maxV, float deadZonePct, int &restMax, int &pressedMin)
+{
+  uint32_t rng = 7;
+  restMax = 0;
+  pressedMin = 255;
+  for (int level = 0; level < 2; ++level)
+  {
+    PedalFilter f = {};
+    PedalFilterSetRange(f, minV, maxV, deadZonePct);
+    for (int i = 0; i < 400; ++i)
+    {
+      rng = rng * 1103515245u + 12345u;
+      int noise = (int)((rng >> 16) % (2 * ROBUST_CALIB_NOISE_MV + 1)) - ROBUST_CALIB_NOISE_MV;
+      int out = PedalFilterUpdate(f, (level ? TRACE_PRESSED_MV : TRACE_REST_MV) + noise);
+      if (i < 50)
+        continue; // 跳过滤波器的初始收敛
+      if (level == 0 && out > restMax)
+        restMax = out;
+      if (level == 1 && out < pressedMin)
+        pressedMin = out;
+    }
+  }
+}
+
+static int ScenarioRobustCalibration()
+{
+  static int trace[ROBUST_CALIB_SAMPLES];
+  TraceGenerate(trace, ROBUST_CALIB_SAMPLES, 2024, ROBUST_CALIB_NOISE_MV);
+  // 偶发的 ADC 尖峰（接触不良、WiFi 发射干扰）
+  trace[500] = 3300;
+  trace[1700] = 3150;
+  trace[2900] = 40;
+
+  CalibEstimator c;
+  CalibEstimatorReset(c);
+  for (int i = 0; i < ROBUST_CALIB_SAMPLES; ++i)
+    CalibEstimatorAdd(c, trace[i]);
+  CalibResult r = CalibEstimatorResult(c);
+
+  int rawRest, rawPressed, robustRest, robustPressed;
+  RangeQuality(c.rawMin, c.rawMax, 0.05f, rawRest, rawPressed);
+  RangeQuality(r.minV, r.maxV, CalibDeadZonePct(r.minV, r.maxV, r.deadZoneMv), robustRest, robustPressed);
+  // 均匀分布 ±A 的标准差为 A/√3
+  printf("[稳健校准] 原始 min/max %d-%dmV（死区 5%%）| 分位数 %d-%dmV，噪声 %.1fmV（实际 %.1fmV），死区 %dmV（%.1f%%）\n",
+         c.rawMin, c.rawMax, r.minV, r.maxV, r.noiseMv, ROBUST_CALIB_NOISE_MV / 1.732f, r.deadZoneMv,
+         100.0f * CalibDeadZonePct(r.minV, r.maxV, r.deadZoneMv));
+  printf("[稳健校准] 静止最大输出 / 踩到底最小输出：原始 %d / %d，稳健 %d / %d\n",
+         rawRest, rawPressed, robustRest, robustPressed);
+  // 尖峰不能撑大范围：稳健估计下静止必须为 0、踩到底必须为 255
+  return BenchReport("稳健校准", "尖峰下满行程", robustRest == 0 && robustPressed == 255);
+}
+
+static int ScenarioStepLatency()
+{
+  SetAllPedals(SIM_REST_MV);
+  for (int i = 0; i < 100; ++i)
+    SimLoopOnce();
+
+  // 延音踏板从松开阶跃到踩到底，测量 DAC 到达终值 90% 的时间
+  int finalDac = (uint8_t)(255 * Max_DAC_Voltage / 3.3);
+  simSetMillivolts(ADC_Sustain_PIN, SIM_PRESSED_MV);
+  unsigned long stepMs = halMillis();
+  unsigned long reachMs = 0;
+  for (int i = 0; i < 200 && reachMs == 0; ++i)
+  {
+    SimLoopOnce();
+    if (simDacValue(DAC_Sustain_PIN) * 10 >= finalDac * 9)
+      reachMs = halMillis() - stepMs;
+  }
+  // 上限：步进限幅下走完 90% 行程所需的循环数，另加两次循环（阶跃与采样不对齐、EMA 收尾）
+  unsigned long budgetMs = (255 * 9 / 10 / PEDAL_FILTER_MAX_STEP + 2) * Main_Loop_DelayMs;
+  char detail[80];
+  snprintf(detail, sizeof(detail), "到达 90%% (%d) 用时 %lums，上限 %lums", finalDac * 9 / 10, reachMs, budgetMs);
+  return BenchReport("阶跃", "延音 DAC 延迟", reachMs != 0 && reachMs <= budgetMs, detail);
+}
+
+static int ScenarioRestJitter()
+{
+  simSetNoise(20);
+  SetAllPedals(SIM_REST_MV + (SIM_PRESSED_MV - SIM_REST_MV) / 2);
+  for (int i = 0; i < 100; ++i)
+    SimLoopOnce();
+
+  // 半踏板静止，统计 DAC 输出跳变次数与目标码值的摆动范围（抖动输出时目标带小数）
+  int last = simDacValue(DAC_Sustain_PIN);
+  int changes = 0;
+  int lo = simDacValueQ8(DAC_Sustain_PIN), hi = lo;
+  for (int i = 0; i < 2000; ++i)
+  {
+    SimLoopOnce();
+    int now = simDacValue(DAC_Sustain_PIN);
+    if (now != last)
+      changes++;
+    last = now;
+    int q8 = simDacValueQ8(DAC_Sustain_PIN);
+    lo = q8 < lo ? q8 : lo;
+    hi = q8 > hi ? q8 : hi;
+  }
+  simSetNoise(0);
+  // 半踏板静止时 DAC 不跳变，目标码值摆动不超过 1 个码
+  char detail[96];
+  snprintf(detail, sizeof(detail), "±20mV 噪声下 2000 次循环 DAC 跳变 %d 次，目标码值摆动 %.2f（%.1fmV）", changes,
+           (hi - lo) / 256.0, (hi - lo) / 256.0 * 3300 / 256);
+  return BenchReport("抖动", "半踏板静止", changes == 0 && hi - lo <= 256, detail);
+}
+
+// 持音踏板踩下 pressMs 后松开（经过完整的采样、滤波链路），记录翻页按键与踩下到第一个按键的延迟
+struct PageTurnResult
+{
+  int keys;
+  PageKey key[8];
+  unsigned long firstMs;
+};
+
+static PageTurnResult PageTurnPress(unsigned long pressMs, bool eager)
+{
+  PageTurnResult r = {};
+  Gesture g;
+  GestureReset(g);
+  GestureConfig cfg = {Page_Press_Level, Page_Release_Level, LongPressTimeMs, 0, Page_Repeat_Delay_Ms, Page_Repeat_Ms};
+  simSetMillivolts(ADC_Sostenuto_PIN, SIM_PRESSED_MV);
+  unsigned long start = halMillis();
+  while (halMillis() - start < pressMs + 200)
+  {
+    if (halMillis() - start >= pressMs)
+      simSetMillivolts(ADC_Sostenuto_PIN, SIM_REST_MV);
+    SimLoopOnce();
+    PageKey keys[GESTURE_PAGE_KEYS_MAX];
+    int n = GesturePageKeys(GestureUpdate(g, cfg, s_frame.value[PEDAL_SOSTENUTO], halMillis()), eager, keys);
+    for (int i = 0; i < n && r.keys < 8; ++i)
+    {
+      if (r.keys == 0)
+        r.firstMs = halMillis() - start;
+      r.key[r.keys++] = keys[i];
+    }
+  }
+  return r;
+}
+
+static void PrintPageTurn(const char *name, const PageTurnResult &r)
+{
+  printf(" | %s →", name);
+  for (int i = 0; i < r.keys; ++i)
+    printf(" %s", r.key[i] == PAGE_NEXT ? "下一页" : "上一页");
+  if (r.keys == 0)
+    printf(" 无");
+  else
+    printf("（首键 %lums）", r.firstMs);
+}
+
+static bool PageTurnKeys(const PageTurnResult &r, const PageKey *expect, int n)
+{
+  if (r.keys != n)
+    return false;
+  for (int i = 0; i < n; ++i)
+    if (r.key[i] != expect[i])
+      return false;
+  return true;
+}
+
+static int ScenarioPageTurn()
+{
+  SetAllPedals(SIM_REST_MV);
+  for (int i = 0; i < 50; ++i)
+    SimLoopOnce();
+  // 松开时翻页：短踩下一页、长踩上一页；踩下即翻页：踩下立刻下一页，长踩再补一次上一页撤销并翻到上一页
+  static const PageKey kShort[] = {PAGE_NEXT};
+  static const PageKey kLong[] = {PAGE_PREV};
+  static const PageKey kEagerLong[] = {PAGE_NEXT, PAGE_PREV, PAGE_PREV};
+  int failed = 0;
+  for (int eager = 0; eager < 2; ++eager)
+  {
+    printf("[翻页] %s", eager ? "踩下即翻页" : "松开时翻页");
+    PageTurnResult shortPress = PageTurnPress(200, eager);
+    PageTurnResult longPress = PageTurnPress(800, eager);
+    PrintPageTurn("短踩 200ms", shortPress);
+    PrintPageTurn("长踩 800ms", longPress);
+    printf("\n");
+    bool pass = PageTurnKeys(shortPress, kShort, 1) &&
+                (eager ? PageTurnKeys(longPress, kEagerLong, 3) : PageTurnKeys(longPress, kLong, 1));
+    // 踩下即翻页的首键在一次全程滤波（约 20 次循环）之内发出
+    if (eager)
+      pass = pass && shortPress.firstMs <= 20 * Main_Loop_DelayMs && longPress.firstMs <= 20 * Main_Loop_DelayMs;
+    failed += BenchReport("翻页", eager ? "踩下即翻页" : "松开时翻页", pass);
+  }
+  return failed;
+}
+
+// 10 分钟演奏（松开 4s / 踩到底 3s / 半踏板 2s 循环），期间霍尔输出随温度线性漂移：
+// 松开端 +80mV，踩到底端 -60mV。对比漂移跟踪后的输出与固定校准范围下的输出；
+// 跟踪后松开必须始终为 0、踩到底必须始终为 255
+#define DRIFT_SIM_MS (10 * 60 * 1000UL)
+#define DRIFT_SIM_REST_MV 80
+#define DRIFT_SIM_PRESSED_MV (-60)
+
+static int ScenarioDrift()
+{
+  int minV0 = Sustain_Pedal_MIN;
+  int maxV0 = Sustain_Pedal_MAX;
+  PedalFilter fixed = {};
+  PedalFilterSetRangeMv(fixed, minV0, maxV0, Sustain_Pedal_DEADZONE);
+
+  simSetNoise(10);
+  int fixedRest = 0, trackedRest = 0, fixedPressed = 255, trackedPressed = 255;
+  for (unsigned long t = 0; t < DRIFT_SIM_MS; t += Main_Loop_DelayMs)
+  {
+    unsigned long phase = t % 9000;
+    int rest = SIM_REST_MV + (int)(DRIFT_SIM_REST_MV * (long)t / (long)DRIFT_SIM_MS);
+    int pressed = SIM_PRESSED_MV + (int)(DRIFT_SIM_PRESSED_MV * (long)t / (long)DRIFT_SIM_MS);
+    SetAllPedals(phase < 4000 ? rest : phase < 7000 ? pressed : (rest + pressed) / 2);
+    SimLoopOnce();
+    int fixedOut = PedalFilterUpdate(fixed, s_frame.mv[PEDAL_SUSTAIN]);
+    // 只统计最后一个循环，且跳过每段开头的过渡
+    if (t + 9000 < DRIFT_SIM_MS || phase % 4000 < 500)
+      continue;
+    if (phase < 4000)
+    {
+      fixedRest = fixedOut > fixedRest ? fixedOut : fixedRest;
+      trackedRest = s_frame.value[PEDAL_SUSTAIN] > trackedRest ? s_frame.value[PEDAL_SUSTAIN] : trackedRest;
+    }
+    else if (phase < 7000)
+    {
+      fixedPressed = fixedOut < fixedPressed ? fixedOut : fixedPressed;
+      trackedPressed = s_frame.value[PEDAL_SUSTAIN] < trackedPressed ? s_frame.value[PEDAL_SUSTAIN] : trackedPressed;
+    }
+  }
+  simSetNoise(0);
+  // 漂移修正只体现在采样帧的范围上，校准参数保持不变
+  printf("[漂移] 松开端 %+dmV、踩到底端 %+dmV：Sustain %d-%dmV → %d-%dmV\n",
+         DRIFT_SIM_REST_MV, DRIFT_SIM_PRESSED_MV, minV0, maxV0, s_frame.minv[PEDAL_SUSTAIN], s_frame.maxv[PEDAL_SUSTAIN]);
+  char detail[128];
+  snprintf(detail, sizeof(detail), "松开最大 固定 %d / 跟踪 %d，踩到底最小 固定 %d / 跟踪 %d", fixedRest, trackedRest,
+           fixedPressed, trackedPressed);
+  bool pass = trackedRest == 0 && trackedPressed == 255 && Sustain_Pedal_MIN == minV0 && Sustain_Pedal_MAX == maxV0;
+  return BenchReport("漂移", "跟踪后满行程", pass, detail);
+}
+
+int main(int argc, char **argv)
+{
+  int tool = DeltaToolMain(argc, argv);
+  if (tool >= 0)
+    return tool;
+  tool = LogToolMain(argc, argv);
+  if (tool >= 0)
+    return tool;
+  tool = FilterToolMain(argc, argv);
+  if (tool >= 0)
+    return tool;
+
+  auto wallStart = std::chrono::steady_clock::now();
+  simReset();
+  PedalBegin();
+
+  int failed = 0;
+  failed += ScenarioCalibration();
+  failed += ScenarioRobustCalibration();
+  failed += ScenarioStepLatency();
+  failed += ScenarioRestJitter();
+  failed += ScenarioPageTurn();
+  failed += ScenarioDrift();
+
+  // 场景运行期间累计的统计（主机上周期数为纳秒，即 1000MHz）
+  static char metricsText[768];
+  MetricsFormat(metricsText, sizeof(metricsText), 1000);
+  printf("[统计]\n%s", metricsText);
+
+  failed += BenchFilter();
+  failed += BenchAdcLut();
+  failed += BenchSampleRing();
+  failed += BenchStatus();
+  failed += BenchOta();
+  failed += BenchDelta();
+  failed += BenchConfig();
+  failed += BenchHidQueue();
+  failed += BenchGesture();
+  failed += BenchMidi();
+  failed += BenchTone();
+  failed += BenchDither();
+  failed += BenchCurve();
+  failed += BenchGovernor();
+  failed += BenchLog();
+  failed += BenchBootProfile();
+  failed += BenchFilterPolicy();
+
+  double wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wallStart).count();
+  printf("[总计] 虚拟时间 %lums，实际耗时 %.2fms，%s\n", halMillis(), wallMs,
+         failed ? "存在失败项" : "全部通过");
+  return failed ? 1 : 0;
+}
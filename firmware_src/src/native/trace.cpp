@@ -0,0 +1,53 @@
+// trace.cpp
+#include "trace.h"
+
+static uint32_t NextRandom(uint32_t &state)
+{
+  // xorshift32
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+void TraceGenerate(int *mv, int count, uint32_t seed, int noiseMv)
+{
+  uint32_t rng = seed ? seed : 1;
+  int level = TRACE_REST_MV;
+  int target = TRACE_REST_MV;
+  int rate = 0; // 每个采样的变化量
+  int hold = 0;
+  for (int i = 0; i < count; ++i)
+  {
+    if (hold > 0)
+    {
+      hold--;
+    }
+    else if (level == target)
+    {
+      // 选择下一个动作：松开 / 踩到底 / 半踏板，速度从慢踩到快踩
+      uint32_t r = NextRandom(rng);
+      switch (r % 4)
+      {
+      case 0:
+        target = TRACE_REST_MV;
+        break;
+      case 1:
+        target = TRACE_PRESSED_MV;
+        break;
+      default:
+        target = TRACE_REST_MV + (int)((r >> 8) % (TRACE_PRESSED_MV - TRACE_REST_MV));
+        break;
+      }
+      rate = 5 + (int)((r >> 20) % 200);
+      hold = 20 + (int)((r >> 12) % 200);
+    }
+    else
+    {
+      int diff = target - level;
+      level += diff > rate ? rate : (diff < -rate ? -rate : diff);
+    }
+    int noise = noiseMv > 0 ? (int)(NextRandom(rng) % (uint32_t)(2 * noiseMv + 1)) - noiseMv : 0;
+    mv[i] = level + noise;
+  }
+}
@@ -0,0 +1,10 @@
+// trace.h
+// 合成的踏板电压轨迹，模拟真实演奏：慢踩、快踩、半踏板保持、颤踏、松开，叠加 ADC 噪声
+#pragma once
+#include <stdint.h>
+
+#define TRACE_REST_MV 600
+#define TRACE_PRESSED_MV 2400
+
+// 生成长度为 count 的电压序列（采样间隔 Main_Loop_DelayMs），seed 相同则结果相同
+void TraceGenerate(int *mv, int count, uint32_t seed, int noiseMv);
@@ -4,6 +4,20 @@
 #include <Update.h>
 #include <DNSServer.h>
 #include <Preferences.h>
+#include <errno.h>
+#include "lwip/sockets.h"
+#include "esp_ota_ops.h"
+#include "esp_partition.h"
+#include "boot_profile.h"
+#include "log_task.h"
+#include "metrics.h"
+#include "output_curve.h"
+#include "pedal_config.h"
+#include "sample_ring.h"
+#include "sense_task.h"
+#include "ota_stream.h"
+#include "portal_assets.h"
+#include "status_codec.h"
 
 // #define DEBUG
 
@@ -24,257 +38,315 @@ static WebServer server(80);
 static DNSServer dnsServer;
 static bool active = false;
 
-// 三个踏板的状态结构（单位：mV，mapped：0-255）
-struct PedalStatus
+// 最近一帧踏板数据（单位：mV，value：0-255），与 /status 处理器同在 loop() 中读写
+static PedalFrame latestFrame = {};
+
+// /events 推送流（Server-Sent Events）：loop() 每收到一帧就压入环形缓冲，
+// 每 Event_Batch_Ms 把缓冲内的全部帧打包成一条事件发给浏览器，网页能看到每一次采样。
+// 推送连接走单独的端口，不经过 WebServer：WebServer 处理完请求后会在同一连接上等待浏览器关闭（最长 2s），
+// 期间不接受其他请求，而推送连接永远不会关闭
+#define Event_Port 81
+#define Event_Batch_Ms 50
+// 发送缓冲一直是满的（浏览器不再读取）超过这个时间就断开，由浏览器自动重连
+#define Event_Stall_Ms 3000
+// 推送用的精简帧：只带映射值，电压与校准范围每批附带最新一帧即可
+struct StreamFrame
 {
-  int mv;
-  int minv;
-  int maxv;
-  int mapped;
+  uint8_t value[PEDAL_COUNT];
 };
+// 1kHz 采样下 50ms 一批约 50 帧，留一倍余量；来不及发送时覆盖最旧的帧
+static SampleRing<StreamFrame, 128, RING_OVERWRITE_OLDEST> streamRing;
+static WiFiServer eventServer(Event_Port);
+static WiFiClient eventClient;
+// 预分配的事件输出缓冲：每帧最多 "255,255,255," 12 字节，128 帧加上头尾不超过 1.7KB
+// 网络拥塞时一条事件可能只发出一部分，剩余部分留在缓冲中下次继续发送，期间新帧在环形缓冲中覆盖最旧的帧
+static char eventBuf[1792];
+static size_t eventLen = 0;
+static size_t eventSent = 0;
+static unsigned long eventProgressMs = 0;
 
-static PedalStatus pedals[3] = {{0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}};
-
-// 外部可调用的函数：用于更新每个踏板的实时状态
-extern "C" void otaPortalSetPedalStatus(int index, int mv, int minv, int maxv, int mapped)
+// 外部可调用的函数：用于更新踏板的实时状态
+void otaPortalSetPedalFrame(const PedalFrame &frame)
 {
-  if (index < 0 || index >= 3)
+  latestFrame = frame;
+  if (!eventClient)
     return;
-  pedals[index].mv = mv;
-  pedals[index].minv = minv;
-  pedals[index].maxv = maxv;
-  pedals[index].mapped = mapped;
+  StreamFrame s;
+  for (int i = 0; i < PEDAL_COUNT; ++i)
+    s.value[i] = (uint8_t)frame.value[statusPageOrder[i]];
+  streamRing.push(s);
 }
 
-// 返回 JSON 状态的处理器
+// 返回 JSON 状态的处理器（序列化到静态缓冲，正文不经过 String）
 void handleStatus()
 {
-  String json = "{";
-  for (int i = 0; i < 3; ++i)
+  static char buf[STATUS_JSON_MAX];
+  size_t n = StatusFormatJson(buf, sizeof(buf), latestFrame);
+  server.send_P(200, "application/json", buf, n);
+}
+
+// 二进制状态：STATUS_BINARY_SIZE 字节，格式见 status_codec.h
+void handleStatusBinary()
+{
+  static uint8_t buf[STATUS_BINARY_SIZE];
+  size_t n = StatusFormatBinary(buf, sizeof(buf), latestFrame);
+  server.send_P(200, "application/octet-stream", (const char *)buf, n);
+}
+
+// 输出曲线：{"curves":[...]}，按 PEDAL_ 索引（延音、持音、弱音），每条的格式见 output_curve.h
+void handleCurves()
+{
+  static char buf[PEDAL_COUNT * 192 + 16];
+  size_t n = snprintf(buf, sizeof(buf), "{\"curves\":[");
+  for (int i = 0; i < PEDAL_COUNT; ++i)
   {
-    json += "\"p" + String(i) + "\":{";
-    json += "\"mv\":" + String(pedals[i].mv) + ",";
-    json += "\"min\":" + String(pedals[i].minv) + ",";
-    json += "\"max\":" + String(pedals[i].maxv) + ",";
-    json += "\"mapped\":" + String(pedals[i].mapped);
-    json += "}";
-    if (i < 2)
-      json += ",";
+    if (i && n + 1 < sizeof(buf))
+      buf[n++] = ',';
+    n += CurveFormatJson(buf + n, sizeof(buf) - n, PedalCurve(i));
   }
-  json += "}";
-  server.send(200, "application/json", json);
+  n += snprintf(buf + n, sizeof(buf) - n, "]}");
+  server.send_P(200, "application/json", buf, n < sizeof(buf) ? n : sizeof(buf) - 1);
 }
 
-const char index_html[] PROGMEM = R"rawliteral(
-<!doctype html>
-<html lang="zh-CN">
-<head>
-  <meta charset="utf-8">
-  <meta name="viewport" content="width=device-width,initial-scale=1">
-  <title>固件更新</title>
-  <style>
-    body{font-family:Segoe UI,Roboto,Arial;background:#f5f7fb;color:#222;margin:0;padding:20px}
-    .card{max-width:720px;margin:30px auto;padding:20px;background:#fff;border-radius:8px;box-shadow:0 6px 18px rgba(0,0,0,0.08)}
-    h1{font-size:20px;margin:0 0 10px}
-    p.note{color:#666;font-size:13px}
-    .row{margin:12px 0}
-    input[type=file]{width:100%}
-    .btn{display:inline-block;padding:10px 16px;border-radius:6px;background:#0078d4;color:#fff;text-decoration:none;border:none;cursor:pointer}
-    .btn:disabled{opacity:0.5}
-    .progress{width:100%;height:14px;background:#eee;border-radius:8px;overflow:hidden}
-    .progress > i{display:block;height:100%;width:0;background:linear-gradient(90deg,#4caf50,#8bc34a);transition:width 150ms}
-    .status{margin-top:8px;font-size:13px}
-    .small{font-size:12px;color:#888}
-    .vprogress{width:60px;height:140px;background:#eee;border-radius:8px;position:relative;margin:8px auto;overflow:hidden}
-    .vprogress>i{position:absolute;left:0;bottom:0;width:100%;height:0;background:linear-gradient(180deg,#4caf50,#8bc34a);transition:height 120ms;border-radius:0 0 8px 8px}
-    .pedal-row{display:flex;gap:12px;justify-content:space-between}
-    .pedal-label{font-weight:600;margin-bottom:6px}
-    .vprogress .vmax, .vprogress .vmin{position:absolute;left:50%;transform:translateX(-50%);color:#444;font-size:12px;font-weight:600}
-    .vprogress .vmax{top:6px}
-    .vprogress .vmin{bottom:6px}
-    .copy-btn{display:inline-block;margin-left:6px;padding:2px 6px;border:1px solid #ccc;border-radius:3px;background:#f8f9fa;color:#666;font-size:11px;cursor:pointer;transition:all 0.2s}
-    .copy-btn:hover{background:#e9ecef;border-color:#999}
-    .copy-btn:active{background:#dee2e6;transform:scale(0.95)}
-  </style>
-</head>
-<body>
-  <div class="card">
-    <h1>延音踏板 固件在线更新</h1>
-    <p class="note" style="color:#d32f2f;font-weight:bold;">注意：使用在线更新功能时无法使用蓝牙翻页</p>
-    <p class="note">在此页面上传编译生成的固件（.bin）。上传完成设备将自动重启。</p>
-
-    <div class="row">
-      <label>选择固件文件（.bin）</label>
-      <input id="file" type="file" accept=".bin" />
-    </div>
-
-    <div class="row">
-      <button id="uploadBtn" class="btn">开始上传</button>
-      <button id="cancelBtn" class="btn" style="background:#999;margin-left:8px;">取消</button>
-    </div>
-
-    <div class="row">
-      <div class="progress"><i id="bar"></i></div>
-      <div class="status" id="status">准备就绪</div>
-      <div class="small">提示：若浏览器未自动打开本页，请在地址栏输入 <strong style="color:#0078d4;">http://192.168.4.1</strong> <button id="copyBtn" class="copy-btn" onclick="copyToClipboard()" title="复制地址">📋</button></div>
-    </div>
-
-    <!-- 三个竖向进度条显示踏板实时状态 -->
-    <div class="row">
-      <div class="pedal-row">
-        <div style="flex:1;text-align:center">
-          <div class="pedal-label" id="v0_label">弱音踏板</div>
-          <div class="vprogress" id="v0"><div class="vmax">0</div><i></i><div class="vmin">0</div></div>
-          <div class="small" id="v0_txt">0 mV (min:0 max:0) → 0</div>
-        </div>
-        <div style="flex:1;text-align:center">
-          <div class="pedal-label" id="v1_label">持音踏板</div>
-          <div class="vprogress" id="v1"><div class="vmax">0</div><i></i><div class="vmin">0</div></div>
-          <div class="small" id="v1_txt">0 mV (min:0 max:0) → 0</div>
-        </div>
-        <div style="flex:1;text-align:center">
-          <div class="pedal-label" id="v2_label">延音踏板</div>
-          <div class="vprogress" id="v2"><div class="vmax">0</div><i></i><div class="vmin">0</div></div>
-          <div class="small" id="v2_txt">0 mV (min:0 max:0) → 0</div>
-        </div>
-      </div>
-    </div>
-  </div>
-
-  <script>
-    const fileEl = document.getElementById('file');
-    const uploadBtn = document.getElementById('uploadBtn');
-    const cancelBtn = document.getElementById('cancelBtn');
-    const bar = document.getElementById('bar');
-    const status = document.getElementById('status');
-    let xhr = null;
-
-    function setStatus(s){ status.textContent = s; }
-    function setProgress(p){ bar.style.width = p + '%'; }
-
-    uploadBtn.addEventListener('click', function(){
-      const f = fileEl.files[0];
-      if(!f){ setStatus('请先选择一个 .bin 文件'); return; }
-      uploadBtn.disabled = true;
-      setStatus('开始上传...');
-      setProgress(0);
-      const fd = new FormData();
-      fd.append('update', f);
-
-      xhr = new XMLHttpRequest();
-      xhr.open('POST', '/update', true);
-      xhr.upload.onprogress = function(e){
-        if(e.lengthComputable){
-          const pct = Math.round(e.loaded / e.total * 100);
-          setProgress(pct);
-          setStatus('上传中：' + pct + '%');
-        }
-      };
-      xhr.onload = function(){
-        if(xhr.status===200){
-          setProgress(100);
-          setStatus('上传完成，设备将重启并应用新固件');
-        } else {
-          setStatus('上传失败：HTTP ' + xhr.status);
-        }
-        uploadBtn.disabled = false;
-      };
-      xhr.onerror = function(){ setStatus('上传发生错误'); uploadBtn.disabled = false; };
-      xhr.send(fd);
-    });
-
-    cancelBtn.addEventListener('click', function(){
-      if(xhr){ xhr.abort(); setStatus('已取消'); setProgress(0); uploadBtn.disabled=false; }
-    });
-
-    // 轮询 /status 更新三个踏板的竖向进度条
-    function updatePedals(){
-      fetch('/status').then(r=>r.json()).then(j=>{
-        for(let i=0;i<3;i++){
-          const p = j['p'+i];
-          if(!p) continue;
-          const pct = Math.round(p.mapped / 255 * 100);
-          const h = Math.max(0, Math.min(100, pct));
-          document.querySelector('#v'+i+' > i').style.height = h+'%';
-          document.getElementById('v'+i+'_txt').textContent = `${p.mv}`;
-          // 将 min/max 显示在进度条顶部/底部
-          const vmaxEl = document.querySelector('#v'+i+' .vmax');
-          const vminEl = document.querySelector('#v'+i+' .vmin');
-          if (vmaxEl) vmaxEl.textContent = p.max;
-          if (vminEl) vminEl.textContent = p.min;
-        }
-      }).catch(e=>{ /* ignore network errors while uploading */ });
-    }
-    setInterval(updatePedals, 100);
-
-    // 复制地址到剪贴板功能
-    function copyToClipboard() {
-      const url = 'http://192.168.4.1';
-      const btn = document.getElementById('copyBtn');
-      
-      if (navigator.clipboard && window.isSecureContext) {
-        // 现代浏览器支持 Clipboard API
-        navigator.clipboard.writeText(url).then(() => {
-          showCopyFeedback(btn, '✓');
-        }).catch(() => {
-          fallbackCopy(url, btn);
-        });
-      } else {
-        // 降级方案
-        fallbackCopy(url, btn);
-      }
-    }
+static OtaCurveSaveFn curveSave = nullptr;
 
-    // 降级复制方案
-    function fallbackCopy(text, btn) {
-      const textArea = document.createElement('textarea');
-      textArea.value = text;
-      textArea.style.position = 'fixed';
-      textArea.style.left = '-999999px';
-      textArea.style.top = '-999999px';
-      document.body.appendChild(textArea);
-      textArea.focus();
-      textArea.select();
-      
-      try {
-        document.execCommand('copy');
-        showCopyFeedback(btn, '✓');
-      } catch (err) {
-        showCopyFeedback(btn, '✗');
-      }
-      
-      document.body.removeChild(textArea);
-    }
+void otaPortalSetCurveSave(OtaCurveSaveFn fn) { curveSave = fn; }
+
+// 可选的 0-255 整数参数：不存在时保持原值，超出范围返回 false
+static bool ByteArg(const char *name, uint8_t &out)
+{
+  if (!server.hasArg(name))
+    return true;
+  long v = server.arg(name).toInt();
+  if (v < 0 || v > 255)
+    return false;
+  out = (uint8_t)v;
+  return true;
+}
+
+// 修改一个踏板的输出曲线：表单参数 p（PEDAL_ 索引），以及要修改的字段 t x0 x1 y0 y1 g on off pts（"x:y,x:y,..."）
+// 未给出的字段保持当前值；参数无效时返回 400 且不改变曲线，成功时立即生效并保存，返回新曲线
+void handleCurveSet()
+{
+  long p = server.hasArg("p") ? server.arg("p").toInt() : -1;
+  if (p < 0 || p >= PEDAL_COUNT)
+  {
+    server.send(400, "text/plain", "踏板索引无效");
+    return;
+  }
+  OutputCurve c = PedalCurve((int)p);
+  bool ok = ByteArg("t", c.type) && ByteArg("x0", c.x0) && ByteArg("x1", c.x1) && ByteArg("y0", c.y0) &&
+            ByteArg("y1", c.y1) && ByteArg("on", c.switchOn) && ByteArg("off", c.switchOff);
+  if (server.hasArg("g"))
+  {
+    long g = server.arg("g").toInt();
+    ok = ok && g >= CURVE_GAMMA_MIN && g <= CURVE_GAMMA_MAX;
+    c.gamma = (uint16_t)g;
+  }
+  if (server.hasArg("pts"))
+    ok = ok && CurveParsePoints(server.arg("pts").c_str(), c);
+  if (!ok || !CurveValid(c))
+  {
+    server.send(400, "text/plain", "曲线参数无效");
+    return;
+  }
+  // 编译查表并切换（采样任务下一帧起使用新曲线），再交给 main.cpp 写入配置块
+  PedalSetCurve((int)p, c);
+  if (curveSave)
+    curveSave((int)p, c);
+  static char buf[192];
+  size_t n = CurveFormatJson(buf, sizeof(buf), c);
+  server.send_P(200, "application/json", buf, n);
+}
+
+// 返回性能统计（纯文本，每行 "名称 值..."，阶段耗时单位为 CPU 周期），以及采样频率调节的时间分布与唤醒延迟、采样记录器状态
+void handleMetrics()
+{
+  static char buf[1024];
+  size_t n = MetricsFormat(buf, sizeof(buf), getCpuFrequencyMhz());
+  GovernorStats g;
+  SenseTaskGovernorStats(g);
+  n += GovernorFormat(buf + n, sizeof(buf) - n, g, Sense_Rate_Hz);
+  LogTaskFormat(buf + n, sizeof(buf) - n);
+  server.send(200, "text/plain", buf);
+}
+
+static bool SendLogBlock(void *ctx, const uint8_t *block, size_t len)
+{
+  server.sendContent((const char *)block, len);
+  return server.client().connected();
+}
+
+// 下载采样记录（格式见 sample_log.h）：按时间顺序逐块分段发送，不需要整段缓冲；
+// 512KB 约需 1 秒，期间 loop() 停在这里（采样任务与 DAC 输出不受影响）
+void handleLog()
+{
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.sendHeader("Content-Disposition", "attachment; filename=\"pedal_log.bin\"");
+  server.send(200, "application/octet-stream", "");
+  LogTaskRead(SendLogBlock, nullptr);
+  server.sendContent("");
+}
 
-    // 显示复制反馈
-    function showCopyFeedback(btn, icon) {
-      const originalText = btn.innerHTML;
-      btn.innerHTML = icon;
-      btn.style.background = icon === '✓' ? '#d4edda' : '#f8d7da';
-      btn.style.borderColor = icon === '✓' ? '#c3e6cb' : '#f5c6cb';
-      
-      setTimeout(() => {
-        btn.innerHTML = originalText;
-        btn.style.background = '#f8f9fa';
-        btn.style.borderColor = '#ccc';
-      }, 1500);
+// 启动阶段计时（纯文本，格式见 boot_profile.h）
+void handleBoot()
+{
+  static char buf[640];
+  BootProfileFormat(buf, sizeof(buf));
+  server.send(200, "text/plain", buf);
+}
+
+// 以非阻塞方式继续发送 eventBuf 中未发完的部分，全部发完时返回 true；
+// 发送缓冲已满时留到下次（WiFiClient::write 会在 loop() 中阻塞等待），出错或长时间发不出去时断开
+static bool FlushEvents()
+{
+  while (eventSent < eventLen)
+  {
+    int w = send(eventClient.fd(), eventBuf + eventSent, eventLen - eventSent, MSG_DONTWAIT);
+    if (w > 0)
+    {
+      eventSent += w;
+      eventProgressMs = millis();
+      continue;
     }
-  </script>
-</body>
-</html>
-)rawliteral";
+    if (w < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) && millis() - eventProgressMs < Event_Stall_Ms)
+      return false;
+    DBG_PRINTLN("[OTA] /events 发送失败，断开推送连接");
+    eventClient.stop();
+    return false;
+  }
+  return true;
+}
 
+// 接受新的推送连接：不解析请求，直接写响应头（只有网页的 EventSource 会连这个端口）；只保留一个订阅者
+static void AcceptEvents()
+{
+  WiFiClient c = eventServer.available();
+  if (!c)
+    return;
+  if (eventClient)
+    eventClient.stop();
+  eventClient = c;
+  eventClient.setNoDelay(true);
+  // 网页来自 80 端口，跨端口的 EventSource 需要 CORS 许可
+  eventLen = snprintf(eventBuf, sizeof(eventBuf),
+                      "HTTP/1.1 200 OK\r\n"
+                      "Content-Type: text/event-stream\r\n"
+                      "Cache-Control: no-cache\r\n"
+                      "Access-Control-Allow-Origin: *\r\n"
+                      "Connection: keep-alive\r\n\r\n"
+                      "retry: 1000\n\n");
+  eventSent = 0;
+  eventProgressMs = millis();
+  // 丢弃订阅前积压的帧
+  StreamFrame s;
+  while (streamRing.pop(s))
+  {
+  }
+}
+
+// 把环形缓冲中的帧打包为一条事件：
+// data:{"v":[p0,p1,p2,p0,p1,p2,...],"p":[[mv,min,max],[mv,min,max],[mv,min,max]]}
+static void PushEvents()
+{
+  static unsigned long lastPush = 0;
+  AcceptEvents();
+  if (!eventClient)
+    return;
+  if (!eventClient.connected())
+  {
+    eventClient.stop();
+    return;
+  }
+  // 浏览器没有按时读取：上一条事件发完之前不生成新事件
+  if (!FlushEvents())
+    return;
+  if (millis() - lastPush < Event_Batch_Ms)
+    return;
+  lastPush = millis();
+
+  const size_t cap = sizeof(eventBuf);
+  size_t n = snprintf(eventBuf, cap, "data:{\"v\":[");
+  StreamFrame s;
+  bool first = true;
+  // 尾部最多约 100 字节，预留足够空间
+  while (n + 128 < cap && streamRing.pop(s))
+  {
+    n += snprintf(eventBuf + n, cap - n, first ? "%u,%u,%u" : ",%u,%u,%u",
+                  s.value[0], s.value[1], s.value[2]);
+    first = false;
+  }
+  if (first)
+    return; // 没有新帧时不发送
+
+  const PedalFrame &f = latestFrame;
+  n += snprintf(eventBuf + n, cap - n, "],\"p\":[");
+  for (int i = 0; i < 3; ++i)
+  {
+    int p = statusPageOrder[i];
+    n += snprintf(eventBuf + n, cap - n, "%s[%d,%d,%d]", i ? "," : "", f.mv[p], f.minv[p], f.maxv[p]);
+  }
+  n += snprintf(eventBuf + n, cap - n, "]}\n\n");
+
+  eventLen = n;
+  eventSent = 0;
+  FlushEvents();
+}
+
+// 网页源文件在 web/index.html，构建时由 scripts/embed_web.py 精简并 gzip 压缩为 portal_assets.h。
+// 浏览器带着相同 ETag 重新请求（强制门户会反复打开首页）时只回 304，不再发送页面
 void handleRoot()
 {
-  server.send_P(200, "text/html", index_html);
+  server.sendHeader("ETag", INDEX_HTML_ETAG);
+  server.sendHeader("Cache-Control", "no-cache");
+  if (server.header("If-None-Match") == INDEX_HTML_ETAG)
+  {
+    server.send(304);
+    return;
+  }
+  server.sendHeader("Content-Encoding", "gzip");
+  server.send_P(200, "text/html", (const char *)index_html_gz, index_html_gz_len);
+}
+
+// 上传流水线：gzip 解压 + SHA-256 校验，校验通过后才调用 Update.end 切换启动分区
+static OtaStream otaStream;
+// 解压窗口只在上传期间占用
+static uint8_t *otaWindow = nullptr;
+static const char *otaError = nullptr;
+
+static bool OtaFlashWrite(void *ctx, const uint8_t *data, size_t len)
+{
+  return Update.write((uint8_t *)data, len) == len;
+}
+
+// 差分补丁的旧镜像：正在运行的 app 分区
+static bool OtaReadRunning(void *ctx, uint32_t offset, uint8_t *buf, size_t len)
+{
+  return esp_partition_read((const esp_partition_t *)ctx, offset, buf, len) == ESP_OK;
+}
+
+static void OtaRelease()
+{
+  free(otaWindow);
+  otaWindow = nullptr;
+}
+
+static void OtaFail(const char *error)
+{
+  if (otaError)
+    return;
+  otaError = error;
+  DBG_PRINTF("更新失败：%s\n", error);
+  Update.abort();
+  OtaRelease();
 }
 
 void handleUpdate()
 {
   server.sendHeader("Connection", "close");
-  if (Update.hasError())
+  if (otaError || Update.hasError())
   {
-    server.send(500, "text/plain", "FAIL");
+    server.send(500, "text/plain", otaError ? otaError : Update.errorString());
     DBG_PRINTLN("/update 返回 500：更新期间发生错误");
   }
   else
@@ -289,30 +361,49 @@ void handleUpload()
 {
   HTTPUpload &upload = server.upload();
 
-  // 在主循环的 otaPortalHandle 中会检查并触发重启
-  static unsigned long restartAt = 0;
   if (upload.status == UPLOAD_FILE_START)
   {
     DBG_PRINTF("开始更新固件: %s\n", upload.filename.c_str());
+    otaError = nullptr;
+    OtaRelease();
+    otaWindow = (uint8_t *)malloc(INFLATE_WINDOW_SIZE);
+    if (!otaWindow)
+    {
+      OtaFail("内存不足，无法分配解压缓冲");
+      return;
+    }
     if (!Update.begin(UPDATE_SIZE_UNKNOWN))
     { // 以最大可用大小开始
-      DBG_PRINTLN("出出出出错了");
       Update.printError(Serial);
+      OtaFail("Update.begin 失败");
+      return;
     }
+    OtaStreamBegin(otaStream, otaWindow, OtaFlashWrite, nullptr);
+    // 补丁基于运行分区生成新镜像，Update 写入的是另一个（未运行的）OTA 分区
+    const esp_partition_t *running = esp_ota_get_running_partition();
+    if (running)
+      OtaStreamSetBase(otaStream, OtaReadRunning, (void *)running, running->size);
   }
   else if (upload.status == UPLOAD_FILE_WRITE)
   {
-    // 将接收到的数据写入Update对象
-    if (Update.write(upload.buf, upload.currentSize) != upload.currentSize)
-    {
-      Update.printError(Serial);
-    }
+    // 解压（如为 gzip）后写入 Update；镜像无效时立即中止，不再写入剩余数据
+    if (!otaError && !OtaStreamWrite(otaStream, upload.buf, upload.currentSize))
+      OtaFail(otaStream.error);
   }
   else if (upload.status == UPLOAD_FILE_END)
   {
+    if (otaError)
+      return;
+    if (!OtaStreamEnd(otaStream))
+    {
+      OtaFail(otaStream.error);
+      return;
+    }
+    OtaRelease();
     if (Update.end(true))
     { // 设置大小为当前大小
-      DBG_PRINTF("更新成功: %u bytes\n", upload.totalSize);
+      DBG_PRINTF("更新成功: 上传 %u 字节，镜像 %u 字节%s%s\n", (unsigned)otaStream.received, (unsigned)otaStream.imageSize,
+                 OtaStreamCompressed(otaStream) ? "（gzip）" : "", OtaStreamIsDelta(otaStream) ? "（差分）" : "");
       DBG_PRINTLN("执行重启...");
       delay(100);
       ESP.restart();
@@ -320,11 +411,12 @@ void handleUpload()
     else
     {
       Update.printError(Serial);
+      otaError = "Update.end 失败";
     }
   }
-
-  if (restartAt != 0 && millis() >= restartAt)
+  else if (upload.status == UPLOAD_FILE_ABORTED)
   {
+    OtaFail("上传中断");
   }
 }
 
@@ -361,8 +453,17 @@ void otaPortalBegin()
     }
   }
   dnsServer.start(53, "*", apIP);
+  // WebServer 只保存事先登记的请求头
+  static const char *headerKeys[] = {"If-None-Match"};
+  server.collectHeaders(headerKeys, 1);
   server.on("/", HTTP_GET, handleRoot);
   server.on("/status", HTTP_GET, handleStatus);
+  server.on("/status.bin", HTTP_GET, handleStatusBinary);
+  server.on("/metrics", HTTP_GET, handleMetrics);
+  server.on("/boot", HTTP_GET, handleBoot);
+  server.on("/log", HTTP_GET, handleLog);
+  server.on("/curves", HTTP_GET, handleCurves);
+  server.on("/curve", HTTP_POST, handleCurveSet);
   server.on("/update", HTTP_POST, handleUpdate, handleUpload);
   // 捕获所有未命中的请求并重定向到根页面，配合 DNS 劫持可以实现 captive-portal 风格自动弹出
   server.onNotFound([]() {
@@ -371,6 +472,7 @@ void otaPortalBegin()
     server.send(302, "text/plain", "");
   });
   server.begin();
+  eventServer.begin();
   DBG_PRINT("OTA 门户已启动，地址：");
   DBG_PRINTLN(WiFi.softAPIP().toString());
 }
@@ -381,6 +483,7 @@ void otaPortalHandle()
     return;
   dnsServer.processNextRequest();
   server.handleClient();
+  PushEvents();
   static unsigned long lastStatus = 0;
   if (millis() - lastStatus > 2000)
   {
@@ -397,6 +500,8 @@ void otaPortalStop()
 {
   if (!active)
     return;
+  eventClient.stop();
+  eventServer.stop();
   server.stop();
   dnsServer.stop();
   WiFi.softAPdisconnect(true);
@@ -0,0 +1,158 @@
+// ota_stream.cpp
+#include <string.h>
+#include "ota_stream.h"
+
+enum
+{
+  FORMAT_UNKNOWN,
+  FORMAT_RAW,
+  FORMAT_GZIP,
+};
+
+enum
+{
+  PAYLOAD_UNKNOWN,
+  PAYLOAD_IMAGE,
+  PAYLOAD_PATCH,
+};
+
+static bool Fail(OtaStream &s, const char *error)
+{
+  if (!s.error)
+    s.error = error;
+  return false;
+}
+
+// 解压后（或原始）的镜像数据：检查镜像头，哈希除最后 32 字节以外的部分，写入分区
+static bool ImageWrite(void *ctx, const uint8_t *data, size_t len)
+{
+  OtaStream &s = *(OtaStream *)ctx;
+  if (s.imageSize < OTA_IMAGE_HEADER_SIZE)
+  {
+    size_t n = OTA_IMAGE_HEADER_SIZE - s.imageSize;
+    if (n > len)
+      n = len;
+    memcpy(s.header + s.imageSize, data, n);
+    if (s.header[0] != OTA_IMAGE_MAGIC)
+      return Fail(s, "不是 ESP32 固件镜像");
+  }
+  if (!s.write(s.writeCtx, data, len))
+    return Fail(s, "写入分区失败");
+  s.imageSize += len;
+
+  // 始终保留最近 32 字节：它们可能是镜像末尾附加的 SHA-256
+  size_t keep = len >= SHA256_DIGEST_SIZE ? 0 : SHA256_DIGEST_SIZE - len;
+  if (s.tailLen > keep)
+  {
+    Sha256Update(s.sha, s.tail, s.tailLen - keep);
+    memmove(s.tail, s.tail + s.tailLen - keep, keep);
+    s.tailLen = keep;
+  }
+  if (len > SHA256_DIGEST_SIZE)
+  {
+    Sha256Update(s.sha, data, len - SHA256_DIGEST_SIZE);
+    data += len - SHA256_DIGEST_SIZE;
+    len = SHA256_DIGEST_SIZE;
+  }
+  memcpy(s.tail + s.tailLen, data, len);
+  s.tailLen += len;
+  return true;
+}
+
+// 解压后的内容：完整镜像直接写入，差分补丁先与运行分区合成新镜像
+static bool PayloadWrite(void *ctx, const uint8_t *data, size_t len)
+{
+  OtaStream &s = *(OtaStream *)ctx;
+  if (s.payload == PAYLOAD_UNKNOWN)
+  {
+    if (data[0] == DELTA_MAGIC[0])
+    {
+      if (!s.readOld)
+        return Fail(s, "不支持差分升级");
+      s.payload = PAYLOAD_PATCH;
+      DeltaPatchBegin(s.patch, s.readOld, s.readOldCtx, s.oldLimit, ImageWrite, &s);
+    }
+    else
+      s.payload = PAYLOAD_IMAGE;
+  }
+  if (s.payload == PAYLOAD_IMAGE)
+    return ImageWrite(&s, data, len);
+  if (!DeltaPatchWrite(s.patch, data, len))
+    return Fail(s, s.patch.error);
+  return true;
+}
+
+void OtaStreamBegin(OtaStream &s, uint8_t *window, OtaWriteFn write, void *writeCtx)
+{
+  s.write = write;
+  s.writeCtx = writeCtx;
+  s.window = window;
+  s.format = FORMAT_UNKNOWN;
+  s.payload = PAYLOAD_UNKNOWN;
+  s.readOld = nullptr;
+  s.readOldCtx = nullptr;
+  s.oldLimit = 0;
+  Sha256Init(s.sha);
+  s.tailLen = 0;
+  s.received = 0;
+  s.imageSize = 0;
+  s.error = nullptr;
+}
+
+void OtaStreamSetBase(OtaStream &s, DeltaReadFn read, void *readCtx, uint32_t limit)
+{
+  s.readOld = read;
+  s.readOldCtx = readCtx;
+  s.oldLimit = limit;
+}
+
+bool OtaStreamWrite(OtaStream &s, const uint8_t *data, size_t len)
+{
+  if (s.error)
+    return false;
+  if (len == 0)
+    return true;
+  if (s.format == FORMAT_UNKNOWN)
+  {
+    if (data[0] == 0x1f)
+    {
+      if (!s.window)
+        return Fail(s, "没有解压缓冲");
+      s.format = FORMAT_GZIP;
+      InflateBegin(s.inflater, s.window, PayloadWrite, &s);
+    }
+    else
+      s.format = FORMAT_RAW;
+  }
+  s.received += len;
+
+  if (s.format == FORMAT_RAW)
+    return PayloadWrite(&s, data, len);
+  if (InflateWrite(s.inflater, data, len) == INFLATE_ERROR)
+    return Fail(s, s.inflater.error);
+  return true;
+}
+
+bool OtaStreamEnd(OtaStream &s)
+{
+  if (s.error)
+    return false;
+  if (s.format == FORMAT_GZIP && InflateFinish(s.inflater) != INFLATE_DONE)
+    return Fail(s, s.inflater.error);
+  if (s.payload == PAYLOAD_PATCH && !DeltaPatchEnd(s.patch))
+    return Fail(s, s.patch.error);
+  if (s.imageSize < OTA_IMAGE_HEADER_SIZE + SHA256_DIGEST_SIZE)
+    return Fail(s, "镜像过短");
+  if (s.header[OTA_IMAGE_HASH_APPENDED_OFFSET] == 1)
+  {
+    uint8_t digest[SHA256_DIGEST_SIZE];
+    Sha256Final(s.sha, digest);
+    if (memcmp(digest, s.tail, SHA256_DIGEST_SIZE) != 0)
+      return Fail(s, "SHA-256 校验失败（镜像损坏或不完整）");
+  }
+  return true;
+}
+
+bool OtaStreamCompressed(const OtaStream &s) { return s.format == FORMAT_GZIP; }
+
+bool OtaStreamIsDelta(const OtaStream &s) { return s.payload == PAYLOAD_PATCH; }
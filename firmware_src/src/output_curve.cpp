@@ -0,0 +1,164 @@
+// output_curve.cpp
+#include <math.h>
+#include <stdio.h>
+#include "output_curve.h"
+#include "pedal_config.h"
+
+void CurveDefault(OutputCurve &c)
+{
+  c.gamma = 100;
+  c.type = CURVE_LINEAR;
+  c.x0 = 0;
+  c.x1 = 255;
+  c.y0 = 0;
+  c.y1 = 255;
+  // 自定义点默认与线性相同，在网页上切换到 CURVE_POINTS 时从这里开始编辑
+  c.count = 2;
+  for (int i = 0; i < CURVE_POINTS_MAX; ++i)
+  {
+    c.px[i] = i == 0 ? 0 : 255;
+    c.py[i] = i == 0 ? 0 : 255;
+  }
+  c.switchOn = Soft_Switch_On_Level;
+  c.switchOff = Soft_Switch_Off_Level;
+}
+
+bool CurveValid(const OutputCurve &c)
+{
+  if (c.type >= CURVE_TYPE_COUNT || c.switchOff >= c.switchOn)
+    return false;
+  switch (c.type)
+  {
+  case CURVE_GAMMA:
+    if (c.gamma < CURVE_GAMMA_MIN || c.gamma > CURVE_GAMMA_MAX)
+      return false;
+    return c.x0 < c.x1;
+  case CURVE_POINTS:
+    if (c.count < 2 || c.count > CURVE_POINTS_MAX)
+      return false;
+    for (int i = 1; i < c.count; ++i)
+    {
+      if (c.px[i] <= c.px[i - 1])
+        return false;
+    }
+    return true;
+  default:
+    return c.x0 < c.x1;
+  }
+}
+
+// 曲线在输入 x（0-255）处的输出（0-255，浮点，只在编译时计算）
+static float CurveEval(const OutputCurve &c, int x)
+{
+  if (c.type == CURVE_POINTS)
+  {
+    if (x <= c.px[0])
+      return c.py[0];
+    for (int i = 1; i < c.count; ++i)
+    {
+      if (x <= c.px[i])
+      {
+        float t = (float)(x - c.px[i - 1]) / (float)(c.px[i] - c.px[i - 1]);
+        return c.py[i - 1] + (c.py[i] - c.py[i - 1]) * t;
+      }
+    }
+    return c.py[c.count - 1];
+  }
+
+  if (x <= c.x0)
+    return c.y0;
+  if (x >= c.x1)
+    return c.y1;
+  float t = (float)(x - c.x0) / (float)(c.x1 - c.x0);
+  if (c.type == CURVE_GAMMA)
+    t = powf(t, c.gamma / 100.0f);
+  return c.y0 + (c.y1 - c.y0) * t;
+}
+
+void CurveCompile(const OutputCurve &c, CurveLut &lut, int (*scale)(int q8))
+{
+  for (int i = 0; i < 256; ++i)
+  {
+    int q8 = (int)lroundf(CurveEval(c, i) * 256.0f);
+    if (q8 < 0)
+      q8 = 0;
+    else if (q8 > 255 << 8)
+      q8 = 255 << 8;
+    lut.q8[i] = (uint16_t)(scale ? scale(q8) : q8);
+  }
+  lut.switchOn = c.switchOn;
+  lut.switchOff = c.switchOff;
+}
+
+size_t CurveFormatJson(char *buf, size_t len, const OutputCurve &c)
+{
+  size_t n = 0;
+#define CURVE_APPEND(...)                              \
+  do                                                   \
+  {                                                    \
+    if (n < len)                                       \
+    {                                                  \
+      int w = snprintf(buf + n, len - n, __VA_ARGS__); \
+      n += w > 0 ? (size_t)w : 0;                      \
+    }                                                  \
+  } while (0)
+
+  CURVE_APPEND("{\"t\":%u,\"x0\":%u,\"x1\":%u,\"y0\":%u,\"y1\":%u,\"g\":%u,\"pts\":[", c.type, c.x0, c.x1, c.y0, c.y1,
+               c.gamma);
+  int count = c.count <= CURVE_POINTS_MAX ? c.count : CURVE_POINTS_MAX;
+  for (int i = 0; i < count; ++i)
+    CURVE_APPEND("%s[%u,%u]", i ? "," : "", c.px[i], c.py[i]);
+  CURVE_APPEND("],\"on\":%u,\"off\":%u}", c.switchOn, c.switchOff);
+#undef CURVE_APPEND
+  return n < len ? n : (len ? len - 1 : 0);
+}
+
+// 读取一个 0-255 的十进制数，返回读取后的位置，格式不符时返回 nullptr
+static const char *ParseByte(const char *p, uint8_t &out)
+{
+  while (*p == ' ')
+    p++;
+  if (*p < '0' || *p > '9')
+    return nullptr;
+  int v = 0;
+  while (*p >= '0' && *p <= '9')
+  {
+    v = v * 10 + (*p++ - '0');
+    if (v > 255)
+      return nullptr;
+  }
+  while (*p == ' ')
+    p++;
+  out = (uint8_t)v;
+  return p;
+}
+
+bool CurveParsePoints(const char *text, OutputCurve &c)
+{
+  uint8_t px[CURVE_POINTS_MAX], py[CURVE_POINTS_MAX];
+  int count = 0;
+  const char *p = text;
+  for (;;)
+  {
+    if (count == CURVE_POINTS_MAX)
+      return false;
+    p = ParseByte(p, px[count]);
+    if (!p || *p++ != ':')
+      return false;
+    p = ParseByte(p, py[count]);
+    if (!p)
+      return false;
+    count++;
+    if (*p == 0)
+      break;
+    if (*p++ != ',')
+      return false;
+  }
+  c.count = (uint8_t)count;
+  for (int i = 0; i < count; ++i)
+  {
+    c.px[i] = px[i];
+    c.py[i] = py[i];
+  }
+  return true;
+}
@@ -0,0 +1,331 @@
+// pedal.cpp
+// 踏板采样 → 滤波 → DAC 输出流水线，所有硬件访问经过 pedal_hal.h
+#include <atomic>
+#include "pedal.h"
+#include "adc_lut.h"
+#include "boot_profile.h"
+#include "calib_estimator.h"
+#include "dac_dither.h"
+#include "drift_tracker.h"
+#include "filter_policy.h"
+#include "pedal_config.h"
+#include "pedal_filter.h"
+#include "metrics.h"
+#include "pedal_hal.h"
+
+// 霍尔范围校准参数
+int Sustain_Pedal_MIN;
+int Sustain_Pedal_MAX;
+int Sostenuto_Pedal_MIN;
+int Sostenuto_Pedal_MAX;
+int Soft_Pedal_MIN;
+int Soft_Pedal_MAX;
+int Sustain_Pedal_DEADZONE;
+int Sostenuto_Pedal_DEADZONE;
+int Soft_Pedal_DEADZONE;
+
+static int s_lastMv[PEDAL_COUNT] = {0};
+// 优化：只使用3个踏板对应的索引，减少内存占用（只用其中的滤波状态，映射参数在 PedalMap 中）
+static PedalFilter s_filters[PEDAL_COUNT] = {};
+// 每个踏板的映射：校准范围（含漂移修正）、死区与按其展开的 raw→0..255 查表。
+// 与输出曲线相同的双缓冲：在采样路径之外编译到未使用的一份后切换指针，采样路径只读指针指向的那份
+struct PedalMap
+{
+  int minV;
+  int maxV;
+  int deadZoneMv;
+  PedalMapLut lut;
+};
+static PedalMap s_mapBufs[PEDAL_COUNT][2];
+static std::atomic<const PedalMap *> s_map[PEDAL_COUNT];
+// 校准期间的流式估计
+static CalibEstimator s_calib[PEDAL_COUNT];
+// 演奏中的端点漂移跟踪，以最近一次生效的校准为锚点；跟踪状态与修正后的端点只由采样路径读写，
+// 端点移动时打包成一个字（min << 16 | max，0 表示没有）交给 PedalMaintain 重建查表
+static DriftTracker s_drift[PEDAL_COUNT];
+static int s_driftMin[PEDAL_COUNT];
+static int s_driftMax[PEDAL_COUNT];
+static std::atomic<uint32_t> s_driftRequest[PEDAL_COUNT];
+// 输出曲线：每个踏板两份查表，编译到未使用的一份后切换指针，采样路径只读指针指向的那份
+static OutputCurve s_curves[PEDAL_COUNT];
+static bool s_curveSet[PEDAL_COUNT] = {false};
+static CurveLut s_curveLuts[PEDAL_COUNT][2];
+static std::atomic<const CurveLut *> s_curveLut[PEDAL_COUNT];
+// 弱音开关当前状态（滞回）
+static bool s_softOn = false;
+// 平滑策略状态（按 pedal_config.h 的 *_Filter_Policy 编译时选择），计时策略需要每个踏板的上一次采样时刻
+static SmoothPolicy<Sustain_Filter_Policy>::State s_sustainSmooth;
+static SmoothPolicy<Sostenuto_Filter_Policy>::State s_sostenutoSmooth;
+static SmoothPolicy<Soft_Filter_Policy>::State s_softSmooth;
+static constexpr bool kSmoothTimed = SmoothPolicy<Sustain_Filter_Policy>::timed ||
+                                     SmoothPolicy<Sostenuto_Filter_Policy>::timed ||
+                                     SmoothPolicy<Soft_Filter_Policy>::timed;
+static uint32_t s_smoothUs[PEDAL_COUNT] = {0};
+
+static inline int PedalIndexOfAdcPin(int pin)
+{
+  return (pin == ADC_Sustain_PIN) ? PEDAL_SUSTAIN : (pin == ADC_Sostenuto_PIN) ? PEDAL_SOSTENUTO
+                                                                               : PEDAL_SOFT;
+}
+
+// 编译未使用的一份映射并切换指针（两次调用之间需间隔一次采样以上）
+static void PedalPublishMap(int idx, int minV, int maxV, int deadZoneMv)
+{
+  const PedalMap *current = s_map[idx].load(std::memory_order_relaxed);
+  PedalMap &next = current == &s_mapBufs[idx][0] ? s_mapBufs[idx][1] : s_mapBufs[idx][0];
+  PedalFilter f = {};
+  PedalFilterSetRangeMv(f, minV, maxV, deadZoneMv);
+  next.minV = minV;
+  next.maxV = maxV;
+  next.deadZoneMv = deadZoneMv;
+  PedalMapLutBuild(next.lut, f);
+  s_map[idx].store(&next, std::memory_order_release);
+}
+
+void PedalBegin()
+{
+  halAdcBegin();
+  // 展开 raw→mV 校准表，之后的转换都是一次查表
+  AdcLutBegin();
+  // 抖动 DAC 输出级（未开启时为空操作）
+  halDacBegin();
+  // 未从配置读取到曲线的踏板使用默认曲线（原固定比例）
+  for (int i = 0; i < PEDAL_COUNT; ++i)
+  {
+    if (!s_curveSet[i])
+    {
+      OutputCurve c;
+      CurveDefault(c);
+      PedalSetCurve(i, c);
+    }
+  }
+  // 映射表先按当前（可能尚未校准的）范围建立，采样路径始终有一份可读
+  PedalApplyCalibration();
+}
+
+void PedalSetCurve(int pedal, const OutputCurve &c)
+{
+  if (pedal < 0 || pedal >= PEDAL_COUNT)
+    return;
+  s_curves[pedal] = c;
+  s_curveSet[pedal] = true;
+  const CurveLut *current = s_curveLut[pedal].load(std::memory_order_relaxed);
+  CurveLut &next = current == &s_curveLuts[pedal][0] ? s_curveLuts[pedal][1] : s_curveLuts[pedal][0];
+  // 延音/持音直接编译为 DAC 码值（Q8），满量程 Max_DAC_Voltage；弱音保持 0-255 电平与开关阈值比较
+  CurveCompile(c, next, pedal == PEDAL_SOFT ? nullptr : DacCodeQ8);
+  s_curveLut[pedal].store(&next, std::memory_order_release);
+}
+
+const OutputCurve &PedalCurve(int pedal) { return s_curves[pedal]; }
+
+// 带防抖的按钮检测函数
+bool CheckButton(int pin)
+{
+  if (halDigitalRead(pin) == HAL_LOW)
+  {
+    halDelay(10);
+    if (halDigitalRead(pin) == HAL_LOW)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+// 检测长按
+bool CheckButtonLong(int pin, unsigned long holdMs)
+{
+  // 优化：只使用实际使用的引脚索引
+  static unsigned long pinStartTimes[3] = {0};
+  int idx = (pin == Sustain_BUTTON_PIN) ? 0 : (pin == Sostenuto_BUTTON_PIN) ? 1
+                                                                            : 2;
+  if (halDigitalRead(pin) == HAL_LOW)
+  {
+    if (pinStartTimes[idx] == 0)
+      pinStartTimes[idx] = halMillis();
+    else if (halMillis() - pinStartTimes[idx] >= holdMs)
+    {
+      // 一次性触发：重置时间戳，等待松开再可触发下一次
+      pinStartTimes[idx] = 0;
+      return true;
+    }
+  }
+  else
+  {
+    pinStartTimes[idx] = 0;
+  }
+  return false;
+}
+
+static inline int SmoothPedal(int idx, PedalFilter &f, int valueRaw, uint32_t dtUs)
+{
+  switch (idx)
+  {
+  case PEDAL_SUSTAIN:
+    return SmoothPolicy<Sustain_Filter_Policy>::Smooth(f, s_sustainSmooth, valueRaw, dtUs);
+  case PEDAL_SOSTENUTO:
+    return SmoothPolicy<Sostenuto_Filter_Policy>::Smooth(f, s_sostenutoSmooth, valueRaw, dtUs);
+  default:
+    return SmoothPolicy<Soft_Filter_Policy>::Smooth(f, s_softSmooth, valueRaw, dtUs);
+  }
+}
+
+// 采样一个踏板并按给定映射滤波到 0-255（采样路径：只查表，不重建）
+static int SampleMapped(int idx, int pin, const PedalMap &map)
+{
+  // 快速多次采样，降低量化与瞬时噪声（低延迟：无额外delay）
+  uint32_t t0 = halCycleCount();
+  int raw0 = halAnalogRead(pin);
+  int raw1 = halAnalogRead(pin);
+  int raw2 = halAnalogRead(pin);
+  int adcValue = (raw0 + raw1 + raw2) / 3;
+  uint32_t t1 = halCycleCount();
+  MetricsStage(METRIC_ADC, t1 - t0);
+  s_lastMv[idx] = AdcLutMillivolts(adcValue);
+  if (map.maxV <= map.minV)
+    return 0;
+
+  // 低延迟平滑与消抖：默认为自适应EMA + 步进限幅 + 微抖动死区（定点实现，见 pedal_filter.cpp），可按踏板换成 filter_policy.h 的策略
+  // 死区映射是一次查表（范围变化时由 PedalPublishMap 在采样路径之外重建）
+  PedalFilter &f = s_filters[idx];
+  uint32_t dtUs = 0;
+  if (kSmoothTimed)
+  {
+    uint32_t now = halMicros();
+    dtUs = now - s_smoothUs[idx];
+    s_smoothUs[idx] = now;
+  }
+  int value = SmoothPedal(idx, f, map.lut.value[adcValue & (ADC_LUT_SIZE - 1)], dtUs);
+  MetricsStage(METRIC_FILTER, halCycleCount() - t1);
+  return value;
+}
+
+// 将 ADC（基于校准范围）映射到 0 -255
+int AdcRemap(int pin, int minV, int maxV, int deadZoneMv)
+{
+  int idx = PedalIndexOfAdcPin(pin);
+  const PedalMap *map = s_map[idx].load(std::memory_order_acquire);
+  if (map->minV != minV || map->maxV != maxV || map->deadZoneMv != deadZoneMv)
+  {
+    PedalPublishMap(idx, minV, maxV, deadZoneMv);
+    map = s_map[idx].load(std::memory_order_relaxed);
+  }
+  return SampleMapped(idx, pin, *map);
+}
+
+int AdcLastMillivolts(int pin)
+{
+  return s_lastMv[PedalIndexOfAdcPin(pin)];
+}
+
+void PedalSample(PedalFrame &frame)
+{
+  static const int kPins[PEDAL_COUNT] = {ADC_Sustain_PIN, ADC_Sostenuto_PIN, ADC_Soft_PIN};
+  frame.timeUs = halMicros();
+  MetricsSampleStart(frame.timeUs);
+  // 只读映射指针，不访问 loop()/校准写入的全局校准参数
+  for (int i = 0; i < PEDAL_COUNT; ++i)
+  {
+    const PedalMap &map = *s_map[i].load(std::memory_order_acquire);
+    frame.minv[i] = map.minV;
+    frame.maxv[i] = map.maxV;
+    frame.value[i] = SampleMapped(i, kPins[i], map);
+    frame.mv[i] = s_lastMv[i];
+    frame.fine[i] = map.maxV > map.minV ? PedalFilterFineQ8(s_filters[i]) : 0;
+#if Drift_Track_Enable
+    // 端点移动时只登记请求，查表由 PedalMaintain 在 loop() 中重建后切换（滤波状态保持连续）
+    if (DriftTrackerAdd(s_drift[i], frame.mv[i], map.deadZoneMv, s_driftMin[i], s_driftMax[i]))
+      s_driftRequest[i].store((uint32_t)s_driftMin[i] << 16 | (uint16_t)s_driftMax[i], std::memory_order_release);
+#endif
+  }
+}
+
+void PedalMaintain()
+{
+  for (int i = 0; i < PEDAL_COUNT; ++i)
+  {
+    uint32_t request = s_driftRequest[i].exchange(0, std::memory_order_acquire);
+    if (request == 0)
+      continue;
+    const PedalMap *map = s_map[i].load(std::memory_order_relaxed);
+    PedalPublishMap(i, (int)(request >> 16), (int)(request & 0xffff), map->deadZoneMv);
+  }
+}
+
+void PedalOutput(const PedalFrame &frame, bool sostenutoEnabled)
+{
+  uint32_t t0 = halCycleCount();
+  const CurveLut &sustainLut = *s_curveLut[PEDAL_SUSTAIN].load(std::memory_order_acquire);
+  const CurveLut &sostenutoLut = *s_curveLut[PEDAL_SOSTENUTO].load(std::memory_order_acquire);
+  const CurveLut &softLut = *s_curveLut[PEDAL_SOFT].load(std::memory_order_acquire);
+#if Dac_Dither_Enable
+  // 写入细分码值（曲线查表，相邻项插值），由 DMA 输出级在相邻码值间做 sigma-delta 调制（dac_dither.h）
+  halDacWriteQ8(DAC_Sustain_PIN, CurveLookupQ8(sustainLut, frame.fine[PEDAL_SUSTAIN]));
+  if (sostenutoEnabled)
+    halDacWriteQ8(DAC_Sostenuto_PIN, CurveLookupQ8(sostenutoLut, frame.fine[PEDAL_SOSTENUTO]));
+#else
+  // 输出延音信号（查表值为 DAC 码值 Q8）
+  halDacWrite(DAC_Sustain_PIN, (uint8_t)(CurveLookup(sustainLut, frame.value[PEDAL_SUSTAIN]) >> 8));
+
+  // 输出持音信号
+  if (sostenutoEnabled)
+    halDacWrite(DAC_Sostenuto_PIN, (uint8_t)(CurveLookup(sostenutoLut, frame.value[PEDAL_SOSTENUTO]) >> 8));
+#endif
+
+  // 输出弱音开关信号：曲线输出带滞回，半踩在阈值附近抖动时不会反复开合
+  s_softOn = CurveSwitch(softLut, s_softOn, frame.value[PEDAL_SOFT]);
+  halDigitalWrite(Switch_Soft_PIN, s_softOn ? HAL_HIGH : HAL_LOW);
+
+  MetricsStage(METRIC_DAC, halCycleCount() - t0);
+  MetricsLatency(halMicros() - frame.timeUs);
+  BootMark(BOOT_FIRST_DAC);
+}
+
+void CalibrationReset()
+{
+  // ADC 电压单位为 mV，设置初始 min 为较大值，max 为 0
+  Sustain_Pedal_MIN = 5000;
+  Sustain_Pedal_MAX = 0;
+  Sostenuto_Pedal_MIN = 5000;
+  Sostenuto_Pedal_MAX = 0;
+  Soft_Pedal_MIN = 5000;
+  Soft_Pedal_MAX = 0;
+  Sustain_Pedal_DEADZONE = 0;
+  Sostenuto_Pedal_DEADZONE = 0;
+  Soft_Pedal_DEADZONE = 0;
+  for (int i = 0; i < PEDAL_COUNT; ++i)
+    CalibEstimatorReset(s_calib[i]);
+}
+
+static void CalibrationApply(int idx, int pin, int &minV, int &maxV, int &deadZone)
+{
+  CalibEstimatorAdd(s_calib[idx], AdcLutMillivolts(halAnalogRead(pin)));
+  // 用 0.5%/99.5% 分位数代替原始 min/max，偶发尖峰不会拉宽范围
+  CalibResult r = CalibEstimatorResult(s_calib[idx]);
+  minV = r.minV;
+  maxV = r.maxV;
+  deadZone = r.deadZoneMv;
+}
+
+void CalibrationSample()
+{
+  CalibrationApply(PEDAL_SUSTAIN, ADC_Sustain_PIN, Sustain_Pedal_MIN, Sustain_Pedal_MAX, Sustain_Pedal_DEADZONE);
+  CalibrationApply(PEDAL_SOSTENUTO, ADC_Sostenuto_PIN, Sostenuto_Pedal_MIN, Sostenuto_Pedal_MAX, Sostenuto_Pedal_DEADZONE);
+  CalibrationApply(PEDAL_SOFT, ADC_Soft_PIN, Soft_Pedal_MIN, Soft_Pedal_MAX, Soft_Pedal_DEADZONE);
+}
+
+void PedalApplyCalibration()
+{
+  const int minV[PEDAL_COUNT] = {Sustain_Pedal_MIN, Sostenuto_Pedal_MIN, Soft_Pedal_MIN};
+  const int maxV[PEDAL_COUNT] = {Sustain_Pedal_MAX, Sostenuto_Pedal_MAX, Soft_Pedal_MAX};
+  const int deadZone[PEDAL_COUNT] = {Sustain_Pedal_DEADZONE, Sostenuto_Pedal_DEADZONE, Soft_Pedal_DEADZONE};
+  for (int i = 0; i < PEDAL_COUNT; ++i)
+  {
+    DriftTrackerReset(s_drift[i], minV[i], maxV[i]);
+    s_driftMin[i] = minV[i];
+    s_driftMax[i] = maxV[i];
+    s_driftRequest[i].store(0, std::memory_order_relaxed);
+    // 滤波器保留当前输出并从该值平滑过渡
+    PedalPublishMap(i, minV[i], maxV[i], deadZone[i]);
+  }
+}
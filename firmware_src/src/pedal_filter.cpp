@@ -0,0 +1,159 @@
+// pedal_filter.cpp
+#include <stdlib.h>
+#include "pedal_filter.h"
+#include "calib_estimator.h"
+#include "pedal_hal.h"
+
+static inline int ClampInt(int v, int lo, int hi)
+{
+  return v < lo ? lo : (v > hi ? hi : v);
+}
+
+static inline float ClampDeadZone(float deadZonePct)
+{
+  // 防止死区重叠
+  return deadZonePct < 0.0f ? 0.0f : (deadZonePct > 0.45f ? 0.45f : deadZonePct);
+}
+
+static inline int RoundFloat(float x)
+{
+  return (int)(x + (x >= 0 ? 0.5f : -0.5f));
+}
+
+// 微抖动死区 + 步进限幅，两种实现共用
+static inline int StepLimit(int lastOut, int emaInt)
+{
+  // 微抖动死区：差值≤1 不更新，避免1级跳动
+  int step = emaInt - lastOut;
+  if (step >= -1 && step <= 1)
+    return lastOut;
+  // 限制单次步进，避免过快跳变但保持低延迟响应
+  if (step > PEDAL_FILTER_MAX_STEP)
+    step = PEDAL_FILTER_MAX_STEP;
+  else if (step < -PEDAL_FILTER_MAX_STEP)
+    step = -PEDAL_FILTER_MAX_STEP;
+  return lastOut + step;
+}
+
+void PedalFilterSetRangeMv(PedalFilter &f, int minV, int maxV, int deadZoneMv)
+{
+  PedalFilterSetRange(f, minV, maxV, CalibDeadZonePct(minV, maxV, deadZoneMv));
+  f.deadZoneMv = deadZoneMv;
+}
+
+void PedalFilterSetRange(PedalFilter &f, int minV, int maxV, float deadZonePct)
+{
+  f.minV = minV;
+  f.maxV = maxV;
+  f.deadZoneMv = PEDAL_FILTER_DEAD_ZONE_PCT;
+
+  // 死区边界与浮点版本使用相同的截断方式，保证映射区间一致
+  float dz = ClampDeadZone(deadZonePct);
+  int reminV = minV + (maxV - minV) * dz;
+  int remaxV = maxV - (maxV - minV) * dz;
+  f.reminV = reminV;
+  f.span = remaxV - reminV;
+  // 倒数取 floor(2^32 * 255 / span) + 1：x ≤ span < 2^16 时 (x * recip) >> 32 恰好等于 floor(255 * x / span)
+  f.recipQ32 = f.span > 0 ? (uint32_t)((255ULL << 32) / (uint32_t)f.span + 1) : 0;
+}
+
+int PedalFilterMap(const PedalFilter &f, int mv)
+{
+  if (f.span <= 0)
+    return 0;
+  uint32_t x = (uint32_t)(ClampInt(mv, f.reminV, f.reminV + f.span) - f.reminV);
+  return (int)(((uint64_t)x * f.recipQ32) >> 32);
+}
+
+int PedalFilterSmooth(PedalFilter &f, int valueRaw)
+{
+  if (!f.inited)
+  {
+    f.inited = true;
+    f.emaQ16 = valueRaw << PEDAL_FILTER_SHIFT;
+    f.lastOut = valueRaw;
+    f.fineQ8 = valueRaw << 8;
+  }
+  else
+  {
+    // 与浮点版比较同一个整数：输入与取整后的 EMA 之差（EMA 始终非负，直接加 0.5 取整）
+    int prevInt = (f.emaQ16 + (1 << (PEDAL_FILTER_SHIFT - 1))) >> PEDAL_FILTER_SHIFT;
+    int32_t alpha = abs(valueRaw - prevInt) > PEDAL_FILTER_FAST_DELTA ? PEDAL_FILTER_ALPHA_FAST : PEDAL_FILTER_ALPHA_SLOW;
+    int32_t delta = (valueRaw << PEDAL_FILTER_SHIFT) - f.emaQ16;
+    // Q26 × Q16 需要 64 位中间结果（Xtensa 上为一次 MULL + MULSH），带舍入
+    f.emaQ16 += (int32_t)(((int64_t)alpha * delta + (1 << (PEDAL_FILTER_ALPHA_SHIFT - 1))) >> PEDAL_FILTER_ALPHA_SHIFT);
+
+    int emaInt = (f.emaQ16 + (1 << (PEDAL_FILTER_SHIFT - 1))) >> PEDAL_FILTER_SHIFT;
+    f.lastOut = StepLimit(f.lastOut, emaInt);
+
+    // 细分值：再平滑后限制在输出值 ±1 以内（输出值大步变化时直接被拉过去，不增加延迟）
+    int32_t emaQ8 = (f.emaQ16 + (1 << 7)) >> 8;
+    f.fineQ8 += (emaQ8 - f.fineQ8) >> PEDAL_FILTER_FINE_SHIFT;
+    f.fineQ8 = ClampInt(f.fineQ8, (f.lastOut - 1) << 8, (f.lastOut + 1) << 8);
+  }
+
+  return ClampInt(f.lastOut, 0, 255);
+}
+
+int PedalFilterUpdate(PedalFilter &f, int mv)
+{
+  return PedalFilterSmooth(f, PedalFilterMap(f, mv));
+}
+
+int PedalFilterFineQ8(const PedalFilter &f)
+{
+  if (!f.inited)
+    return 0;
+  return ClampInt(f.fineQ8, 0, 255 << 8);
+}
+
+int PedalFilterFloatUpdate(PedalFilterFloat &f, int mv, int minV, int maxV, float deadZonePct)
+{
+  if (maxV <= minV)
+    return 0;
+
+  // 应用死区 (deadZonePct 例如 0.05 表示 5%)
+  float dz = ClampDeadZone(deadZonePct);
+
+  int reminV = minV + (maxV - minV) * dz;
+  int remaxV = maxV - (maxV - minV) * dz;
+  int adcVol = ClampInt(mv, reminV, remaxV);
+  // 计算百分比
+  float pct = (float)(adcVol - reminV) / (float)(remaxV - reminV);
+  int valueRaw = 255 * pct;
+
+  if (!f.inited)
+  {
+    f.inited = true;
+    f.ema = (float)valueRaw;
+    f.lastOut = valueRaw;
+  }
+  else
+  {
+    float delta = (float)valueRaw - f.ema;
+    float alpha = (abs(valueRaw - RoundFloat(f.ema)) > PEDAL_FILTER_FAST_DELTA) ? PEDAL_FILTER_ALPHA_FAST_F : PEDAL_FILTER_ALPHA_SLOW_F;
+    f.ema = f.ema + alpha * delta;
+
+    int emaInt = RoundFloat(f.ema);
+    f.lastOut = StepLimit(f.lastOut, emaInt);
+  }
+
+  return ClampInt(f.lastOut, 0, 255);
+}
+
+void PedalFilterBenchmark(const int *mv, int n, int minV, int maxV, uint8_t *outFixed, uint8_t *outFloat,
+                          uint32_t &fixedCycles, uint32_t &floatCycles)
+{
+  PedalFilter fixedState = {};
+  PedalFilterSetRange(fixedState, minV, maxV, 0.05f);
+  uint32_t t0 = halCycleCount();
+  for (int i = 0; i < n; ++i)
+    outFixed[i] = (uint8_t)PedalFilterUpdate(fixedState, mv[i]);
+  fixedCycles = halCycleCount() - t0;
+
+  PedalFilterFloat floatState = {};
+  t0 = halCycleCount();
+  for (int i = 0; i < n; ++i)
+    outFloat[i] = (uint8_t)PedalFilterFloatUpdate(floatState, mv[i], minV, maxV, 0.05f);
+  floatCycles = halCycleCount() - t0;
+}
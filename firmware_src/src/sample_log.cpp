@@ -0,0 +1,268 @@
+// sample_log.cpp
+#include <string.h>
+#include "crc32.h"
+#include "sample_log.h"
+
+static const uint8_t logMagic[4] = {'P', 'L', 'G', '1'};
+
+#define LOG_FLAG_RANGE 0x40
+#define LOG_FLAG_DT 0x80
+// last[] / 记录字段的排列：mv[3] value[3] minv[3] maxv[3]
+#define LOG_FIELDS (PEDAL_COUNT * 4)
+
+static inline void PutLe16(uint8_t *p, uint32_t v)
+{
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void PutLe32(uint8_t *p, uint32_t v)
+{
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+  p[2] = (uint8_t)(v >> 16);
+  p[3] = (uint8_t)(v >> 24);
+}
+
+static inline uint16_t GetLe16(const uint8_t *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+
+static inline uint32_t GetLe32(const uint8_t *p)
+{
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// zigzag：小的正负差值都编码为小的无符号数（0, -1, 1, -2 → 0, 1, 2, 3）
+static inline uint32_t ZigzagEncode(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+static inline int32_t ZigzagDecode(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+
+// 变长整数（LEB128）：每字节 7 位，最高位表示后面还有字节
+static inline uint8_t *PutVarint(uint8_t *p, uint32_t v)
+{
+  while (v >= 0x80)
+  {
+    *p++ = (uint8_t)(v | 0x80);
+    v >>= 7;
+  }
+  *p++ = (uint8_t)v;
+  return p;
+}
+
+static const uint8_t *GetVarint(const uint8_t *p, const uint8_t *end, uint32_t &v)
+{
+  v = 0;
+  for (int shift = 0; shift < 35 && p < end; shift += 7)
+  {
+    uint8_t b = *p++;
+    v |= (uint32_t)(b & 0x7F) << shift;
+    if (!(b & 0x80))
+      return p;
+  }
+  return nullptr;
+}
+
+static void FrameFields(const PedalFrame &f, int *v)
+{
+  for (int i = 0; i < PEDAL_COUNT; ++i)
+  {
+    v[i] = f.mv[i];
+    v[PEDAL_COUNT + i] = f.value[i];
+    v[PEDAL_COUNT * 2 + i] = f.minv[i];
+    v[PEDAL_COUNT * 3 + i] = f.maxv[i];
+  }
+}
+
+void SampleLogBegin(SampleLogWriter &w, uint32_t seq, uint16_t session)
+{
+  w.header.seq = seq;
+  w.header.session = session;
+  w.header.count = 0;
+  w.header.used = 0;
+  w.header.tickUs = SAMPLE_LOG_TICK_US;
+  w.header.startTick = 0;
+  w.started = false;
+  w.lastUs = 0;
+  w.extUs = 0;
+  w.lastTick = 0;
+  w.lastDt = 0;
+}
+
+bool SampleLogAppend(SampleLogWriter &w, const PedalFrame &f)
+{
+  // 32 位 timeUs 约 71 分钟回绕一次，展开为连续时刻后再量化
+  uint64_t ext = w.started ? w.extUs + (uint32_t)(f.timeUs - w.lastUs) : f.timeUs;
+  uint32_t tick = (uint32_t)(ext / SAMPLE_LOG_TICK_US);
+  bool first = w.header.count == 0;
+
+  int cur[LOG_FIELDS];
+  FrameFields(f, cur);
+  static const int zero[LOG_FIELDS] = {};
+  const int *prev = first ? zero : w.last;
+
+  uint8_t rec[SAMPLE_LOG_RECORD_MAX];
+  uint8_t *p = rec + 1;
+  uint8_t flags = 0;
+  uint32_t dt = first ? 0 : tick - w.lastTick;
+  uint32_t lastDt = first ? 0 : w.lastDt;
+  if (dt != lastDt)
+  {
+    flags |= LOG_FLAG_DT;
+    p = PutVarint(p, ZigzagEncode((int32_t)(dt - lastDt)));
+  }
+  for (int i = 0; i < PEDAL_COUNT * 2; ++i)
+  {
+    if (cur[i] != prev[i])
+    {
+      flags |= 1 << i;
+      p = PutVarint(p, ZigzagEncode(cur[i] - prev[i]));
+    }
+  }
+  if (memcmp(cur + PEDAL_COUNT * 2, prev + PEDAL_COUNT * 2, sizeof(int) * PEDAL_COUNT * 2) != 0)
+  {
+    flags |= LOG_FLAG_RANGE;
+    for (int i = PEDAL_COUNT * 2; i < LOG_FIELDS; ++i)
+      p = PutVarint(p, ZigzagEncode(cur[i] - prev[i]));
+  }
+  rec[0] = flags;
+  size_t len = p - rec;
+  if (w.header.used + len > SAMPLE_LOG_PAYLOAD_MAX)
+    return false;
+
+  memcpy(w.block + SAMPLE_LOG_HEADER_SIZE + w.header.used, rec, len);
+  w.header.used += (uint16_t)len;
+  if (first)
+    w.header.startTick = tick;
+  w.header.count++;
+  w.started = true;
+  w.lastUs = f.timeUs;
+  w.extUs = ext;
+  w.lastTick = tick;
+  w.lastDt = dt;
+  memcpy(w.last, cur, sizeof(cur));
+  return true;
+}
+
+bool SampleLogSeal(const SampleLogWriter &w, uint8_t *out)
+{
+  const SampleLogHeader &h = w.header;
+  if (h.count == 0)
+    return false;
+  memcpy(out, logMagic, 4);
+  PutLe32(out + 8, h.seq);
+  PutLe16(out + 12, h.session);
+  PutLe16(out + 14, h.count);
+  PutLe16(out + 16, h.used);
+  PutLe16(out + 18, h.tickUs);
+  PutLe32(out + 20, h.startTick);
+  if (out != w.block)
+    memcpy(out + SAMPLE_LOG_HEADER_SIZE, w.block + SAMPLE_LOG_HEADER_SIZE, h.used);
+  // 未用部分保持擦除后的 0xFF，写入闪存时不改变这些位
+  memset(out + SAMPLE_LOG_HEADER_SIZE + h.used, 0xFF, SAMPLE_LOG_PAYLOAD_MAX - h.used);
+  PutLe32(out + 4, Crc32Update(0, out + 8, SAMPLE_LOG_HEADER_SIZE - 8 + h.used));
+  return true;
+}
+
+void SampleLogNext(SampleLogWriter &w)
+{
+  w.header.seq++;
+  w.header.count = 0;
+  w.header.used = 0;
+}
+
+bool SampleLogHeaderRead(const uint8_t *block, SampleLogHeader &h)
+{
+  if (memcmp(block, logMagic, 4) != 0)
+    return false;
+  h.seq = GetLe32(block + 8);
+  h.session = GetLe16(block + 12);
+  h.count = GetLe16(block + 14);
+  h.used = GetLe16(block + 16);
+  h.tickUs = GetLe16(block + 18);
+  h.startTick = GetLe32(block + 20);
+  if (h.used > SAMPLE_LOG_PAYLOAD_MAX || h.count == 0 || h.tickUs == 0)
+    return false;
+  return Crc32Update(0, block + 8, SAMPLE_LOG_HEADER_SIZE - 8 + h.used) == GetLe32(block + 4);
+}
+
+int SampleLogDecode(const uint8_t *block, SampleLogFrameFn fn, void *ctx)
+{
+  SampleLogHeader h;
+  if (!SampleLogHeaderRead(block, h))
+    return -1;
+  const uint8_t *p = block + SAMPLE_LOG_HEADER_SIZE;
+  const uint8_t *end = p + h.used;
+  int cur[LOG_FIELDS] = {};
+  uint32_t tick = h.startTick, dt = 0;
+  int n = 0;
+  for (; n < h.count; ++n)
+  {
+    if (p >= end)
+      return -1;
+    uint8_t flags = *p++;
+    uint32_t v;
+    if (flags & LOG_FLAG_DT)
+    {
+      if (!(p = GetVarint(p, end, v)))
+        return -1;
+      dt += (uint32_t)ZigzagDecode(v);
+    }
+    tick += dt;
+    for (int i = 0; i < PEDAL_COUNT * 2; ++i)
+    {
+      if (!(flags & (1 << i)))
+        continue;
+      if (!(p = GetVarint(p, end, v)))
+        return -1;
+      cur[i] += ZigzagDecode(v);
+    }
+    if (flags & LOG_FLAG_RANGE)
+    {
+      for (int i = PEDAL_COUNT * 2; i < LOG_FIELDS; ++i)
+      {
+        if (!(p = GetVarint(p, end, v)))
+          return -1;
+        cur[i] += ZigzagDecode(v);
+      }
+    }
+
+    PedalFrame f = {};
+    f.timeUs = tick * h.tickUs;
+    for (int i = 0; i < PEDAL_COUNT; ++i)
+    {
+      f.mv[i] = cur[i];
+      f.value[i] = cur[PEDAL_COUNT + i];
+      f.fine[i] = f.value[i] << 8;
+      f.minv[i] = cur[PEDAL_COUNT * 2 + i];
+      f.maxv[i] = cur[PEDAL_COUNT * 3 + i];
+    }
+    if (fn && !fn(ctx, h, tick, f))
+      return n + 1;
+  }
+  return n;
+}
+
+void SampleLogRingScan(SampleLogRing &r, uint32_t blocks, SampleLogHeaderFn read, void *ctx)
+{
+  r.blocks = blocks;
+  r.next = 0;
+  r.seq = 0;
+  r.session = 0;
+  r.valid = 0;
+  SampleLogHeader h, newest = {};
+  for (uint32_t i = 0; i < blocks; ++i)
+  {
+    if (!read(ctx, i, h))
+      continue;
+    // 序号按回绕比较：写入总是沿环前进，序号最大的块之后就是最旧的块
+    if (r.valid == 0 || (int32_t)(h.seq - newest.seq) > 0)
+    {
+      newest = h;
+      r.next = (i + 1) % blocks;
+    }
+    r.valid++;
+  }
+  if (r.valid > 0)
+  {
+    r.seq = newest.seq + 1;
+    r.session = (uint16_t)(newest.session + 1);
+  }
+}
@@ -0,0 +1,169 @@
+// sense_governor.cpp
+#include <stdio.h>
+#include "sense_governor.h"
+
+const uint32_t governorWakeBoundsUs[GOVERNOR_WAKE_BUCKETS - 1] = {2000, 5000, 10000, 20000, 50000};
+
+void GovernorReset(SenseGovernor &g)
+{
+  g.mode = GOVERNOR_ACTIVE;
+  g.started = false;
+  g.waking = false;
+  for (int i = 0; i < PEDAL_COUNT; ++i)
+    g.refMv[i] = 0;
+  g.lastUs = 0;
+  g.motionUs = 0;
+  g.idleSampleUs = 0;
+  g.detectUs = 0;
+  g.fullUs = 0;
+  g.wakePedal = 0;
+  g.wakeMv = 0;
+  g.wakeDevMv = 0;
+  g.wakeExcessMv = 0;
+  g.stats = GovernorStats();
+}
+
+static void RecordWake(GovernorStats &s, uint32_t us)
+{
+  int bucket = 0;
+  while (bucket < GOVERNOR_WAKE_BUCKETS - 1 && us >= governorWakeBoundsUs[bucket])
+    bucket++;
+  s.wake[bucket]++;
+  s.wakes++;
+  s.wakeSumUs += us;
+  if (us > s.wakeMaxUs)
+    s.wakeMaxUs = us;
+}
+
+// 测速结束：估计运动越过阈值的时刻在检测帧之前多久，加上检测帧到第一次全速采样的时间
+static uint32_t WakeLatency(const SenseGovernor &g, const PedalFrame &frame, uint32_t now)
+{
+  uint32_t gapUs = g.detectUs - g.idleSampleUs;
+  uint32_t dtUs = now - g.detectUs;
+  // 统一到偏离方向为正
+  int dir = g.wakeDevMv > 0 ? 1 : -1;
+  int excess = g.wakeExcessMv * dir;
+  int moved = (frame.mv[g.wakePedal] - g.wakeMv) * dir;
+  // 插值：从上一次静止采样（偏离 0）匀速到检测帧
+  uint32_t backUs = (uint32_t)((uint64_t)excess * gapUs / (uint32_t)(g.wakeDevMv * dir));
+  // 外推：检测帧之后继续同向运动时按其速度
+  if (moved > 0 && (uint64_t)excess * dtUs < (uint64_t)moved * backUs)
+    backUs = (uint32_t)((uint64_t)excess * dtUs / (uint32_t)moved);
+  return g.fullUs - g.detectUs + backUs;
+}
+
+uint32_t GovernorUpdate(SenseGovernor &g, const GovernorConfig &cfg, const PedalFrame &frame)
+{
+  uint32_t now = frame.timeUs;
+  if (!g.started)
+  {
+    // 第一帧：以当前位置为参考，从全速开始
+    g.started = true;
+    for (int i = 0; i < PEDAL_COUNT; ++i)
+      g.refMv[i] = frame.mv[i];
+    g.lastUs = now;
+    g.motionUs = now;
+    g.stats.activeSamples++;
+    return cfg.activePeriodUs;
+  }
+
+  // 上一帧到这一帧的时间计入上一帧所在的模式
+  uint32_t dt = now - g.lastUs;
+  g.lastUs = now;
+  if (g.mode == GOVERNOR_IDLE)
+    g.stats.idleUs += dt;
+  else
+    g.stats.activeUs += dt;
+
+  if (g.waking)
+  {
+    if (g.fullUs == 0)
+      g.fullUs = now;
+    if (now - g.detectUs >= GOVERNOR_SPEED_WINDOW_US)
+    {
+      g.waking = false;
+      RecordWake(g.stats, WakeLatency(g, frame, now));
+    }
+  }
+
+  bool moving = false;
+  int maxExcess = 0;
+  for (int i = 0; i < PEDAL_COUNT; ++i)
+  {
+    int d = frame.mv[i] - g.refMv[i];
+    if (d > cfg.motionMv || d < -cfg.motionMv)
+    {
+      moving = true;
+      g.refMv[i] = frame.mv[i];
+      int excess = d > 0 ? d - cfg.motionMv : d + cfg.motionMv;
+      if (g.mode == GOVERNOR_IDLE && (excess > maxExcess || -excess > maxExcess))
+      {
+        maxExcess = excess > 0 ? excess : -excess;
+        g.wakePedal = i;
+        g.wakeMv = frame.mv[i];
+        g.wakeDevMv = d;
+        g.wakeExcessMv = excess;
+      }
+    }
+  }
+
+  if (moving)
+  {
+    g.motionUs = now;
+    if (g.mode == GOVERNOR_IDLE)
+    {
+      g.mode = GOVERNOR_ACTIVE;
+      g.waking = true;
+      g.detectUs = now;
+      g.fullUs = 0;
+    }
+  }
+  else if (g.mode == GOVERNOR_ACTIVE && now - g.motionUs >= cfg.idleAfterUs)
+  {
+    g.mode = GOVERNOR_IDLE;
+  }
+
+  if (g.mode == GOVERNOR_IDLE)
+  {
+    g.idleSampleUs = now;
+    g.stats.idleSamples++;
+    return cfg.idlePeriodUs;
+  }
+  g.stats.activeSamples++;
+  return cfg.activePeriodUs;
+}
+
+size_t GovernorFormat(char *buf, size_t len, const GovernorStats &s, uint32_t fullRateHz)
+{
+  size_t n = 0;
+#define GOVERNOR_APPEND(...)                           \
+  do                                                   \
+  {                                                    \
+    if (n < len)                                       \
+    {                                                  \
+      int w = snprintf(buf + n, len - n, __VA_ARGS__); \
+      n += w > 0 ? (size_t)w : 0;                      \
+    }                                                  \
+  } while (0)
+
+  uint64_t totalUs = s.activeUs + s.idleUs;
+  uint32_t samples = s.activeSamples + s.idleSamples;
+  // 平均采样率占全速的比例（千分比）：全速时为 1000
+  uint32_t rateMil = totalUs && fullRateHz ? (uint32_t)((uint64_t)samples * 1000000000ULL / fullRateHz / totalUs) : 0;
+  // 采样频率调节：全速时间(ms) 低频时间(ms) 全速样本 低频样本 唤醒次数 平均采样率(‰)
+  GOVERNOR_APPEND("governor %u %u %u %u %u %u\n", (unsigned)(s.activeUs / 1000), (unsigned)(s.idleUs / 1000),
+                  (unsigned)s.activeSamples, (unsigned)s.idleSamples, (unsigned)s.wakes, (unsigned)rateMil);
+  // 唤醒延迟直方图：每档上限(us):次数，最后一档为 inf
+  GOVERNOR_APPEND("governor_wake_us");
+  for (int i = 0; i < GOVERNOR_WAKE_BUCKETS; ++i)
+  {
+    if (i < GOVERNOR_WAKE_BUCKETS - 1)
+      GOVERNOR_APPEND(" %u:%u", (unsigned)governorWakeBoundsUs[i], (unsigned)s.wake[i]);
+    else
+      GOVERNOR_APPEND(" inf:%u", (unsigned)s.wake[i]);
+  }
+  GOVERNOR_APPEND("\ngovernor_wake_mean_max_us %u %u\n", (unsigned)(s.wakes ? s.wakeSumUs / s.wakes : 0),
+                  (unsigned)s.wakeMaxUs);
+#undef GOVERNOR_APPEND
+  return n < len ? n : (len ? len - 1 : 0);
+}
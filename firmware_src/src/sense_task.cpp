@@ -0,0 +1,125 @@
+// sense_task.cpp
+#include <Arduino.h>
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "metrics.h"
+#include "pedal_config.h"
+#include "sample_ring.h"
+#include "sense_governor.h"
+#include "sense_task.h"
+
+// 环形缓冲容量（帧）：1kHz 下可容纳 loop() 约 64ms 的停顿
+#define SENSE_RING_SIZE 64
+#define SENSE_TASK_STACK 4096
+#define SENSE_TASK_PRIORITY (configMAX_PRIORITIES - 5)
+#define SENSE_TASK_CORE APP_CPU_NUM
+
+static TaskHandle_t senseTask = NULL;
+static esp_timer_handle_t senseTimer = NULL;
+static SampleRing<PedalFrame, SENSE_RING_SIZE, Sense_Ring_Policy> senseRing;
+static volatile bool sostenutoEnabled = true;
+
+#if Sense_Governor_Enable
+static SenseGovernor governor;
+static const GovernorConfig governorConfig = {1000000UL / Sense_Rate_Hz, 1000000UL / Sense_Idle_Rate_Hz,
+                                              Sense_Idle_After_Ms * 1000UL, Sense_Motion_Mv};
+// 统计由采样任务写入、loop() 读取
+static portMUX_TYPE governorLock = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t timerPeriodUs = 0;
+// 恢复全速时唤醒的任务（调用 SenseTaskBegin 的 loopTask）
+static TaskHandle_t wakeTask = NULL;
+static volatile bool idle = false;
+
+// 按调节结果切换定时器周期；从低频恢复全速时唤醒 loop()
+static void SenseGovern(const PedalFrame &frame)
+{
+  portENTER_CRITICAL(&governorLock);
+  uint32_t periodUs = GovernorUpdate(governor, governorConfig, frame);
+  bool nowIdle = GovernorIdle(governor);
+  portEXIT_CRITICAL(&governorLock);
+
+  if (nowIdle)
+    MetricsSampleSkip();
+  if (periodUs != timerPeriodUs)
+  {
+    esp_timer_stop(senseTimer);
+    esp_timer_start_periodic(senseTimer, periodUs);
+    timerPeriodUs = periodUs;
+  }
+  if (idle && !nowIdle && wakeTask != NULL)
+    xTaskNotifyGive(wakeTask);
+  idle = nowIdle;
+}
+#endif
+
+// esp_timer 回调：只负责唤醒采样任务
+// （esp_timer 在动态调频下仍保持准确，LEDC/定时器组则会随 APB 频率变化）
+static void SenseTimerCallback(void *arg)
+{
+  xTaskNotifyGive(senseTask);
+}
+
+static void SenseTaskLoop(void *arg)
+{
+  PedalFrame frame;
+  for (;;)
+  {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    PedalSample(frame);
+    PedalOutput(frame, sostenutoEnabled);
+    senseRing.push(frame);
+#if Sense_Governor_Enable
+    SenseGovern(frame);
+#endif
+  }
+}
+
+void SenseTaskBegin(uint32_t rateHz)
+{
+  if (senseTask != NULL || rateHz == 0)
+    return;
+#if Sense_Governor_Enable
+  GovernorReset(governor);
+  timerPeriodUs = 1000000UL / rateHz;
+  wakeTask = xTaskGetCurrentTaskHandle();
+#endif
+  xTaskCreatePinnedToCore(SenseTaskLoop, "sense", SENSE_TASK_STACK, NULL, SENSE_TASK_PRIORITY, &senseTask, SENSE_TASK_CORE);
+
+  esp_timer_create_args_t args = {};
+  args.callback = SenseTimerCallback;
+  args.dispatch_method = ESP_TIMER_TASK;
+  args.name = "sense";
+  esp_timer_create(&args, &senseTimer);
+  esp_timer_start_periodic(senseTimer, 1000000UL / rateHz);
+}
+
+bool SenseTaskActive() { return senseTask != NULL; }
+
+bool SenseTaskPop(PedalFrame &frame) { return senseRing.pop(frame); }
+
+void SenseTaskSetSostenutoEnabled(bool enabled) { sostenutoEnabled = enabled; }
+
+#if Sense_Governor_Enable
+bool SenseTaskIdle() { return idle; }
+
+void SenseTaskWait(uint32_t ms)
+{
+  // 采样任务恢复全速时提前返回
+  ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(ms));
+}
+
+void SenseTaskGovernorStats(GovernorStats &out)
+{
+  portENTER_CRITICAL(&governorLock);
+  out = governor.stats;
+  portEXIT_CRITICAL(&governorLock);
+}
+#else
+bool SenseTaskIdle() { return false; }
+
+void SenseTaskWait(uint32_t ms) { delay(ms); }
+
+void SenseTaskGovernorStats(GovernorStats &out) { out = GovernorStats(); }
+#endif
@@ -0,0 +1,53 @@
+// status_codec.cpp
+#include <stdio.h>
+#include "status_codec.h"
+
+const int statusPageOrder[PEDAL_COUNT] = {PEDAL_SOFT, PEDAL_SOSTENUTO, PEDAL_SUSTAIN};
+
+size_t StatusFormatJson(char *buf, size_t len, const PedalFrame &frame)
+{
+  size_t n = 0;
+  for (int i = 0; i < PEDAL_COUNT; ++i)
+  {
+    int p = statusPageOrder[i];
+    int w = snprintf(buf + n, len - n, "%s\"p%d\":{\"mv\":%d,\"min\":%d,\"max\":%d,\"mapped\":%d}",
+                     i ? "," : "{", i, frame.mv[p], frame.minv[p], frame.maxv[p], frame.value[p]);
+    if (w < 0 || (size_t)w >= len - n)
+      return 0;
+    n += w;
+  }
+  if (n + 2 > len)
+    return 0;
+  buf[n++] = '}';
+  buf[n] = '\0';
+  return n;
+}
+
+static inline uint8_t *PutLe16(uint8_t *p, int v)
+{
+  uint16_t u = (uint16_t)(int16_t)v;
+  p[0] = (uint8_t)u;
+  p[1] = (uint8_t)(u >> 8);
+  return p + 2;
+}
+
+size_t StatusFormatBinary(uint8_t *buf, size_t len, const PedalFrame &frame)
+{
+  if (len < STATUS_BINARY_SIZE)
+    return 0;
+  uint8_t *p = buf;
+  p[0] = (uint8_t)frame.timeUs;
+  p[1] = (uint8_t)(frame.timeUs >> 8);
+  p[2] = (uint8_t)(frame.timeUs >> 16);
+  p[3] = (uint8_t)(frame.timeUs >> 24);
+  p += 4;
+  for (int i = 0; i < PEDAL_COUNT; ++i)
+  {
+    int ped = statusPageOrder[i];
+    p = PutLe16(p, frame.mv[ped]);
+    p = PutLe16(p, frame.minv[ped]);
+    p = PutLe16(p, frame.maxv[ped]);
+    p = PutLe16(p, frame.value[ped]);
+  }
+  return STATUS_BINARY_SIZE;
+}
@@ -0,0 +1,61 @@
+// tone_player.cpp
+#include <Arduino.h>
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "tone_player.h"
+
+static ToneSequencer toneSeq;
+static esp_timer_handle_t toneTimer = NULL;
+static int toneChannel = 0;
+// loop() 放入旋律与定时器任务推进队列之间的互斥
+static portMUX_TYPE toneLock = portMUX_INITIALIZER_UNLOCKED;
+
+// 在 esp_timer 任务中运行：切换到下一个音符并重新定时
+static void ToneTimerCallback(void *arg)
+{
+  uint16_t freq;
+  portENTER_CRITICAL(&toneLock);
+  uint32_t nextMs = ToneSeqStep(toneSeq, freq);
+  portEXIT_CRITICAL(&toneLock);
+
+  if (freq)
+    ledcWriteTone(toneChannel, freq);
+  else
+    ledcWrite(toneChannel, 0);
+  if (nextMs)
+    esp_timer_start_once(toneTimer, (uint64_t)nextMs * 1000);
+}
+
+void TonePlayerBegin(int channel)
+{
+  if (toneTimer != NULL)
+    return;
+  toneChannel = channel;
+  ToneSeqReset(toneSeq);
+  esp_timer_create_args_t args = {};
+  args.callback = ToneTimerCallback;
+  args.name = "tone";
+  esp_timer_create(&args, &toneTimer);
+}
+
+bool TonePlay(const ToneNote *notes, size_t n)
+{
+  if (toneTimer == NULL)
+    return false;
+  bool start;
+  portENTER_CRITICAL(&toneLock);
+  bool ok = ToneSeqPlay(toneSeq, notes, n, start);
+  portEXIT_CRITICAL(&toneLock);
+  // 空闲时由定时器任务立即开始第一个音符（ledcWriteTone 不在调用方执行）
+  if (start)
+    esp_timer_start_once(toneTimer, 1);
+  return ok;
+}
+
+bool TonePlaying()
+{
+  portENTER_CRITICAL(&toneLock);
+  bool playing = ToneSeqPlaying(toneSeq);
+  portEXIT_CRITICAL(&toneLock);
+  return playing;
+}
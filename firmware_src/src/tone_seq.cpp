@@ -0,0 +1,52 @@
+// tone_seq.cpp
+#include "tone_seq.h"
+
+// 基础音阶（C4..B4）频率，单位 Hz
+static const uint16_t toneFreqs[7] = {262, 294, 330, 349, 392, 440, 494};
+
+uint16_t ToneFrequency(uint8_t degree)
+{
+  return degree >= 1 && degree <= 7 ? toneFreqs[degree - 1] : 0;
+}
+
+void ToneSeqReset(ToneSequencer &s)
+{
+  s.head = 0;
+  s.count = 0;
+  s.playing = false;
+}
+
+bool ToneSeqPlay(ToneSequencer &s, const ToneNote *notes, size_t n, bool &start)
+{
+  start = false;
+  if (n > (size_t)(TONE_QUEUE_SIZE - s.count))
+    return false;
+  for (size_t i = 0; i < n; ++i)
+    s.queue[(s.head + s.count + i) % TONE_QUEUE_SIZE] = notes[i];
+  s.count = (uint8_t)(s.count + n);
+  if (!s.playing && n > 0)
+  {
+    s.playing = true;
+    start = true;
+  }
+  return true;
+}
+
+uint32_t ToneSeqStep(ToneSequencer &s, uint16_t &freqHz)
+{
+  freqHz = 0;
+  if (s.count == 0)
+  {
+    // 最后一个音符结束：静音并停止定时器
+    s.playing = false;
+    return 0;
+  }
+  const ToneNote &note = s.queue[s.head];
+  s.head = (uint8_t)((s.head + 1) % TONE_QUEUE_SIZE);
+  s.count--;
+  freqHz = ToneFrequency(note.degree);
+  // 时长为 0 的音符也占一次回调，保证定时器总能走到结尾的静音
+  return note.ms ? note.ms : 1;
+}
+
+bool ToneSeqPlaying(const ToneSequencer &s) { return s.playing; }